@@ -70,6 +70,10 @@ public:
     //! apply socketopt SO_REUSEADDR at Basesocket
     static CBaseSocket&& SoReuseSocket(CBaseSocket &&rBaseSocket);
 
+    //! apply socketopt SO_REUSEPORT at Basesocket, several sockets can be bound
+    //! to the same port and the kernel distributes the connections between them
+    static CBaseSocket&& SoReusePort(CBaseSocket &&rBaseSocket);
+
     //! apply socketopt SO_BROADCAST at Basesocket
     static CBaseSocket&& SoBroadcast(CBaseSocket &&rBaseSocket);
 
@@ -0,0 +1,499 @@
+/*
+ * This file is part of the EMBTOM project
+ * Copyright (c) 2018-2020 Thomas Willetal
+ * (https://github.com/embtom)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _COROLOOP_H_
+#define _COROLOOP_H_
+
+//******************************************************************************
+// Header
+
+#if __has_include(<version>)
+#include <version>
+#endif
+
+//! The coroutine interface requires C++20, the library itself is built as C++17.
+//! All parts are header only and available if the including unit enables C++20.
+#if defined(__cpp_impl_coroutine) && defined(__cpp_lib_jthread) && __has_include(<coroutine>)
+#define NETWORKING_ADAPTER_COROUTINES 1
+
+#include <coroutine>
+#include <stop_token>
+#include <exception>
+#include <optional>
+#include <variant>
+#include <tuple>
+#include <utility>
+#include <functional>
+#include <iostream>
+#include <unordered_map>
+#include <span.h>
+#include <EventLoop.hpp>
+#include <IpAddress.hpp>
+#include <Tcp/TcpDataLink.hpp>
+#include <Tcp/TcpServer.hpp>
+#include <Udp/UdpDataLink.hpp>
+
+namespace EtNet
+{
+
+template<typename T>
+class CTask;
+
+namespace detail
+{
+
+//! resumes the awaiting coroutine at the end of a task
+struct SFinalAwaiter
+{
+    bool await_ready() noexcept { return false; }
+    template<typename Promise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept
+    {
+        std::coroutine_handle<> continuation = h.promise().continuation();
+        return continuation ? continuation : std::noop_coroutine();
+    }
+    void await_resume() noexcept { }
+};
+
+//! common part of the promise types of CTask. The task is started lazily by
+//! co_await and resumes the awaiting coroutine at its end
+class CTaskPromiseBase
+{
+public:
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    SFinalAwaiter final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() noexcept {
+        m_exception = std::current_exception();
+    }
+
+    void setContinuation(std::coroutine_handle<> continuation) noexcept {
+        m_continuation = continuation;
+    }
+
+    std::coroutine_handle<> continuation() const noexcept {
+        return m_continuation;
+    }
+
+protected:
+    void rethrow() const
+    {
+        if (m_exception) {
+            std::rethrow_exception(m_exception);
+        }
+    }
+
+private:
+    std::coroutine_handle<> m_continuation;
+    std::exception_ptr      m_exception;
+};
+
+template<typename T>
+class CTaskPromise : public CTaskPromiseBase
+{
+public:
+    CTask<T> get_return_object() noexcept;
+
+    template<typename U>
+    void return_value(U&& value) {
+        m_value.emplace(std::forward<U>(value));
+    }
+
+    T result()
+    {
+        rethrow();
+        return std::move(*m_value);
+    }
+
+private:
+    std::optional<T> m_value;
+};
+
+template<>
+class CTaskPromise<void> : public CTaskPromiseBase
+{
+public:
+    CTask<void> get_return_object() noexcept;
+    void return_void() noexcept { }
+    void result() { rethrow(); }
+};
+
+}
+
+//*****************************************************************************
+//! \brief CTask
+//! Lazily started coroutine with a result of type T. The task is started by
+//! co_await, the awaiting coroutine is continued with its result. Exceptions
+//! are forwarded to the awaiting coroutine.
+template<typename T = void>
+class [[nodiscard]] CTask
+{
+public:
+    using promise_type = detail::CTaskPromise<T>;
+
+    CTask(const CTask&)            = delete;
+    CTask& operator=(const CTask&) = delete;
+    CTask(CTask&& rhs) noexcept :
+        m_handle(std::exchange(rhs.m_handle, nullptr))
+    { }
+    CTask& operator=(CTask&& rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            if (m_handle) {
+                m_handle.destroy();
+            }
+            m_handle = std::exchange(rhs.m_handle, nullptr);
+        }
+        return *this;
+    }
+    ~CTask() noexcept
+    {
+        if (m_handle) {
+            m_handle.destroy();
+        }
+    }
+
+    auto operator co_await() && noexcept
+    {
+        struct SAwaiter
+        {
+            std::coroutine_handle<promise_type> handle;
+
+            bool await_ready() const noexcept { return !handle || handle.done(); }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+            {
+                handle.promise().setContinuation(awaiting);
+                return handle;
+            }
+            T await_resume() { return handle.promise().result(); }
+        };
+        return SAwaiter{m_handle};
+    }
+
+private:
+    friend promise_type;
+    explicit CTask(std::coroutine_handle<promise_type> handle) noexcept :
+        m_handle(handle)
+    { }
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+namespace detail
+{
+
+template<typename T>
+inline CTask<T> CTaskPromise<T>::get_return_object() noexcept {
+    return CTask<T>(std::coroutine_handle<CTaskPromise<T>>::from_promise(*this));
+}
+
+inline CTask<void> CTaskPromise<void>::get_return_object() noexcept {
+    return CTask<void>(std::coroutine_handle<CTaskPromise<void>>::from_promise(*this));
+}
+
+}
+
+//*****************************************************************************
+//! \brief CCoroLoop
+//! Drives coroutines by the readiness notifications of a CEventLoop. The awaitable
+//! calls try the non-blocking "tryRecive", "trySend" or "tryAccept" first and
+//! suspend the coroutine until the descriptor becomes ready again.
+//! A descriptor is registered at the EventLoop by its first awaited call, at most
+//! one recive and one send can be pending per descriptor. Before a link or server
+//! is destroyed it has to be released.
+//! A pending call is cancelled through its stop token, the stop can be requested from
+//! any thread. All other calls have to be made at the thread running the loop.
+class CCoroLoop
+{
+public:
+    CCoroLoop(const CCoroLoop&)            = delete;
+    CCoroLoop& operator=(const CCoroLoop&) = delete;
+
+    explicit CCoroLoop(CEventLoop& rLoop) noexcept :
+        m_rLoop(rLoop)
+    { }
+
+    ~CCoroLoop() noexcept
+    {
+        for (const auto& entry : m_waiters) {
+            m_rLoop.remove(entry.first);
+        }
+    }
+
+    //! start the task detached from the caller. It runs until its first suspension
+    //! at the calling thread, an exception leaving the task is reported to cerr.
+    void spawn(CTask<void> task)
+    {
+        m_running++;
+        detach(std::move(task), m_running);
+    }
+
+    //! number of spawned tasks which are not finished
+    std::size_t running() const noexcept {
+        return m_running;
+    }
+
+    //! process the events of the EventLoop until all spawned tasks are finished
+    //! or the EventLoop is unblocked
+    CEventLoop::ERet run()
+    {
+        while (m_running > 0)
+        {
+            if (m_rLoop.runOnce() == CEventLoop::ERet::UNBLOCK) {
+                return CEventLoop::ERet::UNBLOCK;
+            }
+        }
+        return CEventLoop::ERet::OK;
+    }
+
+    //! deregister the descriptor of a link or server from the EventLoop
+    void release(int fd) noexcept
+    {
+        if (m_waiters.erase(fd) != 0) {
+            m_rLoop.remove(fd);
+        }
+    }
+    void release(const CTcpDataLink& rLink) noexcept { release(rLink.getFd()); }
+    void release(const CUdpDataLink& rLink) noexcept { release(rLink.getFd()); }
+    void release(const CTcpServer& rServer) noexcept { release(rServer.getFd()); }
+
+    //! suspends until the descriptor is readable, false if cancelled by the stop token
+    auto readable(int fd, std::stop_token stop = {}) { return SReadyAwaiter{*this, fd, true, std::move(stop)}; }
+
+    //! suspends until the descriptor is writable, false if cancelled by the stop token
+    auto writable(int fd, std::stop_token stop = {}) { return SReadyAwaiter{*this, fd, false, std::move(stop)}; }
+
+    //! recive of the available data. The span is shrunk to the amount of data read,
+    //! an empty span with ERet::OK signals that the peer has closed the connection.
+    //! ERet::UNBLOCK if cancelled by the stop token.
+    CTask<CTcpDataLink::ERet> recive(CTcpDataLink& rLink, utils::span<uint8_t>& rRxSpan, std::stop_token stop = {})
+    {
+        const utils::span<uint8_t> buffer = rRxSpan;
+        while (true)
+        {
+            utils::span<uint8_t> rx = buffer;
+            if (rLink.tryRecive(rx) == CTcpDataLink::ERet::OK)
+            {
+                rRxSpan = rx;
+                co_return CTcpDataLink::ERet::OK;
+            }
+            if (!co_await readable(rLink.getFd(), stop)) {
+                co_return CTcpDataLink::ERet::UNBLOCK;
+            }
+        }
+    }
+
+    //! transmit of the whole span. ERet::UNBLOCK if cancelled by the stop token,
+    //! the amount of data already written is unknown then.
+    CTask<CTcpDataLink::ERet> send(const CTcpDataLink& rLink, utils::span<const uint8_t> txSpan, std::stop_token stop = {})
+    {
+        std::size_t dataWritten = 0;
+        while (true)
+        {
+            dataWritten += rLink.trySend(utils::span<const uint8_t>(txSpan.data() + dataWritten, txSpan.size_bytes() - dataWritten));
+            if (dataWritten >= txSpan.size_bytes()) {
+                co_return CTcpDataLink::ERet::OK;
+            }
+            if (!co_await writable(rLink.getFd(), stop)) {
+                co_return CTcpDataLink::ERet::UNBLOCK;
+            }
+        }
+    }
+
+    //! recive of one datagram. The span is shrunk to the size of the datagram and
+    //! the sender is written to rPeerAddr. ERet::UNBLOCK if cancelled by the stop token.
+    CTask<CUdpDataLink::ERet> reciveFrom(const CUdpDataLink& rLink, utils::span<uint8_t>& rRxSpan, SPeerAddr& rPeerAddr, std::stop_token stop = {})
+    {
+        const utils::span<uint8_t> buffer = rRxSpan;
+        while (true)
+        {
+            utils::span<uint8_t> rx = buffer;
+            if (rLink.tryReciveFrom(rx, rPeerAddr) == CUdpDataLink::ERet::OK)
+            {
+                rRxSpan = rx;
+                co_return CUdpDataLink::ERet::OK;
+            }
+            if (!co_await readable(rLink.getFd(), stop)) {
+                co_return CUdpDataLink::ERet::UNBLOCK;
+            }
+        }
+    }
+
+    //! accept of the next connection, std::nullopt if cancelled by the stop token
+    CTask<std::optional<std::tuple<CTcpDataLink, CIpAddress>>> accept(CTcpServer& rServer, std::stop_token stop = {})
+    {
+        while (true)
+        {
+            CTcpDataLink link;
+            CIpAddress peer;
+            if (rServer.tryAccept(link, peer)) {
+                co_return std::tuple<CTcpDataLink, CIpAddress>(std::move(link), std::move(peer));
+            }
+            if (!co_await readable(rServer.getFd(), stop)) {
+                co_return std::nullopt;
+            }
+        }
+    }
+
+private:
+    struct SWaiters
+    {
+        std::coroutine_handle<> reader;
+        std::coroutine_handle<> writer;
+        uint64_t readId  {0};       //!< id of the pending read wait
+        uint64_t writeId {0};       //!< id of the pending write wait
+        bool readCancelled  {false};
+        bool writeCancelled {false};
+    };
+
+    struct SDetached
+    {
+        struct promise_type
+        {
+            SDetached get_return_object() noexcept { return {}; }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() noexcept { }
+            void unhandled_exception() noexcept { std::terminate(); }
+        };
+    };
+
+    static SDetached detach(CTask<void> task, std::size_t& rRunning)
+    {
+        try {
+            co_await std::move(task);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "CCoroLoop: task failed: " << e.what() << std::endl;
+        }
+        rRunning--;
+    }
+
+    struct SReadyAwaiter
+    {
+        using CancelCallback = std::function<void ()>;
+
+        CCoroLoop&      rCoro;
+        int             fd;
+        bool            read;
+        std::stop_token stop;
+        std::optional<std::stop_callback<CancelCallback>> cancel {};
+
+        bool await_ready() const noexcept { return stop.stop_requested(); }
+
+        void await_suspend(std::coroutine_handle<> h)
+        {
+            SWaiters& rWaiters = rCoro.watch(fd);
+            const uint64_t waitId = rCoro.m_nextWaitId++;
+            (read ? rWaiters.reader : rWaiters.writer) = h;
+            (read ? rWaiters.readId : rWaiters.writeId) = waitId;
+
+            // The stop may be requested by another thread, the wake up is posted to the loop.
+            // It is keyed by the wait id, the same coroutine may already wait again meanwhile.
+            if (stop.stop_possible())
+            {
+                CCoroLoop* pCoro = &rCoro;
+                int waitFd = fd;
+                bool waitRead = read;
+                cancel.emplace(stop, CancelCallback([pCoro, waitFd, waitRead, waitId]() {
+                    pCoro->m_rLoop.post([pCoro, waitFd, waitRead, waitId]() { pCoro->cancel(waitFd, waitRead, waitId); });
+                }));
+            }
+        }
+
+        bool await_resume()
+        {
+            cancel.reset();
+            bool cancelled = false;
+            auto it = rCoro.m_waiters.find(fd);
+            if (it != rCoro.m_waiters.end()) {
+                cancelled = std::exchange(read ? it->second.readCancelled : it->second.writeCancelled, false);
+            }
+            return !cancelled && !stop.stop_requested();
+        }
+    };
+
+    //! registers the descriptor at the EventLoop with its first use
+    SWaiters& watch(int fd)
+    {
+        auto it = m_waiters.find(fd);
+        if (it != m_waiters.end()) {
+            return it->second;
+        }
+
+        SWaiters& rWaiters = m_waiters[fd];
+        m_rLoop.add(fd, EEvent::READ | EEvent::WRITE, [this, fd](EEvent events) { notify(fd, events); });
+        return rWaiters;
+    }
+
+    void notify(int fd, EEvent events)
+    {
+        auto it = m_waiters.find(fd);
+        if (it == m_waiters.end()) {
+            return;
+        }
+        // A closed descriptor wakes up both waiters, their next call reports the close
+        std::coroutine_handle<> writer;
+        if (hasEvent(events, EEvent::WRITE) || hasEvent(events, EEvent::CLOSE)) {
+            writer = std::exchange(it->second.writer, nullptr);
+        }
+        if (hasEvent(events, EEvent::READ) || hasEvent(events, EEvent::CLOSE))
+        {
+            if (auto reader = std::exchange(it->second.reader, nullptr)) {
+                reader.resume();
+            }
+        }
+        if (writer) {
+            writer.resume();
+        }
+    }
+
+    //! the wake up is dropped if the wait was resumed by an event meanwhile
+    void cancel(int fd, bool read, uint64_t waitId)
+    {
+        auto it = m_waiters.find(fd);
+        if (it == m_waiters.end()) {
+            return;
+        }
+        std::coroutine_handle<>& rHandle = read ? it->second.reader : it->second.writer;
+        if (rHandle && ((read ? it->second.readId : it->second.writeId) == waitId))
+        {
+            (read ? it->second.readCancelled : it->second.writeCancelled) = true;
+            std::exchange(rHandle, nullptr).resume();
+        }
+    }
+
+    CEventLoop&     m_rLoop;
+    std::size_t     m_running {0};
+    uint64_t        m_nextWaitId {1};
+    std::unordered_map<int, SWaiters> m_waiters;
+};
+
+} // EtNet
+
+#endif // coroutine support
+
+#endif // _COROLOOP_H_
@@ -0,0 +1,138 @@
+/*
+ * This file is part of the EMBTOM project
+ * Copyright (c) 2018-2020 Thomas Willetal
+ * (https://github.com/embtom)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _EVENTLOOP_H_
+#define _EVENTLOOP_H_
+
+//******************************************************************************
+// Header
+
+#include <stdint.h>
+#include <chrono>
+#include <functional>
+#include <memory>
+
+namespace EtNet
+{
+
+//! Readiness events a file descriptor can be registered for at the EventLoop
+enum class EEvent : uint32_t
+{
+    NONE  = 0,
+    READ  = 1 << 0,
+    WRITE = 1 << 1,
+    CLOSE = 1 << 2
+};
+
+constexpr EEvent operator| (EEvent lhs, EEvent rhs) noexcept
+{
+    return static_cast<EEvent>(static_cast<uint32_t>(lhs) | static_cast<uint32_t>(rhs));
+}
+
+constexpr EEvent operator& (EEvent lhs, EEvent rhs) noexcept
+{
+    return static_cast<EEvent>(static_cast<uint32_t>(lhs) & static_cast<uint32_t>(rhs));
+}
+
+//! return true if the "flag" is contained by the passed event set
+constexpr bool hasEvent(EEvent events, EEvent flag) noexcept
+{
+    return (events & flag) != EEvent::NONE;
+}
+
+class CTcpDataLink;
+class CUdpDataLink;
+class CEventLoopPrivate;
+
+//*****************************************************************************
+//! \brief CEventLoop
+//! Edge triggered epoll reactor. DataLinks or plain file descriptors are
+//! registered with their read/write interest and the passed callback is called
+//! at the thread running the loop if the descriptor becomes ready.
+//! Because of the edge triggered notification the callback has to drain the
+//! descriptor until the non-blocking "tryRecive" or "trySend" signals WOULDBLOCK.
+//!
+//! add, modify, remove, post and unblock can be called from any thread.
+class CEventLoop
+{
+public:
+    enum class ERet
+    {
+        OK,
+        TIMEOUT,
+        UNBLOCK
+    };
+
+    using CallbackEvent = std::function<void (EEvent events)>;
+    using CallbackPost  = std::function<void ()>;
+
+    CEventLoop();
+    CEventLoop(const CEventLoop&)                 = delete;
+    CEventLoop& operator= (const CEventLoop&)     = delete;
+    CEventLoop(CEventLoop&&) noexcept             = default;
+    CEventLoop& operator= (CEventLoop&&) noexcept = default;
+    virtual ~CEventLoop() noexcept;
+
+    //! register a file descriptor with its interest (READ and/or WRITE). The
+    //! CLOSE event is reported always if the peer hangs up or an error occurs.
+    void add(int fd, EEvent interest, CallbackEvent callback);
+
+    //! register a DataLink, the link is not owned by the loop and has to
+    //! be removed before it is destroyed
+    void add(const CTcpDataLink& rLink, EEvent interest, CallbackEvent callback);
+    void add(const CUdpDataLink& rLink, EEvent interest, CallbackEvent callback);
+
+    //! change the interest of an already registered file descriptor
+    void modify(int fd, EEvent interest);
+
+    //! deregister a file descriptor. It is allowed to be called
+    //! from within the callback of the descriptor itself
+    void remove(int fd) noexcept;
+    void remove(const CTcpDataLink& rLink) noexcept;
+    void remove(const CUdpDataLink& rLink) noexcept;
+
+    //! number of registered file descriptors
+    std::size_t size() const noexcept;
+
+    //! process all pending events once. The call blocks until at least one event
+    //! is available or the timeout expires. A negative timeout blocks infinitely.
+    ERet runOnce(std::chrono::milliseconds timeout = std::chrono::milliseconds(-1));
+
+    //! process events until "unblock" is called
+    ERet run();
+
+    //! queue a function to be called at the thread running the loop
+    void post(CallbackPost func);
+
+    //! leave "run" or "runOnce" with ERet::UNBLOCK
+    bool unblock() noexcept;
+
+private:
+    std::unique_ptr<CEventLoopPrivate> m_pPrivate;
+};
+
+} //EtNet
+
+#endif // _EVENTLOOP_H_
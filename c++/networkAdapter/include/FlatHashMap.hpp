@@ -0,0 +1,502 @@
+/*
+ * This file is part of the EMBTOM project
+ * Copyright (c) 2018-2020 Thomas Willetal
+ * (https://github.com/embtom)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _FLATHASHMAP_H_
+#define _FLATHASHMAP_H_
+
+//******************************************************************************
+// Header
+
+#include <stdint.h>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace EtNet
+{
+
+namespace detail
+{
+
+struct SSelectFirst
+{
+    template <typename Pair>
+    const auto& operator()(const Pair& rPair) const noexcept { return rPair.first; }
+};
+
+struct SSelectIdentity
+{
+    template <typename T>
+    const T& operator()(const T& rValue) const noexcept { return rValue; }
+};
+
+//*****************************************************************************
+//! \brief CFlatHashTable
+//! Open addressing table with linear probing in one array of slots. A control
+//! byte per slot holds seven bits of the hash, a probe touches a slot only if
+//! its control byte matches. Erased elements are refilled by shifting the
+//! following ones of the cluster back, therefore no tombstones accumulate.
+//! Insertion and erase invalidate the iterators and references.
+template <typename Key, typename Value, typename KeyOf, typename Hash, typename KeyEqual>
+class CFlatHashTable
+{
+    template <typename TableT, typename ValueT> class CIterator;
+
+public:
+    using key_type        = Key;
+    using value_type      = Value;
+    using size_type       = std::size_t;
+    using hasher          = Hash;
+    using key_equal       = KeyEqual;
+    using iterator        = CIterator<CFlatHashTable, Value>;
+    using const_iterator  = CIterator<const CFlatHashTable, const Value>;
+
+    //! at least the passed count of elements fits without a rehash
+    explicit CFlatHashTable(size_type count = 0, const Hash& rHash = Hash(), const KeyEqual& rEqual = KeyEqual()) :
+        m_hash(rHash),
+        m_equal(rEqual)
+    {
+        reserve(count);
+    }
+
+    CFlatHashTable(const CFlatHashTable& rOther) :
+        CFlatHashTable(rOther.size(), rOther.m_hash, rOther.m_equal)
+    {
+        for (const auto& rValue : rOther) {
+            insertUnique(rValue);
+        }
+    }
+
+    CFlatHashTable(CFlatHashTable&& rOther) noexcept :
+        m_hash(rOther.m_hash),
+        m_equal(rOther.m_equal)
+    {
+        swap(rOther);
+    }
+
+    CFlatHashTable& operator=(CFlatHashTable rOther) noexcept
+    {
+        swap(rOther);
+        return *this;
+    }
+
+    ~CFlatHashTable() noexcept
+    {
+        clear();
+    }
+
+    void swap(CFlatHashTable& rOther) noexcept
+    {
+        using std::swap;
+        swap(m_hash, rOther.m_hash);
+        swap(m_equal, rOther.m_equal);
+        swap(m_pControl, rOther.m_pControl);
+        swap(m_pSlots, rOther.m_pSlots);
+        swap(m_capacity, rOther.m_capacity);
+        swap(m_size, rOther.m_size);
+        swap(m_shift, rOther.m_shift);
+    }
+
+    iterator begin() noexcept { return iterator(this, next(0)); }
+    iterator end() noexcept { return iterator(this, m_capacity); }
+    const_iterator begin() const noexcept { return const_iterator(this, next(0)); }
+    const_iterator end() const noexcept { return const_iterator(this, m_capacity); }
+
+    bool empty() const noexcept { return m_size == 0; }
+    size_type size() const noexcept { return m_size; }
+    size_type capacity() const noexcept { return m_capacity; }
+
+    void clear() noexcept
+    {
+        for (size_type i = 0; i < m_capacity; i++)
+        {
+            if (m_pControl[i] != emptySlot)
+            {
+                slot(i)->~Value();
+                m_pControl[i] = emptySlot;
+            }
+        }
+        m_size = 0;
+    }
+
+    //! the passed count of elements fits without a further rehash
+    void reserve(size_type count)
+    {
+        size_type capacity = minCapacity;
+        while (capacity * maxLoadNum < count * maxLoadDen) {
+            capacity *= 2;
+        }
+        if ((count != 0) && (capacity > m_capacity)) {
+            rehash(capacity);
+        }
+    }
+
+    iterator find(const Key& rKey) noexcept
+    {
+        auto location = locate(rKey);
+        return iterator(this, location.second ? location.first : m_capacity);
+    }
+
+    const_iterator find(const Key& rKey) const noexcept
+    {
+        auto location = locate(rKey);
+        return const_iterator(this, location.second ? location.first : m_capacity);
+    }
+
+    bool contains(const Key& rKey) const noexcept { return locate(rKey).second; }
+    size_type count(const Key& rKey) const noexcept { return contains(rKey) ? 1 : 0; }
+
+    size_type erase(const Key& rKey)
+    {
+        auto location = locate(rKey);
+        if (!location.second) {
+            return 0;
+        }
+        eraseAt(location.first);
+        return 1;
+    }
+
+    //! erase all elements the predicate returns true for, returns the count of erased elements
+    template <typename Predicate>
+    size_type erase_if(Predicate predicate)
+    {
+        if (m_size == 0) {
+            return 0;
+        }
+
+        // Elements are shifted back only within a cluster. Started behind an empty slot,
+        // an element shifted into the current slot has not been visited yet.
+        size_type start = 0;
+        while (m_pControl[start] != emptySlot) {
+            start++;
+        }
+        size_type erased = 0;
+        size_type index = (start + 1) & mask();
+        for (size_type visited = 1; visited < m_capacity; visited++)
+        {
+            while ((m_pControl[index] != emptySlot) && predicate(*slot(index)))
+            {
+                eraseAt(index);
+                erased++;
+            }
+            index = (index + 1) & mask();
+        }
+        return erased;
+    }
+
+protected:
+    //! construct the value by the arguments if the key is not contained yet
+    template <typename... Args>
+    std::pair<iterator, bool> emplaceKey(const Key& rKey, Args&&... args)
+    {
+        auto location = locate(rKey);
+        if (location.second) {
+            return {iterator(this, location.first), false};
+        }
+        if ((m_size + 1) * maxLoadDen > m_capacity * maxLoadNum)
+        {
+            rehash((m_capacity == 0) ? minCapacity : 2 * m_capacity);
+            location = locate(rKey);
+        }
+        new (storage(location.first)) Value(std::forward<Args>(args)...);
+        m_pControl[location.first] = tagOf(hashOf(rKey));
+        m_size++;
+        return {iterator(this, location.first), true};
+    }
+
+private:
+    static constexpr uint8_t   emptySlot   = 0;
+    static constexpr size_type minCapacity = 8;
+    //! maximum load factor of 3/4, the expected probe length stays short with linear probing
+    static constexpr size_type maxLoadNum  = 3;
+    static constexpr size_type maxLoadDen  = 4;
+
+    struct SSlot
+    {
+        alignas(Value) unsigned char storage[sizeof(Value)];
+    };
+
+    template <typename TableT, typename ValueT>
+    class CIterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type        = std::remove_const_t<ValueT>;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = ValueT*;
+        using reference         = ValueT&;
+
+        CIterator() noexcept = default;
+
+        //! an iterator converts to a const_iterator
+        template <typename OtherTableT, typename OtherValueT,
+                  std::enable_if_t<std::is_const_v<TableT> && !std::is_const_v<OtherTableT>, int> = 0>
+        CIterator(const CIterator<OtherTableT, OtherValueT>& rOther) noexcept :
+            m_pTable(rOther.m_pTable),
+            m_index(rOther.m_index)
+        { }
+
+        reference operator*() const noexcept { return *m_pTable->slot(m_index); }
+        pointer operator->() const noexcept { return m_pTable->slot(m_index); }
+
+        CIterator& operator++() noexcept
+        {
+            m_index = m_pTable->next(m_index + 1);
+            return *this;
+        }
+
+        CIterator operator++(int) noexcept
+        {
+            CIterator previous = *this;
+            ++(*this);
+            return previous;
+        }
+
+        bool operator==(const CIterator& rhs) const noexcept { return m_index == rhs.m_index; }
+        bool operator!=(const CIterator& rhs) const noexcept { return m_index != rhs.m_index; }
+
+    private:
+        friend class CFlatHashTable;
+        template <typename, typename> friend class CIterator;
+
+        CIterator(TableT* pTable, size_type index) noexcept :
+            m_pTable(pTable),
+            m_index(index)
+        { }
+
+        TableT*   m_pTable {nullptr};
+        size_type m_index {0};
+    };
+
+    size_type mask() const noexcept { return m_capacity - 1; }
+
+    void* storage(size_type index) const noexcept
+    {
+        return m_pSlots[index].storage;
+    }
+
+    Value* slot(size_type index) const noexcept
+    {
+        return std::launder(reinterpret_cast<Value*>(m_pSlots[index].storage));
+    }
+
+    uint64_t hashOf(const Key& rKey) const noexcept
+    {
+        // Fibonacci hashing spreads weak hashes like the identity of integers over the index bits
+        return static_cast<uint64_t>(m_hash(rKey)) * 0x9E3779B97F4A7C15ULL;
+    }
+
+    size_type homeOf(uint64_t hash) const noexcept
+    {
+        return static_cast<size_type>(hash >> m_shift);
+    }
+
+    //! seven bits next to the index bits, the high bit marks the slot as used
+    uint8_t tagOf(uint64_t hash) const noexcept
+    {
+        return static_cast<uint8_t>(0x80 | ((hash >> (m_shift - 7)) & 0x7F));
+    }
+
+    //! slot of the key and true, or the empty slot terminating the probe and false
+    std::pair<size_type, bool> locate(const Key& rKey) const noexcept
+    {
+        if (m_capacity == 0) {
+            return {0, false};
+        }
+        const uint64_t hash = hashOf(rKey);
+        const uint8_t tag = tagOf(hash);
+        for (size_type index = homeOf(hash); ; index = (index + 1) & mask())
+        {
+            const uint8_t control = m_pControl[index];
+            if (control == emptySlot) {
+                return {index, false};
+            }
+            if ((control == tag) && m_equal(KeyOf()(*slot(index)), rKey)) {
+                return {index, true};
+            }
+        }
+    }
+
+    size_type next(size_type index) const noexcept
+    {
+        while ((index < m_capacity) && (m_pControl[index] == emptySlot)) {
+            index++;
+        }
+        return index;
+    }
+
+    void insertUnique(const Value& rValue)
+    {
+        const uint64_t hash = hashOf(KeyOf()(rValue));
+        size_type index = homeOf(hash);
+        while (m_pControl[index] != emptySlot) {
+            index = (index + 1) & mask();
+        }
+        new (storage(index)) Value(rValue);
+        m_pControl[index] = tagOf(hash);
+        m_size++;
+    }
+
+    void eraseAt(size_type hole)
+    {
+        slot(hole)->~Value();
+        m_pControl[hole] = emptySlot;
+        m_size--;
+
+        // An element moves back into the hole if the hole is on the way from its home slot
+        for (size_type index = (hole + 1) & mask(); m_pControl[index] != emptySlot; index = (index + 1) & mask())
+        {
+            const size_type home = homeOf(hashOf(KeyOf()(*slot(index))));
+            if (((index - home) & mask()) >= ((index - hole) & mask()))
+            {
+                new (storage(hole)) Value(std::move(*slot(index)));
+                slot(index)->~Value();
+                m_pControl[hole]  = m_pControl[index];
+                m_pControl[index] = emptySlot;
+                hole = index;
+            }
+        }
+    }
+
+    void rehash(size_type capacity)
+    {
+        std::unique_ptr<uint8_t[]> pControl(new uint8_t[capacity]());
+        std::unique_ptr<SSlot[]> pSlots(new SSlot[capacity]);
+        std::swap(pControl, m_pControl);
+        std::swap(pSlots, m_pSlots);
+        const size_type oldCapacity = m_capacity;
+        m_capacity = capacity;
+        m_shift    = 64 - static_cast<unsigned>(__builtin_ctzll(capacity));
+        m_size     = 0;
+
+        for (size_type i = 0; i < oldCapacity; i++)
+        {
+            if (pControl[i] == emptySlot) {
+                continue;
+            }
+            Value* pValue = std::launder(reinterpret_cast<Value*>(pSlots[i].storage));
+            const uint64_t hash = hashOf(KeyOf()(*pValue));
+            size_type index = homeOf(hash);
+            while (m_pControl[index] != emptySlot) {
+                index = (index + 1) & mask();
+            }
+            new (storage(index)) Value(std::move(*pValue));
+            pValue->~Value();
+            m_pControl[index] = tagOf(hash);
+            m_size++;
+        }
+    }
+
+    Hash     m_hash;
+    KeyEqual m_equal;
+    std::unique_ptr<uint8_t[]> m_pControl;
+    std::unique_ptr<SSlot[]>   m_pSlots;
+    size_type m_capacity {0};
+    size_type m_size {0};
+    unsigned  m_shift {64};
+};
+
+} // detail
+
+//*****************************************************************************
+//! \brief CFlatHashMap
+//! Hash map of the std::unordered_map interface subset stored in one flat array,
+//! e.g. the per peer state of a datagram server keyed by SPeerAddr
+template <typename Key, typename T, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class CFlatHashMap : public detail::CFlatHashTable<Key, std::pair<const Key, T>, detail::SSelectFirst, Hash, KeyEqual>
+{
+    using Base = detail::CFlatHashTable<Key, std::pair<const Key, T>, detail::SSelectFirst, Hash, KeyEqual>;
+
+public:
+    using mapped_type = T;
+    using typename Base::value_type;
+    using typename Base::iterator;
+    using typename Base::const_iterator;
+    using Base::Base;
+
+    template <typename... Args>
+    std::pair<iterator, bool> try_emplace(const Key& rKey, Args&&... args)
+    {
+        return this->emplaceKey(rKey, std::piecewise_construct, std::forward_as_tuple(rKey),
+                                std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+
+    std::pair<iterator, bool> insert(const value_type& rValue)
+    {
+        return this->emplaceKey(rValue.first, rValue);
+    }
+
+    T& operator[](const Key& rKey)
+    {
+        return try_emplace(rKey).first->second;
+    }
+
+    //! throws std::out_of_range if the key is not contained
+    T& at(const Key& rKey)
+    {
+        auto it = this->find(rKey);
+        if (it == this->end()) {
+            throw std::out_of_range("CFlatHashMap::at: key not contained");
+        }
+        return it->second;
+    }
+
+    const T& at(const Key& rKey) const
+    {
+        auto it = this->find(rKey);
+        if (it == this->end()) {
+            throw std::out_of_range("CFlatHashMap::at: key not contained");
+        }
+        return it->second;
+    }
+};
+
+//*****************************************************************************
+//! \brief CFlatHashSet
+//! Hash set of the std::unordered_set interface subset stored in one flat array
+template <typename Key, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>>
+class CFlatHashSet : public detail::CFlatHashTable<Key, const Key, detail::SSelectIdentity, Hash, KeyEqual>
+{
+    using Base = detail::CFlatHashTable<Key, const Key, detail::SSelectIdentity, Hash, KeyEqual>;
+
+public:
+    using typename Base::iterator;
+    using Base::Base;
+
+    std::pair<iterator, bool> insert(const Key& rKey)
+    {
+        return this->emplaceKey(rKey, rKey);
+    }
+};
+
+} // EtNet
+
+#endif // _FLATHASHMAP_H_
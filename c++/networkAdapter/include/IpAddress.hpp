@@ -29,12 +29,18 @@
 //******************************************************************************
 // Headers
 
-#include <variant> //std::variant
+#include <stdint.h>
+#include <algorithm> //std::min
+#include <functional> //std::hash
 #include <vector>
-#include <type_traits> //enable_if, remove_reference
+#include <optional> //std::optional
+#include <stdexcept> //std::invalid_argument
+#include <type_traits> //is_trivially_copyable
 #include <string> //std::string
+#include <string_view> //std::string_view
 #include <cstring> //std::memcmp
 #include <netinet/in.h> //in_addr, in6_addr
+#include <span.h>
 
 #undef min
 #undef max
@@ -48,34 +54,66 @@ enum class EAddressFamily{
     INV
 };
 
+//! Classes of an address as computed by classify(), combined as bit flags
+enum class EAddressClass : uint16_t
+{
+    NONE        = 0,
+    V4          = 1 << 0,
+    V6          = 1 << 1,
+    LOOPBACK    = 1 << 2,   //!< 127.0.0.0/8, ::1
+    BROADCAST   = 1 << 3,   //!< IPv4 with the last octet 0xFF, as is_broadcast()
+    PRIVATE     = 1 << 4,   //!< 10.0.0.0/8, 172.16.0.0/12, 192.168.0.0/16, fc00::/7
+    LINK_LOCAL  = 1 << 5,   //!< 169.254.0.0/16, fe80::/10
+    MULTICAST   = 1 << 6,   //!< 224.0.0.0/4, ff00::/8
+    UNSPECIFIED = 1 << 7,   //!< 0.0.0.0, ::
+    V4_MAPPED   = 1 << 8    //!< ::ffff:0:0/96
+};
+
+constexpr EAddressClass operator| (EAddressClass lhs, EAddressClass rhs) noexcept
+{
+    return static_cast<EAddressClass>(static_cast<uint16_t>(lhs) | static_cast<uint16_t>(rhs));
+}
+
+constexpr EAddressClass operator& (EAddressClass lhs, EAddressClass rhs) noexcept
+{
+    return static_cast<EAddressClass>(static_cast<uint16_t>(lhs) & static_cast<uint16_t>(rhs));
+}
+
+//! return true if the "flag" is contained by the passed classes
+constexpr bool hasClass(EAddressClass classes, EAddressClass flag) noexcept
+{
+    return (classes & flag) != EAddressClass::NONE;
+}
+
 //*****************************************************************************
 //! \brief CIpAddress
 //!It is a representation of IP address, suitable IPv4 or the IPv6
 //!address.
 //!
 //!IPv6 addresses are supported only if the target platform supports IPv6.
+//!The address is stored in 16 bytes in network byte order followed by the
+//!address family, an IPv4 address occupies the first four bytes and the
+//!remaining ones are zero.
 class CIpAddress
 {
 public:
     using IpAddresses = std::vector<CIpAddress>;
 
     //!Creates a (zero) Ip adddress
-    constexpr CIpAddress() noexcept         = default;
-
-    CIpAddress(const CIpAddress&)            = default;
-    CIpAddress& operator=(const CIpAddress&) = default;
-    CIpAddress(CIpAddress&&)                 = default;
-    CIpAddress& operator=(CIpAddress&&)      = default;
-    virtual ~CIpAddress() noexcept           = default;
+    constexpr CIpAddress() noexcept :
+        m_v6{}
+    { }
 
     //! Creates an IPAddress from a native inet address type.
     //! Depending on the passed address type (in_addr or in6_addr)
     //! the containing address family is selected.
-    template <typename T,
-              typename std::enable_if_t<std::is_same<std::remove_reference_t<T>, in_addr>::value ||
-                                        std::is_same<std::remove_reference_t<T>, in6_addr>::value, int> = 0>
-    constexpr CIpAddress(T&& rIpAddr) noexcept :
-        m_address(std::forward<T>(rIpAddr))
+    constexpr CIpAddress(const in_addr& rIpAddr) noexcept :
+        m_v6{{{v4Byte(rIpAddr.s_addr, 0), v4Byte(rIpAddr.s_addr, 1), v4Byte(rIpAddr.s_addr, 2), v4Byte(rIpAddr.s_addr, 3)}}},
+        m_family(EAddressFamily::INET)
+    { }
+    constexpr CIpAddress(const in6_addr& rIpAddr) noexcept :
+        m_v6(rIpAddr),
+        m_family(EAddressFamily::INET6)
     { }
 
     //! Creates an IPAddress a string in representation format of dotted decimal
@@ -87,50 +125,423 @@ public:
         CIpAddress(rIpStr)
     { }
 
+    //! Parses the representation of an IPv4 or IPv6 address without allocation.
+    //! Returns std::nullopt if the text is no valid address
+    static constexpr std::optional<CIpAddress> parse(std::string_view text) noexcept;
+
+    //! maximum length of the formatted address
+    static constexpr std::size_t maxStringLength = INET6_ADDRSTRLEN - 1;
+
+    //! writes the address without terminating zero into the buffer, returns the
+    //! written length or 0 if the address is empty or the buffer too small
+    std::size_t format(utils::span<char> buffer) const noexcept;
+
     //! return the the contained ip address as string
     std::string toString() const noexcept;
 
     //! return ture if containing address is Ipv4
-    bool is_v4() const noexcept;
+    constexpr bool is_v4() const noexcept { return m_family == EAddressFamily::INET; }
 
     //! return ture if containing address is Ipv6
-    bool is_v6() const noexcept;
+    constexpr bool is_v6() const noexcept { return m_family == EAddressFamily::INET6; }
 
     //! return ture if containing address is loopback address
-    bool is_loopback() const noexcept;
+    constexpr bool is_loopback() const noexcept;
 
-    //! return ture if containing address is a broadcast address
-    bool is_broadcast() const noexcept;
+    //! return ture if containing address is a broadcast address, the last
+    //! octet of an IPv4 address is 0xFF. The exact test against the network
+    //! of the address is CSubnet::broadcast()
+    constexpr bool is_broadcast() const noexcept;
 
     //! return ture if containing address is a submask
-    bool is_submask() const noexcept;
+    constexpr bool is_submask() const noexcept;
+
+    //! all classes of the address, EAddressClass::NONE if it is empty
+    constexpr EAddressClass classify() const noexcept;
+
+    //! Classifies a batch of addresses, classes[i] is set to the classes of
+    //! address i. std::invalid_argument if classes is shorter than addresses
+    static void classify(utils::span<const CIpAddress> addresses, utils::span<EAddressClass> classes);
 
     //! return ture if the IpAddress is not initialized
-    bool empty() const noexcept;
+    constexpr bool empty() const noexcept { return m_family == EAddressFamily::INV; }
 
     //! Request of containing address family
-    EAddressFamily addressFamily() const noexcept;
+    constexpr EAddressFamily addressFamily() const noexcept { return m_family; }
+
+    //! the 16 address bytes in network byte order, the last twelve of an
+    //! IPv4 address are zero
+    constexpr const uint8_t* bytes() const noexcept { return m_v6.s6_addr; }
 
     //! returns the internal IPv4 address structure
     //! otherwise nullptr will be returned
-    const in_addr* to_v4() const noexcept;
+    constexpr const in_addr* to_v4() const noexcept { return is_v4() ? &m_v4 : nullptr; }
 
     //! returns the internal IPv6 address structure
     //! otherwise nullptr will be returned
-    const in6_addr* to_v6() const noexcept;
+    constexpr const in6_addr* to_v6() const noexcept { return is_v6() ? &m_v6 : nullptr; }
 
     //! return of the boradcast address derived form the passed
     //! Network SubMask
     CIpAddress broadcast(const CIpAddress& rSubmask) const noexcept;
 
     bool operator== (const CIpAddress& rhs) const noexcept;
-    bool operator!= (const CIpAddress& rhs) const noexcept;
+    bool operator!= (const CIpAddress& rhs) const noexcept { return !((*this) == rhs); }
 
 private:
-    static size_t charCount(const std::string& rIpStr, char toCount) noexcept;
-    mutable std::variant<std::monostate, in6_addr, in_addr> m_address;
+    friend struct std::hash<CIpAddress>;
+
+    //! address of the bytes in network byte order, the unused ones of IPv4 are zero
+    constexpr CIpAddress(const uint8_t (&rBytes)[16], EAddressFamily family) noexcept :
+        m_v6{{{rBytes[0], rBytes[1], rBytes[2],  rBytes[3],  rBytes[4],  rBytes[5],  rBytes[6],  rBytes[7],
+               rBytes[8], rBytes[9], rBytes[10], rBytes[11], rBytes[12], rBytes[13], rBytes[14], rBytes[15]}}},
+        m_family(family)
+    { }
+
+    //! the dotted quad is classified by eight characters per 64 bit word
+    static constexpr std::optional<CIpAddress> parseV4(std::string_view text) noexcept;
+    static constexpr std::optional<CIpAddress> parseV6(std::string_view text) noexcept;
+
+    //! byte of an in_addr_t at its position in memory
+    static constexpr uint8_t v4Byte(in_addr_t address, unsigned index) noexcept
+    {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        return static_cast<uint8_t>(address >> (8 * index));
+#else
+        return static_cast<uint8_t>(address >> (24 - 8 * index));
+#endif
+    }
+
+
+    union
+    {
+        in6_addr m_v6;
+        in_addr  m_v4;
+    };
+    EAddressFamily m_family {EAddressFamily::INV};
 };
 
+static_assert(sizeof(CIpAddress) == 20, "CIpAddress: 16 address bytes and the family");
+static_assert(std::is_trivially_copyable<CIpAddress>::value, "CIpAddress: has to be trivially copyable");
+
+namespace detail
+{
+
+constexpr uint64_t lanes(uint8_t value) noexcept
+{
+    return 0x0101010101010101ULL * value;
+}
+
+//! up to eight characters from offset, character i in byte i of the word
+constexpr uint64_t load8(std::string_view text, std::size_t offset) noexcept
+{
+    uint64_t word = 0;
+    for (std::size_t i = 0; (i < 8) && (offset + i < text.size()); i++) {
+        word |= static_cast<uint64_t>(static_cast<uint8_t>(text[offset + i])) << (8 * i);
+    }
+    return word;
+}
+
+//! the characters of a text of 7 to 15 characters in two words, the missing ones are zero
+constexpr void load16(std::string_view text, uint64_t& rLo, uint64_t& rHi) noexcept
+{
+    if (__builtin_is_constant_evaluated())
+    {
+        rLo = load8(text, 0);
+        rHi = load8(text, 8);
+        return;
+    }
+
+    // At runtime the words are loaded unaligned, the second one ends with the text
+    const char* pText = text.data();
+    rLo = 0;
+    rHi = 0;
+    std::memcpy(&rLo, pText, (text.size() >= 8) ? 8 : 7);
+    if (text.size() > 8) {
+        std::memcpy(&rHi, pText + text.size() - 8, 8);
+    }
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    rLo = __builtin_bswap64(rLo);
+    rHi = __builtin_bswap64(rHi);
+#endif
+    if (text.size() > 8) {
+        rHi >>= 8 * (16 - text.size());
+    }
+}
+
+//! high bit of each byte which equals the character
+constexpr uint64_t equalMask(uint64_t word, char c) noexcept
+{
+    const uint64_t diff = word ^ lanes(static_cast<uint8_t>(c));
+    return ~(((diff & lanes(0x7F)) + lanes(0x7F)) | diff) & lanes(0x80);
+}
+
+//! high bit of each byte which is a decimal digit
+constexpr uint64_t digitMask(uint64_t word) noexcept
+{
+    const uint64_t low = word & lanes(0x7F);
+    const uint64_t atLeast0  = (low + lanes(0x80 - '0')) & lanes(0x80);
+    const uint64_t beyond9   = (low + lanes(0x80 - '9' - 1)) & lanes(0x80);
+    return atLeast0 & ~beyond9 & ~word & lanes(0x80);
+}
+
+//! one bit per byte of a mask of equalMask or digitMask
+constexpr unsigned moveMask(uint64_t mask) noexcept
+{
+    return static_cast<unsigned>(((mask >> 7) * 0x0102040810204080ULL) >> 56);
+}
+
+//! finalizer of MurmurHash3, each input bit affects all output bits
+constexpr uint64_t mix64(uint64_t value) noexcept
+{
+    value ^= value >> 33;
+    value *= 0xFF51AFD7ED558CCDULL;
+    value ^= value >> 33;
+    value *= 0xC4CEB9FE1A85EC53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+constexpr int hexValue(char c) noexcept
+{
+    return ((c >= '0') && (c <= '9')) ? (c - '0') :
+           ((c >= 'a') && (c <= 'f')) ? (c - 'a' + 10) :
+           ((c >= 'A') && (c <= 'F')) ? (c - 'A' + 10) : -1;
+}
+
+} // detail
+
+//*****************************************************************************
+// Inline definitions "CIpAddress"
+
+constexpr bool CIpAddress::is_loopback() const noexcept
+{
+    const uint8_t* pBytes = m_v6.s6_addr;
+    uint8_t v6Prefix = 0;
+    for (int i = 0; i < 15; i++) {
+        v6Prefix |= pBytes[i];
+    }
+    return (is_v4() & (pBytes[0] == 0x7F)) |
+           (is_v6() & (v6Prefix == 0) & (pBytes[15] == 0x01));
+}
+
+constexpr bool CIpAddress::is_submask() const noexcept
+{
+    const uint8_t* pBytes = m_v6.s6_addr;
+    return (is_v4() & (pBytes[0] == 0xFF)) |
+           (is_v6() & (pBytes[0] == 0xFF) & (pBytes[1] == 0xFF) & (pBytes[2] == 0x00) & (pBytes[3] == 0x00));
+}
+
+constexpr bool CIpAddress::is_broadcast() const noexcept
+{
+    return is_v4() & (m_v6.s6_addr[3] == 0xFF);
+}
+
+constexpr EAddressClass CIpAddress::classify() const noexcept
+{
+    const uint8_t* pBytes = m_v6.s6_addr;
+    uint8_t prefix80 = 0;
+    for (int i = 0; i < 10; i++) {
+        prefix80 |= pBytes[i];
+    }
+    const bool zero = (prefix80 | pBytes[10] | pBytes[11] | pBytes[12] | pBytes[13] | pBytes[14] | pBytes[15]) == 0;
+    const bool v4 = is_v4();
+    const bool v6 = is_v6();
+
+    auto flag = [](bool set, EAddressClass value) {
+        return set ? value : EAddressClass::NONE;
+    };
+    return flag(v4, EAddressClass::V4) |
+           flag(v6, EAddressClass::V6) |
+           flag(is_loopback(), EAddressClass::LOOPBACK) |
+           flag(is_broadcast(), EAddressClass::BROADCAST) |
+           flag((v4 && ((pBytes[0] == 10) || ((pBytes[0] == 172) && ((pBytes[1] & 0xF0) == 16)) ||
+                        ((pBytes[0] == 192) && (pBytes[1] == 168)))) ||
+                (v6 && ((pBytes[0] & 0xFE) == 0xFC)), EAddressClass::PRIVATE) |
+           flag((v4 && (pBytes[0] == 169) && (pBytes[1] == 254)) ||
+                (v6 && (pBytes[0] == 0xFE) && ((pBytes[1] & 0xC0) == 0x80)), EAddressClass::LINK_LOCAL) |
+           flag((v4 && ((pBytes[0] & 0xF0) == 0xE0)) || (v6 && (pBytes[0] == 0xFF)), EAddressClass::MULTICAST) |
+           flag((v4 || v6) && zero, EAddressClass::UNSPECIFIED) |
+           flag(v6 && (prefix80 == 0) && (pBytes[10] == 0xFF) && (pBytes[11] == 0xFF), EAddressClass::V4_MAPPED);
+}
+
+inline bool CIpAddress::operator== (const CIpAddress& rhs) const noexcept
+{
+    // The unused bytes of an IPv4 address are zero, all 16 bytes are compared
+    return (m_family == rhs.m_family) && !empty() && (std::memcmp(&m_v6, &rhs.m_v6, sizeof(m_v6)) == 0);
+}
+
+constexpr std::optional<CIpAddress> CIpAddress::parse(std::string_view text) noexcept
+{
+    return (text.find(':') != std::string_view::npos) ? parseV6(text) : parseV4(text);
+}
+
+constexpr std::optional<CIpAddress> CIpAddress::parseV4(std::string_view text) noexcept
+{
+    const std::size_t length = text.size();
+    if ((length < 7) || (length > 15)) {
+        return std::nullopt;
+    }
+
+    // Each character has to be a digit or a dot, exactly three dots split the octets
+    const unsigned used = (1U << length) - 1;
+    uint64_t lo = 0;
+    uint64_t hi = 0;
+    detail::load16(text, lo, hi);
+    const unsigned dots   = detail::moveMask(detail::equalMask(lo, '.')) | (detail::moveMask(detail::equalMask(hi, '.')) << 8);
+    const unsigned digits = detail::moveMask(detail::digitMask(lo)) | (detail::moveMask(detail::digitMask(hi)) << 8);
+    unsigned thirdDot = dots & used;
+    thirdDot &= thirdDot - 1;
+    thirdDot &= thirdDot - 1;
+    if ((((dots | digits) & used) != used) || (thirdDot == 0) || ((thirdDot & (thirdDot - 1)) != 0)) {
+        return std::nullopt;
+    }
+
+    uint8_t bytes[16] {};
+    unsigned separators = (dots & used) | (1U << length);
+    std::size_t start = 0;
+    for (int octet = 0; octet < 4; octet++)
+    {
+        const std::size_t end = static_cast<std::size_t>(__builtin_ctz(separators));
+        separators &= separators - 1;
+        const std::size_t digitCount = end - start;
+        // Octets have one to three digits without leading zero as accepted by inet_pton
+        if ((digitCount == 0) || (digitCount > 3) || ((digitCount > 1) && (text[start] == '0'))) {
+            return std::nullopt;
+        }
+        unsigned value = 0;
+        for (std::size_t i = start; i < end; i++) {
+            value = 10 * value + static_cast<unsigned>(text[i] - '0');
+        }
+        if (value > 255) {
+            return std::nullopt;
+        }
+        bytes[octet] = static_cast<uint8_t>(value);
+        start = end + 1;
+    }
+    return CIpAddress(bytes, EAddressFamily::INET);
+}
+
+constexpr std::optional<CIpAddress> CIpAddress::parseV6(std::string_view text) noexcept
+{
+    uint16_t groups[8] {};
+    int groupCount = 0;
+    int compressed = -1;
+    std::size_t pos = 0;
+
+    if ((text.size() >= 2) && (text[0] == ':') && (text[1] == ':'))
+    {
+        compressed = 0;
+        pos = 2;
+    }
+    else if (!text.empty() && (text[0] == ':')) {
+        return std::nullopt;
+    }
+
+    while (pos < text.size())
+    {
+        if (groupCount == 8) {
+            return std::nullopt;
+        }
+        const std::size_t start = pos;
+        unsigned value = 0;
+        while ((pos < text.size()) && (detail::hexValue(text[pos]) >= 0) && (pos - start < 5))
+        {
+            value = (value << 4) | static_cast<unsigned>(detail::hexValue(text[pos]));
+            pos++;
+        }
+
+        // An IPv4 address in dotted decimal notation replaces the last two groups
+        if ((pos < text.size()) && (text[pos] == '.'))
+        {
+            auto v4 = (groupCount <= 6) ? parseV4(text.substr(start)) : std::nullopt;
+            if (!v4) {
+                return std::nullopt;
+            }
+            const uint8_t* pBytes = v4->m_v6.s6_addr;
+            groups[groupCount++] = static_cast<uint16_t>((pBytes[0] << 8) | pBytes[1]);
+            groups[groupCount++] = static_cast<uint16_t>((pBytes[2] << 8) | pBytes[3]);
+            pos = text.size();
+            break;
+        }
+        if ((pos == start) || (pos - start > 4)) {
+            return std::nullopt;
+        }
+        groups[groupCount++] = static_cast<uint16_t>(value);
+
+        if (pos == text.size()) {
+            break;
+        }
+        if ((text[pos] != ':') || (++pos == text.size())) {
+            return std::nullopt;
+        }
+        if (text[pos] == ':')
+        {
+            if (compressed >= 0) {
+                return std::nullopt;
+            }
+            compressed = groupCount;
+            pos++;
+        }
+    }
+
+    if ((compressed < 0) ? (groupCount != 8) : (groupCount == 8)) {
+        return std::nullopt;
+    }
+
+    // The groups behind "::" are moved to the end
+    uint8_t bytes[16] {};
+    const int gap = 8 - groupCount;
+    for (int i = 0; i < groupCount; i++)
+    {
+        const int index = ((compressed >= 0) && (i >= compressed)) ? i + gap : i;
+        bytes[2 * index]     = static_cast<uint8_t>(groups[i] >> 8);
+        bytes[2 * index + 1] = static_cast<uint8_t>(groups[i]);
+    }
+    return CIpAddress(bytes, EAddressFamily::INET6);
+}
+
+//*****************************************************************************
+// Literals
+
+inline namespace literals
+{
+
+//! address literal, e.g. "192.168.0.1"_ip or "::1"_ip, an invalid
+//! literal does not compile in a constant expression
+constexpr CIpAddress operator""_ip(const char* pText, std::size_t length)
+{
+    auto address = CIpAddress::parse(std::string_view(pText, length));
+    if (!address) {
+        throw std::invalid_argument("CIpAddress: no valid Ip literal");
+    }
+    return *address;
+}
+
+} // literals
+
 } //EtNet
 
+//*****************************************************************************
+// Hash
+
+namespace std
+{
+
+template<>
+struct hash<EtNet::CIpAddress>
+{
+    std::size_t operator()(const EtNet::CIpAddress& rAddress) const noexcept
+    {
+        uint64_t lo;
+        uint64_t hi;
+        std::memcpy(&lo, rAddress.m_v6.s6_addr, sizeof(lo));
+        std::memcpy(&hi, rAddress.m_v6.s6_addr + sizeof(lo), sizeof(hi));
+        const uint64_t family = static_cast<uint64_t>(rAddress.m_family) << 56;
+        return static_cast<std::size_t>(EtNet::detail::mix64(lo ^ EtNet::detail::mix64(hi ^ family)));
+    }
+};
+
+} // std
+
 #endif // _IPADDRESS_H_
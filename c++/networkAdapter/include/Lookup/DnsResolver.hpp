@@ -0,0 +1,118 @@
+/*
+ * This file is part of the EMBTOM project
+ * Copyright (c) 2018-2020 Thomas Willetal
+ * (https://github.com/embtom)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _DNSRESOLVER_H_
+#define _DNSRESOLVER_H_
+
+//******************************************************************************
+// Header
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+#include <Lookup/HostLookup.hpp>
+#include <Udp/UdpDataLink.hpp>
+
+namespace EtNet
+{
+
+//! port of a DNS server
+constexpr unsigned int dnsPort = 53;
+//! time a query waits for the answer before it is retransmitted to the next server
+constexpr std::chrono::milliseconds dnsTimeout {2000};
+//! number of transmissions of a query until it is reported as timed out
+constexpr unsigned int dnsAttempts = 2;
+
+class CDnsResolverPrivate;
+
+//*****************************************************************************
+//! \brief CDnsResolver
+//! Asynchronous resolution of host names by a DNS client over UDP. In contrast to
+//! CHostLookup the calls do not block, many names are resolved concurrently by one
+//! socket and a worker thread. For every name an A and an AAAA query is sent, the
+//! result is delivered by a callback or a future. Literal IP addresses are resolved
+//! without a query. Search domains of the resolv.conf are not applied and truncated
+//! answers are not retried over TCP.
+//! All methods can be called from any thread.
+class CDnsResolver
+{
+public:
+    enum class ERet
+    {
+        OK,
+        NOT_FOUND,      //!< NXDOMAIN or no address record
+        TIMEOUT,        //!< no answer of any server
+        FAILURE         //!< server failure, refused or malformed answer
+    };
+
+    struct SAnswer
+    {
+        ERet status {ERet::FAILURE};
+        CHostLookup::IpAddresses addresses;     //!< IPv6 addresses first, then IPv4
+        std::chrono::seconds ttl {0};           //!< lowest TTL of the records, for a negative answer the one of the SOA record
+    };
+
+    //! called at the thread of the resolver, it must neither block nor throw
+    using CallbackResolved = std::function<void (const std::string& rHostName, const SAnswer& rAnswer)>;
+
+    CDnsResolver(const CDnsResolver&)            = delete;
+    CDnsResolver& operator=(const CDnsResolver&) = delete;
+    CDnsResolver(CDnsResolver&&) noexcept            = default;
+    CDnsResolver& operator=(CDnsResolver&&) noexcept = default;
+    ~CDnsResolver() noexcept;
+
+    //! resolver using the nameservers of the /etc/resolv.conf
+    CDnsResolver();
+
+    //! resolver using the passed servers, the retransmission of a query is sent to the next one
+    explicit CDnsResolver(std::vector<SPeerAddr> servers,
+                          std::chrono::milliseconds timeout = dnsTimeout,
+                          unsigned int attempts = dnsAttempts);
+
+    //! start the resolution, the callback is called once the answer is complete
+    void resolve(const std::string& rHostName, CallbackResolved onResolved);
+
+    //! start the resolution, a failed one is reported by a std::runtime_error of the future
+    std::future<CHostLookup::IpAddresses> resolve(const std::string& rHostName);
+
+    //! start the resolution of all names at once, the queries are sent by a batch transmit
+    std::vector<std::future<CHostLookup::IpAddresses>> resolve(const std::vector<std::string>& rHostNames);
+
+    //! readable description of the status
+    static const char* toString(ERet status) noexcept;
+
+    //! nameservers configured by the /etc/resolv.conf, localhost if none is configured
+    static std::vector<SPeerAddr> systemServers();
+
+private:
+    std::unique_ptr<CDnsResolverPrivate> m_pPrivate;
+};
+
+} //EtNet
+
+#endif // _DNSRESOLVER_H_
@@ -0,0 +1,122 @@
+/*
+ * This file is part of the EMBTOM project
+ * Copyright (c) 2018-2020 Thomas Willetal
+ * (https://github.com/embtom)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _HOSTCACHE_H_
+#define _HOSTCACHE_H_
+
+//******************************************************************************
+// Header
+
+#include <stdint.h>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+#include <Lookup/HostLookup.hpp>
+#include <Lookup/DnsResolver.hpp>
+
+namespace EtNet
+{
+
+//! default number of cached host names
+constexpr std::size_t hostCacheCapacity = 1024;
+//! upper bound of the time an answer is cached, independent of its TTL
+constexpr std::chrono::seconds hostCacheMaxTtl {3600};
+//! time an expired answer is still served while it is refreshed in the background
+constexpr std::chrono::seconds hostCacheStaleTime {30};
+//! getaddrinfo does not report the TTL of the records, its answers are cached for this time
+constexpr std::chrono::seconds hostCacheSystemTtl {30};
+//! time a not existing host name of getaddrinfo is cached
+constexpr std::chrono::seconds hostCacheSystemNegativeTtl {5};
+
+class CHostCachePrivate;
+
+//*****************************************************************************
+//! \brief CHostCache
+//! Cache of resolved host names used by CHostLookup and therefore by CTcpClient
+//! and CUdpClient. An answer is cached for its TTL, a not existing host name is
+//! cached as well (negative caching). After the TTL the expired addresses are still
+//! returned for the stale time while a background thread refreshes them, concurrent
+//! lookups of a missing name wait for a single resolution. The same thread resolves
+//! the names of lookups bounded by a deadline.
+//! All methods can be called from any thread.
+class CHostCache
+{
+public:
+    struct SStats
+    {
+        uint64_t hits {0};          //!< answered by a valid entry
+        uint64_t staleHits {0};     //!< answered by an expired entry while it is refreshed
+        uint64_t negativeHits {0};  //!< answered by a cached not existing host name
+        uint64_t misses {0};        //!< resolutions the caller waited for
+        uint64_t refreshes {0};     //!< background resolutions of expired entries
+        std::size_t entries {0};
+    };
+
+    //! resolution of a host name, called without the lock of the cache held
+    using CallbackResolve = std::function<CDnsResolver::SAnswer (const std::string& rHostName)>;
+
+    CHostCache(const CHostCache&)            = delete;
+    CHostCache& operator=(const CHostCache&) = delete;
+    CHostCache(CHostCache&&) noexcept            = default;
+    CHostCache& operator=(CHostCache&&) noexcept = default;
+    ~CHostCache() noexcept;
+
+    CHostCache(std::size_t capacity = hostCacheCapacity,
+               std::chrono::seconds maxTtl = hostCacheMaxTtl,
+               std::chrono::seconds staleTime = hostCacheStaleTime);
+
+    //! process wide cache used by CHostLookup
+    static CHostCache& instance();
+
+    //! addresses of the host name, a failed resolution is reported by a std::runtime_error
+    CHostLookup::IpAddresses addresses(const std::string& rHostName);
+
+    //! as above, but a missing name is resolved by the background thread of the cache.
+    //! If the answer is not available at the deadline a std::runtime_error is thrown,
+    //! the resolution still completes and fills the cache.
+    CHostLookup::IpAddresses addresses(const std::string& rHostName, std::chrono::steady_clock::time_point deadline);
+
+    //! replace the resolution, default is the systemResolver
+    void setResolver(CallbackResolve resolve);
+
+    //! resolution by getaddrinfo, it considers the hosts file but no record TTL
+    static CallbackResolve systemResolver();
+
+    //! resolution by the passed DNS client, the TTL of the records is respected
+    static CallbackResolve dnsResolver(std::shared_ptr<CDnsResolver> pResolver);
+
+    //! drop all cached entries
+    void clear() noexcept;
+
+    SStats getStats() const;
+
+private:
+    std::unique_ptr<CHostCachePrivate> m_pPrivate;
+};
+
+} //EtNet
+
+#endif // _HOSTCACHE_H_
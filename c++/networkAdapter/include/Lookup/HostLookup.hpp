@@ -53,7 +53,7 @@ public:
     CHostLookup& operator=(CHostLookup&&) noexcept      = default;
     virtual ~CHostLookup() noexcept;
 
-    //! Loopup of the concerning IpAddress
+    //! Loopup of the concerning IpAddress, answered by the process wide CHostCache
     CHostLookup(std::string&& rHostName);
     CHostLookup(const std::string& rHostName);
 
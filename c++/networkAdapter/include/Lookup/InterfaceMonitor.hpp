@@ -0,0 +1,123 @@
+/*
+ * This file is part of the EMBTOM project
+ * Copyright (c) 2018-2020 Thomas Willetal
+ * (https://github.com/embtom)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _INTERFACEMONITOR_H_
+#define _INTERFACEMONITOR_H_
+
+//******************************************************************************
+// Header
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <Lookup/InterfacesLookup.hpp>
+#include <Lookup/InterfaceSnapshot.hpp>
+
+namespace EtNet
+{
+
+class CNetInterfaceMonitorPrivate;
+
+//*****************************************************************************
+//! \brief CNetInterfaceMonitor
+//! Up to date table of the local interfaces and addresses. The table is loaded
+//! by a netlink dump and kept current by the link and address notifications of
+//! the RTNLGRP_LINK, RTNLGRP_IPV4_IFADDR and RTNLGRP_IPV6_IFADDR groups, which
+//! are processed by a background thread. The queries are answered from the table
+//! without any system call, the subscribers are notified about every change.
+//! If notifications are lost because of an overflow of the socket, the table is
+//! reloaded and the differences are reported as changes.
+//! All methods can be called from any thread.
+class CNetInterfaceMonitor
+{
+public:
+    enum class EChange
+    {
+        LINK_ADDED,
+        LINK_REMOVED,
+        LINK_CHANGED,       //!< state, mtu or name changed
+        ADDRESS_ADDED,
+        ADDRESS_REMOVED
+    };
+
+    struct SEvent
+    {
+        EChange     change;
+        unsigned    ifIndex {0};
+        std::string name;
+        EIfState    state {EIfState::down};
+        unsigned    mtu {0};
+        CIpAddress  address;    //!< only for address changes
+    };
+
+    struct SInterface
+    {
+        unsigned    ifIndex {0};
+        std::string name;
+        EIfState    state {EIfState::down};
+        unsigned    mtu {0};
+        CIpAddress::IpAddresses addresses;
+        CIpAddress::IpAddresses subMasks;
+        CIpAddress::IpAddresses broadcasts;
+    };
+
+    //! called at the thread of the monitor, the monitor can be queried within the callback
+    using CallbackChange = std::function<void (const SEvent& rEvent)>;
+
+    CNetInterfaceMonitor(const CNetInterfaceMonitor&)            = delete;
+    CNetInterfaceMonitor& operator=(const CNetInterfaceMonitor&) = delete;
+    CNetInterfaceMonitor(CNetInterfaceMonitor&&) noexcept            = default;
+    CNetInterfaceMonitor& operator=(CNetInterfaceMonitor&&) noexcept = default;
+    ~CNetInterfaceMonitor() noexcept;
+
+    //! subscribe to the notifications and load the table, throws if netlink is not available
+    CNetInterfaceMonitor();
+
+    //! register a callback for all further changes, the returned id is used to unsubscribe
+    std::size_t subscribe(CallbackChange onChange);
+    void unsubscribe(std::size_t id) noexcept;
+
+    //! state of the interface or std::nullopt if it does not exist
+    std::optional<SInterface> getInterface(unsigned ifIndex) const;
+    std::optional<SInterface> getInterface(const std::string& rName) const;
+
+    //! same as the CNetInterface queries, only running interfaces are considered
+    CIpAddress::IpAddresses getAllIpv4Ip(bool bWithLoopback) const;
+    CIpAddress::IpAddresses getAllIpv6Ip(bool bWithLoopback) const;
+    CIpAddress::IpAddresses getAllIpv4Submask() const;
+    CIpAddress::IpAddresses getAllIpv4Broadcast() const;
+
+    //! current state of all interfaces, it is replaced and not modified by later changes
+    std::shared_ptr<const CInterfaceSnapshot> snapshot() const;
+
+private:
+    std::unique_ptr<CNetInterfaceMonitorPrivate> m_pPrivate;
+};
+
+} //EtNet
+
+#endif // _INTERFACEMONITOR_H_
@@ -0,0 +1,156 @@
+/*
+ * This file is part of the EMBTOM project
+ * Copyright (c) 2018-2020 Thomas Willetal
+ * (https://github.com/embtom)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _INTERFACESNAPSHOT_H_
+#define _INTERFACESNAPSHOT_H_
+
+//******************************************************************************
+// Header
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <span.h>
+#include <Lookup/InterfacesLookup.hpp>
+
+namespace EtNet
+{
+
+class CInterfaceSnapshotBuilder;
+
+//*****************************************************************************
+//! \brief CInterfaceSnapshot
+//! Immutable state of the local interfaces. All names are stored in one string
+//! and all addresses in one array, the interfaces refer to ranges of them. The
+//! accessors return views into these arrays without any allocation, the views
+//! are valid as long as the snapshot is referenced. A snapshot is shared between
+//! threads by its std::shared_ptr.
+class CInterfaceSnapshot
+{
+public:
+    //*************************************************************************
+    //! \brief CInterface
+    //! View of one interface of the snapshot
+    class CInterface
+    {
+    public:
+        unsigned getIfIndex() const noexcept { return m_ifIndex; }
+        std::string_view getName() const noexcept;
+        utils::span<const CIpAddress> getAddresses() const noexcept;
+        utils::span<const CIpAddress> getSubMask() const noexcept;
+        utils::span<const CIpAddress> getBroadcast() const noexcept;
+        EIfState getState() const noexcept;
+        unsigned getMtu() const noexcept { return m_mtu; }
+
+    private:
+        friend class CInterfaceSnapshot;
+        friend class CInterfaceSnapshotBuilder;
+
+        struct SRange
+        {
+            uint32_t begin {0};
+            uint32_t count {0};
+        };
+
+        const CInterfaceSnapshot* m_pSnapshot {nullptr};
+        unsigned m_ifIndex {0};
+        unsigned m_flags {0};
+        unsigned m_mtu {0};
+        SRange   m_name;
+        SRange   m_addresses;
+        SRange   m_subMasks;
+        SRange   m_broadcasts;
+    };
+
+    CInterfaceSnapshot(const CInterfaceSnapshot&)            = delete;
+    CInterfaceSnapshot& operator=(const CInterfaceSnapshot&) = delete;
+
+    //! snapshot of all interfaces by a netlink dump, with bRunningOnly
+    //! the interfaces which are not running are omitted
+    static std::shared_ptr<const CInterfaceSnapshot> create(bool bRunningOnly);
+
+    //! all interfaces ordered by their index
+    utils::span<const CInterface> interfaces() const noexcept;
+
+    //! interface of the index or name, nullptr if it does not exist
+    const CInterface* find(unsigned ifIndex) const noexcept;
+    const CInterface* find(std::string_view name) const noexcept;
+
+    //! addresses of the running interfaces, as the corresponding CNetInterface queries
+    utils::span<const CIpAddress> getAllIpv4Ip(bool bWithLoopback) const noexcept;
+    utils::span<const CIpAddress> getAllIpv6Ip(bool bWithLoopback) const noexcept;
+    utils::span<const CIpAddress> getAllIpv4Submask() const noexcept;
+    utils::span<const CIpAddress> getAllIpv4Broadcast() const noexcept;
+
+private:
+    friend class CInterfaceSnapshotBuilder;
+    using SRange = CInterface::SRange;
+
+    CInterfaceSnapshot() = default;
+
+    utils::span<const CIpAddress> view(SRange range) const noexcept {
+        return utils::span<const CIpAddress>(m_addressArena.data() + range.begin, range.count);
+    }
+
+    std::string             m_nameArena;
+    std::vector<CIpAddress> m_addressArena;
+    std::vector<CInterface> m_interfaces;       //!< ordered by the interface index
+    std::vector<uint32_t>   m_byName;           //!< positions of m_interfaces ordered by the name
+    SRange m_ipv4;
+    SRange m_ipv4NoLoopback;
+    SRange m_ipv6;
+    SRange m_ipv6NoLoopback;
+    SRange m_ipv4Submasks;
+    SRange m_ipv4Broadcasts;
+};
+
+//*****************************************************************************
+// Inline definitions "CInterfaceSnapshot::CInterface"
+
+inline std::string_view CInterfaceSnapshot::CInterface::getName() const noexcept
+{
+    return std::string_view(m_pSnapshot->m_nameArena.data() + m_name.begin, m_name.count);
+}
+
+inline utils::span<const CIpAddress> CInterfaceSnapshot::CInterface::getAddresses() const noexcept
+{
+    return m_pSnapshot->view(m_addresses);
+}
+
+inline utils::span<const CIpAddress> CInterfaceSnapshot::CInterface::getSubMask() const noexcept
+{
+    return m_pSnapshot->view(m_subMasks);
+}
+
+inline utils::span<const CIpAddress> CInterfaceSnapshot::CInterface::getBroadcast() const noexcept
+{
+    return m_pSnapshot->view(m_broadcasts);
+}
+
+} //EtNet
+
+#endif // _INTERFACESNAPSHOT_H_
@@ -0,0 +1,207 @@
+/*
+ * This file is part of the EMBTOM project
+ * Copyright (c) 2018-2020 Thomas Willetal
+ * (https://github.com/embtom)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _PREFIXTABLE_H_
+#define _PREFIXTABLE_H_
+
+//******************************************************************************
+// Header
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+#include <IpAddress.hpp>
+#include <Subnet.hpp>
+
+namespace EtNet
+{
+
+//*****************************************************************************
+//! \brief CPrefixTable
+//! Immutable longest prefix match table of IPv4 and IPv6 prefixes, each mapped to
+//! a 32 bit value, e.g. the index of an ACL rule or a route. The prefixes are
+//! expanded into a compressed multibit trie (Poptrie): the first 16 bits of an
+//! address index a table, the remaining bits are consumed 6 at a time by nodes
+//! which store only their children and the runs of equal values. Bits shared by
+//! all prefixes below a node are skipped by one comparison (path compression).
+//! An IPv4 lookup passes at most three nodes, an IPv6 lookup at most nineteen.
+//! Tables are built by the CBuilder and replaced as a whole, see CSharedPrefixTable.
+class CPrefixTable
+{
+private:
+    struct SPrefix
+    {
+        CSubnet  subnet;
+        uint32_t value;
+    };
+
+public:
+    //! value of an address without matching prefix
+    static constexpr uint32_t noMatch = UINT32_MAX;
+
+    class CBuilder
+    {
+    public:
+        //! adds the network of the address with the count of leading bits, the bits
+        //! behind the length are ignored. For the same prefix the value added last
+        //! is kept. std::invalid_argument if the address is empty, the length
+        //! exceeds the address or the value is noMatch
+        void add(const CIpAddress& rNetwork, unsigned length, uint32_t value);
+
+        //! adds all prefixes "address/length" of a list separated by white space,
+        //! commas or lines, without length the address is the prefix. All get
+        //! the passed value. Text after '#' up to the end of the line is a
+        //! comment. Returns the count of prefixes, std::invalid_argument on an
+        //! invalid prefix, then none of the list is added
+        std::size_t add(std::string_view prefixList, uint32_t value);
+
+        std::shared_ptr<const CPrefixTable> build() const;
+
+    private:
+        std::vector<SPrefix> m_prefixes;
+    };
+
+    //! an empty table, all lookups return noMatch
+    CPrefixTable();
+
+    //! value of the longest prefix containing the address or noMatch
+    uint32_t lookup(const CIpAddress& rAddress) const noexcept;
+
+    //! count of distinct prefixes
+    std::size_t size() const noexcept { return m_size; }
+
+    //! bytes allocated by the tables and the trie nodes
+    std::size_t memoryUsage() const noexcept;
+
+private:
+    static constexpr unsigned directBits = 16;
+    static constexpr unsigned strideBits = 6;
+    static constexpr uint32_t noNode = UINT32_MAX;
+
+    //! address bits, the most significant first. An IPv4 address is followed by zeros
+    struct SKey
+    {
+        uint64_t high;
+        uint64_t low;
+    };
+
+    //! entry of the table indexed by the first 16 bits
+    struct SEntry
+    {
+        uint32_t value;     //!< longest prefix covering the entry or noMatch
+        uint32_t node;      //!< node of the following bits, noNode if there is none
+    };
+
+    //! 64 slots of the 6 bits behind the skipped ones. A slot is continued by a
+    //! child node or holds the value of the longest prefix covering it. The
+    //! children and the values are stored consecutively, a slot finds its own by
+    //! counting the set bits in front of it.
+    struct SNode
+    {
+        uint64_t childBits;     //!< slots continued by a child node
+        uint64_t runBits;       //!< slots starting a run of equal values, child slots are skipped
+        uint64_t skipKey;       //!< the skipped bits of all prefixes below the node
+        uint32_t children;      //!< index of the first child node
+        uint32_t values;        //!< index of the value of the first run
+        uint32_t skipBits;      //!< count of skipped bits in front of the slots
+        uint32_t missValue;     //!< value of an address differing in the skipped bits
+    };
+
+    struct SFamily
+    {
+        std::vector<SEntry> direct;     //!< 2^16 entries, empty without prefixes longer than 0
+        uint32_t defaultValue {noMatch};
+    };
+
+    static SKey keyOf(const CIpAddress& rAddress) noexcept;
+    static uint64_t bitsAt(const SKey& rKey, unsigned depth, unsigned count) noexcept;
+
+    uint32_t lookup(const SFamily& rFamily, const SKey& rKey) const noexcept;
+    void build(SFamily& rFamily, const std::vector<const SPrefix*>& rPrefixes);
+    void fillNode(uint32_t node, const std::vector<const SPrefix*>& rPrefixes, unsigned depth, uint32_t inherited);
+    static unsigned commonBits(const std::vector<const SPrefix*>& rPrefixes, unsigned depth) noexcept;
+    uint32_t addNodes(std::size_t count);
+
+    SFamily m_v4;
+    SFamily m_v6;
+    std::vector<SNode> m_nodes;
+    std::vector<uint32_t> m_values;
+    std::size_t m_size {0};
+};
+
+//*****************************************************************************
+//! \brief CSharedPrefixTable
+//! Current table shared between a writer replacing it and any count of reader
+//! threads. A reader checks for a replacement by one atomic load per lookup, the
+//! table it uses stays valid until the reader picks up the next one.
+class CSharedPrefixTable
+{
+public:
+    //! cached reference of one reader thread
+    class CReader
+    {
+    public:
+        explicit CReader(const CSharedPrefixTable& rShared);
+
+        uint32_t lookup(const CIpAddress& rAddress)
+        {
+            return table().lookup(rAddress);
+        }
+
+        //! the current table, it is replaced if the writer stored a new one
+        const CPrefixTable& table()
+        {
+            if (m_version != m_rShared.m_version.load(std::memory_order_acquire)) {
+                refresh();
+            }
+            return *m_pTable;
+        }
+
+    private:
+        void refresh();
+
+        const CSharedPrefixTable& m_rShared;
+        std::shared_ptr<const CPrefixTable> m_pTable;
+        uint64_t m_version {0};
+    };
+
+    explicit CSharedPrefixTable(std::shared_ptr<const CPrefixTable> pTable = std::make_shared<const CPrefixTable>());
+
+    //! replace the table, the readers pick it up at their next lookup
+    void store(std::shared_ptr<const CPrefixTable> pTable);
+    std::shared_ptr<const CPrefixTable> load() const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::shared_ptr<const CPrefixTable> m_pTable;
+    std::atomic<uint64_t> m_version {1};
+};
+
+} //EtNet
+
+#endif // _PREFIXTABLE_H_
@@ -27,6 +27,7 @@
 #define _NETADAPTER_H_
 
 #include <type_traits>
+#include <span.h>
 #include <HostOrder.h>
 #include <templateHelpers.h>
 
@@ -45,6 +46,17 @@ struct is_span_uint8_t<utils::span<T>> // : std::true_type {};
 template <typename T>
 inline constexpr bool is_span_uint8_t_v = is_span_uint8_t<T>::value;
 
+//! I/O engine used by the DataLinks and the TcpServer to transfer data
+//! POSIX: select() followed by the blocking socket call
+//! URING: operations are submitted and completed by io_uring
+enum class EIoEngine
+{
+    POSIX,
+    URING
+};
+
+//! return true if the engine is supported by the running kernel
+bool isIoEngineSupported(EIoEngine engine) noexcept;
 
 }
 
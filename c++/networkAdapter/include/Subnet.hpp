@@ -0,0 +1,107 @@
+/*
+ * This file is part of the EMBTOM project
+ * Copyright (c) 2018-2020 Thomas Willetal
+ * (https://github.com/embtom)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _SUBNET_H_
+#define _SUBNET_H_
+
+//******************************************************************************
+// Headers
+
+#include <stdint.h>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <span.h>
+#include <IpAddress.hpp>
+
+namespace EtNet
+{
+
+//*****************************************************************************
+//! \brief CSubnet
+//! IPv4 or IPv6 network of an address and a prefix length, the bits of the
+//! address behind the prefix length are cleared. An empty subnet contains no
+//! address.
+class CSubnet
+{
+public:
+    //! Creates an empty subnet
+    CSubnet() noexcept = default;
+
+    //! Creates the network of the address, std::invalid_argument if the address
+    //! is empty or the length exceeds 32 for IPv4 or 128 for IPv6
+    CSubnet(const CIpAddress& rAddress, unsigned prefixLength);
+
+    //! Parses "address/length", without length the subnet is the address only.
+    //! Returns std::nullopt if the text is invalid
+    static std::optional<CSubnet> parse(std::string_view text) noexcept;
+
+    //! Subnet of an address and its network submask, std::nullopt if the mask
+    //! is not of the address family or no contiguous sequence of leading ones
+    static std::optional<CSubnet> fromMask(const CIpAddress& rAddress, const CIpAddress& rSubmask) noexcept;
+
+    //! count of the leading ones of a network submask, std::nullopt if the ones
+    //! are not contiguous
+    static std::optional<unsigned> maskLength(const CIpAddress& rSubmask) noexcept;
+
+    const CIpAddress& network() const noexcept { return m_network; }
+    unsigned prefixLength() const noexcept { return m_length; }
+    bool empty() const noexcept { return m_network.empty(); }
+
+    //! network submask of the prefix length
+    const CIpAddress& mask() const noexcept { return m_mask; }
+
+    //! directed broadcast address of an IPv4 subnet, an empty address for IPv6
+    CIpAddress broadcast() const noexcept;
+
+    //! true if the address is of the same family and within the network
+    bool contains(const CIpAddress& rAddress) const noexcept;
+
+    //! true if the other subnet is a part of this one
+    bool contains(const CSubnet& rOther) const noexcept;
+
+    //! true if the subnets have at least one address in common
+    bool overlaps(const CSubnet& rOther) const noexcept;
+
+    //! Tests a batch of addresses, bit i % 64 of matches[i / 64] is set if
+    //! address i is contained, the remaining bits are cleared. Returns the
+    //! count of contained addresses, std::invalid_argument if there are fewer
+    //! than addresses.size() bits in matches
+    std::size_t contains(utils::span<const CIpAddress> addresses, utils::span<uint64_t> matches) const;
+
+    std::string toString() const;
+
+    bool operator== (const CSubnet& rhs) const noexcept;
+    bool operator!= (const CSubnet& rhs) const noexcept { return !((*this) == rhs); }
+
+private:
+    CIpAddress m_network;
+    CIpAddress m_mask;
+    unsigned m_length {0};
+};
+
+} //EtNet
+
+#endif // _SUBNET_H_
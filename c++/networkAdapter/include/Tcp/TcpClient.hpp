@@ -32,11 +32,16 @@
 #include <tuple>
 #include <memory>
 #include <string>
+#include <chrono>
+#include <IpAddress.hpp>
 #include <Tcp/TcpDataLink.hpp>
 
 namespace EtNet
 {
 
+//! delay until the next parallel connection attempt is started (RFC 8305)
+constexpr std::chrono::milliseconds connectionAttemptDelay {250};
+
 class CBaseSocket;
 class CTcpClientPrivate;
 
@@ -57,8 +62,25 @@ public:
     CTcpClient(CBaseSocket &&rBaseSocket);
 
     //! Establish a connection to a TcpServer. The returned
-    //! TcpDataLink Object is used for communication
+    //! TcpDataLink Object is used for communication. A literal IP address
+    //! is connected without any lookup
     CTcpDataLink connect(const std::string& rHost, unsigned int port);
+
+    //! Establish a connection to the passed address, no lookup is done
+    CTcpDataLink connect(const CIpAddress& rIp, unsigned int port);
+
+    //! Establish a connection to a TcpServer within the passed timeout, the lookup of
+    //! the host is part of it. All resolved addresses are tried by non-blocking
+    //! connects, alternating between IPv6 and IPv4 and started with a delay of
+    //! connectionAttemptDelay (Happy Eyeballs). The first established connection is
+    //! returned, if none is established in time a std::runtime_error is thrown. The
+    //! passed BaseSocket is used for the first address of its domain, the other
+    //! attempts create their own sockets.
+    CTcpDataLink connect(const std::string& rHost, unsigned int port, std::chrono::milliseconds timeout);
+
+    //! Establish a connection to one of the already resolved addresses within the
+    //! passed timeout, the addresses are tried as by the connect of a host name
+    CTcpDataLink connect(const CIpAddress::IpAddresses& rIpList, unsigned int port, std::chrono::milliseconds timeout);
 private:
     std::unique_ptr<CTcpClientPrivate> m_pPrivate;
 };
@@ -0,0 +1,136 @@
+/*
+ * This file is part of the EMBTOM project
+ * Copyright (c) 2018-2020 Thomas Willetal
+ * (https://github.com/embtom)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _TCPCONNECTIONPOOL_H_
+#define _TCPCONNECTIONPOOL_H_
+
+//******************************************************************************
+// Header
+
+#include <stdint.h>
+#include <cstddef>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <Tcp/TcpDataLink.hpp>
+
+namespace EtNet
+{
+
+//! default number of connections to one backend, leased and idle ones together
+constexpr std::size_t poolMaxPerBackend = 8;
+//! idle connections are closed after this time
+constexpr std::chrono::milliseconds poolIdleTimeout {60000};
+//! deadline of the connect of a new pooled connection
+constexpr std::chrono::milliseconds poolConnectTimeout {2000};
+
+class CTcpConnectionPoolPrivate;
+
+//*****************************************************************************
+//! \brief CTcpConnectionPool
+//! Pool of established connections keyed by host and port. A connection is
+//! leased for a request/response exchange and returned to the pool afterwards,
+//! the next lease of the same backend reuses it without lookup and handshake.
+//! Idle connections are checked before reuse, a connection closed by the peer,
+//! with unexpected pending data or idle for longer than the idle timeout is dropped.
+//! The number of connections per backend is capped, a lease waits until one is returned.
+//! All methods can be called from any thread.
+class CTcpConnectionPool
+{
+public:
+    struct SStats
+    {
+        uint64_t connects {0};      //!< newly established connections
+        uint64_t reuses {0};        //!< leases served by an idle connection
+        uint64_t dropped {0};       //!< idle connections dropped by the health check or timeout
+        std::size_t idle {0};       //!< currently idle connections
+        std::size_t leased {0};     //!< currently leased connections
+    };
+
+    //*************************************************************************
+    //! \brief CLease
+    //! Leased connection, it is returned to the pool at destruction. A lease
+    //! destroyed by the unwinding of an exception closes its connection, the
+    //! exchange may be incomplete. A connection left in an undefined state
+    //! otherwise, e.g. after a partial exchange, has to be discarded.
+    class CLease
+    {
+    public:
+        CLease() noexcept                    = default;
+        CLease(const CLease&)                = delete;
+        CLease& operator=(const CLease&)     = delete;
+        CLease(CLease&& rhs) noexcept;
+        CLease& operator=(CLease&& rhs) noexcept;
+        ~CLease() noexcept;
+
+        CTcpDataLink& link() noexcept { return m_link; }
+        CTcpDataLink* operator->() noexcept { return &m_link; }
+        explicit operator bool() const noexcept { return m_leased; }
+
+        //! return the connection to the pool for reuse
+        void release() noexcept;
+        //! close the connection instead of returning it
+        void discard() noexcept;
+
+    private:
+        friend class CTcpConnectionPoolPrivate;
+        CLease(std::weak_ptr<CTcpConnectionPoolPrivate> pPool, std::string key, CTcpDataLink link) noexcept;
+        void giveBack(bool reuse) noexcept;
+
+        std::weak_ptr<CTcpConnectionPoolPrivate> m_pPool;
+        std::string  m_key;
+        CTcpDataLink m_link;
+        bool         m_leased {false};
+        int          m_uncaught {0};    //!< uncaught exceptions at the creation of the lease
+    };
+
+    CTcpConnectionPool(const CTcpConnectionPool&)            = delete;
+    CTcpConnectionPool& operator=(const CTcpConnectionPool&) = delete;
+    CTcpConnectionPool(CTcpConnectionPool&&) noexcept            = default;
+    CTcpConnectionPool& operator=(CTcpConnectionPool&&) noexcept = default;
+    ~CTcpConnectionPool() noexcept;
+
+    CTcpConnectionPool(std::size_t maxPerBackend = poolMaxPerBackend,
+                       std::chrono::milliseconds idleTimeout = poolIdleTimeout,
+                       std::chrono::milliseconds connectTimeout = poolConnectTimeout);
+
+    //! lease a connection to the backend, an idle one is reused otherwise a new one is
+    //! established. If the backend has reached its cap the call blocks until a connection
+    //! is returned or the wait timeout expires, then a std::runtime_error is thrown.
+    CLease acquire(const std::string& rHost, unsigned int port,
+                   std::chrono::milliseconds waitTimeout = std::chrono::milliseconds(-1));
+
+    //! close all idle connections
+    void clear() noexcept;
+
+    SStats getStats() const;
+
+private:
+    std::shared_ptr<CTcpConnectionPoolPrivate> m_pPrivate;
+};
+
+} //EtNet
+
+#endif // _TCPCONNECTIONPOOL_H_
@@ -31,8 +31,11 @@
 
 #include <stdint.h>
 #include <cstddef>
+#include <chrono>
 #include <functional>
 #include <memory>
+#include <array>
+#include <sys/types.h>
 #include <span.h>
 #include <templateHelpers.h>
 #include <HostOrder.h>
@@ -45,6 +48,9 @@ namespace EtNet
 
 constexpr auto defaultOneRead = [](utils::span<uint8_t> rx){ return true; };
 
+//! below this size a zero copy transmit is more expensive than the copy into the socket buffer
+constexpr std::size_t zeroCopyThreshold = 10 * 1024;
+
 class CBaseSocket;
 class CTcpDataLinkPrivate;
 
@@ -57,10 +63,22 @@ public:
     enum class ERet
     {
         OK,
-        UNBLOCK
+        UNBLOCK,
+        WOULDBLOCK
     };
 
     using CallbackReceive = std::function<bool (utils::span<uint8_t> rx)>;
+    using CallbackRelease = std::function<void ()>;
+    //! progress of a file transmit, returning false cancels the remaining transmit
+    using CallbackProgress = std::function<bool (std::size_t sent, std::size_t length)>;
+
+    struct SZeroCopyStats
+    {
+        uint64_t zeroCopySends {0};   //!< transmits passed by MSG_ZEROCOPY
+        uint64_t copiedSends {0};     //!< transmits below the threshold, copied at send
+        uint64_t kernelCopied {0};    //!< zero copy sendmsg calls the kernel had to copy anyway, a transmit
+                                      //!< completed by partial writes is counted per call
+    };
 
     CTcpDataLink() noexcept                              = default;
     CTcpDataLink(CTcpDataLink const&)                    = default;
@@ -79,11 +97,33 @@ public:
     void send(const utils::span<const uint8_t>& rTxSpan) const;
 
     //! data to transmit is passed by a the non-owning span view of any type T.
-    template<typename T, std::enable_if_t<!std::is_same_v<utils::remove_cvref_t<T>,uint8_t>,int> = 0>
+    template<typename T, std::enable_if_t<!std::is_same_v<utils::remove_cvref_t<T>,uint8_t> &&
+                                          !utils::is_span_v<utils::remove_cvref_t<T>>,int> = 0>
     void send(const utils::span<T>& rTxSpan) const {
         send(rTxSpan.as_byte());
     }
 
+    //! scatter-gather transmit, the parts are sent in order by sendmsg with an iovec array.
+    //! They are not copied into one buffer, a partial write continues at the pending part.
+    void send(utils::span<const utils::span<const uint8_t>> parts) const;
+
+    //! scatter-gather transmit of any mix of spans and NetOrder reflection helpers
+    //! e.g. send(CNetOrder(header), utils::span(payload));
+    template<typename First, typename Second, typename... Parts>
+    void send(const First& rFirst, const Second& rSecond, const Parts&... rParts) const
+    {
+        const std::array<utils::span<const uint8_t>, 2 + sizeof...(Parts)> parts {toPart(rFirst), toPart(rSecond), toPart(rParts)...};
+        send(utils::span<const utils::span<const uint8_t>>(parts.data(), parts.size()));
+    }
+
+    //! transmit of a file region by sendfile, the data is not copied to user space.
+    //! A length of zero transmits up to the end of the file. The progress callback
+    //! is called after each transmitted chunk. The amount of transmitted data is
+    //! returned, it is less than length if the transmit was cancelled or the end of
+    //! the file was reached. The file is always sent by the socket directly,
+    //! independent of the selected IoEngine.
+    std::size_t sendFile(int fileFd, off_t offset, std::size_t length, CallbackProgress progress = nullptr) const;
+
     //! data to transmit is passed ty NetOrder reflection helper. It converts the data to transmit
     //! automatically into Network-byte-order (Big Endian).
     //! For reflection of the passed type a registration of the members (EtEndian::registerMembers<T>)
@@ -125,7 +165,56 @@ public:
 
     //The recive methode is blocking if no data is available and can be unblocked.
     bool unblockRecive() noexcept;
+
+    //! non-blocking recive of the currently available data, used by EventLoop driven links.
+    //! The span is shrunk to the amount of data read. An empty span with ERet::OK signals
+    //! that the peer has closed the connection. ERet::WOULDBLOCK if no data is pending.
+    ERet tryRecive(utils::span<uint8_t>& rRxSpan);
+
+    //! non-blocking transmit, returns the amount of data written. If less than the
+    //! passed data is written the remaining data has to be sent at the next WRITE event.
+    std::size_t trySend(const utils::span<const uint8_t>& rTxSpan) const;
+
+    //! get the underlying socket, e.g. to register the link at the EventLoop
+    int getFd() const noexcept;
+
+    //! select the engine used by send and recive. If the URING engine is not supported
+    //! by the running kernel the POSIX engine is kept. The active engine is returned.
+    //! The engine has to be selected before the link is used. The non-blocking
+    //! tryRecive/trySend calls always access the socket directly.
+    EIoEngine setIoEngine(EIoEngine engine);
+    EIoEngine getIoEngine() const noexcept;
+
+    //! enables the MSG_ZEROCOPY transmit of sendZeroCopy. Buffers smaller than the
+    //! threshold are copied as usual. Returns false if not supported by the kernel.
+    bool setZeroCopy(std::size_t threshold = zeroCopyThreshold);
+
+    //! transmit without copy of the buffer into the kernel. The buffer has to stay
+    //! valid and unchanged until onRelease is called. The completions are harvested
+    //! at each sendZeroCopy and by flushZeroCopy. Without setZeroCopy the buffer is
+    //! copied and released immediately. If the transmit throws, onRelease is still
+    //! called once the kernel has finished with the already queued parts. The zero
+    //! copy path always uses the socket directly, independent of the selected IoEngine.
+    void sendZeroCopy(const utils::span<const uint8_t>& rTxSpan, CallbackRelease onRelease);
+
+    //! waits up to timeout for the release of the pending zero copy transmits.
+    //! The number of still pending transmits is returned.
+    std::size_t flushZeroCopy(std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+
+    SZeroCopyStats getZeroCopyStats() const;
 private:
+    template<typename T>
+    static utils::span<const uint8_t> toPart(const utils::span<T>& rSpan) noexcept {
+        return rSpan.as_byte();
+    }
+
+    template<typename T>
+    static utils::span<const uint8_t> toPart(const EtEndian::CNetOrder<T>& rTx) noexcept
+    {
+        utils::span<std::add_const_t<std::remove_reference_t<T>>> txSpan (rTx.NetworkOrder());
+        return txSpan.as_byte();
+    }
+
     std::shared_ptr<CTcpDataLinkPrivate> m_pPrivate;
 };
 
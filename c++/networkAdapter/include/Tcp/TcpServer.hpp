@@ -31,6 +31,10 @@
 
 #include <tuple>
 #include <memory>
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include <BaseSocket.hpp>
 #include <IpAddress.hpp>
 #include <Tcp/TcpDataLink.hpp>
 
@@ -38,9 +42,11 @@ namespace EtNet
 {
 
 constexpr int maxConnectionBacklog = 5;
+//! default backlog of the acceptor pool listeners, it is clamped by net.core.somaxconn
+constexpr int poolConnectionBacklog = 1024;
 
-class CBaseSocket;
 class CTcpServerPrivate;
+class CTcpAcceptorPoolPrivate;
 
 //*****************************************************************************
 //! \brief CTcpServer
@@ -56,17 +62,88 @@ public:
     CTcpServer& operator= (CTcpServer&&) noexcept = default;
     virtual ~CTcpServer() noexcept;
 
-    //! Initialize TcpServer with a BaseSocket and port to listen
-    CTcpServer(CBaseSocket&& rBaseSocket, unsigned int port);
+    //! Initialize TcpServer with a BaseSocket and port to listen. The backlog limits
+    //! the number of completed connections queued until they are accepted
+    CTcpServer(CBaseSocket&& rBaseSocket, unsigned int port, int backlog = maxConnectionBacklog);
 
     //! wait for connecton, if the routine unblocks a client have connected
     //! and returns the IpAddress of the Client and a TcpDataLink Object.
     //! It is used to communicate the client
     std::tuple<CTcpDataLink, CIpAddress> waitForConnection();
+
+    //! non-blocking accept of a pending connection, used by EventLoop driven servers.
+    //! Returns false if no connection is pending. It accepts by the socket directly
+    //! and is not available with the URING engine.
+    bool tryAccept(CTcpDataLink& rLink, CIpAddress& rPeer);
+
+    //! get the listening socket, e.g. to drain it by an own accept loop
+    int getFd() const noexcept;
+
+    //! select the engine used to accept connections. The URING engine keeps a
+    //! multishot accept armed. If it is not supported by the running kernel the
+    //! POSIX engine is kept. The active engine is returned.
+    EIoEngine setIoEngine(EIoEngine engine);
+    EIoEngine getIoEngine() const noexcept;
 private:
     std::unique_ptr<CTcpServerPrivate> m_pPrivate;
 };
 
+//*****************************************************************************
+//! \brief CTcpAcceptorPool
+//! Multi acceptor server: several listening sockets share the port by
+//! SO_REUSEPORT, the kernel distributes the incoming connections between them.
+//! Every listener is drained by its own thread with an accept4 loop.
+class CTcpAcceptorPool
+{
+public:
+    using CallbackAccept = std::function<void (CTcpDataLink link, CIpAddress peer)>;
+
+    struct SListenerStats
+    {
+        uint64_t accepted {0};  //!< connections accepted by this listener
+        uint32_t queued   {0};  //!< connections waiting in the accept queue
+        uint32_t backlog  {0};  //!< size of the accept queue
+    };
+
+    struct SStats
+    {
+        uint64_t accepted {0};          //!< connections accepted by all listeners
+        double   acceptsPerSecond {0};  //!< rate since the previous call of getStats
+        uint64_t listenOverflows {0};   //!< host wide accept queue overflows (TcpExt ListenOverflows)
+        uint64_t listenDrops {0};       //!< host wide dropped connection requests (TcpExt ListenDrops)
+        std::vector<SListenerStats> listeners;
+    };
+
+    CTcpAcceptorPool() noexcept                               = default;
+    CTcpAcceptorPool(const CTcpAcceptorPool&)                 = delete;
+    CTcpAcceptorPool& operator= (const CTcpAcceptorPool&)     = delete;
+    CTcpAcceptorPool(CTcpAcceptorPool&&) noexcept             = default;
+    CTcpAcceptorPool& operator= (CTcpAcceptorPool&&) noexcept = default;
+    virtual ~CTcpAcceptorPool() noexcept;
+
+    //! Bind the passed number of listening sockets of the socket mode to the port.
+    //! A listeners count of 0 selects one listener per hardware thread
+    CTcpAcceptorPool(ESocketMode mode, unsigned int port, unsigned int listeners = 0, int backlog = poolConnectionBacklog);
+
+    //! start the accept threads, the callback is called by the accepting thread
+    //! for every new connection. A pool is started once, a start after stop
+    //! throws std::logic_error
+    void start(CallbackAccept onAccept);
+
+    //! stop and join the accept threads. The listening sockets are shut down,
+    //! queued connections are not accepted anymore
+    void stop() noexcept;
+
+    //! number of listening sockets
+    std::size_t size() const noexcept;
+
+    //! accept counters and the fill level of the accept queues
+    SStats getStats() const;
+
+private:
+    std::unique_ptr<CTcpAcceptorPoolPrivate> m_pPrivate;
+};
+
 } //EtNet
 
 #endif // _TCPSERVER_H_
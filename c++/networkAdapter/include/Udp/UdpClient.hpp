@@ -32,6 +32,7 @@
 #include <tuple>
 #include <string>
 #include <memory>
+#include <IpAddress.hpp>
 #include <Udp/UdpDataLink.hpp>
 
 namespace EtNet
@@ -57,9 +58,17 @@ public:
     CUdpClient(CBaseSocket &&rBaseSocket);
 
     //! Request a link to send Udp packets to a UdpServer
-    //! The returned UdpDataLink Object is used for communication
+    //! The returned UdpDataLink Object is used for communication.
+    //! A literal IP address is used without any lookup
     CUdpDataLink getLink(const std::string& rHost, unsigned int port);
 
+    //! Request a link to the passed address, no lookup is done
+    CUdpDataLink getLink(const CIpAddress& rIp, unsigned int port);
+
+    //! Request a link to the first of the already resolved addresses
+    //! matching the domain of the socket
+    CUdpDataLink getLink(const CIpAddress::IpAddresses& rIpList, unsigned int port);
+
 private:
     std::unique_ptr<CUdpClientPrivate> m_pPrivate;
 };
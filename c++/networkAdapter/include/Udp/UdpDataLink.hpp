@@ -33,6 +33,7 @@
 #include <cstddef>
 #include <functional>
 #include <memory>
+#include <vector>
 #include <span.h>
 #include <templateHelpers.h>
 #include <HostOrder.h>
@@ -50,8 +51,35 @@ struct SPeerAddr
 {
     CIpAddress Ip;
     unsigned int Port {0};
+
+    bool operator== (const SPeerAddr& rhs) const noexcept { return (Port == rhs.Port) && (Ip == rhs.Ip); }
+    bool operator!= (const SPeerAddr& rhs) const noexcept { return !((*this) == rhs); }
+};
+
+//! one datagram of a batch transfer
+struct SDatagram
+{
+    utils::span<uint8_t> Data;  //!< recive buffer, shrunk to the length of the recived datagram
+    SPeerAddr Peer;             //!< sender of the datagram
+    int Flags {0};              //!< message flags, e.g. MSG_TRUNC if the datagram exceeded the buffer
 };
 
+//! one datagram of a batch transmit
+struct SDatagramTx
+{
+    SPeerAddr Peer;                 //!< receiver of the datagram
+    utils::span<const uint8_t> Data;
+};
+
+//! maximum number of datagrams transfered by one batch system call
+constexpr std::size_t maxBatchDatagrams = 64;
+
+//! maximum number of segments the kernel splits off one UDP_SEGMENT transmit
+constexpr std::size_t maxGsoSegments = 64;
+
+//! size of a recive buffer able to hold any coalesced datagram of an UDP_GRO recive
+constexpr std::size_t maxGroDatagram = 65535;
+
 constexpr auto defaultReciveFrom = [](SPeerAddr ClientAddr, utils::span<uint8_t> rx)
 {
     std::cout << "DefaultRecive" << std::endl;
@@ -68,10 +96,14 @@ public:
     enum class ERet
     {
         OK,
-        UNBLOCK
+        UNBLOCK,
+        WOULDBLOCK
     };
 
     using CallbackReciveFrom = std::function<bool (EtNet::SPeerAddr ClientAddr, utils::span<uint8_t> rx)>;
+    //! the segments are views into the recive buffer, valid until the callback returns.
+    //! Returning true stops the recive of further pending datagrams.
+    using CallbackReciveSegments = std::function<bool (EtNet::SPeerAddr ClientAddr, utils::span<const utils::span<uint8_t>> segments)>;
 
     CUdpDataLink() noexcept;
     CUdpDataLink(CUdpDataLink const&)                    = delete;
@@ -134,6 +166,50 @@ public:
         sendTo(rClientAddr, txSpan.as_byte());
     }
 
+    //! batch transmit of datagrams to individual peers. The datagrams are flushed by sendmmsg
+    //! in chunks of maxBatchDatagrams, a partial completion is continued with the remaining ones.
+    void sendToBatch(utils::span<const SDatagramTx> batch) const;
+
+    //! batch transmit of one datagram to many peers, e.g. the fan-out of an update
+    void sendToBatch(utils::span<const SPeerAddr> peers, const utils::span<const uint8_t>& rSpanTx) const;
+
+    //! batch transmit of many datagrams to the peer specified at construction
+    void sendBatch(utils::span<const utils::span<const uint8_t>> batch) const;
+
+    //! batch transmit of NetOrder reflection helpers to the peer specified at construction.
+    //! Every message is sent as its own datagram.
+    template<typename T>
+    void sendBatch(const std::vector<EtEndian::CNetOrder<T>>& rTx)
+    {
+        std::vector<utils::span<const uint8_t>> batch;
+        batch.reserve(rTx.size());
+        for (const auto& tx : rTx)
+        {
+            utils::span<std::add_const_t<std::remove_reference_t<T>>> txSpan (tx.NetworkOrder());
+            batch.push_back(txSpan.as_byte());
+        }
+        sendBatch(utils::span<const utils::span<const uint8_t>>(batch.data(), batch.size()));
+    }
+
+    //! fan-out of a NetOrder reflection helper to many peers
+    template<typename T>
+    void sendToBatch(utils::span<const SPeerAddr> peers, const EtEndian::CNetOrder<T>& rTx)
+    {
+        utils::span<std::add_const_t<std::remove_reference_t<T>>> txSpan (rTx.NetworkOrder());
+        sendToBatch(peers, txSpan.as_byte());
+    }
+
+    //! segmented transmit of equal sized datagrams to one peer. The buffer is split into
+    //! datagrams of segmentSize, the last one may be shorter. If the kernel supports
+    //! UDP_SEGMENT (GSO) the buffer is passed by few sendmsg calls and the kernel splits
+    //! it into the datagrams, otherwise the datagrams are sent by sendmmsg.
+    //! The return value is true if the transmit was segmented by the kernel.
+    //! The socket is always accessed directly, independent of the selected IoEngine.
+    bool sendToSegmented(const SPeerAddr& rClientAddr, const utils::span<const uint8_t>& rSpanTx, std::size_t segmentSize) const;
+
+    //! segmented transmit to the peer specified at construction
+    bool sendSegmented(const utils::span<const uint8_t>& rSpanTx, std::size_t segmentSize) const;
+
     //! the recive buffer is passed by a the non-owning span view of type "uint8_t"
     //! The return value is Ret::UNBLOCK if "unblockRecive" is called
     ERet reciveFrom(utils::span<uint8_t>& rSpanRx, CallbackReciveFrom scanForEnd = defaultReciveFrom) const;
@@ -164,10 +240,62 @@ public:
     //The recive methode is blocking if no data is available and can be unblocked.
     bool unblockRecive() noexcept;
 
+    //! non-blocking recive of one pending datagram, used by EventLoop driven links.
+    //! The span is shrunk to the size of the datagram and the sender is written to rPeerAddr.
+    //! ERet::WOULDBLOCK if no datagram is pending.
+    ERet tryReciveFrom(utils::span<uint8_t>& rSpanRx, SPeerAddr& rPeerAddr) const;
+
+    //! batch recive of up to maxBatchDatagrams datagrams by a single recvmmsg. The call blocks until
+    //! at least one datagram is available. The data spans of the batch are shrunk to the recived
+    //! length and have to be restored before the batch is reused. The number of recived datagrams
+    //! is written to rCount. The return value is Ret::UNBLOCK if "unblockRecive" is called
+    ERet reciveBatch(utils::span<SDatagram> batch, std::size_t& rCount) const;
+
+    //! non-blocking batch recive of the pending datagrams, ERet::WOULDBLOCK if none is pending.
+    ERet tryReciveBatch(utils::span<SDatagram> batch, std::size_t& rCount) const;
+
+    //! enables the coalescing of datagrams of the same flow by UDP_GRO. It has to be
+    //! enabled before the datagrams arrive. Returns false if not supported by the kernel.
+    bool setGroRecive(bool enable);
+
+    //! recive of coalesced datagrams, the call blocks until at least one datagram is available.
+    //! Each datagram is read into rxBuffer and passed as its segments to the callback, without
+    //! copying. A datagram that was not coalesced is passed as a single segment. The pending
+    //! datagrams are read until none is left or the callback returns true.
+    //! The rxBuffer should hold maxGroDatagram, otherwise a coalesced datagram is truncated.
+    //! The return value is Ret::UNBLOCK if "unblockRecive" is called
+    ERet reciveSegments(utils::span<uint8_t> rxBuffer, CallbackReciveSegments onSegments) const;
+
+    //! non-blocking recive of the pending coalesced datagrams, ERet::WOULDBLOCK if none is pending.
+    ERet tryReciveSegments(utils::span<uint8_t> rxBuffer, CallbackReciveSegments onSegments) const;
+
+    //! get the underlying socket, e.g. to register the link at the EventLoop
+    int getFd() const noexcept;
+
+    //! select the engine used by send, sendTo and reciveFrom. If the URING engine is not
+    //! supported by the running kernel the POSIX engine is kept. The active engine is returned.
+    //! The engine has to be selected before the link is used.
+    EIoEngine setIoEngine(EIoEngine engine);
+    EIoEngine getIoEngine() const noexcept;
+
 private:
     std::unique_ptr<CUdpDataLinkPrivate> m_pPrivate;
 };
 
 } // EtNet
 
+namespace std
+{
+
+template<>
+struct hash<EtNet::SPeerAddr>
+{
+    std::size_t operator()(const EtNet::SPeerAddr& rPeer) const noexcept
+    {
+        return static_cast<std::size_t>(EtNet::detail::mix64(std::hash<EtNet::CIpAddress>()(rPeer.Ip) + rPeer.Port));
+    }
+};
+
+} // std
+
 #endif // _UDPDATALINK_H_
@@ -125,6 +125,15 @@ CBaseSocket&& CBaseSocket::SoReuseSocket(CBaseSocket &&rBaseSocket)
     return std::move(rBaseSocket);
 }
 
+CBaseSocket&& CBaseSocket::SoReusePort(CBaseSocket &&rBaseSocket)
+{
+    int reuseport = 1;
+    if(setsockopt(rBaseSocket.getFd(), SOL_SOCKET, SO_REUSEPORT, &reuseport, sizeof(reuseport)) == -1) {
+        throw std::runtime_error(utils::buildErrorMessage("CBaseSocket::", __func__, ": SoReusePort: ", strerror(errno)));
+    }
+    return std::move(rBaseSocket);
+}
+
 CBaseSocket&& CBaseSocket::SoBroadcast(CBaseSocket &&rBaseSocket)
 {
     int broadcast = 1;
@@ -0,0 +1,371 @@
+/*
+ * This file is part of the EMBTOM project
+ * Copyright (c) 2018-2020 Thomas Willetal
+ * (https://github.com/embtom)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+//******************************************************************************
+// Header
+
+#include <iostream>
+#include <stdexcept>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <unordered_map>
+
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include <error_msg.hpp>
+#include <Tcp/TcpDataLink.hpp>
+#include <Udp/UdpDataLink.hpp>
+#include <EventLoop.hpp>
+
+namespace EtNet
+{
+
+constexpr int maxEventsPerWait = 256;
+
+//*****************************************************************************
+//! \brief CEventLoopPrivate
+//!
+class CEventLoopPrivate
+{
+public:
+    CEventLoopPrivate();
+    ~CEventLoopPrivate() noexcept;
+
+    void add(int fd, EEvent interest, CEventLoop::CallbackEvent&& callback);
+    void modify(int fd, EEvent interest);
+    void remove(int fd) noexcept;
+    std::size_t size() const noexcept;
+
+    CEventLoop::ERet runOnce(std::chrono::milliseconds timeout);
+    void post(CEventLoop::CallbackPost&& func);
+    bool unblock() noexcept;
+
+private:
+    struct SHandler
+    {
+        uint32_t                    generation {0};
+        CEventLoop::CallbackEvent   callback;
+    };
+
+    static uint32_t toEpoll(EEvent interest) noexcept;
+    static EEvent fromEpoll(uint32_t events) noexcept;
+    bool wakeup() noexcept;
+    bool processWakeup();
+
+    int                     m_epollFd  {-1};
+    int                     m_wakeFd   {-1};
+    uint32_t                m_generation {0};
+    std::atomic<bool>       m_unblock  {false};
+    mutable std::mutex      m_mutex;
+    std::unordered_map<int, std::shared_ptr<SHandler>> m_handlers;
+    std::vector<CEventLoop::CallbackPost> m_posted;
+    std::vector<epoll_event> m_events;
+};
+
+}
+
+using namespace EtNet;
+
+//*****************************************************************************
+// Method definitions "CEventLoopPrivate"
+
+CEventLoopPrivate::CEventLoopPrivate() :
+    m_events(maxEventsPerWait)
+{
+    m_epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    if (m_epollFd < 0) {
+        throw std::runtime_error(utils::buildErrorMessage("CEventLoop::", __func__, ": epoll_create1: ", strerror(errno)));
+    }
+
+    m_wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_wakeFd < 0) {
+        ::close(m_epollFd);
+        throw std::runtime_error(utils::buildErrorMessage("CEventLoop::", __func__, ": eventfd: ", strerror(errno)));
+    }
+
+    epoll_event ev {};
+    ev.events  = EPOLLIN;
+    ev.data.u64 = static_cast<uint32_t>(m_wakeFd);
+    if (::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &ev) != 0) {
+        ::close(m_wakeFd);
+        ::close(m_epollFd);
+        throw std::runtime_error(utils::buildErrorMessage("CEventLoop::", __func__, ": epoll_ctl: ", strerror(errno)));
+    }
+}
+
+CEventLoopPrivate::~CEventLoopPrivate() noexcept
+{
+    ::close(m_wakeFd);
+    ::close(m_epollFd);
+}
+
+uint32_t CEventLoopPrivate::toEpoll(EEvent interest) noexcept
+{
+    uint32_t events = EPOLLET | EPOLLRDHUP;
+    if (hasEvent(interest, EEvent::READ)) {
+        events |= EPOLLIN;
+    }
+    if (hasEvent(interest, EEvent::WRITE)) {
+        events |= EPOLLOUT;
+    }
+    return events;
+}
+
+EEvent CEventLoopPrivate::fromEpoll(uint32_t events) noexcept
+{
+    EEvent ret = EEvent::NONE;
+    if (events & (EPOLLIN | EPOLLPRI)) {
+        ret = ret | EEvent::READ;
+    }
+    if (events & EPOLLOUT) {
+        ret = ret | EEvent::WRITE;
+    }
+    if (events & (EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+        ret = ret | EEvent::CLOSE;
+    }
+    return ret;
+}
+
+void CEventLoopPrivate::add(int fd, EEvent interest, CEventLoop::CallbackEvent&& callback)
+{
+    if (fd < 0) {
+        throw std::invalid_argument(utils::buildErrorMessage("CEventLoop::", __func__, ": invalid file descriptor"));
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto pHandler = std::make_shared<SHandler>();
+    if (++m_generation == 0) {
+        ++m_generation;
+    }
+    pHandler->generation = m_generation;
+    pHandler->callback   = std::move(callback);
+
+    // The generation is stored next to the descriptor to drop stale
+    // events of a descriptor which is removed and reused at the same wait cycle.
+    epoll_event ev {};
+    ev.events   = toEpoll(interest);
+    ev.data.u64 = (static_cast<uint64_t>(pHandler->generation) << 32) | static_cast<uint32_t>(fd);
+
+    if (::epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        throw std::runtime_error(utils::buildErrorMessage("CEventLoop::", __func__, ": epoll_ctl: ", strerror(errno)));
+    }
+    m_handlers[fd] = std::move(pHandler);
+}
+
+void CEventLoopPrivate::modify(int fd, EEvent interest)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_handlers.find(fd);
+    if (it == m_handlers.end()) {
+        throw std::invalid_argument(utils::buildErrorMessage("CEventLoop::", __func__, ": file descriptor not registered"));
+    }
+
+    epoll_event ev {};
+    ev.events   = toEpoll(interest);
+    ev.data.u64 = (static_cast<uint64_t>(it->second->generation) << 32) | static_cast<uint32_t>(fd);
+
+    if (::epoll_ctl(m_epollFd, EPOLL_CTL_MOD, fd, &ev) != 0) {
+        throw std::runtime_error(utils::buildErrorMessage("CEventLoop::", __func__, ": epoll_ctl: ", strerror(errno)));
+    }
+}
+
+void CEventLoopPrivate::remove(int fd) noexcept
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_handlers.erase(fd) == 0) {
+        return;
+    }
+    ::epoll_ctl(m_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+}
+
+std::size_t CEventLoopPrivate::size() const noexcept
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_handlers.size();
+}
+
+bool CEventLoopPrivate::wakeup() noexcept
+{
+    uint64_t one = 1;
+    if (::write(m_wakeFd, &one, sizeof(one)) != sizeof(one)) {
+        return errno == EAGAIN;
+    }
+    return true;
+}
+
+bool CEventLoopPrivate::processWakeup()
+{
+    uint64_t cnt;
+    while (::read(m_wakeFd, &cnt, sizeof(cnt)) > 0) { }
+
+    std::vector<CEventLoop::CallbackPost> posted;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        posted.swap(m_posted);
+    }
+    for (auto& func : posted) {
+        func();
+    }
+    return m_unblock.exchange(false);
+}
+
+CEventLoop::ERet CEventLoopPrivate::runOnce(std::chrono::milliseconds timeout)
+{
+    int timeoutMs = (timeout.count() < 0) ? -1 : static_cast<int>(timeout.count());
+    int nEvents = ::epoll_wait(m_epollFd, m_events.data(), static_cast<int>(m_events.size()), timeoutMs);
+    if (nEvents < 0)
+    {
+        if (errno == EINTR) {
+            return CEventLoop::ERet::OK;
+        }
+        throw std::runtime_error(utils::buildErrorMessage("CEventLoop::", __func__, ": epoll_wait: ", strerror(errno)));
+    }
+    if (nEvents == 0) {
+        return CEventLoop::ERet::TIMEOUT;
+    }
+
+    bool unblocked = false;
+    for (int i = 0; i < nEvents; i++)
+    {
+        const epoll_event& ev = m_events[i];
+        int fd = static_cast<int>(ev.data.u64 & 0xFFFFFFFF);
+        uint32_t generation = static_cast<uint32_t>(ev.data.u64 >> 32);
+
+        if (fd == m_wakeFd && generation == 0) {
+            unblocked |= processWakeup();
+            continue;
+        }
+
+        std::shared_ptr<SHandler> pHandler;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_handlers.find(fd);
+            if ((it == m_handlers.end()) || (it->second->generation != generation)) {
+                continue;
+            }
+            pHandler = it->second;
+        }
+        // The handler is kept alive by the local copy, therefore
+        // the callback is allowed to remove its own registration.
+        pHandler->callback(fromEpoll(ev.events));
+    }
+
+    if (static_cast<std::size_t>(nEvents) == m_events.size()) {
+        m_events.resize(m_events.size() * 2);
+    }
+    return unblocked ? CEventLoop::ERet::UNBLOCK : CEventLoop::ERet::OK;
+}
+
+void CEventLoopPrivate::post(CEventLoop::CallbackPost&& func)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_posted.emplace_back(std::move(func));
+    }
+    if (!wakeup()) {
+        throw std::runtime_error(utils::buildErrorMessage("CEventLoop::", __func__, ": eventfd write: ", strerror(errno)));
+    }
+}
+
+bool CEventLoopPrivate::unblock() noexcept
+{
+    m_unblock = true;
+    return wakeup();
+}
+
+//*****************************************************************************
+// Method definitions "CEventLoop"
+
+CEventLoop::CEventLoop() :
+    m_pPrivate(std::make_unique<CEventLoopPrivate>())
+{ }
+
+CEventLoop::~CEventLoop() noexcept = default;
+
+void CEventLoop::add(int fd, EEvent interest, CallbackEvent callback)
+{
+    m_pPrivate->add(fd, interest, std::move(callback));
+}
+
+void CEventLoop::add(const CTcpDataLink& rLink, EEvent interest, CallbackEvent callback)
+{
+    m_pPrivate->add(rLink.getFd(), interest, std::move(callback));
+}
+
+void CEventLoop::add(const CUdpDataLink& rLink, EEvent interest, CallbackEvent callback)
+{
+    m_pPrivate->add(rLink.getFd(), interest, std::move(callback));
+}
+
+void CEventLoop::modify(int fd, EEvent interest)
+{
+    m_pPrivate->modify(fd, interest);
+}
+
+void CEventLoop::remove(int fd) noexcept
+{
+    m_pPrivate->remove(fd);
+}
+
+void CEventLoop::remove(const CTcpDataLink& rLink) noexcept
+{
+    m_pPrivate->remove(rLink.getFd());
+}
+
+void CEventLoop::remove(const CUdpDataLink& rLink) noexcept
+{
+    m_pPrivate->remove(rLink.getFd());
+}
+
+std::size_t CEventLoop::size() const noexcept
+{
+    return m_pPrivate->size();
+}
+
+CEventLoop::ERet CEventLoop::runOnce(std::chrono::milliseconds timeout)
+{
+    return m_pPrivate->runOnce(timeout);
+}
+
+CEventLoop::ERet CEventLoop::run()
+{
+    while (m_pPrivate->runOnce(std::chrono::milliseconds(-1)) != ERet::UNBLOCK) { }
+    return ERet::UNBLOCK;
+}
+
+void CEventLoop::post(CallbackPost func)
+{
+    m_pPrivate->post(std::move(func));
+}
+
+bool CEventLoop::unblock() noexcept
+{
+    return m_pPrivate->unblock();
+}
@@ -0,0 +1,382 @@
+/*
+ * This file is part of the EMBTOM project
+ * Copyright (c) 2018-2020 Thomas Willetal
+ * (https://github.com/embtom)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+//******************************************************************************
+// Header
+
+#include <stdexcept>
+#include <algorithm>
+#include <memory>
+
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include <error_msg.hpp>
+#include <NetAdapter.hpp>
+#include <IoEngine/IoUring.hpp>
+
+using namespace EtNet;
+
+namespace
+{
+
+int ioUringSetup(unsigned entries, io_uring_params* pParams) noexcept
+{
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, pParams));
+}
+
+int ioUringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) noexcept
+{
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+int ioUringRegister(int fd, unsigned opcode, void* pArg, unsigned nrArgs) noexcept
+{
+    return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, pArg, nrArgs));
+}
+
+bool probeIoUring() noexcept
+{
+    try
+    {
+        CIoUring ring(4);
+
+        constexpr unsigned probeOps = 256;
+        std::size_t probeLen = sizeof(io_uring_probe) + probeOps * sizeof(io_uring_probe_op);
+        std::unique_ptr<uint8_t[]> probeBuffer(new uint8_t[probeLen]());
+        auto* pProbe = reinterpret_cast<io_uring_probe*>(probeBuffer.get());
+        if (ioUringRegister(ring.getFd(), IORING_REGISTER_PROBE, pProbe, probeOps) < 0) {
+            return false;
+        }
+
+        auto isSupported = [pProbe](unsigned op) {
+            return (op <= pProbe->last_op) && (pProbe->ops[op].flags & IO_URING_OP_SUPPORTED);
+        };
+
+        // Multishot recv was introduced together with the zero copy send
+        // operation (linux 6.0), the opcode is used to detect its availability.
+        for (unsigned op : {IORING_OP_RECV, IORING_OP_SEND, IORING_OP_ACCEPT, IORING_OP_POLL_ADD,
+                            IORING_OP_RECVMSG, IORING_OP_SENDMSG, IORING_OP_SEND_ZC})
+        {
+            if (!isSupported(op)) {
+                return false;
+            }
+        }
+
+        // provided buffer rings (linux 5.19)
+        CBufferRing bufferRing(ring, 0, 1, 64);
+        return true;
+    }
+    catch(...)
+    {
+        return false;
+    }
+}
+
+}
+
+//*****************************************************************************
+// Function definitions
+
+bool EtNet::isIoEngineSupported(EIoEngine engine) noexcept
+{
+    switch (engine)
+    {
+        case EIoEngine::POSIX:
+        {
+            return true;
+        }
+        case EIoEngine::URING:
+        {
+            static const bool supported = probeIoUring();
+            return supported;
+        }
+        default:
+        {
+            return false;
+        }
+    }
+}
+
+//*****************************************************************************
+// Method definitions "CIoUring"
+
+CIoUring::CIoUring(unsigned entries)
+{
+    io_uring_params params {};
+    m_ringFd = ioUringSetup(entries, &params);
+    if (m_ringFd < 0) {
+        throw std::runtime_error(utils::buildErrorMessage("CIoUring::", __func__, ": io_uring_setup: ", strerror(errno)));
+    }
+
+    m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMmap) {
+        m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+    }
+
+    m_pSqRing = ::mmap(nullptr, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQ_RING);
+    if (m_pSqRing == MAP_FAILED) {
+        m_pSqRing = nullptr;
+        int err = errno;
+        ::close(m_ringFd);
+        throw std::runtime_error(utils::buildErrorMessage("CIoUring::", __func__, ": mmap sq ring: ", strerror(err)));
+    }
+
+    if (singleMmap) {
+        m_pCqRing = m_pSqRing;
+    }
+    else
+    {
+        m_pCqRing = ::mmap(nullptr, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_CQ_RING);
+        if (m_pCqRing == MAP_FAILED) {
+            m_pCqRing = nullptr;
+            int err = errno;
+            ::munmap(m_pSqRing, m_sqRingSize);
+            ::close(m_ringFd);
+            throw std::runtime_error(utils::buildErrorMessage("CIoUring::", __func__, ": mmap cq ring: ", strerror(err)));
+        }
+    }
+
+    m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void* pSqes = ::mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQES);
+    if (pSqes == MAP_FAILED) {
+        int err = errno;
+        if (!singleMmap) {
+            ::munmap(m_pCqRing, m_cqRingSize);
+        }
+        ::munmap(m_pSqRing, m_sqRingSize);
+        ::close(m_ringFd);
+        throw std::runtime_error(utils::buildErrorMessage("CIoUring::", __func__, ": mmap sqes: ", strerror(err)));
+    }
+    m_pSqes = static_cast<io_uring_sqe*>(pSqes);
+
+    auto* pSq = static_cast<uint8_t*>(m_pSqRing);
+    m_pSqHead   = reinterpret_cast<unsigned*>(pSq + params.sq_off.head);
+    m_pSqTail   = reinterpret_cast<unsigned*>(pSq + params.sq_off.tail);
+    m_sqMask    = *reinterpret_cast<unsigned*>(pSq + params.sq_off.ring_mask);
+    m_sqEntries = *reinterpret_cast<unsigned*>(pSq + params.sq_off.ring_entries);
+    m_sqTailLocal = *m_pSqTail;
+
+    // The submission entries are used in ring order, the indirection
+    // array is therefore an identity mapping.
+    auto* pArray = reinterpret_cast<unsigned*>(pSq + params.sq_off.array);
+    for (unsigned i = 0; i < m_sqEntries; i++) {
+        pArray[i] = i;
+    }
+
+    auto* pCq = static_cast<uint8_t*>(m_pCqRing);
+    m_pCqHead = reinterpret_cast<unsigned*>(pCq + params.cq_off.head);
+    m_pCqTail = reinterpret_cast<unsigned*>(pCq + params.cq_off.tail);
+    m_cqMask  = *reinterpret_cast<unsigned*>(pCq + params.cq_off.ring_mask);
+    m_pCqes   = reinterpret_cast<io_uring_cqe*>(pCq + params.cq_off.cqes);
+}
+
+CIoUring::~CIoUring() noexcept
+{
+    cancelAll();
+    ::munmap(m_pSqes, m_sqesSize);
+    if (m_pCqRing != m_pSqRing) {
+        ::munmap(m_pCqRing, m_cqRingSize);
+    }
+    ::munmap(m_pSqRing, m_sqRingSize);
+    ::close(m_ringFd);
+}
+
+void CIoUring::cancelAll() noexcept
+{
+    // Armed multishot operations hold a reference of their file. Without a
+    // synchronous cancel it is released by the asynchronous teardown of the ring,
+    // e.g. a listening socket would stay bound after it is closed by the user.
+    constexpr uint64_t cancelTag = ~0ULL;
+    try
+    {
+        io_uring_sqe* pSqe = getSqe();
+        pSqe->opcode       = IORING_OP_ASYNC_CANCEL;
+        pSqe->cancel_flags = IORING_ASYNC_CANCEL_ANY | IORING_ASYNC_CANCEL_ALL;
+        pSqe->user_data    = cancelTag;
+
+        io_uring_cqe cqe;
+        do {
+            wait(cqe);
+        } while (cqe.user_data != cancelTag);
+        while (peek(cqe)) { }
+    }
+    catch (...) { }
+}
+
+bool CIoUring::isSupported() noexcept
+{
+    return isIoEngineSupported(EIoEngine::URING);
+}
+
+io_uring_sqe* CIoUring::getSqe()
+{
+    unsigned head = __atomic_load_n(m_pSqHead, __ATOMIC_ACQUIRE);
+    if (m_sqTailLocal - head >= m_sqEntries)
+    {
+        submit(0);
+        head = __atomic_load_n(m_pSqHead, __ATOMIC_ACQUIRE);
+        if (m_sqTailLocal - head >= m_sqEntries) {
+            throw std::runtime_error(utils::buildErrorMessage("CIoUring::", __func__, ": submission queue full"));
+        }
+    }
+
+    io_uring_sqe* pSqe = &m_pSqes[m_sqTailLocal & m_sqMask];
+    std::memset(pSqe, 0, sizeof(io_uring_sqe));
+    m_sqTailLocal++;
+    m_toSubmit++;
+    return pSqe;
+}
+
+void CIoUring::submit(unsigned waitNr)
+{
+    __atomic_store_n(m_pSqTail, m_sqTailLocal, __ATOMIC_RELEASE);
+
+    unsigned flags = (waitNr > 0) ? IORING_ENTER_GETEVENTS : 0;
+    while (true)
+    {
+        int ret = ioUringEnter(m_ringFd, m_toSubmit, waitNr, flags);
+        if (ret >= 0) {
+            m_toSubmit -= std::min(m_toSubmit, static_cast<unsigned>(ret));
+            return;
+        }
+
+        switch (errno)
+        {
+            case EINTR:
+            {
+                // Interrupted while waiting, the caller checks for completions again
+                return;
+            }
+            case EAGAIN: [[fallthrough]];
+            case EBUSY:
+            {
+                // Completion queue is full, it has to be reaped first
+                return;
+            }
+            default:
+            {
+                throw std::runtime_error(utils::buildErrorMessage("CIoUring::", __func__, ": io_uring_enter: ", strerror(errno)));
+            }
+        }
+    }
+}
+
+bool CIoUring::peek(io_uring_cqe& rCqe) noexcept
+{
+    unsigned head = *m_pCqHead;
+    unsigned tail = __atomic_load_n(m_pCqTail, __ATOMIC_ACQUIRE);
+    if (head == tail) {
+        return false;
+    }
+
+    rCqe = m_pCqes[head & m_cqMask];
+    __atomic_store_n(m_pCqHead, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+void CIoUring::wait(io_uring_cqe& rCqe)
+{
+    // Pending submissions and the wait for completion share one system call
+    while (!peek(rCqe)) {
+        submit(1);
+    }
+}
+
+int CIoUring::getFd() const noexcept
+{
+    return m_ringFd;
+}
+
+//*****************************************************************************
+// Method definitions "CBufferRing"
+
+CBufferRing::CBufferRing(CIoUring& rRing, uint16_t groupId, uint16_t count, uint32_t bufferSize) :
+    m_rRing(rRing),
+    m_groupId(groupId),
+    m_count(count),
+    m_bufferSize(bufferSize),
+    m_buffers(static_cast<std::size_t>(count) * bufferSize)
+{
+    if ((count == 0) || ((count & (count - 1)) != 0)) {
+        throw std::invalid_argument(utils::buildErrorMessage("CBufferRing::", __func__, ": count has to be a power of 2"));
+    }
+
+    m_bufRingSize = count * sizeof(io_uring_buf);
+    void* pRing = ::mmap(nullptr, m_bufRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pRing == MAP_FAILED) {
+        throw std::runtime_error(utils::buildErrorMessage("CBufferRing::", __func__, ": mmap: ", strerror(errno)));
+    }
+    m_pBufRing = static_cast<io_uring_buf_ring*>(pRing);
+
+    io_uring_buf_reg reg {};
+    reg.ring_addr    = reinterpret_cast<uint64_t>(m_pBufRing);
+    reg.ring_entries = count;
+    reg.bgid         = groupId;
+    if (ioUringRegister(m_rRing.getFd(), IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        int err = errno;
+        ::munmap(m_pBufRing, m_bufRingSize);
+        throw std::runtime_error(utils::buildErrorMessage("CBufferRing::", __func__, ": register: ", strerror(err)));
+    }
+
+    for (uint16_t i = 0; i < count; i++) {
+        recycle(i);
+    }
+}
+
+CBufferRing::~CBufferRing() noexcept
+{
+    io_uring_buf_reg reg {};
+    reg.bgid = m_groupId;
+    ioUringRegister(m_rRing.getFd(), IORING_UNREGISTER_PBUF_RING, &reg, 1);
+    ::munmap(m_pBufRing, m_bufRingSize);
+}
+
+uint16_t CBufferRing::groupId() const noexcept
+{
+    return m_groupId;
+}
+
+uint8_t* CBufferRing::buffer(uint16_t bufferId) noexcept
+{
+    return m_buffers.data() + static_cast<std::size_t>(bufferId) * m_bufferSize;
+}
+
+void CBufferRing::recycle(uint16_t bufferId) noexcept
+{
+    // The ring entries are addressed directly, in C++ the flexible array of the
+    // kernel header is shifted by the size of its empty placeholder struct
+    uint16_t tail = m_pBufRing->tail;
+    io_uring_buf& rBuf = reinterpret_cast<io_uring_buf*>(m_pBufRing)[tail & (m_count - 1)];
+    rBuf.addr = reinterpret_cast<uint64_t>(buffer(bufferId));
+    rBuf.len  = m_bufferSize;
+    rBuf.bid  = bufferId;
+    __atomic_store_n(&m_pBufRing->tail, static_cast<uint16_t>(tail + 1), __ATOMIC_RELEASE);
+}
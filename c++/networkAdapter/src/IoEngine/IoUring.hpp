@@ -0,0 +1,133 @@
+/*
+ * This file is part of the EMBTOM project
+ * Copyright (c) 2018-2020 Thomas Willetal
+ * (https://github.com/embtom)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _IOURING_H_
+#define _IOURING_H_
+
+//******************************************************************************
+// Header
+
+#include <stdint.h>
+#include <cstddef>
+#include <vector>
+#include <linux/io_uring.h>
+
+namespace EtNet
+{
+
+//*****************************************************************************
+//! \brief CIoUring
+//! Minimal io_uring submission/completion ring based on the kernel interface.
+//! The ring is not thread safe, every user has to serialize the access.
+class CIoUring
+{
+public:
+    CIoUring(const CIoUring&)            = delete;
+    CIoUring& operator=(const CIoUring&) = delete;
+
+    //! setup of a ring with the requested amount of submission entries
+    explicit CIoUring(unsigned entries);
+    ~CIoUring() noexcept;
+
+    //! true if the running kernel supports all operations used by the
+    //! URING engine (multishot accept and recv, provided buffer rings)
+    static bool isSupported() noexcept;
+
+    //! request a free submission entry. If the submission queue is
+    //! full the already prepared entries are submitted first.
+    io_uring_sqe* getSqe();
+
+    //! submit all prepared entries and wait for "waitNr" completions
+    //! within the same system call
+    void submit(unsigned waitNr = 0);
+
+    //! fetch the next available completion, false if none is available
+    bool peek(io_uring_cqe& rCqe) noexcept;
+
+    //! submit the prepared entries and block until a completion is available
+    void wait(io_uring_cqe& rCqe);
+
+    int getFd() const noexcept;
+
+    //! cancel all pending operations and wait until the kernel has finished them
+    void cancelAll() noexcept;
+
+private:
+
+    int         m_ringFd {-1};
+    unsigned    m_toSubmit {0};
+
+    void*       m_pSqRing {nullptr};
+    std::size_t m_sqRingSize {0};
+    void*       m_pCqRing {nullptr};
+    std::size_t m_cqRingSize {0};
+    io_uring_sqe* m_pSqes {nullptr};
+    std::size_t m_sqesSize {0};
+
+    unsigned*   m_pSqHead {nullptr};
+    unsigned*   m_pSqTail {nullptr};
+    unsigned    m_sqMask {0};
+    unsigned    m_sqEntries {0};
+    unsigned    m_sqTailLocal {0};
+
+    unsigned*   m_pCqHead {nullptr};
+    unsigned*   m_pCqTail {nullptr};
+    unsigned    m_cqMask {0};
+    io_uring_cqe* m_pCqes {nullptr};
+};
+
+//*****************************************************************************
+//! \brief CBufferRing
+//! Provided buffer ring registered at a CIoUring. Multishot recv operations
+//! pick a buffer of this group by themself and report it by the buffer id.
+class CBufferRing
+{
+public:
+    CBufferRing(const CBufferRing&)            = delete;
+    CBufferRing& operator=(const CBufferRing&) = delete;
+
+    //! "count" has to be a power of 2
+    CBufferRing(CIoUring& rRing, uint16_t groupId, uint16_t count, uint32_t bufferSize);
+    ~CBufferRing() noexcept;
+
+    uint16_t groupId() const noexcept;
+    uint8_t* buffer(uint16_t bufferId) noexcept;
+
+    //! hand a consumed buffer back to the kernel
+    void recycle(uint16_t bufferId) noexcept;
+
+private:
+    CIoUring&           m_rRing;
+    uint16_t            m_groupId;
+    uint16_t            m_count;
+    uint32_t            m_bufferSize;
+    io_uring_buf_ring*  m_pBufRing {nullptr};
+    std::size_t         m_bufRingSize {0};
+    std::vector<uint8_t> m_buffers;
+};
+
+} //EtNet
+
+#endif // _IOURING_H_
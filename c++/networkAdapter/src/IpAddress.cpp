@@ -31,250 +31,246 @@
 #include <netinet/in.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 #include <error_msg.hpp>
 #include <IpAddress.hpp>
 
-template<class... Ts> struct overload : Ts... { using Ts::operator()...; };
-template<class... Ts> overload(Ts...) -> overload<Ts...>;
-
-//*****************************************************************************
-// Method definitions "CIpAddress"
-
-EtNet::CIpAddress::CIpAddress(const std::string& rIpStr)
+namespace
 {
-    size_t cnt = charCount(rIpStr, '.');
-    if(cnt == 3)
-    {
-        in_addr IpAddr = {0};
-        if(inet_pton(AF_INET, rIpStr.c_str(), &IpAddr))
-        {
-            m_address.emplace<in_addr>(IpAddr);
-            return;
-        }
-    }
-    cnt = charCount(rIpStr, ':');
-    if (cnt)
-    {
-        in6_addr IpAddr = {0};
-        if(inet_pton(AF_INET6, rIpStr.c_str(), &IpAddr))
-        {
-            m_address.emplace<in6_addr>(IpAddr);
-            return;
-        }
-    }
-    throw std::runtime_error(utils::buildErrorMessage("CIpAddress::", __func__," No valid Ip string"));
-}
 
-std::string EtNet::CIpAddress::toString() const noexcept
+#if defined(__SSE2__)
+//! 32 bit word of four address bytes as loaded from memory
+constexpr int word(uint8_t b0, uint8_t b1, uint8_t b2, uint8_t b3) noexcept
 {
-    std::string ret;
-    std::visit(overload{
-        [&ret](const in_addr& val)
-        {
-            char addrstr[INET_ADDRSTRLEN] = {0};
-            inet_ntop(AF_INET, &val, addrstr, sizeof(addrstr));
-            ret = std::string(addrstr);
-        },
-        [&ret](const in6_addr& val)
-        {
-            char addrstr[INET6_ADDRSTRLEN] = {0};
-            inet_ntop(AF_INET6, &val, addrstr, sizeof(addrstr));
-            ret = std::string(addrstr);
-        },
-        [&ret](const std::monostate& )
-        {
-            ret = std::string();
-        }
-    }, m_address);
-
-    return ret;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    return static_cast<int>(b0 | (b1 << 8) | (b2 << 16) | (static_cast<uint32_t>(b3) << 24));
+#else
+    return static_cast<int>((static_cast<uint32_t>(b0) << 24) | (b1 << 16) | (b2 << 8) | b3);
+#endif
 }
 
-bool EtNet::CIpAddress::is_v4() const noexcept
+//! lanes of the words equal the value after masking
+inline __m128i maskedEqual(__m128i words, int mask, int value) noexcept
 {
-    bool ret;
-    std::visit(overload{
-        [&ret](const in_addr& )        { ret = true; },
-        [&ret](const in6_addr& )       { ret = false; },
-        [&ret](const std::monostate& ) { ret = false; }
-    }, m_address);
-    return ret;
+    return _mm_cmpeq_epi32(_mm_and_si128(words, _mm_set1_epi32(mask)), _mm_set1_epi32(value));
 }
 
-bool EtNet::CIpAddress::is_v6() const noexcept
+inline __m128i flag(__m128i lanes, EtNet::EAddressClass value) noexcept
 {
-    bool ret;
-    std::visit(overload{
-        [&ret](const in_addr& )        { ret = false; },
-        [&ret](const in6_addr& )       { ret = true; },
-        [&ret](const std::monostate& ) { ret = false; }
-    }, m_address);
-    return ret;
+    return _mm_and_si128(lanes, _mm_set1_epi32(static_cast<int>(value)));
 }
+#endif
 
-bool EtNet::CIpAddress::is_loopback() const noexcept
-{
-    bool ret;
-    std::visit(overload{
-        [&ret](const in_addr& addr)
-        {
-	        ret =(ntohl(addr.s_addr) & 0xFF000000) == 0x7F000000;
-        },
-        [&ret](const in6_addr& addr)
-        {
-            if ((ntohl(addr.__in6_u.__u6_addr32[3]) == 0x00000001) &&
-                (addr.__in6_u.__u6_addr32[2] == 0x0000) &&
-                (addr.__in6_u.__u6_addr32[1] == 0x0000) &&
-                (addr.__in6_u.__u6_addr32[0] == 0x0000)) {
-                ret = true;
-            }
-            else {
-                ret = false;
-            }
-        },
-        [&ret](const std::monostate& ) { ret = false; }
-    }, m_address);
-    return ret;
 }
 
-bool EtNet::CIpAddress::is_submask() const noexcept
+//*****************************************************************************
+// Method definitions "CIpAddress"
+
+EtNet::CIpAddress::CIpAddress(const std::string& rIpStr)
 {
-    bool ret;
-    std::visit(overload{
-        [&ret](const in_addr& addr)
-        {
-	        ret =(ntohl(addr.s_addr) & 0xFF000000) == 0xFF000000;
-        },
-        [&ret](const in6_addr& addr)
-        {
-            ret = (addr.__in6_u.__u6_addr32[0] == 0xffff);
-        },
-        [&ret](const std::monostate& ) { ret = false; }
-    }, m_address);
-    return ret;
+    auto address = parse(rIpStr);
+    if (!address) {
+        throw std::runtime_error(utils::buildErrorMessage("CIpAddress::", __func__," No valid Ip string"));
+    }
+    *this = *address;
 }
 
-bool EtNet::CIpAddress::is_broadcast() const noexcept
+std::size_t EtNet::CIpAddress::format(utils::span<char> buffer) const noexcept
 {
-    bool ret;
-    std::visit(overload{
-        [&ret](const in_addr& addr)
-        {
-	        ret = (ntohl(addr.s_addr) & 0x000000FF) == 0x000000FF;
-        },
-        [&ret](const in6_addr& )       { ret = false; },
-        [&ret](const std::monostate& ) { ret = false; }
-    }, m_address);
+    char text[maxStringLength];
+    char* pText = text;
+    const uint8_t* pBytes = m_v6.s6_addr;
 
-    return ret;
-}
+    auto putDecimal = [&pText](unsigned value)
+    {
+        if (value >= 100) {
+            *pText++ = static_cast<char>('0' + value / 100);
+        }
+        if (value >= 10) {
+            *pText++ = static_cast<char>('0' + (value / 10) % 10);
+        }
+        *pText++ = static_cast<char>('0' + value % 10);
+    };
+    auto putV4 = [&pText, &putDecimal](const uint8_t* pV4)
+    {
+        for (int i = 0; i < 4; i++)
+        {
+            if (i != 0) {
+                *pText++ = '.';
+            }
+            putDecimal(pV4[i]);
+        }
+    };
 
-bool EtNet::CIpAddress::empty() const noexcept
-{
-    bool ret;
-    std::visit(overload{
-        [&ret](const in_addr& )        { ret = false; },
-        [&ret](const in6_addr& )       { ret = false; },
-        [&ret](const std::monostate& ) { ret = true; }
-    }, m_address);
-    return ret;
-}
+    switch (m_family)
+    {
+        case EAddressFamily::INET:
+        {
+            putV4(pBytes);
+            break;
+        }
+        case EAddressFamily::INET6:
+        {
+            uint16_t groups[8];
+            for (int i = 0; i < 8; i++) {
+                groups[i] = static_cast<uint16_t>((pBytes[2 * i] << 8) | pBytes[2 * i + 1]);
+            }
 
-EtNet::EAddressFamily EtNet::CIpAddress::addressFamily() const noexcept
-{
-    EtNet::EAddressFamily ret;
-    std::visit(overload{
-        [&ret](const in_addr& )        { ret = EtNet::EAddressFamily::INET; },
-        [&ret](const in6_addr& )       { ret = EtNet::EAddressFamily::INET6; },
-        [&ret](const std::monostate& ) { ret = EtNet::EAddressFamily::INV; }
-    }, m_address);
+            // The first longest run of at least two zero groups is compressed, as by inet_ntop
+            int bestBegin = -1;
+            int bestLength = 0;
+            for (int i = 0; i < 8;)
+            {
+                int j = i;
+                while ((j < 8) && (groups[j] == 0)) {
+                    j++;
+                }
+                if ((j - i > bestLength) && (j - i >= 2))
+                {
+                    bestBegin  = i;
+                    bestLength = j - i;
+                }
+                i = (j == i) ? i + 1 : j;
+            }
 
-    return ret;
-}
+            // IPv4 compatible and mapped addresses end with the dotted quad
+            const bool embeddedV4 = (bestBegin == 0) &&
+                                    ((bestLength == 6) || ((bestLength == 5) && (groups[5] == 0xFFFF)));
+            const int groupEnd = embeddedV4 ? 6 : 8;
 
-const in_addr* EtNet::CIpAddress::to_v4() const noexcept
-{
-    if (!is_v4()) {
-        return nullptr;
+            static constexpr char hexDigits[] = "0123456789abcdef";
+            for (int i = 0; i < groupEnd; i++)
+            {
+                if (i == bestBegin)
+                {
+                    *pText++ = ':';
+                    if (i + bestLength == 8) {
+                        *pText++ = ':';
+                    }
+                    i += bestLength - 1;
+                    continue;
+                }
+                if (i != 0) {
+                    *pText++ = ':';
+                }
+                bool leading = true;
+                for (int shift = 12; shift >= 0; shift -= 4)
+                {
+                    unsigned nibble = (groups[i] >> shift) & 0xF;
+                    if (leading && (nibble == 0) && (shift != 0)) {
+                        continue;
+                    }
+                    leading = false;
+                    *pText++ = hexDigits[nibble];
+                }
+            }
+            if (embeddedV4)
+            {
+                *pText++ = ':';
+                putV4(pBytes + 12);
+            }
+            break;
+        }
+        default:
+            break;
     }
-    return std::get_if<in_addr>(&m_address);
-}
 
-const in6_addr* EtNet::CIpAddress::to_v6() const noexcept
-{
-    if (!is_v6()) {
-        return nullptr;
+    const std::size_t length = static_cast<std::size_t>(pText - text);
+    if (length > buffer.size()) {
+        return 0;
     }
-    return std::get_if<in6_addr>(&m_address);
+    std::copy(text, pText, buffer.data());
+    return length;
 }
 
-size_t EtNet::CIpAddress::charCount(const std::string& rIpStr, char toCount) noexcept
+std::string EtNet::CIpAddress::toString() const noexcept
 {
-    return std::count_if( rIpStr.begin(), rIpStr.end(), [toCount] ( char c )
-    {
-        if(c == toCount)
-            return true;
-        else
-            return false;
-    });
+    char text[maxStringLength];
+    return std::string(text, format(utils::span<char>(text)));
 }
 
 EtNet::CIpAddress EtNet::CIpAddress::broadcast(const EtNet::CIpAddress& rSubmask) const noexcept
 {
-    if(is_v4() != rSubmask.is_v4()) {
+    if(!is_v4() || !rSubmask.is_v4()) {
         return EtNet::CIpAddress();
     }
-
-    if(is_v6() != rSubmask.is_v6()) {
-        return EtNet::CIpAddress();
-    }
-
-    CIpAddress broadcastIp;
-    std::visit(overload{
-        [&broadcastIp, &rSubmask](const in_addr& val) {
-            broadcastIp = CIpAddress(in_addr{(val.s_addr | ~(rSubmask.to_v4()->s_addr))});
-        },
-        [&broadcastIp, &rSubmask](const in6_addr& val) {
-            ;
-        },
-        [](const std::monostate& ){ }
-    }, m_address);
-
-    return broadcastIp;
+    return CIpAddress(in_addr{(m_v4.s_addr | ~(rSubmask.m_v4.s_addr))});
 }
 
-bool EtNet::CIpAddress::operator== (const EtNet::CIpAddress& rhs) const noexcept
+void EtNet::CIpAddress::classify(utils::span<const CIpAddress> addresses, utils::span<EAddressClass> classes)
 {
-    if(is_v4() != rhs.is_v4()) {
-        return false;
+    const std::size_t count = addresses.size();
+    if (classes.size() < count) {
+        throw std::invalid_argument(utils::buildErrorMessage("CIpAddress::", __func__, ": ", classes.size(), " classes for ", count, " addresses"));
     }
 
-    if(is_v6() != rhs.is_v6()) {
-        return false;
-    }
-
-    bool ret = false;
-
-    std::visit(overload{
-    [rhs, &ret](const in_addr& val)
+    const CIpAddress* pAddresses = addresses.data();
+    EAddressClass* pClasses = classes.data();
+    std::size_t i = 0;
+#if defined(__SSE2__)
+    // Four addresses are classified at once, lane k of each vector holds one
+    // 32 bit word of address k and all predicates are evaluated for the lanes
+    auto gather = [pAddresses](std::size_t first, std::size_t offset)
     {
-        ret = (std::memcmp(&val, rhs.to_v4(), sizeof(in_addr)) == 0);
-    },
-    [rhs, &ret](const in6_addr& val)
-    {
-        ret = (std::memcmp(&val, rhs.to_v6(), sizeof(in6_addr)) == 0);
-    },
-    [&ret](const std::monostate& )
+        int words[4];
+        for (std::size_t k = 0; k < 4; k++) {
+            std::memcpy(&words[k], pAddresses[first + k].m_v6.s6_addr + offset, sizeof(int));
+        }
+        return _mm_setr_epi32(words[0], words[1], words[2], words[3]);
+    };
+    const __m128i zero = _mm_setzero_si128();
+
+    for (; i + 4 <= count; i += 4)
     {
-        ret = false;
-    }
-    }, m_address);
+        const __m128i w0 = gather(i, 0);
+        const __m128i w1 = gather(i, 4);
+        const __m128i w2 = gather(i, 8);
+        const __m128i w3 = gather(i, 12);
+        const __m128i family = _mm_setr_epi32(static_cast<int>(pAddresses[i].m_family),     static_cast<int>(pAddresses[i + 1].m_family),
+                                              static_cast<int>(pAddresses[i + 2].m_family), static_cast<int>(pAddresses[i + 3].m_family));
+        const __m128i v4 = _mm_cmpeq_epi32(family, _mm_set1_epi32(static_cast<int>(EAddressFamily::INET)));
+        const __m128i v6 = _mm_cmpeq_epi32(family, _mm_set1_epi32(static_cast<int>(EAddressFamily::INET6)));
 
-    return ret;
-}
+        // The words behind an IPv4 address are zero
+        const __m128i zero64 = _mm_and_si128(_mm_cmpeq_epi32(w0, zero), _mm_cmpeq_epi32(w1, zero));
+        const __m128i zero96 = _mm_and_si128(zero64, _mm_cmpeq_epi32(w2, zero));
+        const __m128i any    = _mm_or_si128(v4, v6);
 
-bool EtNet::CIpAddress::operator !=(const EtNet::CIpAddress& rhs) const noexcept
-{
-    return !((*this) == rhs);
-}
+        const __m128i loopback = _mm_or_si128(
+            _mm_and_si128(v4, maskedEqual(w0, word(0xFF, 0, 0, 0), word(0x7F, 0, 0, 0))),
+            _mm_and_si128(_mm_and_si128(v6, zero96), _mm_cmpeq_epi32(w3, _mm_set1_epi32(word(0, 0, 0, 1)))));
+        const __m128i broadcast = _mm_and_si128(v4, maskedEqual(w0, word(0, 0, 0, 0xFF), word(0, 0, 0, 0xFF)));
+        const __m128i private4 = _mm_or_si128(_mm_or_si128(
+            maskedEqual(w0, word(0xFF, 0, 0, 0), word(10, 0, 0, 0)),
+            maskedEqual(w0, word(0xFF, 0xF0, 0, 0), word(172, 16, 0, 0))),
+            maskedEqual(w0, word(0xFF, 0xFF, 0, 0), word(192, 168, 0, 0)));
+        const __m128i privateAll = _mm_or_si128(_mm_and_si128(v4, private4),
+                                                _mm_and_si128(v6, maskedEqual(w0, word(0xFE, 0, 0, 0), word(0xFC, 0, 0, 0))));
+        const __m128i linkLocal = _mm_or_si128(
+            _mm_and_si128(v4, maskedEqual(w0, word(0xFF, 0xFF, 0, 0), word(169, 254, 0, 0))),
+            _mm_and_si128(v6, maskedEqual(w0, word(0xFF, 0xC0, 0, 0), word(0xFE, 0x80, 0, 0))));
+        const __m128i multicast = _mm_or_si128(
+            _mm_and_si128(v4, maskedEqual(w0, word(0xF0, 0, 0, 0), word(0xE0, 0, 0, 0))),
+            _mm_and_si128(v6, maskedEqual(w0, word(0xFF, 0, 0, 0), word(0xFF, 0, 0, 0))));
+        const __m128i unspecified = _mm_and_si128(_mm_and_si128(any, zero96), _mm_cmpeq_epi32(w3, zero));
+        const __m128i mapped = _mm_and_si128(_mm_and_si128(v6, zero64), _mm_cmpeq_epi32(w2, _mm_set1_epi32(word(0, 0, 0xFF, 0xFF))));
 
+        __m128i result = _mm_or_si128(flag(v4, EAddressClass::V4), flag(v6, EAddressClass::V6));
+        result = _mm_or_si128(result, flag(loopback, EAddressClass::LOOPBACK));
+        result = _mm_or_si128(result, flag(broadcast, EAddressClass::BROADCAST));
+        result = _mm_or_si128(result, flag(privateAll, EAddressClass::PRIVATE));
+        result = _mm_or_si128(result, flag(linkLocal, EAddressClass::LINK_LOCAL));
+        result = _mm_or_si128(result, flag(multicast, EAddressClass::MULTICAST));
+        result = _mm_or_si128(result, flag(unspecified, EAddressClass::UNSPECIFIED));
+        result = _mm_or_si128(result, flag(mapped, EAddressClass::V4_MAPPED));
+
+        // The flags fit into 15 bits, the signed saturation keeps them
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(pClasses + i), _mm_packs_epi32(result, result));
+    }
+#endif
+    for (; i < count; i++) {
+        pClasses[i] = pAddresses[i].classify();
+    }
+}
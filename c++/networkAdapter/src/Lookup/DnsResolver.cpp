@@ -0,0 +1,752 @@
+/*
+ * This file is part of the EMBTOM project
+ * Copyright (c) 2018-2020 Thomas Willetal
+ * (https://github.com/embtom)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+//******************************************************************************
+// Header
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <cstring>
+#include <strings.h>
+#include <sys/socket.h>
+
+#include <error_msg.hpp>
+#include <BaseSocket.hpp>
+#include <EventLoop.hpp>
+#include <Lookup/DnsResolver.hpp>
+
+namespace
+{
+
+using namespace EtNet;
+
+constexpr uint16_t typeA    = 1;
+constexpr uint16_t typeSoa  = 6;
+constexpr uint16_t typeAaaa = 28;
+constexpr uint16_t classIn  = 1;
+
+constexpr std::size_t dnsHeaderSize = 12;
+//! an answer without EDNS is limited to 512 bytes, the buffer holds any datagram of a misbehaving server
+constexpr std::size_t dnsReciveBuffer = 2048;
+//! recive buffer of the socket, the answers of a batch are queued until the worker drains them
+constexpr int dnsSocketBuffer = 1024 * 1024;
+//! bound of the compression pointers followed while reading one name
+constexpr unsigned maxNameJumps = 32;
+
+constexpr uint16_t flagResponse  = 0x8000;
+constexpr uint16_t flagTruncated = 0x0200;
+constexpr uint16_t flagRecursion = 0x0100;
+constexpr uint16_t maskOpcode    = 0x7800;
+constexpr uint16_t maskRcode     = 0x000F;
+constexpr uint16_t rcodeNxDomain = 3;
+
+uint16_t get16(const uint8_t* pData) noexcept
+{
+    return static_cast<uint16_t>((pData[0] << 8) | pData[1]);
+}
+
+uint32_t get32(const uint8_t* pData) noexcept
+{
+    return (static_cast<uint32_t>(get16(pData)) << 16) | get16(pData + 2);
+}
+
+void put16(std::vector<uint8_t>& rOut, uint16_t value)
+{
+    rOut.push_back(static_cast<uint8_t>(value >> 8));
+    rOut.push_back(static_cast<uint8_t>(value));
+}
+
+//! strip the trailing dot of a fully qualified name
+std::string normalizeName(const std::string& rHostName)
+{
+    if (!rHostName.empty() && (rHostName.back() == '.')) {
+        return rHostName.substr(0, rHostName.size() - 1);
+    }
+    return rHostName;
+}
+
+//! a name of labels of 1 to 63 bytes with a total length of up to 253 bytes
+bool isValidName(const std::string& rHostName) noexcept
+{
+    if (rHostName.empty() || (rHostName.size() > 253)) {
+        return false;
+    }
+    std::size_t labelStart = 0;
+    while (true)
+    {
+        std::size_t dot = rHostName.find('.', labelStart);
+        std::size_t labelEnd = (dot == std::string::npos) ? rHostName.size() : dot;
+        if ((labelEnd == labelStart) || (labelEnd - labelStart > 63)) {
+            return false;
+        }
+        if (dot == std::string::npos) {
+            return true;
+        }
+        labelStart = dot + 1;
+    }
+}
+
+std::vector<uint8_t> buildQuery(uint16_t id, const std::string& rHostName, uint16_t type)
+{
+    std::vector<uint8_t> query;
+    query.reserve(dnsHeaderSize + rHostName.size() + 6);
+    put16(query, id);
+    put16(query, flagRecursion);
+    put16(query, 1);    // questions
+    put16(query, 0);    // answers
+    put16(query, 0);    // authority records
+    put16(query, 0);    // additional records
+
+    std::size_t labelStart = 0;
+    while (labelStart <= rHostName.size())
+    {
+        std::size_t labelEnd = std::min(rHostName.find('.', labelStart), rHostName.size());
+        query.push_back(static_cast<uint8_t>(labelEnd - labelStart));
+        query.insert(query.end(), rHostName.begin() + labelStart, rHostName.begin() + labelEnd);
+        labelStart = labelEnd + 1;
+    }
+    query.push_back(0);
+    put16(query, type);
+    put16(query, classIn);
+    return query;
+}
+
+//! read a possibly compressed name, the offset is advanced behind the name at its origin position
+bool readName(const utils::span<const uint8_t>& rMessage, std::size_t& rOffset, std::string& rName)
+{
+    rName.clear();
+    std::size_t offset = rOffset;
+    bool jumped = false;
+    unsigned jumps = 0;
+
+    while (true)
+    {
+        if (offset >= rMessage.size()) {
+            return false;
+        }
+        uint8_t length = rMessage[offset];
+        if ((length & 0xC0) == 0xC0)
+        {
+            if ((offset + 1 >= rMessage.size()) || (++jumps > maxNameJumps)) {
+                return false;
+            }
+            if (!jumped) {
+                rOffset = offset + 2;
+            }
+            jumped = true;
+            offset = get16(rMessage.data() + offset) & 0x3FFF;
+            continue;
+        }
+        if ((length & 0xC0) != 0) {
+            return false;
+        }
+        if (length == 0)
+        {
+            if (!jumped) {
+                rOffset = offset + 1;
+            }
+            return true;
+        }
+        if (offset + 1 + length > rMessage.size()) {
+            return false;
+        }
+        if (!rName.empty()) {
+            rName.push_back('.');
+        }
+        rName.append(reinterpret_cast<const char*>(rMessage.data() + offset + 1), length);
+        offset += 1 + length;
+    }
+}
+
+struct SRecord
+{
+    uint16_t type;
+    uint16_t rclass;
+    uint32_t ttl;
+    std::size_t dataOffset;
+    uint16_t dataLength;
+};
+
+bool readRecord(const utils::span<const uint8_t>& rMessage, std::size_t& rOffset, SRecord& rRecord)
+{
+    std::string owner;
+    if (!readName(rMessage, rOffset, owner) || (rOffset + 10 > rMessage.size())) {
+        return false;
+    }
+    const uint8_t* pData = rMessage.data() + rOffset;
+    rRecord.type       = get16(pData);
+    rRecord.rclass     = get16(pData + 2);
+    rRecord.ttl        = get32(pData + 4);
+    rRecord.dataLength = get16(pData + 8);
+    rRecord.dataOffset = rOffset + 10;
+    rOffset = rRecord.dataOffset + rRecord.dataLength;
+    return rOffset <= rMessage.size();
+}
+
+//! the negative TTL of a SOA record is the lower one of the record TTL and its minimum field
+bool soaTtl(const utils::span<const uint8_t>& rMessage, const SRecord& rRecord, uint32_t& rTtl)
+{
+    std::string name;
+    std::size_t offset = rRecord.dataOffset;
+    if (!readName(rMessage, offset, name) || !readName(rMessage, offset, name)) {
+        return false;
+    }
+    // serial, refresh, retry, expire and minimum
+    if (offset + 20 > rRecord.dataOffset + rRecord.dataLength) {
+        return false;
+    }
+    rTtl = std::min(rRecord.ttl, get32(rMessage.data() + offset + 16));
+    return true;
+}
+
+//! parse the answer of a query. False if the message does not answer the question and has to be ignored
+bool parseAnswer(const utils::span<const uint8_t>& rMessage, const std::string& rHostName, uint16_t type, CDnsResolver::SAnswer& rAnswer)
+{
+    if (rMessage.size() < dnsHeaderSize) {
+        return false;
+    }
+    const uint16_t flags = get16(rMessage.data() + 2);
+    if (((flags & flagResponse) == 0) || ((flags & maskOpcode) != 0) || (get16(rMessage.data() + 4) != 1)) {
+        return false;
+    }
+
+    std::string question;
+    std::size_t offset = dnsHeaderSize;
+    if (!readName(rMessage, offset, question) || (offset + 4 > rMessage.size()) ||
+        (::strcasecmp(question.c_str(), rHostName.c_str()) != 0) ||
+        (get16(rMessage.data() + offset) != type) || (get16(rMessage.data() + offset + 2) != classIn)) {
+        return false;
+    }
+    offset += 4;
+
+    rAnswer = CDnsResolver::SAnswer();
+    const uint16_t rcode = flags & maskRcode;
+    if ((rcode != 0) && (rcode != rcodeNxDomain)) {
+        return true;
+    }
+    if (flags & flagTruncated) {
+        return true;
+    }
+
+    // CNAME records are not followed, the recursive server appends the records of the target
+    uint32_t ttl = UINT32_MAX;
+    const uint16_t answers = get16(rMessage.data() + 6);
+    for (uint16_t i = 0; i < answers; i++)
+    {
+        SRecord record;
+        if (!readRecord(rMessage, offset, record)) {
+            return true;
+        }
+        if ((record.rclass != classIn) || (record.type != type)) {
+            continue;
+        }
+        if ((type == typeA) && (record.dataLength == sizeof(in_addr)))
+        {
+            in_addr address;
+            std::memcpy(&address, rMessage.data() + record.dataOffset, sizeof(address));
+            rAnswer.addresses.emplace_back(address);
+        }
+        else if ((type == typeAaaa) && (record.dataLength == sizeof(in6_addr)))
+        {
+            in6_addr address;
+            std::memcpy(&address, rMessage.data() + record.dataOffset, sizeof(address));
+            rAnswer.addresses.emplace_back(address);
+        }
+        else {
+            continue;
+        }
+        ttl = std::min(ttl, record.ttl);
+    }
+
+    if (!rAnswer.addresses.empty())
+    {
+        rAnswer.status = CDnsResolver::ERet::OK;
+        rAnswer.ttl = std::chrono::seconds(ttl);
+        return true;
+    }
+
+    // NXDOMAIN or no record of the type, the SOA of the authority section limits the negative caching
+    rAnswer.status = CDnsResolver::ERet::NOT_FOUND;
+    const uint16_t authorities = get16(rMessage.data() + 8);
+    for (uint16_t i = 0; i < authorities; i++)
+    {
+        SRecord record;
+        if (!readRecord(rMessage, offset, record)) {
+            break;
+        }
+        uint32_t negativeTtl;
+        if ((record.type == typeSoa) && soaTtl(rMessage, record, negativeTtl))
+        {
+            rAnswer.ttl = std::chrono::seconds(negativeTtl);
+            break;
+        }
+    }
+    return true;
+}
+
+}
+
+namespace EtNet
+{
+
+//*****************************************************************************
+//! \brief CDnsResolverPrivate
+//!
+class CDnsResolverPrivate
+{
+public:
+    CDnsResolverPrivate(std::vector<SPeerAddr> servers, std::chrono::milliseconds timeout, unsigned int attempts);
+    ~CDnsResolverPrivate() noexcept;
+
+    void resolve(std::vector<std::pair<std::string, CDnsResolver::CallbackResolved>> requests);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    //! resolution of one name by an AAAA and an A query
+    struct SQuery
+    {
+        std::string hostName;
+        CDnsResolver::CallbackResolved onResolved;
+        CDnsResolver::SAnswer parts[2];     //!< AAAA and A answer
+        unsigned pending {2};
+    };
+
+    struct SRequest
+    {
+        std::shared_ptr<SQuery> pQuery;
+        std::size_t part;
+        unsigned attempt {0};
+        Clock::time_point deadline;
+        std::vector<uint8_t> packet;
+    };
+
+    struct SChannel
+    {
+        explicit SChannel(ESocketMode mode) :
+            socket(mode),
+            link(socket.getFd())
+        {
+            // The answers of a batch arrive at once, the buffer is raised as far as permitted
+            int size = dnsSocketBuffer;
+            ::setsockopt(socket.getFd(), SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+        }
+        CBaseSocket  socket;
+        CUdpDataLink link;
+    };
+
+    void worker();
+    void start(std::vector<std::shared_ptr<SQuery>>& rQueries);
+    void transmit(const std::vector<uint16_t>& rIds);
+    void onReadable(const CUdpDataLink& rLink);
+    void expire();
+    void complete(uint16_t id, CDnsResolver::SAnswer&& rPart);
+    Clock::time_point nextDeadline() const noexcept;
+    const SPeerAddr& server(unsigned attempt) const noexcept;
+    static void finish(SQuery& rQuery);
+
+    const std::vector<SPeerAddr>    m_servers;
+    const std::chrono::milliseconds m_timeout;
+    const unsigned int              m_attempts;
+
+    std::unique_ptr<SChannel> m_pChannel4;
+    std::unique_ptr<SChannel> m_pChannel6;
+
+    // State of the worker thread
+    CEventLoop   m_loop;
+    std::mt19937 m_random;
+    std::unordered_map<uint16_t, SRequest> m_inflight;
+    bool         m_stop {false};
+    std::thread  m_thread;
+};
+
+}
+
+using namespace EtNet;
+
+//*****************************************************************************
+// Method definitions "CDnsResolverPrivate"
+
+CDnsResolverPrivate::CDnsResolverPrivate(std::vector<SPeerAddr> servers, std::chrono::milliseconds timeout, unsigned int attempts) :
+    m_servers(std::move(servers)),
+    m_timeout(timeout),
+    m_attempts(std::max(attempts, 1U)),
+    m_random(std::random_device{}())
+{
+    if (m_servers.empty()) {
+        throw std::invalid_argument(utils::buildErrorMessage("CDnsResolver::", __func__, ": no nameserver"));
+    }
+    for (const auto& rServer : m_servers)
+    {
+        if (rServer.Ip.is_v4() && !m_pChannel4)
+        {
+            m_pChannel4 = std::make_unique<SChannel>(ESocketMode::INET_DGRAM);
+            m_loop.add(m_pChannel4->link, EEvent::READ, [this](EEvent) { onReadable(m_pChannel4->link); });
+        }
+        else if (rServer.Ip.is_v6() && !m_pChannel6)
+        {
+            m_pChannel6 = std::make_unique<SChannel>(ESocketMode::INET6_DGRAM);
+            m_loop.add(m_pChannel6->link, EEvent::READ, [this](EEvent) { onReadable(m_pChannel6->link); });
+        }
+    }
+    m_thread = std::thread(&CDnsResolverPrivate::worker, this);
+}
+
+CDnsResolverPrivate::~CDnsResolverPrivate() noexcept
+{
+    m_loop.post([this]() { m_stop = true; });
+    m_thread.join();
+
+    // Queries still in flight are reported as failed
+    for (auto& rEntry : m_inflight)
+    {
+        SQuery& rQuery = *rEntry.second.pQuery;
+        rQuery.parts[rEntry.second.part].status = CDnsResolver::ERet::FAILURE;
+        if (--rQuery.pending == 0) {
+            finish(rQuery);
+        }
+    }
+    if (m_pChannel4) {
+        m_loop.remove(m_pChannel4->link);
+    }
+    if (m_pChannel6) {
+        m_loop.remove(m_pChannel6->link);
+    }
+}
+
+void CDnsResolverPrivate::resolve(std::vector<std::pair<std::string, CDnsResolver::CallbackResolved>> requests)
+{
+    auto pQueries = std::make_shared<std::vector<std::shared_ptr<SQuery>>>();
+    pQueries->reserve(requests.size());
+    for (auto& rRequest : requests)
+    {
+        auto pQuery = std::make_shared<SQuery>();
+        pQuery->hostName   = normalizeName(rRequest.first);
+        pQuery->onResolved = std::move(rRequest.second);
+        pQueries->push_back(std::move(pQuery));
+    }
+    m_loop.post([this, pQueries]() { start(*pQueries); });
+}
+
+void CDnsResolverPrivate::worker()
+{
+    while (!m_stop)
+    {
+        std::chrono::milliseconds wait(-1);
+        if (!m_inflight.empty()) {
+            wait = std::max(std::chrono::ceil<std::chrono::milliseconds>(nextDeadline() - Clock::now()), std::chrono::milliseconds(0));
+        }
+        try {
+            m_loop.runOnce(wait);
+            expire();
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+}
+
+void CDnsResolverPrivate::start(std::vector<std::shared_ptr<SQuery>>& rQueries)
+{
+    const Clock::time_point deadline = Clock::now() + m_timeout;
+    std::vector<uint16_t> ids;
+    ids.reserve(2 * rQueries.size());
+
+    for (auto& pQuery : rQueries)
+    {
+        // A literal address is resolved without a query
+        if (auto address = CIpAddress::parse(pQuery->hostName))
+        {
+            CDnsResolver::SAnswer literal;
+            literal.addresses.push_back(*address);
+            literal.status = CDnsResolver::ERet::OK;
+            pQuery->onResolved(pQuery->hostName, literal);
+            continue;
+        }
+
+        if (!isValidName(pQuery->hostName) || (m_inflight.size() + 2 > UINT16_MAX))
+        {
+            pQuery->onResolved(pQuery->hostName, CDnsResolver::SAnswer());
+            continue;
+        }
+
+        const uint16_t types[2] = {typeAaaa, typeA};
+        for (std::size_t part = 0; part < 2; part++)
+        {
+            uint16_t id;
+            do {
+                id = static_cast<uint16_t>(m_random());
+            } while (m_inflight.count(id) != 0);
+
+            SRequest& rRequest = m_inflight[id];
+            rRequest.pQuery   = pQuery;
+            rRequest.part     = part;
+            rRequest.deadline = deadline;
+            rRequest.packet   = buildQuery(id, pQuery->hostName, types[part]);
+            ids.push_back(id);
+        }
+    }
+    transmit(ids);
+}
+
+void CDnsResolverPrivate::transmit(const std::vector<uint16_t>& rIds)
+{
+    std::vector<SDatagramTx> batch4;
+    std::vector<SDatagramTx> batch6;
+    for (uint16_t id : rIds)
+    {
+        const SRequest& rRequest = m_inflight.at(id);
+        const SPeerAddr& rServer = server(rRequest.attempt);
+        auto& rBatch = rServer.Ip.is_v4() ? batch4 : batch6;
+        rBatch.push_back(SDatagramTx{rServer, utils::span<const uint8_t>(rRequest.packet.data(), rRequest.packet.size())});
+    }
+
+    // A failed transmit is not reported, the query is retransmitted at the timeout
+    try {
+        if (!batch4.empty()) {
+            m_pChannel4->link.sendToBatch(utils::span<const SDatagramTx>(batch4.data(), batch4.size()));
+        }
+        if (!batch6.empty()) {
+            m_pChannel6->link.sendToBatch(utils::span<const SDatagramTx>(batch6.data(), batch6.size()));
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+    }
+}
+
+void CDnsResolverPrivate::onReadable(const CUdpDataLink& rLink)
+{
+    uint8_t rxBuffer[dnsReciveBuffer];
+    while (true)
+    {
+        utils::span<uint8_t> rxSpan(rxBuffer);
+        SPeerAddr peer;
+        if (rLink.tryReciveFrom(rxSpan, peer) != CUdpDataLink::ERet::OK) {
+            return;
+        }
+        if (rxSpan.size() < dnsHeaderSize) {
+            continue;
+        }
+
+        auto it = m_inflight.find(get16(rxSpan.data()));
+        if (it == m_inflight.end()) {
+            continue;
+        }
+
+        // Only the configured servers are trusted
+        bool fromServer = std::any_of(m_servers.begin(), m_servers.end(), [&peer](const SPeerAddr& rServer) {
+            return (rServer.Ip == peer.Ip) && (rServer.Port == peer.Port);
+        });
+        const uint16_t type = (it->second.part == 0) ? typeAaaa : typeA;
+        CDnsResolver::SAnswer part;
+        if (fromServer && parseAnswer(utils::span<const uint8_t>(rxSpan.data(), rxSpan.size()), it->second.pQuery->hostName, type, part)) {
+            complete(it->first, std::move(part));
+        }
+    }
+}
+
+void CDnsResolverPrivate::expire()
+{
+    const Clock::time_point now = Clock::now();
+    std::vector<uint16_t> retransmit;
+    std::vector<uint16_t> timedOut;
+    for (auto& rEntry : m_inflight)
+    {
+        SRequest& rRequest = rEntry.second;
+        if (rRequest.deadline > now) {
+            continue;
+        }
+        if (++rRequest.attempt < m_attempts)
+        {
+            rRequest.deadline = now + m_timeout;
+            retransmit.push_back(rEntry.first);
+        }
+        else {
+            timedOut.push_back(rEntry.first);
+        }
+    }
+
+    transmit(retransmit);
+    for (uint16_t id : timedOut)
+    {
+        CDnsResolver::SAnswer part;
+        part.status = CDnsResolver::ERet::TIMEOUT;
+        complete(id, std::move(part));
+    }
+}
+
+void CDnsResolverPrivate::complete(uint16_t id, CDnsResolver::SAnswer&& rPart)
+{
+    auto it = m_inflight.find(id);
+    std::shared_ptr<SQuery> pQuery = std::move(it->second.pQuery);
+    pQuery->parts[it->second.part] = std::move(rPart);
+    m_inflight.erase(it);
+
+    if (--pQuery->pending == 0) {
+        finish(*pQuery);
+    }
+}
+
+void CDnsResolverPrivate::finish(SQuery& rQuery)
+{
+    CDnsResolver::SAnswer answer;
+    answer.status = CDnsResolver::ERet::NOT_FOUND;
+    bool ttlSet = false;
+    for (auto& rPart : rQuery.parts)
+    {
+        if (rPart.status == CDnsResolver::ERet::OK)
+        {
+            answer.addresses.insert(answer.addresses.end(), rPart.addresses.begin(), rPart.addresses.end());
+            answer.ttl = ttlSet ? std::min(answer.ttl, rPart.ttl) : rPart.ttl;
+            ttlSet = true;
+        }
+    }
+
+    if (!answer.addresses.empty()) {
+        answer.status = CDnsResolver::ERet::OK;
+    }
+    else
+    {
+        // Without any address the most severe failure of both queries is reported
+        for (const auto& rPart : rQuery.parts) {
+            answer.status = std::max(answer.status, rPart.status);
+        }
+        if (answer.status == CDnsResolver::ERet::NOT_FOUND) {
+            answer.ttl = std::min(rQuery.parts[0].ttl, rQuery.parts[1].ttl);
+        }
+    }
+    rQuery.onResolved(rQuery.hostName, answer);
+}
+
+CDnsResolverPrivate::Clock::time_point CDnsResolverPrivate::nextDeadline() const noexcept
+{
+    Clock::time_point deadline = Clock::time_point::max();
+    for (const auto& rEntry : m_inflight) {
+        deadline = std::min(deadline, rEntry.second.deadline);
+    }
+    return deadline;
+}
+
+const SPeerAddr& CDnsResolverPrivate::server(unsigned attempt) const noexcept
+{
+    return m_servers[attempt % m_servers.size()];
+}
+
+//*****************************************************************************
+// Method definitions "CDnsResolver"
+
+CDnsResolver::CDnsResolver() :
+    CDnsResolver(systemServers())
+{ }
+
+CDnsResolver::CDnsResolver(std::vector<SPeerAddr> servers, std::chrono::milliseconds timeout, unsigned int attempts) :
+    m_pPrivate(std::make_unique<CDnsResolverPrivate>(std::move(servers), timeout, attempts))
+{ }
+
+CDnsResolver::~CDnsResolver() noexcept = default;
+
+void CDnsResolver::resolve(const std::string& rHostName, CallbackResolved onResolved)
+{
+    std::vector<std::pair<std::string, CallbackResolved>> requests;
+    requests.emplace_back(rHostName, std::move(onResolved));
+    m_pPrivate->resolve(std::move(requests));
+}
+
+std::future<CHostLookup::IpAddresses> CDnsResolver::resolve(const std::string& rHostName)
+{
+    return std::move(resolve(std::vector<std::string>{rHostName}).front());
+}
+
+std::vector<std::future<CHostLookup::IpAddresses>> CDnsResolver::resolve(const std::vector<std::string>& rHostNames)
+{
+    std::vector<std::future<CHostLookup::IpAddresses>> futures;
+    std::vector<std::pair<std::string, CallbackResolved>> requests;
+    futures.reserve(rHostNames.size());
+    requests.reserve(rHostNames.size());
+
+    for (const auto& rHostName : rHostNames)
+    {
+        auto pPromise = std::make_shared<std::promise<CHostLookup::IpAddresses>>();
+        futures.push_back(pPromise->get_future());
+        requests.emplace_back(rHostName, [pPromise](const std::string& rName, const SAnswer& rAnswer)
+        {
+            if (rAnswer.status == ERet::OK) {
+                pPromise->set_value(rAnswer.addresses);
+            }
+            else {
+                pPromise->set_exception(std::make_exception_ptr(std::runtime_error(
+                    utils::buildErrorMessage("CDnsResolver::", "resolve", ": ", rName, ": ", CDnsResolver::toString(rAnswer.status)))));
+            }
+        });
+    }
+    m_pPrivate->resolve(std::move(requests));
+    return futures;
+}
+
+const char* CDnsResolver::toString(ERet status) noexcept
+{
+    switch (status)
+    {
+        case ERet::OK:        return "ok";
+        case ERet::NOT_FOUND: return "host not found";
+        case ERet::TIMEOUT:   return "timeout";
+        default:              return "server failure";
+    }
+}
+
+std::vector<SPeerAddr> CDnsResolver::systemServers()
+{
+    std::vector<SPeerAddr> servers;
+    std::ifstream resolvConf("/etc/resolv.conf");
+    std::string line;
+    while (std::getline(resolvConf, line))
+    {
+        std::istringstream tokens(line);
+        std::string keyword, address;
+        if (!(tokens >> keyword >> address) || (keyword != "nameserver")) {
+            continue;
+        }
+        // Link local servers with a scope id are not supported
+        if (address.find('%') != std::string::npos) {
+            continue;
+        }
+        if (auto server = CIpAddress::parse(address)) {
+            servers.push_back(SPeerAddr{*server, dnsPort});
+        }
+    }
+
+    if (servers.empty()) {
+        servers.push_back(SPeerAddr{"127.0.0.1"_ip, dnsPort});
+    }
+    return servers;
+}
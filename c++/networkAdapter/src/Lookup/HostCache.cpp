@@ -0,0 +1,444 @@
+/*
+ * This file is part of the EMBTOM project
+ * Copyright (c) 2018-2020 Thomas Willetal
+ * (https://github.com/embtom)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+//******************************************************************************
+// Header
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <netdb.h> //getaddrinfo
+#include <sys/socket.h> //AF_INET AF_INET6
+
+#include <error_msg.hpp>
+#include <Lookup/HostCache.hpp>
+
+namespace EtNet
+{
+
+//*****************************************************************************
+//! \brief CHostCachePrivate
+//!
+class CHostCachePrivate
+{
+public:
+    CHostCachePrivate(std::size_t capacity, std::chrono::seconds maxTtl, std::chrono::seconds staleTime);
+    ~CHostCachePrivate() noexcept;
+
+    CHostLookup::IpAddresses addresses(const std::string& rHostName, std::optional<std::chrono::steady_clock::time_point> deadline);
+    void setResolver(CHostCache::CallbackResolve resolve);
+    void clear() noexcept;
+    CHostCache::SStats getStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct SEntry
+    {
+        CDnsResolver::ERet status {CDnsResolver::ERet::FAILURE};
+        CHostLookup::IpAddresses addresses;
+        Clock::time_point expires;
+        bool resolving {false};     //!< a resolution is in progress, waiting lookups are notified by m_resolved
+    };
+
+    //! store the answer of a resolution and wake up the waiting lookups
+    void store(const std::string& rHostName, const CDnsResolver::SAnswer& rAnswer);
+    void evict(Clock::time_point now);
+    //! pass the name to the refresher thread, it is started by the first name
+    void enqueue(const std::string& rHostName);
+    void refresher();
+    CDnsResolver::SAnswer resolve(const std::string& rHostName);
+
+    const std::size_t          m_capacity;
+    const std::chrono::seconds m_maxTtl;
+    const std::chrono::seconds m_staleTime;
+
+    mutable std::mutex      m_mutex;
+    std::condition_variable m_resolved;
+    std::condition_variable m_refresh;
+    std::unordered_map<std::string, SEntry> m_entries;
+    std::deque<std::string> m_refreshQueue;
+    CHostCache::CallbackResolve m_resolve;
+    CHostCache::SStats m_stats;
+    bool        m_stop {false};
+    std::thread m_refresher;
+};
+
+}
+
+using namespace EtNet;
+
+//*****************************************************************************
+// Method definitions "CHostCachePrivate"
+
+CHostCachePrivate::CHostCachePrivate(std::size_t capacity, std::chrono::seconds maxTtl, std::chrono::seconds staleTime) :
+    m_capacity(std::max<std::size_t>(capacity, 1)),
+    m_maxTtl(maxTtl),
+    m_staleTime(staleTime),
+    m_resolve(CHostCache::systemResolver())
+{ }
+
+CHostCachePrivate::~CHostCachePrivate() noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_refresh.notify_all();
+    if (m_refresher.joinable()) {
+        m_refresher.join();
+    }
+}
+
+CHostLookup::IpAddresses CHostCachePrivate::addresses(const std::string& rHostName, std::optional<Clock::time_point> deadline)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    bool waited = false;
+    while (true)
+    {
+        const Clock::time_point now = Clock::now();
+        auto it = m_entries.find(rHostName);
+        if (it != m_entries.end())
+        {
+            SEntry& rEntry = it->second;
+            if ((now < rEntry.expires) && (rEntry.status == CDnsResolver::ERet::OK))
+            {
+                m_stats.hits++;
+                return rEntry.addresses;
+            }
+            if ((now < rEntry.expires) && (rEntry.status == CDnsResolver::ERet::NOT_FOUND))
+            {
+                m_stats.negativeHits++;
+                throw std::runtime_error(utils::buildErrorMessage("CHostCache::", __func__, ": ", rHostName, ": ",
+                                                                  CDnsResolver::toString(rEntry.status)));
+            }
+            if ((rEntry.status == CDnsResolver::ERet::OK) && (now < rEntry.expires + m_staleTime))
+            {
+                // The expired addresses are served while the refresher resolves the name again
+                m_stats.staleHits++;
+                if (!rEntry.resolving)
+                {
+                    rEntry.resolving = true;
+                    m_stats.refreshes++;
+                    enqueue(rHostName);
+                }
+                return rEntry.addresses;
+            }
+            if (rEntry.resolving)
+            {
+                if (!deadline) {
+                    m_resolved.wait(lock);
+                }
+                else if (m_resolved.wait_until(lock, *deadline) == std::cv_status::timeout) {
+                    throw std::runtime_error(utils::buildErrorMessage("CHostCache::", __func__, ": ", rHostName, ": ",
+                                                                      CDnsResolver::toString(CDnsResolver::ERet::TIMEOUT)));
+                }
+                waited = true;
+                continue;
+            }
+        }
+
+        if (deadline && waited)
+        {
+            // The awaited resolution failed temporarily and was not cached
+            throw std::runtime_error(utils::buildErrorMessage("CHostCache::", __func__, ": ", rHostName, ": ",
+                                                              CDnsResolver::toString(CDnsResolver::ERet::FAILURE)));
+        }
+
+        // Miss, concurrent lookups of the name wait for this resolution
+        m_stats.misses++;
+        m_entries[rHostName].resolving = true;
+        if (deadline)
+        {
+            // The caller must not block beyond the deadline, the name is resolved by the refresher
+            enqueue(rHostName);
+            continue;
+        }
+        lock.unlock();
+        CDnsResolver::SAnswer answer = resolve(rHostName);
+        lock.lock();
+        store(rHostName, answer);
+
+        if (answer.status != CDnsResolver::ERet::OK) {
+            throw std::runtime_error(utils::buildErrorMessage("CHostCache::", __func__, ": ", rHostName, ": ",
+                                                              CDnsResolver::toString(answer.status)));
+        }
+        return answer.addresses;
+    }
+}
+
+void CHostCachePrivate::setResolver(CHostCache::CallbackResolve resolve)
+{
+    if (!resolve) {
+        resolve = CHostCache::systemResolver();
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_resolve = std::move(resolve);
+}
+
+void CHostCachePrivate::clear() noexcept
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Entries of running resolutions are kept, their lookups are waiting for them
+    for (auto it = m_entries.begin(); it != m_entries.end(); )
+    {
+        if (it->second.resolving) {
+            it++;
+        }
+        else {
+            it = m_entries.erase(it);
+        }
+    }
+}
+
+CHostCache::SStats CHostCachePrivate::getStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    CHostCache::SStats stats = m_stats;
+    stats.entries = m_entries.size();
+    return stats;
+}
+
+CDnsResolver::SAnswer CHostCachePrivate::resolve(const std::string& rHostName)
+{
+    CHostCache::CallbackResolve resolve;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        resolve = m_resolve;
+    }
+
+    try {
+        return resolve(rHostName);
+    }
+    catch (const std::exception&) {
+        return CDnsResolver::SAnswer();
+    }
+}
+
+void CHostCachePrivate::store(const std::string& rHostName, const CDnsResolver::SAnswer& rAnswer)
+{
+    const Clock::time_point now = Clock::now();
+    SEntry& rEntry = m_entries[rHostName];
+    rEntry.resolving = false;
+
+    if ((rAnswer.status == CDnsResolver::ERet::OK) || (rAnswer.status == CDnsResolver::ERet::NOT_FOUND))
+    {
+        rEntry.status    = rAnswer.status;
+        rEntry.addresses = rAnswer.addresses;
+        rEntry.expires   = now + std::min(rAnswer.ttl, m_maxTtl);
+    }
+    else if (rEntry.status != CDnsResolver::ERet::OK)
+    {
+        // A temporary failure is not cached, a stale entry is kept until its stale time ends
+        m_entries.erase(rHostName);
+    }
+
+    evict(now);
+    m_resolved.notify_all();
+}
+
+void CHostCachePrivate::evict(Clock::time_point now)
+{
+    if (m_entries.size() <= m_capacity) {
+        return;
+    }
+
+    for (auto it = m_entries.begin(); it != m_entries.end(); )
+    {
+        if (!it->second.resolving && (it->second.expires + m_staleTime <= now)) {
+            it = m_entries.erase(it);
+        }
+        else {
+            it++;
+        }
+    }
+
+    // Still above the capacity, the entries closest to their expiry are dropped
+    while (m_entries.size() > m_capacity)
+    {
+        auto victim = m_entries.end();
+        for (auto it = m_entries.begin(); it != m_entries.end(); it++)
+        {
+            if (!it->second.resolving && ((victim == m_entries.end()) || (it->second.expires < victim->second.expires))) {
+                victim = it;
+            }
+        }
+        if (victim == m_entries.end()) {
+            return;
+        }
+        m_entries.erase(victim);
+    }
+}
+
+void CHostCachePrivate::enqueue(const std::string& rHostName)
+{
+    m_refreshQueue.push_back(rHostName);
+    if (!m_refresher.joinable()) {
+        m_refresher = std::thread(&CHostCachePrivate::refresher, this);
+    }
+    m_refresh.notify_one();
+}
+
+void CHostCachePrivate::refresher()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+        m_refresh.wait(lock, [this]() { return m_stop || !m_refreshQueue.empty(); });
+        if (m_stop) {
+            return;
+        }
+
+        std::string hostName = std::move(m_refreshQueue.front());
+        m_refreshQueue.pop_front();
+
+        lock.unlock();
+        CDnsResolver::SAnswer answer = resolve(hostName);
+        lock.lock();
+        store(hostName, answer);
+    }
+}
+
+//*****************************************************************************
+// Method definitions "CHostCache"
+
+CHostCache::CHostCache(std::size_t capacity, std::chrono::seconds maxTtl, std::chrono::seconds staleTime) :
+    m_pPrivate(std::make_unique<CHostCachePrivate>(capacity, maxTtl, staleTime))
+{ }
+
+CHostCache::~CHostCache() noexcept = default;
+
+CHostCache& CHostCache::instance()
+{
+    static CHostCache cache;
+    return cache;
+}
+
+CHostLookup::IpAddresses CHostCache::addresses(const std::string& rHostName)
+{
+    return m_pPrivate->addresses(rHostName, std::nullopt);
+}
+
+CHostLookup::IpAddresses CHostCache::addresses(const std::string& rHostName, std::chrono::steady_clock::time_point deadline)
+{
+    return m_pPrivate->addresses(rHostName, deadline);
+}
+
+void CHostCache::setResolver(CallbackResolve resolve)
+{
+    m_pPrivate->setResolver(std::move(resolve));
+}
+
+void CHostCache::clear() noexcept
+{
+    m_pPrivate->clear();
+}
+
+CHostCache::SStats CHostCache::getStats() const
+{
+    return m_pPrivate->getStats();
+}
+
+CHostCache::CallbackResolve CHostCache::systemResolver()
+{
+    return [](const std::string& rHostName)
+    {
+        CDnsResolver::SAnswer answer;
+
+        struct addrinfo hints = {};
+        hints.ai_family = PF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+
+        struct addrinfo *result, *rp;
+        int ret = getaddrinfo(rHostName.c_str(), NULL, &hints, &result);
+        switch (ret)
+        {
+            case 0:
+                break;
+            case EAI_NONAME: [[fallthrough]];
+            case EAI_NODATA:
+            {
+                answer.status = CDnsResolver::ERet::NOT_FOUND;
+                answer.ttl = hostCacheSystemNegativeTtl;
+                return answer;
+            }
+            case EAI_AGAIN:
+            {
+                answer.status = CDnsResolver::ERet::TIMEOUT;
+                return answer;
+            }
+            default:
+            {
+                return answer;
+            }
+        }
+
+        for (rp = result; rp != NULL; rp = rp->ai_next)
+        {
+            switch (rp->ai_family)
+            {
+                case AF_INET:
+                {
+                    sockaddr_in *pSockAddr = reinterpret_cast<sockaddr_in*>(rp->ai_addr);
+                    answer.addresses.emplace_back(CIpAddress(pSockAddr->sin_addr));
+                    break;
+                }
+                case AF_INET6:
+                {
+                    sockaddr_in6 *pSockAddr = reinterpret_cast<sockaddr_in6*>(rp->ai_addr);
+                    answer.addresses.emplace_back(CIpAddress(pSockAddr->sin6_addr));
+                    break;
+                }
+            }
+        }
+        freeaddrinfo(result);
+
+        answer.status = answer.addresses.empty() ? CDnsResolver::ERet::NOT_FOUND : CDnsResolver::ERet::OK;
+        answer.ttl = answer.addresses.empty() ? hostCacheSystemNegativeTtl : hostCacheSystemTtl;
+        return answer;
+    };
+}
+
+CHostCache::CallbackResolve CHostCache::dnsResolver(std::shared_ptr<CDnsResolver> pResolver)
+{
+    if (!pResolver) {
+        throw std::invalid_argument(utils::buildErrorMessage("CHostCache::", __func__, ": no resolver"));
+    }
+    return [pResolver](const std::string& rHostName)
+    {
+        auto pAnswer = std::make_shared<std::promise<CDnsResolver::SAnswer>>();
+        std::future<CDnsResolver::SAnswer> answer = pAnswer->get_future();
+        pResolver->resolve(rHostName, [pAnswer](const std::string&, const CDnsResolver::SAnswer& rAnswer) {
+            pAnswer->set_value(rAnswer);
+        });
+        return answer.get();
+    };
+}
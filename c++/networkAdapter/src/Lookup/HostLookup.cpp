@@ -27,10 +27,10 @@
 // Header
 
 #include <Lookup/HostLookup.hpp>
+#include <Lookup/HostCache.hpp>
 #include <iostream> //std::cout
 #include <string> //std::string
-#include <netdb.h> //getaddrinfo
-#include <arpa/inet.h> //inet_ntop
+#include <netdb.h> //getnameinfo
 #include <sys/socket.h> //AF_INET AF_INET6
 #include <error_msg.hpp> //utils::buildErrorMessage
 #include <make_unordered_map.h> //utils::make_unordered_map
@@ -72,44 +72,7 @@ std::string CHostLookup::hostname() const noexcept
 
 CHostLookup::IpAddresses CHostLookup::requestIpAddresses(const std::string& rHostName)
 {
-    CHostLookup::IpAddresses hostIps;
-    char addrstr[INET6_ADDRSTRLEN];
-
-    struct addrinfo hints = {};
-    hints.ai_family = PF_UNSPEC;
-    hints.ai_socktype = SOCK_STREAM;
-    hints.ai_flags |= AI_CANONNAME;
-
-    struct addrinfo *result, *rp;
-    int ret = getaddrinfo (rHostName.c_str(), NULL, &hints, &result);
-    if (ret != 0) {
-         throw std::runtime_error(utils::buildErrorMessage("CHostLookup::", __func__, ": getaddrinfo: ", gai_strerror(ret)));
-    }
-
-    for(rp = result; rp != NULL; rp = rp->ai_next)
-    {
-        inet_ntop (result->ai_family, result->ai_addr->sa_data, addrstr, sizeof(addrstr));
-
-        switch (result->ai_family)
-        {
-            case AF_INET:
-            {
-                sockaddr_in *pSockAddr = reinterpret_cast<sockaddr_in*>(result->ai_addr);
-                hostIps.emplace_back(CIpAddress(pSockAddr->sin_addr));
-
-                break;
-            }
-            case AF_INET6:
-            {
-                sockaddr_in6 *pSockAddr = reinterpret_cast<sockaddr_in6*>(result->ai_addr);
-                hostIps.emplace_back(CIpAddress(pSockAddr->sin6_addr));
-                break;
-            }
-        }
-        result = result->ai_next;
-    }
-    freeaddrinfo(result);
-    return hostIps;
+    return CHostCache::instance().addresses(rHostName);
 }
 
 std::string CHostLookup::requestHostname(const CIpAddress& rIpAddress)
@@ -0,0 +1,519 @@
+/*
+ * This file is part of the EMBTOM project
+ * Copyright (c) 2018-2020 Thomas Willetal
+ * (https://github.com/embtom)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+//******************************************************************************
+// Header
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <string.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <linux/rtnetlink.h>
+
+#include <error_msg.hpp>
+#include <EventLoop.hpp>
+#include <Lookup/InterfaceMonitor.hpp>
+#include <Lookup/RouteNetlink.hpp>
+#include <Lookup/InterfaceSnapshotBuilder.hpp>
+
+namespace
+{
+
+using namespace EtNet;
+
+//! recive buffer of the notification socket, a burst of changes is queued until the monitor drains it
+constexpr int monitorSocketBuffer = 1024 * 1024;
+
+EIfState toState(unsigned flags) noexcept
+{
+    if ((flags & IFF_UP) && (flags & IFF_RUNNING)) {
+        return EIfState::running;
+    }
+    return (flags & IFF_UP) ? EIfState::up : EIfState::down;
+}
+
+//! key of an address of a link for the hashed lookup of the reloaded table
+std::string addressKey(unsigned ifIndex, const CIpAddress& rAddress)
+{
+    std::string key(reinterpret_cast<const char*>(&ifIndex), sizeof(ifIndex));
+    if (rAddress.is_v4()) {
+        key.append(reinterpret_cast<const char*>(rAddress.to_v4()), sizeof(in_addr));
+    }
+    else if (rAddress.is_v6()) {
+        key.append(reinterpret_cast<const char*>(rAddress.to_v6()), sizeof(in6_addr));
+    }
+    return key;
+}
+
+void addUnique(CIpAddress::IpAddresses& rList, const CIpAddress& rAddress)
+{
+    if (!rAddress.empty() && (std::find(rList.begin(), rList.end(), rAddress) == rList.end())) {
+        rList.push_back(rAddress);
+    }
+}
+
+}
+
+namespace EtNet
+{
+
+//*****************************************************************************
+//! \brief CNetInterfaceMonitorPrivate
+//!
+class CNetInterfaceMonitorPrivate
+{
+public:
+    CNetInterfaceMonitorPrivate();
+    ~CNetInterfaceMonitorPrivate() noexcept;
+
+    std::size_t subscribe(CNetInterfaceMonitor::CallbackChange onChange);
+    void unsubscribe(std::size_t id) noexcept;
+
+    std::optional<CNetInterfaceMonitor::SInterface> getInterface(unsigned ifIndex) const;
+    std::optional<CNetInterfaceMonitor::SInterface> getInterface(const std::string& rName) const;
+
+    CIpAddress::IpAddresses getAllIpv4Ip(bool bWithLoopback) const;
+    CIpAddress::IpAddresses getAllIpv6Ip(bool bWithLoopback) const;
+    CIpAddress::IpAddresses getAllIpv4Submask() const;
+    CIpAddress::IpAddresses getAllIpv4Broadcast() const;
+    std::shared_ptr<const CInterfaceSnapshot> snapshot() const;
+
+private:
+    using Events = std::vector<CNetInterfaceMonitor::SEvent>;
+
+    using SLinkEntry = CInterfaceSnapshotBuilder::SLinkState;
+
+    void onReadable();
+    //! reload the table by a dump, the differences to the current table are reported
+    void resync(Events& rEvents);
+    void applyLink(const CRouteNetlink::SLink& rLink, bool removed, Events& rEvents);
+    void applyAddress(const CRouteNetlink::SAddress& rAddress, bool removed, Events& rEvents);
+    //! publish a new snapshot of the table answering the queries
+    void rebuild();
+    void notify(const Events& rEvents);
+    CNetInterfaceMonitor::SInterface toInterface(const SLinkEntry& rEntry) const;
+    static CNetInterfaceMonitor::SEvent linkEvent(CNetInterfaceMonitor::EChange change, const CRouteNetlink::SLink& rLink);
+
+    CRouteNetlink m_netlink;
+
+    mutable std::mutex m_mutex;
+    std::unordered_map<unsigned, SLinkEntry> m_links;
+    std::unordered_map<std::string, unsigned> m_names;
+    std::shared_ptr<const CInterfaceSnapshot> m_snapshot;
+
+    std::mutex  m_subscriberMutex;
+    std::map<std::size_t, CNetInterfaceMonitor::CallbackChange> m_subscribers;
+    std::size_t m_nextId {0};
+
+    // State of the monitor thread
+    CEventLoop  m_loop;
+    bool        m_stop {false};
+    std::thread m_thread;
+};
+
+}
+
+using namespace EtNet;
+
+//*****************************************************************************
+// Method definitions "CNetInterfaceMonitorPrivate"
+
+CNetInterfaceMonitorPrivate::CNetInterfaceMonitorPrivate() :
+    m_netlink(RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR)
+{
+    int size = monitorSocketBuffer;
+    ::setsockopt(m_netlink.getFd(), SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+
+    // The groups are joined before the dump, changes during the dump are queued at the socket
+    Events events;
+    resync(events);
+
+    m_loop.add(m_netlink.getFd(), EEvent::READ, [this](EEvent) { onReadable(); });
+    m_thread = std::thread([this]()
+    {
+        while (!m_stop)
+        {
+            try {
+                m_loop.runOnce();
+            }
+            catch (const std::exception& e) {
+                std::cerr << e.what() << std::endl;
+            }
+        }
+    });
+    m_loop.post([this]() { onReadable(); });
+}
+
+CNetInterfaceMonitorPrivate::~CNetInterfaceMonitorPrivate() noexcept
+{
+    m_loop.post([this]() { m_stop = true; });
+    m_thread.join();
+    m_loop.remove(m_netlink.getFd());
+}
+
+std::size_t CNetInterfaceMonitorPrivate::subscribe(CNetInterfaceMonitor::CallbackChange onChange)
+{
+    std::lock_guard<std::mutex> lock(m_subscriberMutex);
+    m_subscribers.emplace(++m_nextId, std::move(onChange));
+    return m_nextId;
+}
+
+void CNetInterfaceMonitorPrivate::unsubscribe(std::size_t id) noexcept
+{
+    std::lock_guard<std::mutex> lock(m_subscriberMutex);
+    m_subscribers.erase(id);
+}
+
+std::optional<CNetInterfaceMonitor::SInterface> CNetInterfaceMonitorPrivate::getInterface(unsigned ifIndex) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_links.find(ifIndex);
+    if (it == m_links.end()) {
+        return std::nullopt;
+    }
+    return toInterface(it->second);
+}
+
+std::optional<CNetInterfaceMonitor::SInterface> CNetInterfaceMonitorPrivate::getInterface(const std::string& rName) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_names.find(rName);
+    if (it == m_names.end()) {
+        return std::nullopt;
+    }
+    return toInterface(m_links.at(it->second));
+}
+
+CIpAddress::IpAddresses CNetInterfaceMonitorPrivate::getAllIpv4Ip(bool bWithLoopback) const
+{
+    auto addresses = snapshot()->getAllIpv4Ip(bWithLoopback);
+    return CIpAddress::IpAddresses(addresses.begin(), addresses.end());
+}
+
+CIpAddress::IpAddresses CNetInterfaceMonitorPrivate::getAllIpv6Ip(bool bWithLoopback) const
+{
+    auto addresses = snapshot()->getAllIpv6Ip(bWithLoopback);
+    return CIpAddress::IpAddresses(addresses.begin(), addresses.end());
+}
+
+CIpAddress::IpAddresses CNetInterfaceMonitorPrivate::getAllIpv4Submask() const
+{
+    auto addresses = snapshot()->getAllIpv4Submask();
+    return CIpAddress::IpAddresses(addresses.begin(), addresses.end());
+}
+
+CIpAddress::IpAddresses CNetInterfaceMonitorPrivate::getAllIpv4Broadcast() const
+{
+    auto addresses = snapshot()->getAllIpv4Broadcast();
+    return CIpAddress::IpAddresses(addresses.begin(), addresses.end());
+}
+
+std::shared_ptr<const CInterfaceSnapshot> CNetInterfaceMonitorPrivate::snapshot() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_snapshot;
+}
+
+void CNetInterfaceMonitorPrivate::onReadable()
+{
+    Events events;
+    bool complete;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        complete = m_netlink.reciveNotifications([this, &events](const nlmsghdr* pMessage)
+        {
+            CRouteNetlink::SLink link;
+            CRouteNetlink::SAddress address;
+            if (CRouteNetlink::parseLink(pMessage, link)) {
+                applyLink(link, pMessage->nlmsg_type == RTM_DELLINK, events);
+            }
+            else if (CRouteNetlink::parseAddress(pMessage, address)) {
+                applyAddress(address, pMessage->nlmsg_type == RTM_DELADDR, events);
+            }
+        });
+        if (!events.empty()) {
+            rebuild();
+        }
+    }
+
+    if (!complete) {
+        resync(events);
+    }
+    notify(events);
+}
+
+void CNetInterfaceMonitorPrivate::resync(Events& rEvents)
+{
+    CRouteNetlink netlink;
+    std::vector<CRouteNetlink::SLink> links = netlink.dumpLinks();
+    std::vector<CRouteNetlink::SAddress> addresses = netlink.dumpAddresses();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::unordered_set<unsigned> seenLinks;
+    std::unordered_set<std::string> seenAddresses;
+    for (const auto& rLink : links)
+    {
+        applyLink(rLink, false, rEvents);
+        seenLinks.insert(rLink.index);
+    }
+    for (const auto& rAddress : addresses)
+    {
+        applyAddress(rAddress, false, rEvents);
+        seenAddresses.insert(addressKey(rAddress.index, rAddress.address));
+    }
+
+    // Links and addresses removed while notifications were lost
+    std::vector<CRouteNetlink::SLink> removedLinks;
+    std::vector<CRouteNetlink::SAddress> removedAddresses;
+    for (const auto& rEntry : m_links)
+    {
+        if (seenLinks.count(rEntry.first) == 0)
+        {
+            removedLinks.push_back(rEntry.second.link);
+            continue;
+        }
+        for (const auto& rAddress : rEntry.second.addresses)
+        {
+            if (seenAddresses.count(addressKey(rEntry.first, rAddress.address)) == 0) {
+                removedAddresses.push_back(rAddress);
+            }
+        }
+    }
+    for (const auto& rAddress : removedAddresses) {
+        applyAddress(rAddress, true, rEvents);
+    }
+    for (const auto& rLink : removedLinks) {
+        applyLink(rLink, true, rEvents);
+    }
+    rebuild();
+}
+
+void CNetInterfaceMonitorPrivate::applyLink(const CRouteNetlink::SLink& rLink, bool removed, Events& rEvents)
+{
+    using EChange = CNetInterfaceMonitor::EChange;
+    auto it = m_links.find(rLink.index);
+    if (removed)
+    {
+        if (it == m_links.end()) {
+            return;
+        }
+        for (const auto& rAddress : it->second.addresses)
+        {
+            CNetInterfaceMonitor::SEvent event = linkEvent(EChange::ADDRESS_REMOVED, it->second.link);
+            event.address = rAddress.address;
+            rEvents.push_back(std::move(event));
+        }
+        rEvents.push_back(linkEvent(EChange::LINK_REMOVED, it->second.link));
+        m_names.erase(it->second.link.name);
+        m_links.erase(it);
+        return;
+    }
+
+    if (it == m_links.end())
+    {
+        m_links[rLink.index].link = rLink;
+        m_names[rLink.name] = rLink.index;
+        rEvents.push_back(linkEvent(EChange::LINK_ADDED, rLink));
+        return;
+    }
+
+    CRouteNetlink::SLink& rKnown = it->second.link;
+    bool changed = (toState(rKnown.flags) != toState(rLink.flags)) || (rKnown.mtu != rLink.mtu) || (rKnown.name != rLink.name);
+    if (rKnown.name != rLink.name)
+    {
+        m_names.erase(rKnown.name);
+        m_names[rLink.name] = rLink.index;
+    }
+    rKnown = rLink;
+    if (changed) {
+        rEvents.push_back(linkEvent(EChange::LINK_CHANGED, rLink));
+    }
+}
+
+void CNetInterfaceMonitorPrivate::applyAddress(const CRouteNetlink::SAddress& rAddress, bool removed, Events& rEvents)
+{
+    using EChange = CNetInterfaceMonitor::EChange;
+    auto linkIt = m_links.find(rAddress.index);
+    if (linkIt == m_links.end()) {
+        return;
+    }
+
+    auto& rAddresses = linkIt->second.addresses;
+    auto it = std::find_if(rAddresses.begin(), rAddresses.end(), [&rAddress](const CRouteNetlink::SAddress& rKnown) {
+        return rKnown.address == rAddress.address;
+    });
+
+    if (removed)
+    {
+        if (it == rAddresses.end()) {
+            return;
+        }
+        rAddresses.erase(it);
+    }
+    else if (it != rAddresses.end())
+    {
+        // e.g. a changed lifetime of an IPv6 address
+        *it = rAddress;
+        return;
+    }
+    else {
+        rAddresses.push_back(rAddress);
+    }
+
+    CNetInterfaceMonitor::SEvent event = linkEvent(removed ? EChange::ADDRESS_REMOVED : EChange::ADDRESS_ADDED, linkIt->second.link);
+    event.address = rAddress.address;
+    rEvents.push_back(std::move(event));
+}
+
+void CNetInterfaceMonitorPrivate::rebuild()
+{
+    // Ordered by the interface index as the map of CNetInterface::getStateMap
+    std::vector<const SLinkEntry*> links;
+    links.reserve(m_links.size());
+    for (const auto& rEntry : m_links) {
+        links.push_back(&rEntry.second);
+    }
+    std::sort(links.begin(), links.end(), [](const SLinkEntry* pLhs, const SLinkEntry* pRhs) {
+        return pLhs->link.index < pRhs->link.index;
+    });
+    m_snapshot = CInterfaceSnapshotBuilder::build(links);
+}
+
+void CNetInterfaceMonitorPrivate::notify(const Events& rEvents)
+{
+    if (rEvents.empty()) {
+        return;
+    }
+
+    // The callbacks are called without a lock held, they are allowed to query or unsubscribe
+    std::vector<CNetInterfaceMonitor::CallbackChange> subscribers;
+    {
+        std::lock_guard<std::mutex> lock(m_subscriberMutex);
+        for (const auto& rSubscriber : m_subscribers) {
+            subscribers.push_back(rSubscriber.second);
+        }
+    }
+    for (const auto& rEvent : rEvents)
+    {
+        for (const auto& rSubscriber : subscribers) {
+            rSubscriber(rEvent);
+        }
+    }
+}
+
+CNetInterfaceMonitor::SInterface CNetInterfaceMonitorPrivate::toInterface(const SLinkEntry& rEntry) const
+{
+    CNetInterfaceMonitor::SInterface interface;
+    interface.ifIndex = rEntry.link.index;
+    interface.name    = rEntry.link.name;
+    interface.state   = toState(rEntry.link.flags);
+    interface.mtu     = rEntry.link.mtu;
+
+    // Masks and broadcasts as reported by CNetInterface
+    for (const auto& rAddress : rEntry.addresses)
+    {
+        bool isV4 = rAddress.address.is_v4();
+        addUnique(interface.addresses, rAddress.address);
+        if (!isV4 || !(rEntry.link.flags & IFF_LOOPBACK)) {
+            addUnique(interface.subMasks, rAddress.mask);
+        }
+        if (isV4 && (rEntry.link.flags & IFF_BROADCAST)) {
+            addUnique(interface.broadcasts, rAddress.broadcast);
+        }
+    }
+    return interface;
+}
+
+CNetInterfaceMonitor::SEvent CNetInterfaceMonitorPrivate::linkEvent(CNetInterfaceMonitor::EChange change, const CRouteNetlink::SLink& rLink)
+{
+    CNetInterfaceMonitor::SEvent event;
+    event.change  = change;
+    event.ifIndex = rLink.index;
+    event.name    = rLink.name;
+    event.state   = toState(rLink.flags);
+    event.mtu     = rLink.mtu;
+    return event;
+}
+
+//*****************************************************************************
+// Method definitions "CNetInterfaceMonitor"
+
+CNetInterfaceMonitor::CNetInterfaceMonitor() :
+    m_pPrivate(std::make_unique<CNetInterfaceMonitorPrivate>())
+{ }
+
+CNetInterfaceMonitor::~CNetInterfaceMonitor() noexcept = default;
+
+std::size_t CNetInterfaceMonitor::subscribe(CallbackChange onChange)
+{
+    return m_pPrivate->subscribe(std::move(onChange));
+}
+
+void CNetInterfaceMonitor::unsubscribe(std::size_t id) noexcept
+{
+    m_pPrivate->unsubscribe(id);
+}
+
+std::optional<CNetInterfaceMonitor::SInterface> CNetInterfaceMonitor::getInterface(unsigned ifIndex) const
+{
+    return m_pPrivate->getInterface(ifIndex);
+}
+
+std::optional<CNetInterfaceMonitor::SInterface> CNetInterfaceMonitor::getInterface(const std::string& rName) const
+{
+    return m_pPrivate->getInterface(rName);
+}
+
+CIpAddress::IpAddresses CNetInterfaceMonitor::getAllIpv4Ip(bool bWithLoopback) const
+{
+    return m_pPrivate->getAllIpv4Ip(bWithLoopback);
+}
+
+CIpAddress::IpAddresses CNetInterfaceMonitor::getAllIpv6Ip(bool bWithLoopback) const
+{
+    return m_pPrivate->getAllIpv6Ip(bWithLoopback);
+}
+
+CIpAddress::IpAddresses CNetInterfaceMonitor::getAllIpv4Submask() const
+{
+    return m_pPrivate->getAllIpv4Submask();
+}
+
+CIpAddress::IpAddresses CNetInterfaceMonitor::getAllIpv4Broadcast() const
+{
+    return m_pPrivate->getAllIpv4Broadcast();
+}
+
+std::shared_ptr<const CInterfaceSnapshot> CNetInterfaceMonitor::snapshot() const
+{
+    return m_pPrivate->snapshot();
+}
@@ -0,0 +1,235 @@
+/*
+ * This file is part of the EMBTOM project
+ * Copyright (c) 2018-2020 Thomas Willetal
+ * (https://github.com/embtom)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+//******************************************************************************
+// Header
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include <net/if.h>
+
+#include <Lookup/InterfaceSnapshot.hpp>
+#include <Lookup/InterfaceSnapshotBuilder.hpp>
+
+using namespace EtNet;
+
+namespace
+{
+
+//! append the address to the range at the end of the arena if the range does not contain it yet
+void addUnique(std::vector<CIpAddress>& rArena, uint32_t rangeBegin, const CIpAddress& rAddress)
+{
+    if (!rAddress.empty() && (std::find(rArena.begin() + rangeBegin, rArena.end(), rAddress) == rArena.end())) {
+        rArena.push_back(rAddress);
+    }
+}
+
+}
+
+//*****************************************************************************
+// Method definitions "CInterfaceSnapshotBuilder"
+
+std::shared_ptr<const CInterfaceSnapshot> CInterfaceSnapshotBuilder::build(const std::vector<const SLinkState*>& rLinks)
+{
+    using SRange = CInterfaceSnapshot::SRange;
+    std::shared_ptr<CInterfaceSnapshot> pSnapshot(new CInterfaceSnapshot());
+    CInterfaceSnapshot& rSnapshot = *pSnapshot;
+
+    std::size_t nameLength = 0;
+    std::size_t addressCount = 0;
+    for (const SLinkState* pLink : rLinks)
+    {
+        nameLength += pLink->link.name.size();
+        addressCount += pLink->addresses.size();
+    }
+    rSnapshot.m_nameArena.reserve(nameLength);
+    // Address, mask and broadcast of each address, the aggregated lists repeat an address
+    // twice (with and without loopback), its mask and its broadcast
+    rSnapshot.m_addressArena.reserve(7 * addressCount);
+    rSnapshot.m_interfaces.reserve(rLinks.size());
+
+    auto& rArena = rSnapshot.m_addressArena;
+    auto close = [&rArena](SRange& rRange) {
+        rRange.count = static_cast<uint32_t>(rArena.size()) - rRange.begin;
+    };
+
+    for (const SLinkState* pLink : rLinks)
+    {
+        const CRouteNetlink::SLink& rLink = pLink->link;
+        CInterfaceSnapshot::CInterface interface;
+        interface.m_pSnapshot = &rSnapshot;
+        interface.m_ifIndex   = rLink.index;
+        interface.m_flags     = rLink.flags;
+        interface.m_mtu       = rLink.mtu;
+        interface.m_name      = SRange{static_cast<uint32_t>(rSnapshot.m_nameArena.size()), static_cast<uint32_t>(rLink.name.size())};
+        rSnapshot.m_nameArena.append(rLink.name);
+
+        interface.m_addresses.begin = static_cast<uint32_t>(rArena.size());
+        for (const auto& rAddress : pLink->addresses) {
+            addUnique(rArena, interface.m_addresses.begin, rAddress.address);
+        }
+        close(interface.m_addresses);
+
+        // As reported by getifaddrs, the IPv4 loopback has no mask and only broadcast capable links a broadcast address
+        interface.m_subMasks.begin = static_cast<uint32_t>(rArena.size());
+        for (const auto& rAddress : pLink->addresses)
+        {
+            if (!rAddress.address.is_v4() || !(rLink.flags & IFF_LOOPBACK)) {
+                addUnique(rArena, interface.m_subMasks.begin, rAddress.mask);
+            }
+        }
+        close(interface.m_subMasks);
+
+        interface.m_broadcasts.begin = static_cast<uint32_t>(rArena.size());
+        for (const auto& rAddress : pLink->addresses)
+        {
+            if (rAddress.address.is_v4() && (rLink.flags & IFF_BROADCAST)) {
+                addUnique(rArena, interface.m_broadcasts.begin, rAddress.broadcast);
+            }
+        }
+        close(interface.m_broadcasts);
+
+        rSnapshot.m_interfaces.push_back(interface);
+    }
+
+    // The aggregated lists of the running interfaces follow the ranges of the interfaces
+    auto aggregate = [&rSnapshot, &rArena, &close](SRange& rRange, auto range, auto predicate)
+    {
+        rRange.begin = static_cast<uint32_t>(rArena.size());
+        for (const auto& rInterface : rSnapshot.m_interfaces)
+        {
+            if (!(rInterface.m_flags & IFF_RUNNING)) {
+                continue;
+            }
+            const SRange& rSource = rInterface.*range;
+            for (uint32_t i = rSource.begin; i < rSource.begin + rSource.count; i++)
+            {
+                if (predicate(rArena[i])) {
+                    rArena.push_back(rArena[i]);
+                }
+            }
+        }
+        close(rRange);
+    };
+    using CInterface = CInterfaceSnapshot::CInterface;
+    aggregate(rSnapshot.m_ipv4, &CInterface::m_addresses, [](const CIpAddress& rIp) { return rIp.is_v4(); });
+    aggregate(rSnapshot.m_ipv4NoLoopback, &CInterface::m_addresses, [](const CIpAddress& rIp) { return rIp.is_v4() && !rIp.is_loopback(); });
+    aggregate(rSnapshot.m_ipv6, &CInterface::m_addresses, [](const CIpAddress& rIp) { return rIp.is_v6(); });
+    aggregate(rSnapshot.m_ipv6NoLoopback, &CInterface::m_addresses, [](const CIpAddress& rIp) { return rIp.is_v6() && !rIp.is_loopback(); });
+    aggregate(rSnapshot.m_ipv4Submasks, &CInterface::m_subMasks, [](const CIpAddress& rIp) { return rIp.is_v4() && rIp.is_submask(); });
+    aggregate(rSnapshot.m_ipv4Broadcasts, &CInterface::m_broadcasts, [](const CIpAddress& rIp) { return rIp.is_v4() && rIp.is_broadcast(); });
+
+    rSnapshot.m_byName.resize(rSnapshot.m_interfaces.size());
+    std::iota(rSnapshot.m_byName.begin(), rSnapshot.m_byName.end(), 0);
+    std::sort(rSnapshot.m_byName.begin(), rSnapshot.m_byName.end(), [&rSnapshot](uint32_t lhs, uint32_t rhs) {
+        return rSnapshot.m_interfaces[lhs].getName() < rSnapshot.m_interfaces[rhs].getName();
+    });
+    return pSnapshot;
+}
+
+//*****************************************************************************
+// Method definitions "CInterfaceSnapshot::CInterface"
+
+EIfState CInterfaceSnapshot::CInterface::getState() const noexcept
+{
+    if ((m_flags & IFF_UP) && (m_flags & IFF_RUNNING)) {
+        return EIfState::running;
+    }
+    return (m_flags & IFF_UP) ? EIfState::up : EIfState::down;
+}
+
+//*****************************************************************************
+// Method definitions "CInterfaceSnapshot"
+
+std::shared_ptr<const CInterfaceSnapshot> CInterfaceSnapshot::create(bool bRunningOnly)
+{
+    CRouteNetlink netlink;
+    std::unordered_map<unsigned, CInterfaceSnapshotBuilder::SLinkState> links;
+    for (auto& link : netlink.dumpLinks())
+    {
+        if (!bRunningOnly || (link.flags & IFF_RUNNING)) {
+            links[link.index].link = std::move(link);
+        }
+    }
+    for (auto& address : netlink.dumpAddresses())
+    {
+        auto it = links.find(address.index);
+        if (it != links.end()) {
+            it->second.addresses.push_back(std::move(address));
+        }
+    }
+
+    std::vector<const CInterfaceSnapshotBuilder::SLinkState*> ordered;
+    ordered.reserve(links.size());
+    for (const auto& rEntry : links) {
+        ordered.push_back(&rEntry.second);
+    }
+    std::sort(ordered.begin(), ordered.end(), [](const auto* pLhs, const auto* pRhs) {
+        return pLhs->link.index < pRhs->link.index;
+    });
+    return CInterfaceSnapshotBuilder::build(ordered);
+}
+
+utils::span<const CInterfaceSnapshot::CInterface> CInterfaceSnapshot::interfaces() const noexcept
+{
+    return utils::span<const CInterface>(m_interfaces.data(), m_interfaces.size());
+}
+
+const CInterfaceSnapshot::CInterface* CInterfaceSnapshot::find(unsigned ifIndex) const noexcept
+{
+    auto it = std::lower_bound(m_interfaces.begin(), m_interfaces.end(), ifIndex, [](const CInterface& rInterface, unsigned index) {
+        return rInterface.getIfIndex() < index;
+    });
+    return ((it != m_interfaces.end()) && (it->getIfIndex() == ifIndex)) ? &*it : nullptr;
+}
+
+const CInterfaceSnapshot::CInterface* CInterfaceSnapshot::find(std::string_view name) const noexcept
+{
+    auto it = std::lower_bound(m_byName.begin(), m_byName.end(), name, [this](uint32_t position, std::string_view searched) {
+        return m_interfaces[position].getName() < searched;
+    });
+    return ((it != m_byName.end()) && (m_interfaces[*it].getName() == name)) ? &m_interfaces[*it] : nullptr;
+}
+
+utils::span<const CIpAddress> CInterfaceSnapshot::getAllIpv4Ip(bool bWithLoopback) const noexcept
+{
+    return view(bWithLoopback ? m_ipv4 : m_ipv4NoLoopback);
+}
+
+utils::span<const CIpAddress> CInterfaceSnapshot::getAllIpv6Ip(bool bWithLoopback) const noexcept
+{
+    return view(bWithLoopback ? m_ipv6 : m_ipv6NoLoopback);
+}
+
+utils::span<const CIpAddress> CInterfaceSnapshot::getAllIpv4Submask() const noexcept
+{
+    return view(m_ipv4Submasks);
+}
+
+utils::span<const CIpAddress> CInterfaceSnapshot::getAllIpv4Broadcast() const noexcept
+{
+    return view(m_ipv4Broadcasts);
+}
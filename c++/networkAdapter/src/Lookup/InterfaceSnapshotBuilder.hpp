@@ -0,0 +1,59 @@
+/*
+ * This file is part of the EMBTOM project
+ * Copyright (c) 2018-2020 Thomas Willetal
+ * (https://github.com/embtom)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _INTERFACESNAPSHOTBUILDER_H_
+#define _INTERFACESNAPSHOTBUILDER_H_
+
+//******************************************************************************
+// Header
+
+#include <memory>
+#include <vector>
+#include <Lookup/InterfaceSnapshot.hpp>
+#include <Lookup/RouteNetlink.hpp>
+
+namespace EtNet
+{
+
+//*****************************************************************************
+//! \brief CInterfaceSnapshotBuilder
+//! Fills the arenas of a CInterfaceSnapshot from the netlink state of the links
+class CInterfaceSnapshotBuilder
+{
+public:
+    //! a link and its addresses
+    struct SLinkState
+    {
+        CRouteNetlink::SLink link;
+        std::vector<CRouteNetlink::SAddress> addresses;
+    };
+
+    //! the snapshot of the passed links, they have to be ordered by their index
+    static std::shared_ptr<const CInterfaceSnapshot> build(const std::vector<const SLinkState*>& rLinks);
+};
+
+} // EtNet
+
+#endif // _INTERFACESNAPSHOTBUILDER_H_
@@ -32,17 +32,13 @@
 #include <type_traits>
 #include <algorithm>
 #include <iterator>
-#include <stdio.h>
+#include <unordered_map>
+#include <unordered_set>
 #include <string.h>
-#include <sys/types.h>
-#include <ifaddrs.h>
 #include <net/if.h>
-#include <unistd.h>
 #include <netinet/in.h>
-#include <arpa/inet.h>
-#include <sys/ioctl.h>
-#include <errno.h>
 #include <Lookup/InterfacesLookup.hpp>
+#include <Lookup/RouteNetlink.hpp>
 #include <IpAddress.hpp>
 #include <error_msg.hpp>
 
@@ -55,7 +51,6 @@ namespace EtNet
 struct CNetInterfacePrivat
 {
     CNetInterfacePrivat (unsigned int index, std::string&& name) noexcept;
-    void requestMtu() noexcept;
     void addAddress(CIpAddress&& address) noexcept;
     void addMask(CIpAddress&& mask) noexcept;
     void addBroadcast(CIpAddress&& broadcast) noexcept;
@@ -65,6 +60,9 @@ struct CNetInterfacePrivat
     CIpAddress::IpAddresses m_addressList;
     CIpAddress::IpAddresses m_maskList;
     CIpAddress::IpAddresses m_broadcastList;
+    std::unordered_set<std::string> m_knownAddresses;
+    std::unordered_set<std::string> m_knownMasks;
+    std::unordered_set<std::string> m_knownBroadcasts;
     bool        m_up {0};
     bool        m_running {0};
     unsigned    m_mtu {0};
@@ -74,60 +72,44 @@ struct CNetInterfacePrivat
 
 using namespace EtNet;
 
-//*****************************************************************************
-// Method definitions "CNetInterfacePrivat"
-
-CNetInterfacePrivat::CNetInterfacePrivat (unsigned int index, std::string&& name) noexcept :
-    m_name(std::move(name)), m_index(index)
+namespace
 {
-    requestMtu();
-}
 
-void CNetInterfacePrivat::addAddress(CIpAddress&& address) noexcept
+//! append the address if it is not contained yet, the raw address bytes are the key of the hashed lookup
+void addUnique(CIpAddress::IpAddresses& rList, std::unordered_set<std::string>& rKnown, CIpAddress&& address)
 {
     if (address.empty()) {
         return;
     }
-    if (std::find(m_addressList.begin(), m_addressList.end(), address) == m_addressList.end()) {
-        m_addressList.emplace_back(address);
+    std::string key = address.is_v4() ? std::string(reinterpret_cast<const char*>(address.to_v4()), sizeof(in_addr))
+                                       : std::string(reinterpret_cast<const char*>(address.to_v6()), sizeof(in6_addr));
+    if (rKnown.insert(std::move(key)).second) {
+        rList.emplace_back(std::move(address));
     }
 }
 
-void CNetInterfacePrivat::addMask(CIpAddress&& mask) noexcept
-{
-    if (mask.empty()) {
-        return;
-    }
-    if (std::find(m_maskList.begin(), m_maskList.end(), mask) == m_maskList.end()) {
-        m_maskList.emplace_back(mask);
-    }
 }
 
-void CNetInterfacePrivat::addBroadcast(CIpAddress&& broadcast) noexcept
+//*****************************************************************************
+// Method definitions "CNetInterfacePrivat"
+
+CNetInterfacePrivat::CNetInterfacePrivat (unsigned int index, std::string&& name) noexcept :
+    m_name(std::move(name)), m_index(index)
+{ }
+
+void CNetInterfacePrivat::addAddress(CIpAddress&& address) noexcept
 {
-    if (broadcast.empty()) {
-        return;
-    }
-    if (std::find(m_broadcastList.begin(), m_broadcastList.end(), broadcast) == m_broadcastList.end()) {
-        m_broadcastList.emplace_back(broadcast);
-    }
+    try { addUnique(m_addressList, m_knownAddresses, std::move(address)); } catch(...) { }
 }
 
-void CNetInterfacePrivat::requestMtu() noexcept
+void CNetInterfacePrivat::addMask(CIpAddress&& mask) noexcept
 {
-	struct ifreq ifr;
-    int s;
-
-	if ((s = socket(AF_INET, SOCK_DGRAM, 0)) < 0)
-        return;
+    try { addUnique(m_maskList, m_knownMasks, std::move(mask)); } catch(...) { }
+}
 
-	ifr.ifr_addr.sa_family = AF_INET;
-	strcpy(ifr.ifr_name, m_name.c_str());
-	if (ioctl(s, SIOCGIFMTU, (caddr_t)&ifr) < 0) {
-        return;
-    }
-	close(s);
-    m_mtu = ifr.ifr_mtu;
+void CNetInterfacePrivat::addBroadcast(CIpAddress&& broadcast) noexcept
+{
+    try { addUnique(m_broadcastList, m_knownBroadcasts, std::move(broadcast)); } catch(...) { }
 }
 
 //*****************************************************************************
@@ -181,99 +163,48 @@ unsigned CNetInterface::getMtu() const noexcept
 
 CNetInterface::IfMap CNetInterface::getStateMap(bool OnlyRunning) noexcept
 {
-    ifaddrs *ifAddrStruct=NULL, *ifa=NULL;
-    void * tmpAddrPtr=NULL;
-
     try
     {
-        /* code */
-        if (getifaddrs(&ifAddrStruct) == -1) {
-            throw std::runtime_error(utils::buildErrorMessage("CNetInterface::", __func__, ": getifaddrs failure: ", strerror(errno)));
+        // One dump of the links and one of the addresses replace getifaddrs and the ioctl per interface
+        CRouteNetlink netlink;
+        std::unordered_map<unsigned, CRouteNetlink::SLink> links;
+        for (auto& link : netlink.dumpLinks()) {
+            links.emplace(link.index, std::move(link));
         }
 
         IfMap ifMap;
-        IfMap::iterator ifIt;
-        unsigned ifIndex;
-        auto test_and_add = [&ifMap, &ifIt, &ifIndex](ifaddrs *ifa){
-            ifIndex = if_nametoindex(ifa->ifa_name);
-            ifIt = ifMap.find(ifIndex);
-            if(ifIt == ifMap.end()) {
-                bool valid;
-                std::tie(ifIt,valid) = ifMap.emplace(std::piecewise_construct,
-                                                    std::forward_as_tuple(ifIndex),
-                                                    std::forward_as_tuple(CNetInterface(ifIndex,ifa->ifa_name)));
-            }
-        };
-
-        for (ifa = ifAddrStruct; ifa != NULL; ifa = ifa->ifa_next)
+        for (auto& rAddress : netlink.dumpAddresses())
         {
-            if (ifa->ifa_addr == NULL) {
+            auto linkIt = links.find(rAddress.index);
+            if (linkIt == links.end()) {
                 continue;
             }
-
-            CIpAddress address, subnetMask, broadcastAddress;
-
-            if ((OnlyRunning && !(ifa->ifa_flags & IFF_RUNNING))) {
+            const CRouteNetlink::SLink& rLink = linkIt->second;
+            if (OnlyRunning && !(rLink.flags & IFF_RUNNING)) {
                 continue;
             }
 
-            switch (ifa->ifa_addr->sa_family)
+            auto ifIt = ifMap.find(rLink.index);
+            if (ifIt == ifMap.end())
             {
-                case AF_INET:
-                {
-                    test_and_add(ifa);
-                    {
-                        auto *pIpAddr = reinterpret_cast<sockaddr_in*>(ifa->ifa_addr);
-                        address = CIpAddress (pIpAddr->sin_addr);
-                    }
-                    if(((ifa->ifa_flags & IFF_LOOPBACK) == 0) && (ifa->ifa_netmask != NULL))
-                    {
-                        auto *pMaskAddr = reinterpret_cast<sockaddr_in*>(ifa->ifa_netmask);
-                        subnetMask = CIpAddress (pMaskAddr->sin_addr);
-                    }
-                    if((ifa->ifa_flags & IFF_BROADCAST) && (ifa->ifa_broadaddr != NULL))
-                    {
-                        auto *pBroadcastAddr = reinterpret_cast<sockaddr_in*>(ifa->ifa_broadaddr);
-                        broadcastAddress = CIpAddress (pBroadcastAddr->sin_addr);
-                    }
-                    break;
-                }
-                case AF_INET6:
-                {
-                    test_and_add(ifa);
-                    {
-                        auto *pIpAddr = reinterpret_cast<sockaddr_in6*>(ifa->ifa_addr);
-                        address = CIpAddress (pIpAddr->sin6_addr);
-                    }
-                    {
-                        sockaddr_in6 *pMaskAddr = reinterpret_cast<sockaddr_in6*>(ifa->ifa_netmask);
-                        subnetMask = CIpAddress (pMaskAddr->sin6_addr);
-                    }
-                    broadcastAddress = CIpAddress();
-
-                    break;
-                }
-                default:
-                {
-                    ifIndex = 0;
-                    break;
-                }
+                std::tie(ifIt, std::ignore) = ifMap.emplace(std::piecewise_construct,
+                                                            std::forward_as_tuple(rLink.index),
+                                                            std::forward_as_tuple(CNetInterface(rLink.index, std::string(rLink.name))));
+                ifIt->second.m_pPrivate->m_up      = (rLink.flags & IFF_UP) != 0;
+                ifIt->second.m_pPrivate->m_running = (rLink.flags & IFF_RUNNING) != 0;
+                ifIt->second.m_pPrivate->m_mtu     = rLink.mtu;
             }
 
-            if ((ifIndex > 0) &&
-                ((OnlyRunning && (ifa->ifa_flags & IFF_RUNNING)) || !OnlyRunning))
-
-            {
-                ifIt->second.m_pPrivate->m_up = (ifa->ifa_flags && IFF_UP);
-                ifIt->second.m_pPrivate->m_up = (ifa->ifa_flags && IFF_RUNNING);
-                ifIt->second.m_pPrivate->addAddress(std::move(address));
-                ifIt->second.m_pPrivate->addMask(std::move(subnetMask));
-                ifIt->second.m_pPrivate->addBroadcast(std::move(broadcastAddress));
+            // As reported by getifaddrs, the IPv4 loopback has no mask and only broadcast capable links a broadcast address
+            CNetInterfacePrivat& rInterface = *ifIt->second.m_pPrivate;
+            bool isV4 = rAddress.address.is_v4();
+            if (!isV4 || !(rLink.flags & IFF_LOOPBACK)) {
+                rInterface.addMask(std::move(rAddress.mask));
             }
-        }
-
-        if (ifAddrStruct != NULL) {
-            freeifaddrs(ifAddrStruct);
+            if (isV4 && (rLink.flags & IFF_BROADCAST)) {
+                rInterface.addBroadcast(std::move(rAddress.broadcast));
+            }
+            rInterface.addAddress(std::move(rAddress.address));
         }
         return ifMap;
     }
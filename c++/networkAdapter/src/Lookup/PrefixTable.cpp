@@ -0,0 +1,379 @@
+/*
+ * This file is part of the EMBTOM project
+ * Copyright (c) 2018-2020 Thomas Willetal
+ * (https://github.com/embtom)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+//******************************************************************************
+// Header
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <error_msg.hpp>
+#include <Lookup/PrefixTable.hpp>
+
+using namespace EtNet;
+
+namespace
+{
+
+//! slot bits up to and including the slot
+uint64_t upToSlot(unsigned slot) noexcept
+{
+    return (2ULL << slot) - 1;
+}
+
+}
+
+//*****************************************************************************
+// Method definitions "CPrefixTable::CBuilder"
+
+void CPrefixTable::CBuilder::add(const CIpAddress& rNetwork, unsigned length, uint32_t value)
+{
+    if (value == noMatch) {
+        throw std::invalid_argument(utils::buildErrorMessage("CPrefixTable::CBuilder::", __func__, ": noMatch is no valid value"));
+    }
+    m_prefixes.push_back(SPrefix{CSubnet(rNetwork, length), value});
+}
+
+std::size_t CPrefixTable::CBuilder::add(std::string_view prefixList, uint32_t value)
+{
+    auto isSeparator = [](char c) {
+        return (c == ' ') || (c == '\t') || (c == '\r') || (c == '\n') || (c == ',');
+    };
+
+    // The prefixes are added once the whole list is valid
+    std::vector<CSubnet> subnets;
+    std::size_t pos = 0;
+    while (pos < prefixList.size())
+    {
+        if (isSeparator(prefixList[pos])) {
+            pos++;
+            continue;
+        }
+        if (prefixList[pos] == '#')
+        {
+            pos = prefixList.find('\n', pos);
+            continue;
+        }
+
+        const std::size_t start = pos;
+        while ((pos < prefixList.size()) && !isSeparator(prefixList[pos]) && (prefixList[pos] != '#')) {
+            pos++;
+        }
+        const std::string_view token = prefixList.substr(start, pos - start);
+        auto subnet = CSubnet::parse(token);
+        if (!subnet) {
+            throw std::invalid_argument(utils::buildErrorMessage("CPrefixTable::CBuilder::", __func__, ": invalid prefix: ", std::string(token)));
+        }
+        subnets.push_back(*subnet);
+    }
+
+    for (const auto& rSubnet : subnets) {
+        add(rSubnet.network(), rSubnet.prefixLength(), value);
+    }
+    return subnets.size();
+}
+
+std::shared_ptr<const CPrefixTable> CPrefixTable::CBuilder::build() const
+{
+    // Ordered by the network and the length, equal prefixes stay in the order they were added
+    std::vector<const SPrefix*> v4;
+    std::vector<const SPrefix*> v6;
+    for (const auto& rPrefix : m_prefixes) {
+        (rPrefix.subnet.network().is_v4() ? v4 : v6).push_back(&rPrefix);
+    }
+    auto before = [](const SPrefix* pLhs, const SPrefix* pRhs) {
+        const int order = std::memcmp(pLhs->subnet.network().bytes(), pRhs->subnet.network().bytes(), 16);
+        return (order != 0) ? (order < 0) : (pLhs->subnet.prefixLength() < pRhs->subnet.prefixLength());
+    };
+    std::stable_sort(v4.begin(), v4.end(), before);
+    std::stable_sort(v6.begin(), v6.end(), before);
+
+    auto pTable = std::make_shared<CPrefixTable>();
+    pTable->build(pTable->m_v4, v4);
+    pTable->build(pTable->m_v6, v6);
+
+    auto equal = [](const SPrefix* pLhs, const SPrefix* pRhs) {
+        return pLhs->subnet == pRhs->subnet;
+    };
+    pTable->m_size = static_cast<std::size_t>(std::unique(v4.begin(), v4.end(), equal) - v4.begin()) +
+                     static_cast<std::size_t>(std::unique(v6.begin(), v6.end(), equal) - v6.begin());
+    return pTable;
+}
+
+//*****************************************************************************
+// Method definitions "CPrefixTable"
+
+CPrefixTable::CPrefixTable() = default;
+
+uint32_t CPrefixTable::lookup(const CIpAddress& rAddress) const noexcept
+{
+    if (rAddress.is_v4()) {
+        return lookup(m_v4, keyOf(rAddress));
+    }
+    if (rAddress.is_v6()) {
+        return lookup(m_v6, keyOf(rAddress));
+    }
+    return noMatch;
+}
+
+std::size_t CPrefixTable::memoryUsage() const noexcept
+{
+    return (m_v4.direct.size() + m_v6.direct.size()) * sizeof(SEntry) +
+           m_nodes.size() * sizeof(SNode) + m_values.size() * sizeof(uint32_t);
+}
+
+CPrefixTable::SKey CPrefixTable::keyOf(const CIpAddress& rAddress) noexcept
+{
+    SKey key;
+    std::memcpy(&key.high, rAddress.bytes(), sizeof(key.high));
+    std::memcpy(&key.low, rAddress.bytes() + sizeof(key.high), sizeof(key.low));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    key.high = __builtin_bswap64(key.high);
+    key.low  = __builtin_bswap64(key.low);
+#endif
+    return key;
+}
+
+uint64_t CPrefixTable::bitsAt(const SKey& rKey, unsigned depth, unsigned count) noexcept
+{
+    // The 64 bits starting at depth, the bits behind the address are zero
+    uint64_t window;
+    if (depth == 0) {
+        window = rKey.high;
+    }
+    else if (depth < 64) {
+        window = (rKey.high << depth) | (rKey.low >> (64 - depth));
+    }
+    else {
+        window = rKey.low << (depth - 64);
+    }
+    return window >> (64 - count);
+}
+
+unsigned CPrefixTable::commonBits(const std::vector<const SPrefix*>& rPrefixes, unsigned depth) noexcept
+{
+    // The networks are ordered, the first and the last one differ in the first bit any two differ.
+    // None of the prefixes may end within the skipped bits.
+    const uint64_t first = bitsAt(keyOf(rPrefixes.front()->subnet.network()), depth, 64);
+    const uint64_t last  = bitsAt(keyOf(rPrefixes.back()->subnet.network()), depth, 64);
+    unsigned common = (first == last) ? 64 : static_cast<unsigned>(__builtin_clzll(first ^ last));
+    for (const SPrefix* pPrefix : rPrefixes) {
+        common = std::min(common, pPrefix->subnet.prefixLength() - depth - 1);
+    }
+    return common;
+}
+
+uint32_t CPrefixTable::lookup(const SFamily& rFamily, const SKey& rKey) const noexcept
+{
+    if (rFamily.direct.empty()) {
+        return rFamily.defaultValue;
+    }
+    const SEntry& rEntry = rFamily.direct[rKey.high >> (64 - directBits)];
+    if (rEntry.node == noNode) {
+        return rEntry.value;
+    }
+
+    const SNode* pNodes = m_nodes.data();
+    uint32_t node = rEntry.node;
+    unsigned depth = directBits;
+    while (true)
+    {
+        const SNode& rNode = pNodes[node];
+        if (rNode.skipBits != 0)
+        {
+            if (bitsAt(rKey, depth, rNode.skipBits) != rNode.skipKey) {
+                return rNode.missValue;
+            }
+            depth += rNode.skipBits;
+        }
+
+        const unsigned slot = static_cast<unsigned>(bitsAt(rKey, depth, strideBits));
+        if ((rNode.childBits >> slot) & 1)
+        {
+            node = rNode.children + static_cast<uint32_t>(__builtin_popcountll(rNode.childBits & upToSlot(slot))) - 1;
+            depth += strideBits;
+            continue;
+        }
+        return m_values[rNode.values + static_cast<uint32_t>(__builtin_popcountll(rNode.runBits & upToSlot(slot))) - 1];
+    }
+}
+
+void CPrefixTable::build(SFamily& rFamily, const std::vector<const SPrefix*>& rPrefixes)
+{
+    // The default route sorts first, without longer prefixes there is no table
+    auto it = rPrefixes.begin();
+    for (; (it != rPrefixes.end()) && ((*it)->subnet.prefixLength() == 0); it++) {
+        rFamily.defaultValue = (*it)->value;
+    }
+    if (it == rPrefixes.end()) {
+        return;
+    }
+    rFamily.direct.assign(std::size_t(1) << directBits, SEntry{rFamily.defaultValue, noNode});
+
+    // Shorter prefixes are expanded first, the longer ones overwrite them
+    std::vector<const SPrefix*> ending;
+    std::vector<const SPrefix*> longer;
+    for (; it != rPrefixes.end(); it++) {
+        (((*it)->subnet.prefixLength() <= directBits) ? ending : longer).push_back(*it);
+    }
+    std::stable_sort(ending.begin(), ending.end(), [](const SPrefix* pLhs, const SPrefix* pRhs) {
+        return pLhs->subnet.prefixLength() < pRhs->subnet.prefixLength();
+    });
+    for (const SPrefix* pPrefix : ending)
+    {
+        const unsigned first = static_cast<unsigned>(bitsAt(keyOf(pPrefix->subnet.network()), 0, directBits));
+        const unsigned count = 1U << (directBits - pPrefix->subnet.prefixLength());
+        for (unsigned i = 0; i < count; i++) {
+            rFamily.direct[first + i].value = pPrefix->value;
+        }
+    }
+
+    // The longer prefixes of an entry are adjacent in the order of the networks
+    auto group = longer.begin();
+    while (group != longer.end())
+    {
+        const uint64_t slot = bitsAt(keyOf((*group)->subnet.network()), 0, directBits);
+        auto end = std::find_if(group, longer.end(), [slot](const SPrefix* pPrefix) {
+            return bitsAt(keyOf(pPrefix->subnet.network()), 0, directBits) != slot;
+        });
+        const uint32_t node = addNodes(1);
+        rFamily.direct[slot].node = node;
+        fillNode(node, std::vector<const SPrefix*>(group, end), directBits, rFamily.direct[slot].value);
+        group = end;
+    }
+}
+
+void CPrefixTable::fillNode(uint32_t node, const std::vector<const SPrefix*>& rPrefixes, unsigned depth, uint32_t inherited)
+{
+    SNode result {0, 0, 0, 0, static_cast<uint32_t>(m_values.size()), commonBits(rPrefixes, depth), inherited};
+    if (result.skipBits != 0)
+    {
+        result.skipKey = bitsAt(keyOf(rPrefixes.front()->subnet.network()), depth, result.skipBits);
+        depth += result.skipBits;
+    }
+
+    std::array<uint32_t, 64> slotValues;
+    slotValues.fill(inherited);
+
+    // Shorter prefixes are expanded first, the longer ones overwrite them
+    std::vector<const SPrefix*> ending;
+    std::vector<const SPrefix*> longer;
+    for (const SPrefix* pPrefix : rPrefixes) {
+        ((pPrefix->subnet.prefixLength() <= depth + strideBits) ? ending : longer).push_back(pPrefix);
+    }
+    std::stable_sort(ending.begin(), ending.end(), [](const SPrefix* pLhs, const SPrefix* pRhs) {
+        return pLhs->subnet.prefixLength() < pRhs->subnet.prefixLength();
+    });
+    for (const SPrefix* pPrefix : ending)
+    {
+        const unsigned first = static_cast<unsigned>(bitsAt(keyOf(pPrefix->subnet.network()), depth, strideBits));
+        const unsigned count = 1U << (depth + strideBits - pPrefix->subnet.prefixLength());
+        std::fill_n(slotValues.begin() + first, count, pPrefix->value);
+    }
+
+    // The longer prefixes of a slot are adjacent in the order of the networks
+    std::vector<std::pair<unsigned, std::vector<const SPrefix*>>> groups;
+    for (const SPrefix* pPrefix : longer)
+    {
+        const unsigned slot = static_cast<unsigned>(bitsAt(keyOf(pPrefix->subnet.network()), depth, strideBits));
+        if (groups.empty() || (groups.back().first != slot)) {
+            groups.emplace_back(slot, std::vector<const SPrefix*>());
+        }
+        groups.back().second.push_back(pPrefix);
+        result.childBits |= 1ULL << slot;
+    }
+
+    bool firstRun = true;
+    for (unsigned slot = 0; slot < slotValues.size(); slot++)
+    {
+        if ((result.childBits >> slot) & 1) {
+            continue;
+        }
+        if (firstRun || (slotValues[slot] != m_values.back()))
+        {
+            result.runBits |= 1ULL << slot;
+            m_values.push_back(slotValues[slot]);
+            firstRun = false;
+        }
+    }
+
+    result.children = addNodes(groups.size());
+    m_nodes[node] = result;
+    for (std::size_t i = 0; i < groups.size(); i++) {
+        fillNode(result.children + static_cast<uint32_t>(i), groups[i].second, depth + strideBits, slotValues[groups[i].first]);
+    }
+}
+
+uint32_t CPrefixTable::addNodes(std::size_t count)
+{
+    if (m_nodes.size() + count >= noNode) {
+        throw std::length_error(utils::buildErrorMessage("CPrefixTable::", __func__, ": too many nodes"));
+    }
+    const uint32_t first = static_cast<uint32_t>(m_nodes.size());
+    m_nodes.resize(m_nodes.size() + count, SNode{0, 0, 0, 0, 0, 0, noMatch});
+    return first;
+}
+
+//*****************************************************************************
+// Method definitions "CSharedPrefixTable"
+
+CSharedPrefixTable::CSharedPrefixTable(std::shared_ptr<const CPrefixTable> pTable)
+{
+    store(std::move(pTable));
+}
+
+void CSharedPrefixTable::store(std::shared_ptr<const CPrefixTable> pTable)
+{
+    if (!pTable) {
+        throw std::invalid_argument(utils::buildErrorMessage("CSharedPrefixTable::", __func__, ": no table"));
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pTable = std::move(pTable);
+    m_version.fetch_add(1, std::memory_order_release);
+}
+
+std::shared_ptr<const CPrefixTable> CSharedPrefixTable::load() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pTable;
+}
+
+//*****************************************************************************
+// Method definitions "CSharedPrefixTable::CReader"
+
+CSharedPrefixTable::CReader::CReader(const CSharedPrefixTable& rShared) :
+    m_rShared(rShared)
+{
+    refresh();
+}
+
+void CSharedPrefixTable::CReader::refresh()
+{
+    std::lock_guard<std::mutex> lock(m_rShared.m_mutex);
+    m_pTable  = m_rShared.m_pTable;
+    m_version = m_rShared.m_version.load(std::memory_order_relaxed);
+}
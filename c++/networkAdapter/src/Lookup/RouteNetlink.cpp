@@ -0,0 +1,323 @@
+/*
+ * This file is part of the EMBTOM project
+ * Copyright (c) 2018-2020 Thomas Willetal
+ * (https://github.com/embtom)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+//******************************************************************************
+// Header
+
+#include <algorithm>
+#include <stdexcept>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <net/if.h>
+#include <linux/rtnetlink.h>
+
+#include <error_msg.hpp>
+#include <Lookup/RouteNetlink.hpp>
+
+using namespace EtNet;
+
+namespace
+{
+
+//! a dump is sent in chunks of up to 32 KiB, the buffer holds any of them
+constexpr std::size_t netlinkBuffer = 64 * 1024;
+//! restarts of a dump interrupted by concurrent changes until it is given up
+constexpr unsigned maxDumpAttempts = 8;
+
+CIpAddress maskFromPrefix(uint8_t family, unsigned prefixLength) noexcept
+{
+    if (family == AF_INET)
+    {
+        in_addr mask;
+        mask.s_addr = (prefixLength == 0) ? 0 : htonl(UINT32_MAX << (32 - std::min(prefixLength, 32U)));
+        return CIpAddress(mask);
+    }
+
+    in6_addr mask {};
+    for (unsigned i = 0; i < 16; i++)
+    {
+        unsigned bits = (prefixLength > i * 8) ? std::min(prefixLength - i * 8, 8U) : 0;
+        mask.s6_addr[i] = static_cast<uint8_t>(0xFF00 >> bits);
+    }
+    return CIpAddress(mask);
+}
+
+CIpAddress toAddress(uint8_t family, const rtattr* pAttribute) noexcept
+{
+    if ((family == AF_INET) && (RTA_PAYLOAD(pAttribute) >= sizeof(in_addr)))
+    {
+        in_addr address;
+        memcpy(&address, RTA_DATA(pAttribute), sizeof(address));
+        return CIpAddress(address);
+    }
+    if ((family == AF_INET6) && (RTA_PAYLOAD(pAttribute) >= sizeof(in6_addr)))
+    {
+        in6_addr address;
+        memcpy(&address, RTA_DATA(pAttribute), sizeof(address));
+        return CIpAddress(address);
+    }
+    return CIpAddress();
+}
+
+}
+
+//*****************************************************************************
+// Method definitions "CRouteNetlink"
+
+CRouteNetlink::CRouteNetlink(unsigned groups)
+{
+    m_socketFd = ::socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+    if (m_socketFd < 0) {
+        throw std::runtime_error(utils::buildErrorMessage("CRouteNetlink::", __func__, ": socket: ", strerror(errno)));
+    }
+
+    sockaddr_nl local {};
+    local.nl_family = AF_NETLINK;
+    local.nl_groups = groups;
+    if (::bind(m_socketFd, reinterpret_cast<sockaddr*>(&local), sizeof(local)) != 0)
+    {
+        int error = errno;
+        ::close(m_socketFd);
+        throw std::runtime_error(utils::buildErrorMessage("CRouteNetlink::", __func__, ": bind: ", strerror(error)));
+    }
+}
+
+CRouteNetlink::~CRouteNetlink() noexcept
+{
+    ::close(m_socketFd);
+}
+
+template<typename TCallback>
+bool CRouteNetlink::dump(uint16_t type, uint8_t family, TCallback&& onMessage)
+{
+    struct
+    {
+        nlmsghdr header;
+        rtgenmsg message;
+    } request {};
+    request.header.nlmsg_len   = NLMSG_LENGTH(sizeof(rtgenmsg));
+    request.header.nlmsg_type  = type;
+    request.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    request.header.nlmsg_seq   = ++m_sequence;
+    request.message.rtgen_family = family;
+
+    sockaddr_nl kernel {};
+    kernel.nl_family = AF_NETLINK;
+    while (::sendto(m_socketFd, &request, request.header.nlmsg_len, 0, reinterpret_cast<sockaddr*>(&kernel), sizeof(kernel)) < 0)
+    {
+        if (errno != EINTR) {
+            throw std::runtime_error(utils::buildErrorMessage("CRouteNetlink::", __func__, ": sendto: ", strerror(errno)));
+        }
+    }
+
+    std::vector<uint8_t> buffer(netlinkBuffer);
+    bool interrupted = false;
+    while (true)
+    {
+        iovec iov {buffer.data(), buffer.size()};
+        msghdr msg {};
+        msg.msg_iov    = &iov;
+        msg.msg_iovlen = 1;
+        ssize_t get = ::recvmsg(m_socketFd, &msg, 0);
+        if (get < 0)
+        {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(utils::buildErrorMessage("CRouteNetlink::", __func__, ": recvmsg: ", strerror(errno)));
+        }
+        if (msg.msg_flags & MSG_TRUNC) {
+            throw std::runtime_error(utils::buildErrorMessage("CRouteNetlink::", __func__, ": message truncated"));
+        }
+
+        int length = static_cast<int>(get);
+        for (const nlmsghdr* pMessage = reinterpret_cast<const nlmsghdr*>(buffer.data()); NLMSG_OK(pMessage, length); pMessage = NLMSG_NEXT(pMessage, length))
+        {
+            // Notifications of joined groups are not part of the dump
+            if (pMessage->nlmsg_seq != m_sequence) {
+                continue;
+            }
+            if (pMessage->nlmsg_flags & NLM_F_DUMP_INTR) {
+                interrupted = true;
+            }
+            if (pMessage->nlmsg_type == NLMSG_DONE) {
+                return !interrupted;
+            }
+            if (pMessage->nlmsg_type == NLMSG_ERROR)
+            {
+                const nlmsgerr* pError = static_cast<const nlmsgerr*>(NLMSG_DATA(pMessage));
+                throw std::runtime_error(utils::buildErrorMessage("CRouteNetlink::", __func__, ": dump: ", strerror(-pError->error)));
+            }
+            onMessage(pMessage);
+        }
+    }
+}
+
+std::vector<CRouteNetlink::SLink> CRouteNetlink::dumpLinks()
+{
+    std::vector<SLink> links;
+    for (unsigned attempt = 0; attempt < maxDumpAttempts; attempt++)
+    {
+        links.clear();
+        bool complete = dump(RTM_GETLINK, AF_UNSPEC, [&links](const nlmsghdr* pMessage)
+        {
+            SLink link;
+            if (parseLink(pMessage, link)) {
+                links.push_back(std::move(link));
+            }
+        });
+        if (complete) {
+            return links;
+        }
+    }
+    throw std::runtime_error(utils::buildErrorMessage("CRouteNetlink::", __func__, ": dump interrupted"));
+}
+
+std::vector<CRouteNetlink::SAddress> CRouteNetlink::dumpAddresses()
+{
+    std::vector<SAddress> addresses;
+    for (unsigned attempt = 0; attempt < maxDumpAttempts; attempt++)
+    {
+        addresses.clear();
+        bool complete = dump(RTM_GETADDR, AF_UNSPEC, [&addresses](const nlmsghdr* pMessage)
+        {
+            SAddress address;
+            if (parseAddress(pMessage, address)) {
+                addresses.push_back(std::move(address));
+            }
+        });
+        if (complete) {
+            return addresses;
+        }
+    }
+    throw std::runtime_error(utils::buildErrorMessage("CRouteNetlink::", __func__, ": dump interrupted"));
+}
+
+bool CRouteNetlink::reciveNotifications(const std::function<void (const nlmsghdr* pMessage)>& onMessage)
+{
+    std::vector<uint8_t> buffer(netlinkBuffer);
+    bool complete = true;
+    while (true)
+    {
+        ssize_t get = ::recv(m_socketFd, buffer.data(), buffer.size(), MSG_DONTWAIT);
+        if (get < 0)
+        {
+            switch (errno)
+            {
+                case EINTR:
+                {
+                    continue;
+                }
+                case ENOBUFS:
+                {
+                    // The socket overflowed, the pending notifications are still read
+                    complete = false;
+                    continue;
+                }
+                case EAGAIN:
+                {
+                    return complete;
+                }
+                default:
+                {
+                    throw std::runtime_error(utils::buildErrorMessage("CRouteNetlink::", __func__, ": recv: ", strerror(errno)));
+                }
+            }
+        }
+
+        int length = static_cast<int>(get);
+        for (const nlmsghdr* pMessage = reinterpret_cast<const nlmsghdr*>(buffer.data()); NLMSG_OK(pMessage, length); pMessage = NLMSG_NEXT(pMessage, length)) {
+            onMessage(pMessage);
+        }
+    }
+}
+
+bool CRouteNetlink::parseLink(const nlmsghdr* pMessage, SLink& rLink) noexcept
+{
+    if (((pMessage->nlmsg_type != RTM_NEWLINK) && (pMessage->nlmsg_type != RTM_DELLINK)) ||
+        (pMessage->nlmsg_len < NLMSG_LENGTH(sizeof(ifinfomsg)))) {
+        return false;
+    }
+
+    const ifinfomsg* pInfo = static_cast<const ifinfomsg*>(NLMSG_DATA(pMessage));
+    rLink.index = static_cast<unsigned>(pInfo->ifi_index);
+    rLink.flags = pInfo->ifi_flags;
+
+    int length = static_cast<int>(IFLA_PAYLOAD(pMessage));
+    for (const rtattr* pAttribute = IFLA_RTA(pInfo); RTA_OK(pAttribute, length); pAttribute = RTA_NEXT(pAttribute, length))
+    {
+        switch (pAttribute->rta_type)
+        {
+            case IFLA_IFNAME:
+            {
+                rLink.name = std::string(static_cast<const char*>(RTA_DATA(pAttribute)), strnlen(static_cast<const char*>(RTA_DATA(pAttribute)), RTA_PAYLOAD(pAttribute)));
+                break;
+            }
+            case IFLA_MTU:
+            {
+                if (RTA_PAYLOAD(pAttribute) >= sizeof(uint32_t)) {
+                    memcpy(&rLink.mtu, RTA_DATA(pAttribute), sizeof(uint32_t));
+                }
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+bool CRouteNetlink::parseAddress(const nlmsghdr* pMessage, SAddress& rAddress) noexcept
+{
+    if (((pMessage->nlmsg_type != RTM_NEWADDR) && (pMessage->nlmsg_type != RTM_DELADDR)) ||
+        (pMessage->nlmsg_len < NLMSG_LENGTH(sizeof(ifaddrmsg)))) {
+        return false;
+    }
+
+    const ifaddrmsg* pInfo = static_cast<const ifaddrmsg*>(NLMSG_DATA(pMessage));
+    if ((pInfo->ifa_family != AF_INET) && (pInfo->ifa_family != AF_INET6)) {
+        return false;
+    }
+    rAddress.index = pInfo->ifa_index;
+    rAddress.mask  = maskFromPrefix(pInfo->ifa_family, pInfo->ifa_prefixlen);
+
+    // At a point to point link IFA_ADDRESS is the peer and IFA_LOCAL the own address
+    CIpAddress local;
+    int length = static_cast<int>(IFA_PAYLOAD(pMessage));
+    for (const rtattr* pAttribute = IFA_RTA(pInfo); RTA_OK(pAttribute, length); pAttribute = RTA_NEXT(pAttribute, length))
+    {
+        switch (pAttribute->rta_type)
+        {
+            case IFA_ADDRESS:   rAddress.address   = toAddress(pInfo->ifa_family, pAttribute); break;
+            case IFA_LOCAL:     local              = toAddress(pInfo->ifa_family, pAttribute); break;
+            case IFA_BROADCAST: rAddress.broadcast = toAddress(pInfo->ifa_family, pAttribute); break;
+        }
+    }
+    if (!local.empty()) {
+        rAddress.address = local;
+    }
+    return !rAddress.address.empty();
+}
@@ -0,0 +1,101 @@
+/*
+ * This file is part of the EMBTOM project
+ * Copyright (c) 2018-2020 Thomas Willetal
+ * (https://github.com/embtom)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _ROUTENETLINK_H_
+#define _ROUTENETLINK_H_
+
+//******************************************************************************
+// Header
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+#include <linux/netlink.h>
+#include <IpAddress.hpp>
+
+namespace EtNet
+{
+
+//*****************************************************************************
+//! \brief CRouteNetlink
+//! NETLINK_ROUTE socket to request the links and addresses of the host by a
+//! single dump each, instead of getifaddrs and an ioctl per interface.
+class CRouteNetlink
+{
+public:
+    struct SLink
+    {
+        unsigned    index {0};
+        std::string name;
+        unsigned    flags {0};      //!< IFF_* flags of the interface
+        unsigned    mtu {0};
+    };
+
+    struct SAddress
+    {
+        unsigned   index {0};       //!< index of the link the address is assigned to
+        CIpAddress address;
+        CIpAddress mask;            //!< derived from the prefix length
+        CIpAddress broadcast;       //!< only IPv4
+    };
+
+    CRouteNetlink(const CRouteNetlink&)            = delete;
+    CRouteNetlink& operator=(const CRouteNetlink&) = delete;
+    ~CRouteNetlink() noexcept;
+
+    //! open the socket, it joins the passed RTMGRP_* multicast groups
+    explicit CRouteNetlink(unsigned groups = 0);
+
+    int getFd() const noexcept { return m_socketFd; }
+
+    //! dump of all links, a dump interrupted by a concurrent change is restarted
+    std::vector<SLink> dumpLinks();
+
+    //! dump of all IPv4 and IPv6 addresses
+    std::vector<SAddress> dumpAddresses();
+
+    //! read the pending notifications of the joined groups without blocking. False if
+    //! notifications were lost because of an overflow of the socket (ENOBUFS)
+    bool reciveNotifications(const std::function<void (const nlmsghdr* pMessage)>& onMessage);
+
+    //! parse a RTM_NEWLINK or RTM_DELLINK message
+    static bool parseLink(const nlmsghdr* pMessage, SLink& rLink) noexcept;
+
+    //! parse a RTM_NEWADDR or RTM_DELADDR message
+    static bool parseAddress(const nlmsghdr* pMessage, SAddress& rAddress) noexcept;
+
+private:
+    //! request a dump and pass its messages to the callback, false if the dump was interrupted
+    template<typename TCallback>
+    bool dump(uint16_t type, uint8_t family, TCallback&& onMessage);
+
+    int      m_socketFd {-1};
+    uint32_t m_sequence {0};
+};
+
+} // EtNet
+
+#endif // _ROUTENETLINK_H_
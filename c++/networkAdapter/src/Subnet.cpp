@@ -0,0 +1,265 @@
+/*
+ * This file is part of the EMBTOM project
+ * Copyright (c) 2018-2020 Thomas Willetal
+ * (https://github.com/embtom)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+//******************************************************************************
+// Header
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include <error_msg.hpp>
+#include <Subnet.hpp>
+
+using namespace EtNet;
+
+namespace
+{
+
+unsigned maxLength(const CIpAddress& rAddress) noexcept
+{
+    return rAddress.is_v4() ? 32 : 128;
+}
+
+CIpAddress addressOf(const uint8_t (&rBytes)[16], bool v4) noexcept
+{
+    if (v4)
+    {
+        in_addr address;
+        std::memcpy(&address, rBytes, sizeof(address));
+        return CIpAddress(address);
+    }
+    in6_addr address;
+    std::memcpy(address.s6_addr, rBytes, sizeof(address.s6_addr));
+    return CIpAddress(address);
+}
+
+//! the 16 address bytes in two words
+struct SWords
+{
+    uint64_t lo;
+    uint64_t hi;
+};
+
+SWords wordsOf(const CIpAddress& rAddress) noexcept
+{
+    SWords words;
+    std::memcpy(&words.lo, rAddress.bytes(), sizeof(words.lo));
+    std::memcpy(&words.hi, rAddress.bytes() + sizeof(words.lo), sizeof(words.hi));
+    return words;
+}
+
+}
+
+//*****************************************************************************
+// Method definitions "CSubnet"
+
+CSubnet::CSubnet(const CIpAddress& rAddress, unsigned prefixLength)
+{
+    if (rAddress.empty()) {
+        throw std::invalid_argument(utils::buildErrorMessage("CSubnet::", __func__, ": no address"));
+    }
+    if (prefixLength > maxLength(rAddress)) {
+        throw std::invalid_argument(utils::buildErrorMessage("CSubnet::", __func__, ": invalid prefix length: ", prefixLength));
+    }
+
+    uint8_t mask[16] {};
+    uint8_t network[16] {};
+    for (unsigned bit = 0; bit < prefixLength; bit++) {
+        mask[bit / 8] |= static_cast<uint8_t>(0x80 >> (bit % 8));
+    }
+    for (unsigned i = 0; i < 16; i++) {
+        network[i] = rAddress.bytes()[i] & mask[i];
+    }
+    m_network = addressOf(network, rAddress.is_v4());
+    m_mask    = addressOf(mask, rAddress.is_v4());
+    m_length  = prefixLength;
+}
+
+std::optional<CSubnet> CSubnet::parse(std::string_view text) noexcept
+{
+    const std::size_t slash = text.find('/');
+    auto address = CIpAddress::parse(text.substr(0, slash));
+    if (!address) {
+        return std::nullopt;
+    }
+
+    unsigned length = maxLength(*address);
+    if (slash != std::string_view::npos)
+    {
+        const std::string_view digits = text.substr(slash + 1);
+        if (digits.empty() || (digits.size() > 3)) {
+            return std::nullopt;
+        }
+        length = 0;
+        for (char c : digits)
+        {
+            if ((c < '0') || (c > '9')) {
+                return std::nullopt;
+            }
+            length = 10 * length + static_cast<unsigned>(c - '0');
+        }
+        if (length > maxLength(*address)) {
+            return std::nullopt;
+        }
+    }
+    return CSubnet(*address, length);
+}
+
+std::optional<CSubnet> CSubnet::fromMask(const CIpAddress& rAddress, const CIpAddress& rSubmask) noexcept
+{
+    auto length = maskLength(rSubmask);
+    if (!length || (rAddress.addressFamily() != rSubmask.addressFamily())) {
+        return std::nullopt;
+    }
+    return CSubnet(rAddress, *length);
+}
+
+std::optional<unsigned> CSubnet::maskLength(const CIpAddress& rSubmask) noexcept
+{
+    if (rSubmask.empty()) {
+        return std::nullopt;
+    }
+
+    const uint8_t* pBytes = rSubmask.bytes();
+    const unsigned size = maxLength(rSubmask) / 8;
+    unsigned length = 0;
+    unsigned i = 0;
+    while ((i < size) && (pBytes[i] == 0xFF))
+    {
+        length += 8;
+        i++;
+    }
+    if (i < size)
+    {
+        // The ones of the partial byte are followed by zeros only
+        uint8_t partial = pBytes[i];
+        while (partial & 0x80)
+        {
+            partial = static_cast<uint8_t>(partial << 1);
+            length++;
+        }
+        if (partial != 0) {
+            return std::nullopt;
+        }
+        i++;
+    }
+    for (; i < size; i++)
+    {
+        if (pBytes[i] != 0) {
+            return std::nullopt;
+        }
+    }
+    return length;
+}
+
+CIpAddress CSubnet::broadcast() const noexcept
+{
+    return m_network.broadcast(m_mask);
+}
+
+bool CSubnet::contains(const CIpAddress& rAddress) const noexcept
+{
+    if (empty() || (rAddress.addressFamily() != m_network.addressFamily())) {
+        return false;
+    }
+    const SWords address = wordsOf(rAddress);
+    const SWords mask    = wordsOf(m_mask);
+    const SWords network = wordsOf(m_network);
+    return ((address.lo & mask.lo) == network.lo) && ((address.hi & mask.hi) == network.hi);
+}
+
+bool CSubnet::contains(const CSubnet& rOther) const noexcept
+{
+    return (rOther.m_length >= m_length) && contains(rOther.m_network);
+}
+
+bool CSubnet::overlaps(const CSubnet& rOther) const noexcept
+{
+    return contains(rOther.m_network) || rOther.contains(m_network);
+}
+
+std::size_t CSubnet::contains(utils::span<const CIpAddress> addresses, utils::span<uint64_t> matches) const
+{
+    const std::size_t count = addresses.size();
+    const std::size_t words = (count + 63) / 64;
+    if (matches.size() < words) {
+        throw std::invalid_argument(utils::buildErrorMessage("CSubnet::", __func__, ": ", matches.size(), " match words for ", count, " addresses"));
+    }
+    if (empty())
+    {
+        std::fill(matches.begin(), matches.begin() + words, 0);
+        return 0;
+    }
+
+    // The unused bytes of an IPv4 address are zero, as those of the mask and the
+    // network, so both families are tested by the same 16 byte comparison
+    const EAddressFamily family = m_network.addressFamily();
+    const CIpAddress* pAddresses = addresses.data();
+    std::size_t contained = 0;
+#if defined(__SSE2__)
+    const __m128i mask    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_mask.bytes()));
+    const __m128i network = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_network.bytes()));
+#else
+    const SWords mask    = wordsOf(m_mask);
+    const SWords network = wordsOf(m_network);
+#endif
+
+    for (std::size_t word = 0; word < words; word++)
+    {
+        const std::size_t first = 64 * word;
+        const std::size_t last  = std::min(first + 64, count);
+        uint64_t bits = 0;
+        for (std::size_t i = first; i < last; i++)
+        {
+#if defined(__SSE2__)
+            const __m128i address = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pAddresses[i].bytes()));
+            const bool inNetwork  = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(address, mask), network)) == 0xFFFF;
+#else
+            const SWords address  = wordsOf(pAddresses[i]);
+            const bool inNetwork  = ((address.lo & mask.lo) == network.lo) & ((address.hi & mask.hi) == network.hi);
+#endif
+            bits |= static_cast<uint64_t>(inNetwork & (pAddresses[i].addressFamily() == family)) << (i - first);
+        }
+        matches[word] = bits;
+        contained += static_cast<std::size_t>(__builtin_popcountll(bits));
+    }
+    return contained;
+}
+
+std::string CSubnet::toString() const
+{
+    if (empty()) {
+        return std::string();
+    }
+    return m_network.toString() + "/" + std::to_string(m_length);
+}
+
+bool CSubnet::operator== (const CSubnet& rhs) const noexcept
+{
+    return (m_length == rhs.m_length) && (m_network == rhs.m_network);
+}
@@ -31,14 +31,19 @@
 #include <iostream>
 #include <stdexcept>
 #include <algorithm>
+#include <vector>
+#include <memory>
 
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <string.h>
 #include <netinet/in.h>
+#include <fcntl.h>
+#include <poll.h>
 
 #include <error_msg.hpp>
 #include <Lookup/HostLookup.hpp>
+#include <Lookup/HostCache.hpp>
 #include <IpAddress.hpp>
 #include <BaseSocket.hpp>
 
@@ -53,7 +58,14 @@ class CTcpClientPrivate
 public:
      CTcpClientPrivate(CBaseSocket&& rBaseSocket);
      CTcpDataLink connect(const std::string& rHost, unsigned int port);
+     CTcpDataLink connect(const CIpAddress& rIp, unsigned int port);
+     CTcpDataLink connect(const std::string& rHost, unsigned int port, std::chrono::milliseconds timeout);
+     CTcpDataLink connect(const CIpAddress::IpAddresses& rIpList, unsigned int port, std::chrono::milliseconds timeout);
 private:
+     static CHostLookup::IpAddresses resolve(const std::string& rHost);
+     static CHostLookup::IpAddresses resolve(const std::string& rHost, std::chrono::steady_clock::time_point deadline);
+     CBaseSocket attemptSocket(const CIpAddress& rIp);
+
      CBaseSocket m_baseSocket;
 };
 
@@ -61,22 +73,115 @@ private:
 
 using namespace EtNet;
 
+namespace
+{
+
+socklen_t toSockAddr(const CIpAddress& rIp, unsigned int port, sockaddr_storage& rAddr) noexcept
+{
+    rAddr = sockaddr_storage {};
+    if (rIp.is_v4())
+    {
+        auto& rAddr4 = reinterpret_cast<sockaddr_in&>(rAddr);
+        rAddr4.sin_family = AF_INET;
+        rAddr4.sin_port   = htons(port);
+        std::memcpy(&rAddr4.sin_addr, rIp.to_v4(), sizeof(in_addr));
+        return sizeof(sockaddr_in);
+    }
+
+    auto& rAddr6 = reinterpret_cast<sockaddr_in6&>(rAddr);
+    rAddr6.sin6_family = AF_INET6;
+    rAddr6.sin6_port   = htons(port);
+    std::memcpy(&rAddr6.sin6_addr, rIp.to_v6(), sizeof(in6_addr));
+    return sizeof(sockaddr_in6);
+}
+
+//! reorder the addresses alternating between the families, starting with the
+//! family of the first resolved address (RFC 8305, section 4)
+CHostLookup::IpAddresses interleaveFamilies(const CHostLookup::IpAddresses& rIpList)
+{
+    CHostLookup::IpAddresses primary;
+    CHostLookup::IpAddresses secondary;
+    for (const auto& ip : rIpList)
+    {
+        if (ip.empty()) {
+            continue;
+        }
+        if (primary.empty() || (ip.addressFamily() == primary.front().addressFamily())) {
+            primary.push_back(ip);
+        }
+        else {
+            secondary.push_back(ip);
+        }
+    }
+
+    CHostLookup::IpAddresses ordered;
+    for (std::size_t i = 0; i < std::max(primary.size(), secondary.size()); i++)
+    {
+        if (i < primary.size()) {
+            ordered.push_back(primary[i]);
+        }
+        if (i < secondary.size()) {
+            ordered.push_back(secondary[i]);
+        }
+    }
+    return ordered;
+}
+
+void setNonBlocking(int fd, bool enable)
+{
+    int flags = ::fcntl(fd, F_GETFL);
+    if (flags != -1) {
+        flags = enable ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+        flags = ::fcntl(fd, F_SETFL, flags);
+    }
+    if (flags == -1) {
+        throw std::runtime_error(utils::buildErrorMessage("ConnectSocket::", __func__, ": fcntl: ", strerror(errno)));
+    }
+}
+
+}
+
 //*****************************************************************************
 // Method definitions "CTcpClientPrivate"
 CTcpClientPrivate::CTcpClientPrivate(CBaseSocket&& rBaseSocket) :
     m_baseSocket(std::move(rBaseSocket))
 { }
 
-CTcpDataLink CTcpClientPrivate::connect(const std::string& rHost, unsigned int port)
+CHostLookup::IpAddresses CTcpClientPrivate::resolve(const std::string& rHost)
 {
-    CHostLookup::IpAddresses ipList;
-    try  { ipList = CHostLookup(CIpAddress(rHost)).addresses(); }  catch(...) {  }
+    // A literal address needs no lookup
+    if (auto literal = CIpAddress::parse(rHost)) {
+        return CHostLookup::IpAddresses{*literal};
+    }
 
-    if (ipList.empty())
-    {
-        ipList = CHostLookup(rHost).addresses();
+    return CHostLookup(rHost).addresses();
+}
+
+CHostLookup::IpAddresses CTcpClientPrivate::resolve(const std::string& rHost, std::chrono::steady_clock::time_point deadline)
+{
+    // A literal address needs no lookup
+    if (auto literal = CIpAddress::parse(rHost)) {
+        return CHostLookup::IpAddresses{*literal};
     }
 
+    // getaddrinfo has no timeout, the name is resolved by the thread of the host
+    // cache. The lookup gives up at the deadline, the resolution still fills the cache
+    return CHostCache::instance().addresses(rHost, deadline);
+}
+
+CBaseSocket CTcpClientPrivate::attemptSocket(const CIpAddress& rIp)
+{
+    int domain = rIp.is_v4() ? AF_INET : AF_INET6;
+    if (m_baseSocket.isValid() && (m_baseSocket.getDomain() == domain)) {
+        return std::move(m_baseSocket);
+    }
+    return CBaseSocket(rIp.is_v4() ? ESocketMode::INET_STREAM : ESocketMode::INET6_STREAM);
+}
+
+CTcpDataLink CTcpClientPrivate::connect(const std::string& rHost, unsigned int port)
+{
+    CHostLookup::IpAddresses ipList = resolve(rHost);
+
     int domain = m_baseSocket.getDomain();
     auto it = std::find_if(ipList.begin(), ipList.end(),[&domain] (const auto &elm)
     {
@@ -94,24 +199,32 @@ CTcpDataLink CTcpClientPrivate::connect(const std::string& rHost, unsigned int p
     if (it == ipList.end()) {
         throw std::runtime_error(utils::buildErrorMessage("CTcpClient: ", __func__, " : No valid Ip available"));
     }
+    return connect(*it, port);
+}
+
+CTcpDataLink CTcpClientPrivate::connect(const CIpAddress& rIp, unsigned int port)
+{
+    if (rIp.is_v4() != (m_baseSocket.getDomain() == AF_INET)) {
+        throw std::runtime_error(utils::buildErrorMessage("CTcpClient: ", __func__, " : Ip does not match the socket domain"));
+    }
 
-    if ((*it).is_v4())
+    if (rIp.is_v4())
     {
         sockaddr_in serverAddr{};
         serverAddr.sin_family       = AF_INET;
         serverAddr.sin_port         = htons(port);
-        std::memcpy(&serverAddr.sin_addr, (*it).to_v4(), sizeof(in_addr));
+        std::memcpy(&serverAddr.sin_addr, rIp.to_v4(), sizeof(in_addr));
 
         if (::connect(m_baseSocket.getFd(), (sockaddr*)&serverAddr, sizeof(serverAddr)) != 0) {
             throw std::runtime_error(utils::buildErrorMessage("ConnectSocket::", __func__, ": connect: ", strerror(errno)));
         }
     }
-    else if((*it).is_v6())
+    else if(rIp.is_v6())
     {
         sockaddr_in6 serverAddr{};
         serverAddr.sin6_family       = AF_INET6;
         serverAddr.sin6_port         = htons(port);
-        std::memcpy(&serverAddr.sin6_addr, (*it).to_v6(), sizeof(in6_addr));
+        std::memcpy(&serverAddr.sin6_addr, rIp.to_v6(), sizeof(in6_addr));
 
         if (::connect(m_baseSocket.getFd(), (sockaddr*)&serverAddr, sizeof(serverAddr)) != 0) {
             throw std::runtime_error(utils::buildErrorMessage("ConnectSocket::", __func__, ": connect: ", strerror(errno)));
@@ -124,6 +237,127 @@ CTcpDataLink CTcpClientPrivate::connect(const std::string& rHost, unsigned int p
     return CTcpDataLink(std::move(m_baseSocket));
 }
 
+CTcpDataLink CTcpClientPrivate::connect(const std::string& rHost, unsigned int port, std::chrono::milliseconds timeout)
+{
+    // The lookup is part of the timeout
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point deadline = Clock::now() + timeout;
+    CHostLookup::IpAddresses ipList = resolve(rHost, deadline);
+    auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now());
+    return connect(ipList, port, std::max(remaining, std::chrono::milliseconds(0)));
+}
+
+CTcpDataLink CTcpClientPrivate::connect(const CIpAddress::IpAddresses& rIpList, unsigned int port, std::chrono::milliseconds timeout)
+{
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point deadline = Clock::now() + timeout;
+
+    CHostLookup::IpAddresses ipList = interleaveFamilies(rIpList);
+    if (ipList.empty()) {
+        throw std::runtime_error(utils::buildErrorMessage("CTcpClient: ", __func__, " : No valid Ip available"));
+    }
+
+    // Sockets of the attempts in flight and their poll entries share the index
+    std::vector<CBaseSocket> attempts;
+    std::vector<pollfd> pollFds;
+    std::size_t nextIp = 0;
+    int lastError = ETIMEDOUT;
+    Clock::time_point nextStart = Clock::now();
+
+    auto established = [](CBaseSocket&& rSocket)
+    {
+        setNonBlocking(rSocket.getFd(), false);
+        return CTcpDataLink(std::move(rSocket));
+    };
+
+    while (true)
+    {
+        Clock::time_point now = Clock::now();
+        if (now >= deadline) {
+            break;
+        }
+
+        if ((nextIp < ipList.size()) && ((now >= nextStart) || attempts.empty()))
+        {
+            const CIpAddress& rIp = ipList[nextIp++];
+            CBaseSocket socket;
+            try {
+                socket = attemptSocket(rIp);
+            }
+            catch (const std::runtime_error&) {
+                // e.g. IPv6 is not available at the host, skip this family
+                lastError = EAFNOSUPPORT;
+                continue;
+            }
+            setNonBlocking(socket.getFd(), true);
+
+            sockaddr_storage serverAddr;
+            socklen_t length = toSockAddr(rIp, port, serverAddr);
+            if (::connect(socket.getFd(), reinterpret_cast<sockaddr*>(&serverAddr), length) == 0) {
+                return established(std::move(socket));
+            }
+            if (errno != EINPROGRESS)
+            {
+                // Failed immediately, the next address is tried without delay
+                lastError = errno;
+                nextStart = now;
+                continue;
+            }
+
+            pollFds.push_back(pollfd{socket.getFd(), POLLOUT, 0});
+            attempts.push_back(std::move(socket));
+            nextStart = now + connectionAttemptDelay;
+        }
+
+        if (attempts.empty())
+        {
+            if (nextIp >= ipList.size()) {
+                break;
+            }
+            continue;
+        }
+
+        Clock::time_point wakeup = (nextIp < ipList.size()) ? std::min(nextStart, deadline) : deadline;
+        auto wait = std::chrono::ceil<std::chrono::milliseconds>(wakeup - now);
+        int ret = ::poll(pollFds.data(), pollFds.size(), static_cast<int>(std::max<std::chrono::milliseconds::rep>(wait.count(), 0)));
+        if (ret < 0)
+        {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(utils::buildErrorMessage("ConnectSocket::", __func__, ": poll: ", strerror(errno)));
+        }
+
+        for (std::size_t i = 0; i < pollFds.size();)
+        {
+            if (pollFds[i].revents == 0) {
+                i++;
+                continue;
+            }
+
+            int error = 0;
+            socklen_t errorLength = sizeof(error);
+            if (::getsockopt(pollFds[i].fd, SOL_SOCKET, SO_ERROR, &error, &errorLength) != 0) {
+                error = errno;
+            }
+            if (error == 0) {
+                return established(std::move(attempts[i]));
+            }
+
+            // A failed attempt starts the next one without waiting for the delay
+            lastError = error;
+            nextStart = Clock::now();
+            attempts.erase(attempts.begin() + i);
+            pollFds.erase(pollFds.begin() + i);
+        }
+    }
+
+    if (!attempts.empty() || (nextIp < ipList.size())) {
+        lastError = ETIMEDOUT;
+    }
+    throw std::runtime_error(utils::buildErrorMessage("ConnectSocket::", __func__, ": connect: ", strerror(lastError)));
+}
+
 //*****************************************************************************
 // Method definitions "CTcpClient"
 
@@ -137,3 +371,18 @@ CTcpDataLink CTcpClient::connect(const std::string& rHost, unsigned int port)
 {
      return m_pPrivate->connect(rHost,port);
 }
+
+CTcpDataLink CTcpClient::connect(const std::string& rHost, unsigned int port, std::chrono::milliseconds timeout)
+{
+     return m_pPrivate->connect(rHost, port, timeout);
+}
+
+CTcpDataLink CTcpClient::connect(const CIpAddress& rIp, unsigned int port)
+{
+     return m_pPrivate->connect(rIp, port);
+}
+
+CTcpDataLink CTcpClient::connect(const CIpAddress::IpAddresses& rIpList, unsigned int port, std::chrono::milliseconds timeout)
+{
+     return m_pPrivate->connect(rIpList, port, timeout);
+}
@@ -0,0 +1,313 @@
+/*
+ * This file is part of the EMBTOM project
+ * Copyright (c) 2018-2020 Thomas Willetal
+ * (https://github.com/embtom)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+//******************************************************************************
+// Header
+
+#include <stdexcept>
+#include <exception>
+#include <deque>
+#include <vector>
+#include <utility>
+#include <mutex>
+#include <condition_variable>
+#include <unordered_map>
+
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+
+#include <error_msg.hpp>
+#include <BaseSocket.hpp>
+#include <Tcp/TcpClient.hpp>
+#include <Tcp/TcpConnectionPool.hpp>
+
+namespace EtNet
+{
+
+//*****************************************************************************
+//! \brief CTcpConnectionPoolPrivate
+//!
+class CTcpConnectionPoolPrivate : public std::enable_shared_from_this<CTcpConnectionPoolPrivate>
+{
+public:
+    CTcpConnectionPoolPrivate(std::size_t maxPerBackend, std::chrono::milliseconds idleTimeout, std::chrono::milliseconds connectTimeout);
+
+    CTcpConnectionPool::CLease acquire(const std::string& rHost, unsigned int port, std::chrono::milliseconds waitTimeout);
+    void giveBack(const std::string& rKey, CTcpDataLink&& rLink, bool reuse) noexcept;
+    void clear() noexcept;
+    CTcpConnectionPool::SStats getStats() const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct SIdle
+    {
+        CTcpDataLink     link;
+        Clock::time_point since;
+    };
+
+    struct SBackend
+    {
+        std::deque<SIdle> idle;     //!< the most recently returned connection is at the back
+        std::size_t       leased {0};
+    };
+
+    //! an idle connection is healthy if the peer has not closed it and no data is pending
+    static bool isHealthy(const CTcpDataLink& rLink) noexcept;
+
+    const std::size_t               m_maxPerBackend;
+    const std::chrono::milliseconds m_idleTimeout;
+    const std::chrono::milliseconds m_connectTimeout;
+
+    mutable std::mutex      m_mutex;
+    std::condition_variable m_returned;
+    std::unordered_map<std::string, SBackend> m_backends;
+    CTcpConnectionPool::SStats m_stats;
+};
+
+}
+
+using namespace EtNet;
+
+//*****************************************************************************
+// Method definitions "CTcpConnectionPoolPrivate"
+
+CTcpConnectionPoolPrivate::CTcpConnectionPoolPrivate(std::size_t maxPerBackend, std::chrono::milliseconds idleTimeout, std::chrono::milliseconds connectTimeout) :
+    m_maxPerBackend(maxPerBackend),
+    m_idleTimeout(idleTimeout),
+    m_connectTimeout(connectTimeout)
+{
+    if (m_maxPerBackend == 0) {
+        throw std::invalid_argument(utils::buildErrorMessage("CTcpConnectionPool::", __func__, ": at least one connection per backend required"));
+    }
+}
+
+bool CTcpConnectionPoolPrivate::isHealthy(const CTcpDataLink& rLink) noexcept
+{
+    uint8_t probe;
+    ssize_t get = ::recv(rLink.getFd(), &probe, sizeof(probe), MSG_PEEK | MSG_DONTWAIT);
+    if (get == -1) {
+        return (errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR);
+    }
+    // Closed by the peer or stale data of a previous exchange
+    return false;
+}
+
+CTcpConnectionPool::CLease CTcpConnectionPoolPrivate::acquire(const std::string& rHost, unsigned int port, std::chrono::milliseconds waitTimeout)
+{
+    const std::string key = rHost + ":" + std::to_string(port);
+    const Clock::time_point deadline = Clock::now() + waitTimeout;
+
+    std::vector<CTcpDataLink> dropped;
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        SBackend& rBackend = m_backends[key];
+        while (true)
+        {
+            // The most recently used connection is preferred, it is the most likely alive
+            // and has the largest congestion window
+            const Clock::time_point now = Clock::now();
+            while (!rBackend.idle.empty())
+            {
+                SIdle entry = std::move(rBackend.idle.back());
+                rBackend.idle.pop_back();
+                m_stats.idle--;
+
+                if ((now - entry.since < m_idleTimeout) && isHealthy(entry.link))
+                {
+                    rBackend.leased++;
+                    m_stats.leased++;
+                    m_stats.reuses++;
+                    lock.unlock();
+                    return CTcpConnectionPool::CLease(weak_from_this(), key, std::move(entry.link));
+                }
+                m_stats.dropped++;
+                dropped.push_back(std::move(entry.link));
+            }
+
+            if (rBackend.leased < m_maxPerBackend) {
+                break;
+            }
+
+            if (waitTimeout.count() < 0) {
+                m_returned.wait(lock);
+            }
+            else if (m_returned.wait_until(lock, deadline) == std::cv_status::timeout)
+            {
+                throw std::runtime_error(utils::buildErrorMessage("CTcpConnectionPool::", __func__, ": ", key, ": ", strerror(ETIMEDOUT)));
+            }
+        }
+        // The slot is reserved while connecting without the lock held
+        rBackend.leased++;
+        m_stats.leased++;
+    }
+    dropped.clear();
+
+    try
+    {
+        CTcpClient client(CBaseSocket(ESocketMode::INET_STREAM));
+        CTcpDataLink link = client.connect(rHost, port, m_connectTimeout);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.connects++;
+        return CTcpConnectionPool::CLease(weak_from_this(), key, std::move(link));
+    }
+    catch (...)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_backends[key].leased--;
+            m_stats.leased--;
+        }
+        m_returned.notify_all();
+        throw;
+    }
+}
+
+void CTcpConnectionPoolPrivate::giveBack(const std::string& rKey, CTcpDataLink&& rLink, bool reuse) noexcept
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_backends.find(rKey);
+        if (it != m_backends.end())
+        {
+            it->second.leased--;
+            m_stats.leased--;
+            if (reuse)
+            {
+                it->second.idle.push_back(SIdle{std::move(rLink), Clock::now()});
+                m_stats.idle++;
+            }
+        }
+    }
+    m_returned.notify_all();
+}
+
+void CTcpConnectionPoolPrivate::clear() noexcept
+{
+    // The connections are closed without the lock held
+    std::vector<std::deque<SIdle>> dropped;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& backend : m_backends)
+    {
+        m_stats.dropped += backend.second.idle.size();
+        dropped.push_back(std::move(backend.second.idle));
+        backend.second.idle.clear();
+    }
+    m_stats.idle = 0;
+}
+
+CTcpConnectionPool::SStats CTcpConnectionPoolPrivate::getStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+//*****************************************************************************
+// Method definitions "CTcpConnectionPool::CLease"
+
+CTcpConnectionPool::CLease::CLease(std::weak_ptr<CTcpConnectionPoolPrivate> pPool, std::string key, CTcpDataLink link) noexcept :
+    m_pPool(std::move(pPool)),
+    m_key(std::move(key)),
+    m_link(std::move(link)),
+    m_leased(true),
+    m_uncaught(std::uncaught_exceptions())
+{ }
+
+CTcpConnectionPool::CLease::CLease(CLease&& rhs) noexcept :
+    m_pPool(std::move(rhs.m_pPool)),
+    m_key(std::move(rhs.m_key)),
+    m_link(std::move(rhs.m_link)),
+    m_leased(std::exchange(rhs.m_leased, false)),
+    m_uncaught(rhs.m_uncaught)
+{ }
+
+CTcpConnectionPool::CLease& CTcpConnectionPool::CLease::operator=(CLease&& rhs) noexcept
+{
+    if (this != &rhs)
+    {
+        release();
+        m_pPool  = std::move(rhs.m_pPool);
+        m_key    = std::move(rhs.m_key);
+        m_link   = std::move(rhs.m_link);
+        m_leased = std::exchange(rhs.m_leased, false);
+        m_uncaught = rhs.m_uncaught;
+    }
+    return *this;
+}
+
+CTcpConnectionPool::CLease::~CLease() noexcept
+{
+    // An exception raised while the connection was leased may have interrupted an exchange
+    giveBack(std::uncaught_exceptions() <= m_uncaught);
+}
+
+void CTcpConnectionPool::CLease::release() noexcept
+{
+    giveBack(true);
+}
+
+void CTcpConnectionPool::CLease::discard() noexcept
+{
+    giveBack(false);
+}
+
+void CTcpConnectionPool::CLease::giveBack(bool reuse) noexcept
+{
+    if (!m_leased) {
+        return;
+    }
+    m_leased = false;
+    // Without the pool the connection is closed with the link
+    if (auto pPool = m_pPool.lock()) {
+        pPool->giveBack(m_key, std::move(m_link), reuse);
+    }
+    m_link = CTcpDataLink();
+}
+
+//*****************************************************************************
+// Method definitions "CTcpConnectionPool"
+
+CTcpConnectionPool::CTcpConnectionPool(std::size_t maxPerBackend, std::chrono::milliseconds idleTimeout, std::chrono::milliseconds connectTimeout) :
+    m_pPrivate(std::make_shared<CTcpConnectionPoolPrivate>(maxPerBackend, idleTimeout, connectTimeout))
+{ }
+
+CTcpConnectionPool::~CTcpConnectionPool() noexcept = default;
+
+CTcpConnectionPool::CLease CTcpConnectionPool::acquire(const std::string& rHost, unsigned int port, std::chrono::milliseconds waitTimeout)
+{
+    return m_pPrivate->acquire(rHost, port, waitTimeout);
+}
+
+void CTcpConnectionPool::clear() noexcept
+{
+    m_pPrivate->clear();
+}
+
+CTcpConnectionPool::SStats CTcpConnectionPool::getStats() const
+{
+    return m_pPrivate->getStats();
+}
@@ -28,21 +28,83 @@
 
 #include <iostream>
 #include <stdexcept>
+#include <deque>
+#include <mutex>
+#include <array>
+#include <vector>
+#include <algorithm>
+#include <climits>
 
 #include <unistd.h>
 #include <errno.h>
 #include <string.h>
+#include <poll.h>
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <sys/stat.h>
+#include <sys/sendfile.h>
 
 #include <fdSet.h>
 #include <error_msg.hpp>
 #include <BaseSocket.hpp>
+#include <IoEngine/IoUring.hpp>
 #include <Tcp/TcpDataLink.hpp>
+#include <Tcp/TcpZeroCopy.hpp>
 
 namespace EtNet
 {
+    //*****************************************************************************
+    //! \brief CTcpUringEngine
+    //! io_uring transfer of a TcpDataLink. A multishot recv fills the buffers of a
+    //! provided buffer ring and the recive call copies the data out of them.
+    //! The unblock eventfd is watched by a multishot poll at the same ring.
+    class CTcpUringEngine
+    {
+    public:
+        CTcpUringEngine(int socketFd);
+        ~CTcpUringEngine() noexcept;
+
+        void send(const utils::span<const uint8_t>& rTxSpan);
+        void send(iovec* pIov, std::size_t count);
+        CTcpDataLink::ERet recive(utils::span<uint8_t>& rRxSpan, CTcpDataLink::CallbackReceive& scanForEnd);
+        bool unblock() noexcept;
+
+    private:
+        static constexpr unsigned ringEntries = 16;
+        static constexpr uint16_t bufferCount = 16;
+        static constexpr uint32_t bufferSize  = 4096;
+
+        enum ETag : uint64_t
+        {
+            TAG_RECV = 1,
+            TAG_UNBLOCK
+        };
+
+        struct SChunk
+        {
+            uint16_t bufferId;
+            uint32_t offset;
+            uint32_t length;
+        };
+
+        bool waitForData();
+
+        int                 m_socketFd;
+        int                 m_unblockFd {-1};
+        CIoUring            m_rxRing;
+        CBufferRing         m_bufferRing;
+        std::deque<SChunk>  m_pending;
+        bool                m_recvArmed {false};
+        bool                m_pollArmed {false};
+        bool                m_closed    {false};
+
+        std::mutex          m_txMutex;
+        CIoUring            m_txRing;
+    };
+
     class CTcpDataLinkPrivate : public std::enable_shared_from_this<CTcpDataLinkPrivate>
     {
     public:
@@ -51,20 +113,308 @@ namespace EtNet
         CTcpDataLinkPrivate(CBaseSocket&& rBaseSocket) noexcept;
         ~CTcpDataLinkPrivate() noexcept;
         void send(const utils::span<const uint8_t>& rTxSpan) const;
+        void send(utils::span<const utils::span<const uint8_t>> parts) const;
+        std::size_t sendFile(int fileFd, off_t offset, std::size_t length, CTcpDataLink::CallbackProgress& rProgress) const;
 
         bool unblockRecive() noexcept;
         CTcpDataLink::ERet recive(utils::span<uint8_t>& rRxSpan, CTcpDataLink::CallbackReceive scanForEnd);
+        CTcpDataLink::ERet tryRecive(utils::span<uint8_t>& rRxSpan);
+        std::size_t trySend(const utils::span<const uint8_t>& rTxSpan) const;
+        int getFd() const noexcept;
+        EIoEngine setIoEngine(EIoEngine engine);
+        EIoEngine getIoEngine() const noexcept;
+        bool setZeroCopy(std::size_t threshold);
+        void sendZeroCopy(const utils::span<const uint8_t>& rTxSpan, CTcpDataLink::CallbackRelease onRelease);
+        std::size_t flushZeroCopy(std::chrono::milliseconds timeout);
+        CTcpDataLink::SZeroCopyStats getZeroCopyStats() const;
 
     private:
         void reciveImpl(utils::span<uint8_t>& rRxSpan, CTcpDataLink::CallbackReceive scanForEnd);
 
         utils::CFdSet   m_FdSet;
         CBaseSocket     m_baseSocket;
+        std::unique_ptr<CTcpUringEngine> m_pUring;
+        std::unique_ptr<CTcpZeroCopy>    m_pZeroCopy;
     };
 }
 
 using namespace EtNet;
 
+namespace
+{
+
+//! number of iovec entries kept on the stack by a scatter-gather transmit
+constexpr std::size_t gatherStackParts = 16;
+
+//! amount of data passed to a single sendfile call, it limits the interval
+//! of the progress reports of a file transmit
+constexpr std::size_t sendFileChunk = 1024 * 1024;
+
+//! skip the written data at the iovec array. Completely written entries are
+//! dropped and a partially written entry is adjusted to its remaining data.
+void advanceIovec(iovec*& rpIov, std::size_t& rCount, std::size_t written) noexcept
+{
+    while ((rCount > 0) && (written >= rpIov->iov_len))
+    {
+        written -= rpIov->iov_len;
+        rpIov++;
+        rCount--;
+    }
+    if (rCount > 0)
+    {
+        rpIov->iov_base = static_cast<uint8_t*>(rpIov->iov_base) + written;
+        rpIov->iov_len -= written;
+    }
+}
+
+}
+
+//*****************************************************************************
+// Method definitions "CTcpUringEngine"
+
+CTcpUringEngine::CTcpUringEngine(int socketFd) :
+    m_socketFd(socketFd),
+    m_rxRing(ringEntries),
+    m_bufferRing(m_rxRing, 0, bufferCount, bufferSize),
+    m_txRing(ringEntries)
+{
+    m_unblockFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_unblockFd < 0) {
+        throw std::runtime_error(utils::buildErrorMessage("CTcpUringEngine::", __func__, ": eventfd: ", strerror(errno)));
+    }
+}
+
+CTcpUringEngine::~CTcpUringEngine() noexcept
+{
+    // The armed recv picks buffers of the buffer ring, it has to be finished
+    // before the buffer ring is unregistered and unmapped.
+    m_rxRing.cancelAll();
+    ::close(m_unblockFd);
+}
+
+void CTcpUringEngine::send(const utils::span<const uint8_t>& rTxSpan)
+{
+    std::lock_guard<std::mutex> lock(m_txMutex);
+    std::size_t dataWritten = 0;
+
+    while(dataWritten < rTxSpan.size_bytes())
+    {
+        io_uring_sqe* pSqe = m_txRing.getSqe();
+        pSqe->opcode    = IORING_OP_SEND;
+        pSqe->fd        = m_socketFd;
+        pSqe->addr      = reinterpret_cast<uint64_t>(rTxSpan.data() + dataWritten);
+        pSqe->len       = static_cast<uint32_t>(rTxSpan.size_bytes() - dataWritten);
+        pSqe->msg_flags = MSG_NOSIGNAL;
+
+        io_uring_cqe cqe;
+        m_txRing.wait(cqe);
+        if (cqe.res < 0)
+        {
+            switch(-cqe.res)
+            {
+                case EINTR:      [[fallthrough]];
+                case EAGAIN:
+                {
+                    // Temporary Error, retry.
+                    continue;
+                }
+                case EINVAL:     [[fallthrough]];
+                case EBADF:      [[fallthrough]];
+                case ECONNRESET: [[fallthrough]];
+                case ENXIO:      [[fallthrough]];
+                case EPIPE:
+                {
+                    throw std::domain_error(utils::buildErrorMessage("DataSocket::", __func__, ": write: critical error: ", strerror(-cqe.res)));
+                }
+                default:
+                {
+                    throw std::runtime_error(utils::buildErrorMessage("DataSocket::", __func__, ": write: returned -1: ", strerror(-cqe.res)));
+                }
+            }
+        }
+        dataWritten += static_cast<std::size_t>(cqe.res);
+    }
+}
+
+void CTcpUringEngine::send(iovec* pIov, std::size_t count)
+{
+    std::lock_guard<std::mutex> lock(m_txMutex);
+    advanceIovec(pIov, count, 0);
+
+    while (count > 0)
+    {
+        msghdr msg {};
+        msg.msg_iov    = pIov;
+        msg.msg_iovlen = std::min<std::size_t>(count, IOV_MAX);
+
+        io_uring_sqe* pSqe = m_txRing.getSqe();
+        pSqe->opcode    = IORING_OP_SENDMSG;
+        pSqe->fd        = m_socketFd;
+        pSqe->addr      = reinterpret_cast<uint64_t>(&msg);
+        pSqe->len       = 1;
+        pSqe->msg_flags = MSG_NOSIGNAL;
+
+        io_uring_cqe cqe;
+        m_txRing.wait(cqe);
+        if (cqe.res < 0)
+        {
+            switch(-cqe.res)
+            {
+                case EINTR:      [[fallthrough]];
+                case EAGAIN:
+                {
+                    // Temporary Error, retry.
+                    continue;
+                }
+                case EINVAL:     [[fallthrough]];
+                case EBADF:      [[fallthrough]];
+                case ECONNRESET: [[fallthrough]];
+                case ENXIO:      [[fallthrough]];
+                case EPIPE:
+                {
+                    throw std::domain_error(utils::buildErrorMessage("DataSocket::", __func__, ": sendmsg: critical error: ", strerror(-cqe.res)));
+                }
+                default:
+                {
+                    throw std::runtime_error(utils::buildErrorMessage("DataSocket::", __func__, ": sendmsg: returned -1: ", strerror(-cqe.res)));
+                }
+            }
+        }
+        advanceIovec(pIov, count, static_cast<std::size_t>(cqe.res));
+    }
+}
+
+CTcpDataLink::ERet CTcpUringEngine::recive(utils::span<uint8_t>& rRxSpan, CTcpDataLink::CallbackReceive& scanForEnd)
+{
+    std::size_t dataRead = 0;
+    uint8_t* readBuffer = rRxSpan.data();
+
+    while(dataRead < rRxSpan.size_bytes())
+    {
+        if (m_pending.empty())
+        {
+            // A pending unblock request is reported even if the peer has already closed
+            uint64_t cnt;
+            if (m_closed && (::read(m_unblockFd, &cnt, sizeof(cnt)) <= 0)) {
+                break;
+            }
+            if (m_closed || waitForData()) {
+                rRxSpan = utils::span<uint8_t>(readBuffer, dataRead);
+                return CTcpDataLink::ERet::UNBLOCK;
+            }
+            continue;
+        }
+
+        SChunk& rChunk = m_pending.front();
+        std::size_t get = std::min<std::size_t>(rChunk.length, rRxSpan.size_bytes() - dataRead);
+        std::memcpy(readBuffer + dataRead, m_bufferRing.buffer(rChunk.bufferId) + rChunk.offset, get);
+        rChunk.offset += get;
+        rChunk.length -= get;
+        if (rChunk.length == 0) {
+            m_bufferRing.recycle(rChunk.bufferId);
+            m_pending.pop_front();
+        }
+
+        dataRead += get;
+        if (scanForEnd(utils::span<uint8_t>(readBuffer, dataRead))) {
+            break;
+        }
+    }
+    rRxSpan = utils::span<uint8_t>(readBuffer, dataRead);
+    return CTcpDataLink::ERet::OK;
+}
+
+bool CTcpUringEngine::waitForData()
+{
+    // The recv and the poll of the unblock event stay armed across calls,
+    // rearming is only required if the kernel terminated the multishot operation.
+    if (!m_recvArmed)
+    {
+        io_uring_sqe* pSqe = m_rxRing.getSqe();
+        pSqe->opcode    = IORING_OP_RECV;
+        pSqe->fd        = m_socketFd;
+        pSqe->flags     = IOSQE_BUFFER_SELECT;
+        pSqe->ioprio    = IORING_RECV_MULTISHOT;
+        pSqe->buf_group = m_bufferRing.groupId();
+        pSqe->user_data = TAG_RECV;
+        m_recvArmed = true;
+    }
+    if (!m_pollArmed)
+    {
+        io_uring_sqe* pSqe = m_rxRing.getSqe();
+        pSqe->opcode        = IORING_OP_POLL_ADD;
+        pSqe->fd            = m_unblockFd;
+        pSqe->len           = IORING_POLL_ADD_MULTI;
+        pSqe->poll32_events = POLLIN;
+        pSqe->user_data     = TAG_UNBLOCK;
+        m_pollArmed = true;
+    }
+
+    bool unblocked = false;
+    io_uring_cqe cqe;
+    m_rxRing.wait(cqe);
+    do
+    {
+        bool more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+        switch (cqe.user_data)
+        {
+            case TAG_RECV:
+            {
+                m_recvArmed = more;
+                if (cqe.res > 0) {
+                    uint16_t bufferId = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+                    m_pending.push_back(SChunk{bufferId, 0, static_cast<uint32_t>(cqe.res)});
+                }
+                else if (cqe.res == 0) {
+                    m_closed = true;
+                }
+                else
+                {
+                    switch(-cqe.res)
+                    {
+                        case ENOBUFS:   [[fallthrough]];
+                        case EINTR:     [[fallthrough]];
+                        case ETIMEDOUT: [[fallthrough]];
+                        case EAGAIN:
+                        {
+                            // Temporary error, the recv is armed again
+                            break;
+                        }
+                        case ECONNRESET:[[fallthrough]];
+                        case ENOTCONN:
+                        {
+                            // Connection broken, handled as closed connection
+                            m_closed = true;
+                            break;
+                        }
+                        default:
+                        {
+                            throw std::runtime_error(utils::buildErrorMessage("DataSocket::", __func__, ": read: returned: ", strerror(-cqe.res)));
+                        }
+                    }
+                }
+                break;
+            }
+            case TAG_UNBLOCK:
+            {
+                m_pollArmed = more;
+                uint64_t cnt;
+                while (::read(m_unblockFd, &cnt, sizeof(cnt)) > 0) { }
+                unblocked = true;
+                break;
+            }
+        }
+    } while (m_rxRing.peek(cqe));
+
+    return unblocked;
+}
+
+bool CTcpUringEngine::unblock() noexcept
+{
+    uint64_t one = 1;
+    return ::write(m_unblockFd, &one, sizeof(one)) == sizeof(one);
+}
+
 //*****************************************************************************
 // Method definitions "CTcpDataLinkPrivate"
 
@@ -98,6 +448,11 @@ CTcpDataLinkPrivate::~CTcpDataLinkPrivate() noexcept
 
 void CTcpDataLinkPrivate::send(const utils::span<const uint8_t>& rTxSpan) const
 {
+    if (m_pUring) {
+        m_pUring->send(rTxSpan);
+        return;
+    }
+
     std::size_t dataWritten = 0;
 
     while(dataWritten < rTxSpan.size_bytes())
@@ -146,8 +501,144 @@ void CTcpDataLinkPrivate::send(const utils::span<const uint8_t>& rTxSpan) const
     return;
 }
 
+void CTcpDataLinkPrivate::send(utils::span<const utils::span<const uint8_t>> parts) const
+{
+    std::array<iovec, gatherStackParts> stackIov;
+    std::vector<iovec> heapIov;
+    iovec* pIov = stackIov.data();
+    if (parts.size() > stackIov.size()) {
+        heapIov.resize(parts.size());
+        pIov = heapIov.data();
+    }
+
+    std::size_t count = parts.size();
+    for (std::size_t i = 0; i < count; i++) {
+        pIov[i] = iovec {const_cast<uint8_t*>(parts[i].data()), parts[i].size_bytes()};
+    }
+
+    if (m_pUring) {
+        m_pUring->send(pIov, count);
+        return;
+    }
+
+    // Empty parts are skipped, otherwise a sendmsg of a zero length is issued
+    advanceIovec(pIov, count, 0);
+    while (count > 0)
+    {
+        msghdr msg {};
+        msg.msg_iov    = pIov;
+        msg.msg_iovlen = std::min<std::size_t>(count, IOV_MAX);
+
+        ssize_t put = ::sendmsg(m_baseSocket.getFd(), &msg, MSG_NOSIGNAL);
+        if (put == -1)
+        {
+            switch(errno)
+            {
+                case EINVAL:     [[fallthrough]];
+                case EBADF:      [[fallthrough]];
+                case ECONNRESET: [[fallthrough]];
+                case ENXIO:      [[fallthrough]];
+                case EPIPE:
+                {
+                    // Fatal error
+                    throw std::domain_error(utils::buildErrorMessage("DataSocket::", __func__, ": sendmsg: critical error: ", strerror(errno)));
+                }
+                case EDQUOT:     [[fallthrough]];
+                case EFBIG:      [[fallthrough]];
+                case EIO:        [[fallthrough]];
+                case ENETDOWN:   [[fallthrough]];
+                case ENETUNREACH:[[fallthrough]];
+                case ENOSPC:
+                {
+                    // Resource acquisition failure or device error
+                    throw std::runtime_error(utils::buildErrorMessage("DataSocket::", __func__, ": sendmsg: resource failure: ", strerror(errno)));
+                }
+                case EINTR:      [[fallthrough]];
+                case EAGAIN:
+                {
+                    // Temporary Error, retry the write.
+                    continue;
+                }
+                default:
+                {
+                    throw std::runtime_error(utils::buildErrorMessage("DataSocket::", __func__, ": sendmsg: returned -1: ", strerror(errno)));
+                }
+            }
+        }
+        advanceIovec(pIov, count, static_cast<std::size_t>(put));
+    }
+}
+
+std::size_t CTcpDataLinkPrivate::sendFile(int fileFd, off_t offset, std::size_t length, CTcpDataLink::CallbackProgress& rProgress) const
+{
+    if (length == 0)
+    {
+        struct stat fileStat;
+        if (::fstat(fileFd, &fileStat) != 0) {
+            throw std::runtime_error(utils::buildErrorMessage("DataSocket::", __func__, ": fstat: ", strerror(errno)));
+        }
+        if (fileStat.st_size <= offset) {
+            return 0;
+        }
+        length = static_cast<std::size_t>(fileStat.st_size - offset);
+    }
+
+    std::size_t dataWritten = 0;
+    while (dataWritten < length)
+    {
+        ssize_t put = ::sendfile(m_baseSocket.getFd(), fileFd, &offset, std::min(length - dataWritten, sendFileChunk));
+        if (put == -1)
+        {
+            switch(errno)
+            {
+                case EINVAL:     [[fallthrough]];
+                case EBADF:      [[fallthrough]];
+                case ECONNRESET: [[fallthrough]];
+                case ENXIO:      [[fallthrough]];
+                case EPIPE:
+                {
+                    // Fatal error
+                    throw std::domain_error(utils::buildErrorMessage("DataSocket::", __func__, ": sendfile: critical error: ", strerror(errno)));
+                }
+                case EIO:        [[fallthrough]];
+                case ENOMEM:     [[fallthrough]];
+                case EOVERFLOW:  [[fallthrough]];
+                case ENETDOWN:   [[fallthrough]];
+                case ENETUNREACH:
+                {
+                    // Resource acquisition failure or device error
+                    throw std::runtime_error(utils::buildErrorMessage("DataSocket::", __func__, ": sendfile: resource failure: ", strerror(errno)));
+                }
+                case EINTR:      [[fallthrough]];
+                case EAGAIN:
+                {
+                    // Temporary Error, retry the write.
+                    continue;
+                }
+                default:
+                {
+                    throw std::runtime_error(utils::buildErrorMessage("DataSocket::", __func__, ": sendfile: returned -1: ", strerror(errno)));
+                }
+            }
+        }
+        if (put == 0) {
+            // End of file reached
+            break;
+        }
+        dataWritten += static_cast<std::size_t>(put);
+        if (rProgress && !rProgress(dataWritten, length)) {
+            break;
+        }
+    }
+    return dataWritten;
+}
+
 bool CTcpDataLinkPrivate::unblockRecive() noexcept
 {
+    if (m_pUring) {
+        return m_pUring->unblock();
+    }
+
     try {
         m_FdSet.UnBlock();
     }
@@ -160,6 +651,10 @@ bool CTcpDataLinkPrivate::unblockRecive() noexcept
 
 CTcpDataLink::ERet CTcpDataLinkPrivate::recive(utils::span<uint8_t>& rSpanRx, CTcpDataLink::CallbackReceive scanForEnd)
 {
+    if (m_pUring) {
+        return m_pUring->recive(rSpanRx, scanForEnd);
+    }
+
     utils::CFdSetRetval ret = m_FdSet.Select([this, &rSpanRx, &scanForEnd](int fd) {
         reciveImpl(rSpanRx, scanForEnd);
     });
@@ -246,6 +741,146 @@ void CTcpDataLinkPrivate::reciveImpl(utils::span<uint8_t>& rRxSpan, CTcpDataLink
     rRxSpan = utils::span<uint8_t>(readBuffer, dataRead);
 }
 
+CTcpDataLink::ERet CTcpDataLinkPrivate::tryRecive(utils::span<uint8_t>& rRxSpan)
+{
+    while (true)
+    {
+        ssize_t get = ::recv(m_baseSocket.getFd(), rRxSpan.data(), rRxSpan.size_bytes(), MSG_DONTWAIT);
+        if (get >= 0) {
+            rRxSpan = utils::span<uint8_t>(rRxSpan.data(), static_cast<std::size_t>(get));
+            return CTcpDataLink::ERet::OK;
+        }
+
+        switch(errno)
+        {
+            case EINTR:
+            {
+                continue;
+            }
+            case EAGAIN:
+            {
+                return CTcpDataLink::ERet::WOULDBLOCK;
+            }
+            case ECONNRESET:[[fallthrough]];
+            case ENOTCONN:
+            {
+                // Connection broken, reported like a closed connection
+                rRxSpan = utils::span<uint8_t>(rRxSpan.data(), 0);
+                return CTcpDataLink::ERet::OK;
+            }
+            default:
+            {
+                throw std::runtime_error(utils::buildErrorMessage("DataSocket::", __func__, ": read: returned -1: ", strerror(errno)));
+            }
+        }
+    }
+}
+
+std::size_t CTcpDataLinkPrivate::trySend(const utils::span<const uint8_t>& rTxSpan) const
+{
+    while (true)
+    {
+        ssize_t put = ::send(m_baseSocket.getFd(), rTxSpan.data(), rTxSpan.size_bytes(), MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (put >= 0) {
+            return static_cast<std::size_t>(put);
+        }
+
+        switch(errno)
+        {
+            case EINTR:
+            {
+                continue;
+            }
+            case EAGAIN:
+            {
+                return 0;
+            }
+            case EINVAL:     [[fallthrough]];
+            case EBADF:      [[fallthrough]];
+            case ECONNRESET: [[fallthrough]];
+            case ENXIO:      [[fallthrough]];
+            case EPIPE:
+            {
+                throw std::domain_error(utils::buildErrorMessage("DataSocket::", __func__, ": write: critical error: ", strerror(errno)));
+            }
+            default:
+            {
+                throw std::runtime_error(utils::buildErrorMessage("DataSocket::", __func__, ": write: returned -1: ", strerror(errno)));
+            }
+        }
+    }
+}
+
+int CTcpDataLinkPrivate::getFd() const noexcept
+{
+    return m_baseSocket.getFd();
+}
+
+EIoEngine CTcpDataLinkPrivate::setIoEngine(EIoEngine engine)
+{
+    if ((engine == EIoEngine::URING) && isIoEngineSupported(EIoEngine::URING))
+    {
+        if (!m_pUring) {
+            try {
+                m_pUring = std::make_unique<CTcpUringEngine>(m_baseSocket.getFd());
+            }
+            catch (const std::exception& e) {
+                std::cerr << e.what() << std::endl;
+            }
+        }
+    }
+    else {
+        m_pUring.reset();
+    }
+    return getIoEngine();
+}
+
+EIoEngine CTcpDataLinkPrivate::getIoEngine() const noexcept
+{
+    return m_pUring ? EIoEngine::URING : EIoEngine::POSIX;
+}
+
+bool CTcpDataLinkPrivate::setZeroCopy(std::size_t threshold)
+{
+    // the kernel keeps counting the transmit ids of the socket, therefore
+    // an active instance is only adjusted
+    if (m_pZeroCopy) {
+        m_pZeroCopy->setThreshold(threshold);
+        return true;
+    }
+    try {
+        m_pZeroCopy = std::make_unique<CTcpZeroCopy>(m_baseSocket.getFd(), threshold);
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void CTcpDataLinkPrivate::sendZeroCopy(const utils::span<const uint8_t>& rTxSpan, CTcpDataLink::CallbackRelease onRelease)
+{
+    if (!m_pZeroCopy)
+    {
+        send(rTxSpan);
+        if (onRelease) {
+            onRelease();
+        }
+        return;
+    }
+    m_pZeroCopy->send(rTxSpan, std::move(onRelease));
+}
+
+std::size_t CTcpDataLinkPrivate::flushZeroCopy(std::chrono::milliseconds timeout)
+{
+    return m_pZeroCopy ? m_pZeroCopy->flush(timeout) : 0;
+}
+
+CTcpDataLink::SZeroCopyStats CTcpDataLinkPrivate::getZeroCopyStats() const
+{
+    return m_pZeroCopy ? m_pZeroCopy->getStats() : CTcpDataLink::SZeroCopyStats{};
+}
+
 //*****************************************************************************
 // Method definitions "CTcpDataLink"
 
@@ -274,6 +909,16 @@ void CTcpDataLink::send(const utils::span<const uint8_t>& rTxSpan) const
     m_pPrivate->send(rTxSpan);
 }
 
+void CTcpDataLink::send(utils::span<const utils::span<const uint8_t>> parts) const
+{
+    m_pPrivate->send(parts);
+}
+
+std::size_t CTcpDataLink::sendFile(int fileFd, off_t offset, std::size_t length, CallbackProgress progress) const
+{
+    return m_pPrivate->sendFile(fileFd, offset, length, progress);
+}
+
 bool CTcpDataLink::unblockRecive() noexcept
 {
     return m_pPrivate->unblockRecive();
@@ -289,5 +934,47 @@ CTcpDataLink::ERet CTcpDataLink::recive(utils::span<uint8_t>&& rRxSpan, Callback
     return m_pPrivate->recive(rRxSpan, scanForEnd);
 }
 
+CTcpDataLink::ERet CTcpDataLink::tryRecive(utils::span<uint8_t>& rRxSpan)
+{
+    return m_pPrivate->tryRecive(rRxSpan);
+}
+
+std::size_t CTcpDataLink::trySend(const utils::span<const uint8_t>& rTxSpan) const
+{
+    return m_pPrivate->trySend(rTxSpan);
+}
+
+int CTcpDataLink::getFd() const noexcept
+{
+    return m_pPrivate ? m_pPrivate->getFd() : -1;
+}
+
+EIoEngine CTcpDataLink::setIoEngine(EIoEngine engine)
+{
+    return m_pPrivate->setIoEngine(engine);
+}
+
+EIoEngine CTcpDataLink::getIoEngine() const noexcept
+{
+    return m_pPrivate->getIoEngine();
+}
+
+bool CTcpDataLink::setZeroCopy(std::size_t threshold)
+{
+    return m_pPrivate->setZeroCopy(threshold);
+}
+
+void CTcpDataLink::sendZeroCopy(const utils::span<const uint8_t>& rTxSpan, CallbackRelease onRelease)
+{
+    m_pPrivate->sendZeroCopy(rTxSpan, std::move(onRelease));
+}
 
+std::size_t CTcpDataLink::flushZeroCopy(std::chrono::milliseconds timeout)
+{
+    return m_pPrivate->flushZeroCopy(timeout);
+}
 
+CTcpDataLink::SZeroCopyStats CTcpDataLink::getZeroCopyStats() const
+{
+    return m_pPrivate->getZeroCopyStats();
+}
@@ -29,15 +29,27 @@
 #include <iostream>
 #include <BaseSocket.hpp>
 #include <stdexcept>
+#include <deque>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
 
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+#include <poll.h>
 #include <string.h>
 
 #include <error_msg.hpp>
 #include <make_unordered_map.h>
 #include <BaseSocket.hpp>
+#include <IoEngine/IoUring.hpp>
 #include <Tcp/TcpServer.hpp>
 
 namespace EtNet
@@ -48,30 +60,137 @@ namespace EtNet
 class CTcpServerPrivate
 {
 public:
-    CTcpServerPrivate(CBaseSocket&& rBaseSocket, unsigned int port);
+    CTcpServerPrivate(CBaseSocket&& rBaseSocket, unsigned int port, int backlog);
+    ~CTcpServerPrivate() noexcept;
     std::tuple<CTcpDataLink, CIpAddress> waitForConnection();
+    bool tryAccept(CTcpDataLink& rLink, CIpAddress& rPeer);
+    int getFd() const noexcept;
+    EIoEngine setIoEngine(EIoEngine engine);
+    EIoEngine getIoEngine() const noexcept;
 private:
+    int acceptUring();
+
     CBaseSocket m_baseSocket;
+    std::unique_ptr<CIoUring> m_pRing;
+    std::deque<int> m_accepted;
+    bool m_acceptArmed {false};
+};
+
+//*****************************************************************************
+//! \brief CTcpAcceptorPoolPrivate
+//!
+class CTcpAcceptorPoolPrivate
+{
+public:
+    CTcpAcceptorPoolPrivate(ESocketMode mode, unsigned int port, unsigned int listeners, int backlog);
+    ~CTcpAcceptorPoolPrivate() noexcept;
+    void start(CTcpAcceptorPool::CallbackAccept onAccept);
+    void stop() noexcept;
+    std::size_t size() const noexcept;
+    CTcpAcceptorPool::SStats getStats() const;
+private:
+    struct SListener
+    {
+        explicit SListener(CTcpServer&& rServer) :
+            server(std::move(rServer))
+        { }
+
+        CTcpServer            server;
+        std::atomic<uint64_t> accepted {0};
+        std::thread           thread;
+    };
+
+    void acceptLoop(SListener& rListener);
+
+    std::vector<std::unique_ptr<SListener>> m_listeners;
+    CTcpAcceptorPool::CallbackAccept m_onAccept;
+    std::atomic<bool> m_running {false};
+    bool m_stopped {false};
+
+    mutable std::mutex m_statsMutex;
+    mutable uint64_t m_lastAccepted {0};
+    mutable std::chrono::steady_clock::time_point m_lastStats;
 };
 }
 
 using namespace EtNet;
 
+namespace
+{
+
+CIpAddress toIpAddress(const sockaddr_storage& rPeerAdr) noexcept
+{
+    switch (rPeerAdr.ss_family)
+    {
+        case AF_INET:
+        {
+            in_addr ip4 = reinterpret_cast<const sockaddr_in&>(rPeerAdr).sin_addr;
+            return CIpAddress(ip4);
+        }
+        case AF_INET6:
+        {
+            const auto& sin6 = reinterpret_cast<const sockaddr_in6&>(rPeerAdr);
+            if (IN6_IS_ADDR_V4MAPPED(&sin6.sin6_addr)) {
+                in_addr ip4;
+                std::memcpy(&ip4, &sin6.sin6_addr.__in6_u.__u6_addr8[12], sizeof(in_addr));
+                return CIpAddress(ip4);
+            }
+            in6_addr ip6 = sin6.sin6_addr;
+            return CIpAddress(ip6);
+        }
+        default:
+        {
+            return CIpAddress();
+        }
+    }
+}
+
+//! read the accept queue counters of the TcpExt section of /proc/net/netstat
+void readListenCounters(uint64_t& rOverflows, uint64_t& rDrops)
+{
+    std::ifstream netstat("/proc/net/netstat");
+    std::string names;
+    std::string values;
+    while (std::getline(netstat, names) && std::getline(netstat, values))
+    {
+        if (names.compare(0, 7, "TcpExt:") != 0) {
+            continue;
+        }
+
+        std::istringstream nameStream(names);
+        std::istringstream valueStream(values);
+        std::string name;
+        std::string value;
+        while ((nameStream >> name) && (valueStream >> value))
+        {
+            if (name == "ListenOverflows") {
+                rOverflows = std::stoull(value);
+            }
+            else if (name == "ListenDrops") {
+                rDrops = std::stoull(value);
+            }
+        }
+        return;
+    }
+}
+
+}
+
 //*****************************************************************************
 // Method definitions "CTcpServerPrivate"
 
-CTcpServerPrivate::CTcpServerPrivate(CBaseSocket&& rBaseSocket, unsigned int port) :
+CTcpServerPrivate::CTcpServerPrivate(CBaseSocket&& rBaseSocket, unsigned int port, int backlog) :
     m_baseSocket(std::move(rBaseSocket))
 {
     int fd = m_baseSocket.getFd();
-    auto setupServer = [fd](const sockaddr* addr, socklen_t len)
+    auto setupServer = [fd, backlog](const sockaddr* addr, socklen_t len)
     {
         if (::bind(fd, addr, len) != 0)
         {
             throw std::runtime_error(utils::buildErrorMessage("ServerSocket::", __func__, ": bind: ", strerror(errno)));
         }
 
-        if (::listen(fd, maxConnectionBacklog) != 0)
+        if (::listen(fd, backlog) != 0)
         {
             throw std::runtime_error(utils::buildErrorMessage("ServerSocket::", __func__, ": listen: ", strerror(errno)));
         }
@@ -109,52 +228,304 @@ CTcpServerPrivate::CTcpServerPrivate(CBaseSocket&& rBaseSocket, unsigned int por
     }
 }
 
+CTcpServerPrivate::~CTcpServerPrivate() noexcept
+{
+    for (int fd : m_accepted) {
+        ::close(fd);
+    }
+}
+
 std::tuple<CTcpDataLink, CIpAddress> CTcpServerPrivate::waitForConnection()
 {
-    union
+    sockaddr_storage peerAdr {};
+    socklen_t addr_size = sizeof(peerAdr);
+    int newSocket;
+
+    if (m_pRing) {
+        newSocket = acceptUring();
+    }
+    else {
+        newSocket = ::accept(m_baseSocket.getFd(), reinterpret_cast<sockaddr*>(&peerAdr), &addr_size);
+    }
+
+    if (newSocket == -1)
     {
-        sockaddr_storage  common;
-        sockaddr_in       sin;
-        sockaddr_in6      sin6;
-    } peerAdr;
+        throw std::runtime_error(utils::buildErrorMessage("ServerSocket:", __func__, ": accept: ", strerror(errno)));
+    }
+    if (m_pRing && (::getpeername(newSocket, reinterpret_cast<sockaddr*>(&peerAdr), &addr_size) != 0)) {
+        peerAdr.ss_family = AF_UNSPEC;
+    }
+    return std::tuple(CTcpDataLink(newSocket), toIpAddress(peerAdr));
+}
 
-    socklen_t addr_size   = sizeof(peerAdr);
-    int newSocket = ::accept(m_baseSocket.getFd(), (struct sockaddr*)&peerAdr, &addr_size);
+bool CTcpServerPrivate::tryAccept(CTcpDataLink& rLink, CIpAddress& rPeer)
+{
+    if (m_pRing) {
+        throw std::logic_error(utils::buildErrorMessage("ServerSocket:", __func__, ": not available with the URING engine"));
+    }
 
-    CIpAddress peerAddress;
-    switch (peerAdr.common.ss_family)
+    // The listening socket is blocking, the pending connection is probed before
+    pollfd pfd {m_baseSocket.getFd(), POLLIN, 0};
+    if (::poll(&pfd, 1, 0) <= 0) {
+        return false;
+    }
+
+    sockaddr_storage peerAdr {};
+    socklen_t addr_size = sizeof(peerAdr);
+    int newSocket = ::accept4(m_baseSocket.getFd(), reinterpret_cast<sockaddr*>(&peerAdr), &addr_size, SOCK_CLOEXEC);
+    if (newSocket == -1)
     {
-        case AF_INET:
+        switch(errno)
         {
-            peerAddress = std::move(CIpAddress(peerAdr.sin.sin_addr));
-            break;
+            case EAGAIN:       [[fallthrough]];
+            case EINTR:        [[fallthrough]];
+            case ECONNABORTED:
+            {
+                // The connection was withdrawn before the accept
+                return false;
+            }
+            default:
+            {
+                throw std::runtime_error(utils::buildErrorMessage("ServerSocket:", __func__, ": accept4: ", strerror(errno)));
+            }
         }
-        case AF_INET6:
+    }
+    rLink = CTcpDataLink(newSocket);
+    rPeer = toIpAddress(peerAdr);
+    return true;
+}
+
+int CTcpServerPrivate::acceptUring()
+{
+    // A multishot accept stays armed across the calls. Every accepted
+    // connection is reported by its own completion.
+    while (m_accepted.empty())
+    {
+        if (!m_acceptArmed)
         {
-            if (IN6_IS_ADDR_V4MAPPED(&peerAdr.sin6.sin6_addr)) {
-                in_addr ip4;
-                std::memcpy(&ip4, &peerAdr.sin6.sin6_addr.__in6_u.__u6_addr8[12], sizeof(in_addr));
-                peerAddress = std::move(CIpAddress(ip4));
+            io_uring_sqe* pSqe = m_pRing->getSqe();
+            pSqe->opcode       = IORING_OP_ACCEPT;
+            pSqe->fd           = m_baseSocket.getFd();
+            pSqe->ioprio       = IORING_ACCEPT_MULTISHOT;
+            pSqe->accept_flags = SOCK_CLOEXEC;
+            m_acceptArmed = true;
+        }
+
+        io_uring_cqe cqe;
+        m_pRing->wait(cqe);
+        do
+        {
+            m_acceptArmed = (cqe.flags & IORING_CQE_F_MORE) != 0;
+            if (cqe.res >= 0) {
+                m_accepted.push_back(cqe.res);
+                continue;
             }
-            else {
-                peerAddress = std::move(CIpAddress(peerAdr.sin6.sin6_addr));
+
+            switch (-cqe.res)
+            {
+                case EINTR:        [[fallthrough]];
+                case EAGAIN:       [[fallthrough]];
+                case ECONNABORTED:
+                {
+                    // Temporary error, accept is armed again
+                    break;
+                }
+                default:
+                {
+                    errno = -cqe.res;
+                    return -1;
+                }
+            }
+        } while (m_pRing->peek(cqe));
+    }
+
+    int fd = m_accepted.front();
+    m_accepted.pop_front();
+    return fd;
+}
+
+int CTcpServerPrivate::getFd() const noexcept
+{
+    return m_baseSocket.getFd();
+}
+
+EIoEngine CTcpServerPrivate::setIoEngine(EIoEngine engine)
+{
+    if ((engine == EIoEngine::URING) && isIoEngineSupported(EIoEngine::URING))
+    {
+        if (!m_pRing) {
+            try {
+                m_pRing = std::make_unique<CIoUring>(8);
+            }
+            catch (const std::exception& e) {
+                std::cerr << e.what() << std::endl;
             }
         }
-        break;
     }
+    else
+    {
+        m_pRing.reset();
+        m_acceptArmed = false;
+    }
+    return getIoEngine();
+}
 
-    if (newSocket == -1)
+EIoEngine CTcpServerPrivate::getIoEngine() const noexcept
+{
+    return m_pRing ? EIoEngine::URING : EIoEngine::POSIX;
+}
+
+//*****************************************************************************
+// Method definitions "CTcpAcceptorPoolPrivate"
+
+CTcpAcceptorPoolPrivate::CTcpAcceptorPoolPrivate(ESocketMode mode, unsigned int port, unsigned int listeners, int backlog) :
+    m_lastStats(std::chrono::steady_clock::now())
+{
+    if ((mode != ESocketMode::INET_STREAM) && (mode != ESocketMode::INET6_STREAM)) {
+        throw std::invalid_argument(utils::buildErrorMessage("CTcpAcceptorPool::", __func__, ": stream socket mode required"));
+    }
+    if (listeners == 0) {
+        listeners = std::max(1U, std::thread::hardware_concurrency());
+    }
+
+    for (unsigned int i = 0; i < listeners; i++)
     {
-        throw std::runtime_error(utils::buildErrorMessage("ServerSocket:", __func__, ": accept: ", strerror(errno)));
+        CBaseSocket socket = CBaseSocket::SoReusePort(CBaseSocket::SoReuseSocket(CBaseSocket(mode)));
+        m_listeners.push_back(std::unique_ptr<SListener>(new SListener(CTcpServer(std::move(socket), port, backlog))));
+    }
+}
+
+CTcpAcceptorPoolPrivate::~CTcpAcceptorPoolPrivate() noexcept
+{
+    stop();
+}
+
+void CTcpAcceptorPoolPrivate::start(CTcpAcceptorPool::CallbackAccept onAccept)
+{
+    if (m_stopped) {
+        throw std::logic_error(utils::buildErrorMessage("CTcpAcceptorPool::", __func__, ": stopped, the listeners are shut down"));
     }
-    return std::tuple(CTcpDataLink(newSocket),peerAddress);
+    if (m_running.exchange(true)) {
+        throw std::logic_error(utils::buildErrorMessage("CTcpAcceptorPool::", __func__, ": already started"));
+    }
+
+    m_onAccept = std::move(onAccept);
+    for (auto& pListener : m_listeners) {
+        pListener->thread = std::thread(&CTcpAcceptorPoolPrivate::acceptLoop, this, std::ref(*pListener));
+    }
+}
+
+void CTcpAcceptorPoolPrivate::stop() noexcept
+{
+    if (!m_running.exchange(false)) {
+        return;
+    }
+    m_stopped = true;
+
+    // A shutdown of the listening socket wakes up the blocking accept4
+    for (auto& pListener : m_listeners) {
+        ::shutdown(pListener->server.getFd(), SHUT_RD);
+    }
+    for (auto& pListener : m_listeners)
+    {
+        if (pListener->thread.joinable()) {
+            pListener->thread.join();
+        }
+    }
+}
+
+std::size_t CTcpAcceptorPoolPrivate::size() const noexcept
+{
+    return m_listeners.size();
+}
+
+void CTcpAcceptorPoolPrivate::acceptLoop(SListener& rListener)
+{
+    int fd = rListener.server.getFd();
+    while (m_running)
+    {
+        sockaddr_storage peerAdr {};
+        socklen_t addr_size = sizeof(peerAdr);
+        int newSocket = ::accept4(fd, reinterpret_cast<sockaddr*>(&peerAdr), &addr_size, SOCK_CLOEXEC);
+        if (newSocket == -1)
+        {
+            switch (errno)
+            {
+                case EINTR:         [[fallthrough]];
+                case ECONNABORTED:  [[fallthrough]];
+                case EPROTO:
+                {
+                    // The pending connection was reset by the peer, retry
+                    continue;
+                }
+                case EMFILE:        [[fallthrough]];
+                case ENFILE:        [[fallthrough]];
+                case ENOBUFS:       [[fallthrough]];
+                case ENOMEM:
+                {
+                    // Resource exhaustion, give the application time to release resources
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    continue;
+                }
+                default:
+                {
+                    // EINVAL is reported after the listening socket is shut down by stop()
+                    if (m_running) {
+                        std::cerr << utils::buildErrorMessage("CTcpAcceptorPool::", __func__, ": accept4: ", strerror(errno)) << std::endl;
+                    }
+                    return;
+                }
+            }
+        }
+
+        rListener.accepted.fetch_add(1, std::memory_order_relaxed);
+        try {
+            m_onAccept(CTcpDataLink(newSocket), toIpAddress(peerAdr));
+        }
+        catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+}
+
+CTcpAcceptorPool::SStats CTcpAcceptorPoolPrivate::getStats() const
+{
+    CTcpAcceptorPool::SStats stats;
+    for (auto& pListener : m_listeners)
+    {
+        CTcpAcceptorPool::SListenerStats listenerStats;
+        listenerStats.accepted = pListener->accepted.load(std::memory_order_relaxed);
+
+        // At a listening socket the fill level of the accept queue is reported
+        // by tcpi_unacked and its size by tcpi_sacked
+        tcp_info info {};
+        socklen_t length = sizeof(info);
+        if (::getsockopt(pListener->server.getFd(), IPPROTO_TCP, TCP_INFO, &info, &length) == 0) {
+            listenerStats.queued  = info.tcpi_unacked;
+            listenerStats.backlog = info.tcpi_sacked;
+        }
+
+        stats.accepted += listenerStats.accepted;
+        stats.listeners.push_back(listenerStats);
+    }
+    readListenCounters(stats.listenOverflows, stats.listenDrops);
+
+    std::lock_guard<std::mutex> lock(m_statsMutex);
+    auto now = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(now - m_lastStats).count();
+    if (elapsed > 0) {
+        stats.acceptsPerSecond = static_cast<double>(stats.accepted - m_lastAccepted) / elapsed;
+    }
+    m_lastAccepted = stats.accepted;
+    m_lastStats    = now;
+    return stats;
 }
 
 //*****************************************************************************
 // Method definitions "CTcpServer"
 
-CTcpServer::CTcpServer(CBaseSocket&& rBaseSocket, unsigned int port) :
-    m_pPrivate(std::make_unique<CTcpServerPrivate>(std::move(rBaseSocket), port))
+CTcpServer::CTcpServer(CBaseSocket&& rBaseSocket, unsigned int port, int backlog) :
+    m_pPrivate(std::make_unique<CTcpServerPrivate>(std::move(rBaseSocket), port, backlog))
 { }
 
 CTcpServer::~CTcpServer() noexcept = default;
@@ -163,3 +534,52 @@ std::tuple<CTcpDataLink, CIpAddress> CTcpServer::waitForConnection()
 {
     return m_pPrivate->waitForConnection();
 }
+
+bool CTcpServer::tryAccept(CTcpDataLink& rLink, CIpAddress& rPeer)
+{
+    return m_pPrivate->tryAccept(rLink, rPeer);
+}
+
+int CTcpServer::getFd() const noexcept
+{
+    return m_pPrivate->getFd();
+}
+
+EIoEngine CTcpServer::setIoEngine(EIoEngine engine)
+{
+    return m_pPrivate->setIoEngine(engine);
+}
+
+EIoEngine CTcpServer::getIoEngine() const noexcept
+{
+    return m_pPrivate->getIoEngine();
+}
+
+//*****************************************************************************
+// Method definitions "CTcpAcceptorPool"
+
+CTcpAcceptorPool::CTcpAcceptorPool(ESocketMode mode, unsigned int port, unsigned int listeners, int backlog) :
+    m_pPrivate(std::make_unique<CTcpAcceptorPoolPrivate>(mode, port, listeners, backlog))
+{ }
+
+CTcpAcceptorPool::~CTcpAcceptorPool() noexcept = default;
+
+void CTcpAcceptorPool::start(CallbackAccept onAccept)
+{
+    m_pPrivate->start(std::move(onAccept));
+}
+
+void CTcpAcceptorPool::stop() noexcept
+{
+    m_pPrivate->stop();
+}
+
+std::size_t CTcpAcceptorPool::size() const noexcept
+{
+    return m_pPrivate->size();
+}
+
+CTcpAcceptorPool::SStats CTcpAcceptorPool::getStats() const
+{
+    return m_pPrivate->getStats();
+}
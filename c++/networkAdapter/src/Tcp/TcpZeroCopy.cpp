@@ -0,0 +1,278 @@
+/*
+ * This file is part of the EMBTOM project
+ * Copyright (c) 2018-2020 Thomas Willetal
+ * (https://github.com/embtom)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+//******************************************************************************
+// Header
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <errno.h>
+#include <string.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <linux/errqueue.h>
+
+#include <error_msg.hpp>
+#include <Tcp/TcpZeroCopy.hpp>
+
+using namespace EtNet;
+
+namespace
+{
+
+//! wrap around safe comparison of the 32 bit transmit ids
+bool idBefore(uint32_t lhs, uint32_t rhs) noexcept
+{
+    return static_cast<int32_t>(lhs - rhs) < 0;
+}
+
+}
+
+//*****************************************************************************
+// Method definitions "CTcpZeroCopy"
+
+CTcpZeroCopy::CTcpZeroCopy(int socketFd, std::size_t threshold) :
+    m_socketFd(socketFd),
+    m_threshold(threshold)
+{
+    int one = 1;
+    if (::setsockopt(m_socketFd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one)) != 0) {
+        throw std::runtime_error(utils::buildErrorMessage("CTcpZeroCopy::", __func__, ": SO_ZEROCOPY: ", strerror(errno)));
+    }
+}
+
+void CTcpZeroCopy::send(const utils::span<const uint8_t>& rTxSpan, CTcpDataLink::CallbackRelease onRelease)
+{
+    std::vector<CTcpDataLink::CallbackRelease> released;
+    std::exception_ptr pError;
+    {
+        std::lock_guard<std::mutex> txLock(m_txMutex);
+        bool zeroCopy;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            zeroCopy = rTxSpan.size_bytes() >= m_threshold;
+        }
+        int flags = MSG_NOSIGNAL | (zeroCopy ? MSG_ZEROCOPY : 0);
+
+        // Every sendmsg which queued data used one id, they are reserved after the transmit
+        uint32_t usedIds = 0;
+        std::size_t dataWritten = 0;
+        try
+        {
+            while (dataWritten < rTxSpan.size_bytes())
+            {
+                ssize_t put = ::send(m_socketFd, rTxSpan.data() + dataWritten, rTxSpan.size_bytes() - dataWritten, flags);
+                if (put == -1)
+                {
+                    switch(errno)
+                    {
+                        case ENOBUFS:
+                        {
+                            // The notifications exceed the option memory of the socket,
+                            // they are harvested before the retry
+                            if (!zeroCopy) {
+                                throw std::runtime_error(utils::buildErrorMessage("DataSocket::", __func__, ": write: resource failure: ", strerror(errno)));
+                            }
+                            pollfd pfd {m_socketFd, 0, 0};
+                            ::poll(&pfd, 1, 1);
+                            std::lock_guard<std::mutex> lock(m_mutex);
+                            harvest(released);
+                            continue;
+                        }
+                        case EINTR:      [[fallthrough]];
+                        case EAGAIN:
+                        {
+                            // Temporary Error, retry the write.
+                            continue;
+                        }
+                        case EINVAL:     [[fallthrough]];
+                        case EBADF:      [[fallthrough]];
+                        case ECONNRESET: [[fallthrough]];
+                        case ENXIO:      [[fallthrough]];
+                        case EPIPE:
+                        {
+                            throw std::domain_error(utils::buildErrorMessage("DataSocket::", __func__, ": write: critical error: ", strerror(errno)));
+                        }
+                        default:
+                        {
+                            throw std::runtime_error(utils::buildErrorMessage("DataSocket::", __func__, ": write: returned -1: ", strerror(errno)));
+                        }
+                    }
+                }
+                if (zeroCopy && (put > 0)) {
+                    usedIds++;
+                }
+                dataWritten += static_cast<std::size_t>(put);
+            }
+        }
+        catch (...) {
+            pError = std::current_exception();
+        }
+
+        // A completion harvested in the meantime has advanced m_completedId,
+        // the pending transmit is then released by the harvest below. The ids
+        // of a failed transmit are used by the kernel as well, its queued parts
+        // are released by their completions.
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (zeroCopy && (!pError || (usedIds > 0)))
+        {
+            m_nextId += usedIds;
+            if (!pError) {
+                m_stats.zeroCopySends++;
+            }
+            m_pending.push_back(SPending{m_nextId - 1, std::move(onRelease)});
+        }
+        else
+        {
+            if (!pError) {
+                m_stats.copiedSends++;
+            }
+            released.push_back(std::move(onRelease));
+        }
+        harvest(released);
+    }
+
+    for (auto& release : released) {
+        if (release) {
+            release();
+        }
+    }
+    if (pError) {
+        std::rethrow_exception(pError);
+    }
+}
+
+std::size_t CTcpZeroCopy::flush(std::chrono::milliseconds timeout)
+{
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point deadline = Clock::now() + timeout;
+
+    while (true)
+    {
+        std::vector<CTcpDataLink::CallbackRelease> released;
+        std::size_t pending;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            harvest(released);
+            pending = m_pending.size();
+        }
+        for (auto& release : released) {
+            if (release) {
+                release();
+            }
+        }
+
+        Clock::time_point now = Clock::now();
+        if ((pending == 0) || (now >= deadline)) {
+            return pending;
+        }
+
+        // A pending completion at the error queue is reported as POLLERR
+        pollfd pfd {m_socketFd, 0, 0};
+        auto wait = std::chrono::ceil<std::chrono::milliseconds>(deadline - now);
+        if ((::poll(&pfd, 1, static_cast<int>(wait.count())) < 0) && (errno != EINTR)) {
+            throw std::runtime_error(utils::buildErrorMessage("CTcpZeroCopy::", __func__, ": poll: ", strerror(errno)));
+        }
+    }
+}
+
+CTcpDataLink::SZeroCopyStats CTcpZeroCopy::getStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void CTcpZeroCopy::setThreshold(std::size_t threshold)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_threshold = threshold;
+}
+
+void CTcpZeroCopy::harvest(std::vector<CTcpDataLink::CallbackRelease>& rReleased)
+{
+    while (true)
+    {
+        uint8_t control[CMSG_SPACE(sizeof(sock_extended_err) + sizeof(sockaddr_in6))];
+        msghdr msg {};
+        msg.msg_control    = control;
+        msg.msg_controllen = sizeof(control);
+
+        if (::recvmsg(m_socketFd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) == -1)
+        {
+            if (errno == EINTR) {
+                continue;
+            }
+            // EAGAIN, the error queue is empty
+            break;
+        }
+
+        for (cmsghdr* pCmsg = CMSG_FIRSTHDR(&msg); pCmsg != nullptr; pCmsg = CMSG_NXTHDR(&msg, pCmsg))
+        {
+            bool recvErr = ((pCmsg->cmsg_level == SOL_IP)   && (pCmsg->cmsg_type == IP_RECVERR)) ||
+                           ((pCmsg->cmsg_level == SOL_IPV6) && (pCmsg->cmsg_type == IPV6_RECVERR));
+            if (!recvErr) {
+                continue;
+            }
+
+            sock_extended_err err;
+            memcpy(&err, CMSG_DATA(pCmsg), sizeof(err));
+            if ((err.ee_errno != 0) || (err.ee_origin != SO_EE_ORIGIN_ZEROCOPY)) {
+                continue;
+            }
+            if (err.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+                m_stats.kernelCopied += err.ee_data - err.ee_info + 1;
+            }
+            complete(err.ee_info, err.ee_data);
+        }
+    }
+
+    while (!m_pending.empty() && idBefore(m_pending.front().lastId, m_completedId))
+    {
+        rReleased.push_back(std::move(m_pending.front().onRelease));
+        m_pending.pop_front();
+    }
+}
+
+void CTcpZeroCopy::complete(uint32_t firstId, uint32_t lastId)
+{
+    // The completions of a stream socket arrive mostly in order, ranges
+    // beyond the first gap are kept until the gap is closed
+    m_outOfOrder.emplace_back(firstId, lastId);
+    std::sort(m_outOfOrder.begin(), m_outOfOrder.end(), [this](const auto& lhs, const auto& rhs) {
+        return (lhs.first - m_completedId) < (rhs.first - m_completedId);
+    });
+
+    auto it = m_outOfOrder.begin();
+    while ((it != m_outOfOrder.end()) && !idBefore(m_completedId, it->first))
+    {
+        if (!idBefore(it->second, m_completedId)) {
+            m_completedId = it->second + 1;
+        }
+        it++;
+    }
+    m_outOfOrder.erase(m_outOfOrder.begin(), it);
+}
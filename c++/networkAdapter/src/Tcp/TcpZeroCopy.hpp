@@ -0,0 +1,97 @@
+/*
+ * This file is part of the EMBTOM project
+ * Copyright (c) 2018-2020 Thomas Willetal
+ * (https://github.com/embtom)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef _TCPZEROCOPY_H_
+#define _TCPZEROCOPY_H_
+
+//******************************************************************************
+// Header
+
+#include <stdint.h>
+#include <cstddef>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include <span.h>
+#include <Tcp/TcpDataLink.hpp>
+
+namespace EtNet
+{
+
+//*****************************************************************************
+//! \brief CTcpZeroCopy
+//! MSG_ZEROCOPY transmit of a TcpDataLink. The kernel references the user buffer
+//! until it reports the completion of the transmit at the socket error queue.
+//! Every sendmsg which queues data gets the next id of a 32 bit counter, the
+//! completions report ranges of these ids.
+class CTcpZeroCopy
+{
+public:
+    CTcpZeroCopy(const CTcpZeroCopy&)            = delete;
+    CTcpZeroCopy& operator=(const CTcpZeroCopy&) = delete;
+
+    //! enables SO_ZEROCOPY at the socket, throws if not supported by the kernel
+    CTcpZeroCopy(int socketFd, std::size_t threshold);
+
+    //! transmit of the buffer, the release callback is called after the completion
+    void send(const utils::span<const uint8_t>& rTxSpan, CTcpDataLink::CallbackRelease onRelease);
+
+    //! harvest the completions until all transmits are released or the timeout
+    //! expires. The number of still pending transmits is returned.
+    std::size_t flush(std::chrono::milliseconds timeout);
+
+    CTcpDataLink::SZeroCopyStats getStats() const;
+    void setThreshold(std::size_t threshold);
+
+private:
+    struct SPending
+    {
+        uint32_t lastId;
+        CTcpDataLink::CallbackRelease onRelease;
+    };
+
+    //! read all available completions of the error queue, the released callbacks
+    //! are moved to rReleased to call them without the lock held
+    void harvest(std::vector<CTcpDataLink::CallbackRelease>& rReleased);
+    void complete(uint32_t firstId, uint32_t lastId);
+
+    int                 m_socketFd;
+
+    //! serializes the transmits, the kernel assigns the ids in the order of the sendmsg calls
+    std::mutex          m_txMutex;
+    //! guards the ids and the pending transmits, it is not held during a blocking send
+    mutable std::mutex  m_mutex;
+    std::size_t         m_threshold;
+    uint32_t            m_nextId {0};       //!< id of the next zero copy sendmsg
+    uint32_t            m_completedId {0};  //!< all ids below are completed
+    std::vector<std::pair<uint32_t, uint32_t>> m_outOfOrder;
+    std::deque<SPending> m_pending;
+    CTcpDataLink::SZeroCopyStats m_stats;
+};
+
+} // EtNet
+
+#endif // _TCPZEROCOPY_H_
@@ -52,6 +52,7 @@ class CUdpClientPrivate
 public:
     CUdpClientPrivate(CBaseSocket&& rBaseSocket);
     CUdpDataLink getLink(const std::string& rHost, unsigned int port);
+    CUdpDataLink getLink(const CIpAddress::IpAddresses& rIpList, unsigned int port);
 private:
     CBaseSocket m_baseSocket;
 };
@@ -69,16 +70,17 @@ CUdpClientPrivate::CUdpClientPrivate(CBaseSocket&& rBaseSocket) :
 
 CUdpDataLink CUdpClientPrivate::getLink(const std::string& rHost, unsigned int port)
 {
-    CHostLookup::IpAddresses ipList;
-    try  { ipList = CHostLookup(CIpAddress(rHost)).addresses(); }  catch(...) {  }
-
-    if (ipList.empty())
-    {
-         ipList = CHostLookup(rHost).addresses();
+    // A literal address needs no lookup
+    if (auto literal = CIpAddress::parse(rHost)) {
+        return getLink(CHostLookup::IpAddresses{*literal}, port);
     }
+    return getLink(CHostLookup(rHost).addresses(), port);
+}
 
+CUdpDataLink CUdpClientPrivate::getLink(const CIpAddress::IpAddresses& rIpList, unsigned int port)
+{
     int domain = m_baseSocket.getDomain();
-    auto it = std::find_if(ipList.begin(), ipList.end(),[&domain] (const auto &elm)
+    auto it = std::find_if(rIpList.begin(), rIpList.end(),[&domain] (const auto &elm)
     {
        if (elm.is_v4() && (domain == AF_INET)) {
            return true;
@@ -91,7 +93,7 @@ CUdpDataLink CUdpClientPrivate::getLink(const std::string& rHost, unsigned int p
        }
     });
 
-    if (it == ipList.end()) {
+    if (it == rIpList.end()) {
        throw std::runtime_error(utils::buildErrorMessage("CUdpClient::", __func__, " : No valid Ip available"));
     }
 
@@ -111,3 +113,13 @@ CUdpDataLink CUdpClient::getLink(const std::string& rHost, unsigned int port)
 {
      return m_pPrivate->getLink(rHost,port);
 }
+
+CUdpDataLink CUdpClient::getLink(const CIpAddress& rIp, unsigned int port)
+{
+     return m_pPrivate->getLink(CIpAddress::IpAddresses{rIp}, port);
+}
+
+CUdpDataLink CUdpClient::getLink(const CIpAddress::IpAddresses& rIpList, unsigned int port)
+{
+     return m_pPrivate->getLink(rIpList, port);
+}
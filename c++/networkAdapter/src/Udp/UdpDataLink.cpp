@@ -28,15 +28,61 @@
 
 #include <iostream>
 #include <stdexcept>
+#include <mutex>
+#include <array>
+#include <algorithm>
+#include <atomic>
 #include <unistd.h>
 #include <errno.h>
 #include <string.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <netinet/udp.h>
 #include <fdSet.h>
 #include <error_msg.hpp>
+#include <IoEngine/IoUring.hpp>
 #include <Udp/UdpDataLink.hpp>
 
 namespace EtNet
 {
+//*****************************************************************************
+//! \brief CUdpUringEngine
+//! io_uring transfer of a UdpDataLink. The datagram is recived by recvmsg directly
+//! into the passed buffer, the unblock eventfd is watched by a multishot poll.
+class CUdpUringEngine
+{
+public:
+    CUdpUringEngine(int socketFd);
+    ~CUdpUringEngine() noexcept;
+
+    void sendTo(const sockaddr* pAddr, socklen_t addrLen, const utils::span<const uint8_t>& rSpanTx);
+    CUdpDataLink::ERet reciveFrom(utils::span<uint8_t>& rSpanRx, CUdpDataLink::CallbackReciveFrom& scanForEnd);
+    CUdpDataLink::ERet waitReadable();
+    bool unblock() noexcept;
+
+private:
+    static constexpr unsigned ringEntries = 8;
+
+    enum ETag : uint64_t
+    {
+        TAG_RECV = 1,
+        TAG_UNBLOCK,
+        TAG_CANCEL
+    };
+
+    int waitRecv();
+    void drainUnblock() noexcept;
+
+    int         m_socketFd;
+    int         m_unblockFd {-1};
+    CIoUring    m_rxRing;
+    bool        m_pollArmed {false};
+
+    std::mutex  m_txMutex;
+    CIoUring    m_txRing;
+};
+
 //*****************************************************************************
 //! \brief CUdpDataLink
 //!
@@ -51,22 +97,349 @@ public:
 
     void send(const utils::span<const uint8_t>& rSpanTx) const;
     void sendTo(const SPeerAddr& rClientAddr, const utils::span<const uint8_t>& rSpanTx) const;
+    void sendToBatch(utils::span<const SDatagramTx> batch) const;
+    void sendToBatch(utils::span<const SPeerAddr> peers, const utils::span<const uint8_t>& rSpanTx) const;
+    void sendBatch(utils::span<const utils::span<const uint8_t>> batch) const;
+    bool sendSegmented(const utils::span<const uint8_t>& rSpanTx, std::size_t segmentSize) const;
+    bool sendToSegmented(const SPeerAddr& rClientAddr, const utils::span<const uint8_t>& rSpanTx, std::size_t segmentSize) const;
 
     bool unblockRecive() noexcept;
     CUdpDataLink::ERet reciveFrom(utils::span<uint8_t>& rSpanRx, CUdpDataLink::CallbackReciveFrom scanForEnd) const;
+    CUdpDataLink::ERet tryReciveFrom(utils::span<uint8_t>& rSpanRx, SPeerAddr& rPeerAddr) const;
+    CUdpDataLink::ERet reciveBatch(utils::span<SDatagram> batch, std::size_t& rCount) const;
+    CUdpDataLink::ERet tryReciveBatch(utils::span<SDatagram> batch, std::size_t& rCount) const;
+    bool setGroRecive(bool enable);
+    CUdpDataLink::ERet reciveSegments(utils::span<uint8_t> rxBuffer, CUdpDataLink::CallbackReciveSegments& rOnSegments) const;
+    CUdpDataLink::ERet tryReciveSegments(utils::span<uint8_t> rxBuffer, CUdpDataLink::CallbackReciveSegments& rOnSegments) const;
+    int getFd() const noexcept;
+    EIoEngine setIoEngine(EIoEngine engine);
+    EIoEngine getIoEngine() const noexcept;
 
 private:
     void reciveFromImpl(utils::span<uint8_t>& rSpanRx, CUdpDataLink::CallbackReciveFrom scanForEnd) const;
+    std::size_t reciveBatchImpl(utils::span<SDatagram> batch) const;
+    //! reads the pending datagrams and splits them at the GRO segment size,
+    //! returns the number of datagrams read
+    std::size_t reciveSegmentsImpl(utils::span<uint8_t> rxBuffer, CUdpDataLink::CallbackReciveSegments& rOnSegments) const;
+
+    //! flush the batch by sendmmsg, the access functions provide the peer and data of datagram "i"
+    template<typename PeerAt, typename DataAt>
+    void sendBatchImpl(std::size_t count, PeerAt peerAt, DataAt dataAt) const;
+
+    //! transmit of the segments by sendmmsg, used without kernel support of UDP_SEGMENT
+    void sendSegmentsBatch(const SPeerAddr& rClientAddr, const utils::span<const uint8_t>& rSpanTx, std::size_t segmentSize) const;
 
     utils::CFdSet   m_FdSet;
     int             m_socketFd  {-1};
     SPeerAddr       m_peerAdr   {CIpAddress(), 0};
+    std::unique_ptr<CUdpUringEngine> m_pUring;
+    //! set if the device rejected a segmented transmit by EIO
+    mutable std::atomic<bool> m_gsoFailed {false};
 };
 
 }
 
 using namespace EtNet;
 
+namespace
+{
+
+SPeerAddr toPeerAddr(const sockaddr_storage& rPeerAdr) noexcept
+{
+    SPeerAddr peerAddress;
+    switch (rPeerAdr.ss_family)
+    {
+        case AF_INET:
+        {
+            const auto& sin = reinterpret_cast<const sockaddr_in&>(rPeerAdr);
+            in_addr ip4 = sin.sin_addr;
+            peerAddress.Ip = CIpAddress(ip4);
+            peerAddress.Port = ntohs(sin.sin_port);
+            break;
+        }
+        case AF_INET6:
+        {
+            const auto& sin6 = reinterpret_cast<const sockaddr_in6&>(rPeerAdr);
+            if (IN6_IS_ADDR_V4MAPPED(&sin6.sin6_addr)) {
+                in_addr ip4;
+                std::memcpy(&ip4, &sin6.sin6_addr.__in6_u.__u6_addr8[12], sizeof(in_addr));
+                peerAddress.Ip = CIpAddress(ip4);
+            }
+            else {
+                in6_addr ip6 = sin6.sin6_addr;
+                peerAddress.Ip = CIpAddress(ip6);
+            }
+            peerAddress.Port = ntohs(sin6.sin6_port);
+            break;
+        }
+    }
+    return peerAddress;
+}
+
+socklen_t toSockAddr(const SPeerAddr& rPeerAddr, sockaddr_storage& rSockAddr)
+{
+    std::memset(&rSockAddr, 0, sizeof(sockaddr_storage));
+    if (rPeerAddr.Ip.is_v4())
+    {
+        auto& sin = reinterpret_cast<sockaddr_in&>(rSockAddr);
+        sin.sin_family = AF_INET;
+        sin.sin_port   = htons(rPeerAddr.Port);
+        std::memcpy(&sin.sin_addr, rPeerAddr.Ip.to_v4(), sizeof(in_addr));
+        return sizeof(sockaddr_in);
+    }
+    else if (rPeerAddr.Ip.is_v6())
+    {
+        auto& sin6 = reinterpret_cast<sockaddr_in6&>(rSockAddr);
+        sin6.sin6_family = AF_INET6;
+        sin6.sin6_port   = htons(rPeerAddr.Port);
+        std::memcpy(&sin6.sin6_addr, rPeerAddr.Ip.to_v6(), sizeof(in6_addr));
+        return sizeof(sockaddr_in6);
+    }
+    throw std::logic_error(utils::buildErrorMessage("CUdpServer::", __func__, " : No valid Ip to connect"));
+}
+
+//! largest UDP payload of one IPv4 datagram, it limits the size of a segmented transmit
+constexpr std::size_t maxGsoPayload = 65507;
+
+//! UDP_SEGMENT is available since Linux 4.18, the socket option is probed once
+bool isGsoSupported() noexcept
+{
+    static const bool supported = []()
+    {
+        int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            return false;
+        }
+        int segment = 0;
+        socklen_t len = sizeof(segment);
+        bool ret = (::getsockopt(fd, SOL_UDP, UDP_SEGMENT, &segment, &len) == 0);
+        ::close(fd);
+        return ret;
+    }();
+    return supported;
+}
+
+}
+
+//*****************************************************************************
+// Method definitions "CUdpUringEngine"
+
+CUdpUringEngine::CUdpUringEngine(int socketFd) :
+    m_socketFd(socketFd),
+    m_rxRing(ringEntries),
+    m_txRing(ringEntries)
+{
+    m_unblockFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_unblockFd < 0) {
+        throw std::runtime_error(utils::buildErrorMessage("CUdpUringEngine::", __func__, ": eventfd: ", strerror(errno)));
+    }
+}
+
+CUdpUringEngine::~CUdpUringEngine() noexcept
+{
+    ::close(m_unblockFd);
+}
+
+void CUdpUringEngine::sendTo(const sockaddr* pAddr, socklen_t addrLen, const utils::span<const uint8_t>& rSpanTx)
+{
+    std::lock_guard<std::mutex> lock(m_txMutex);
+
+    iovec iov {const_cast<uint8_t*>(rSpanTx.data()), rSpanTx.size_bytes()};
+    msghdr msg {};
+    msg.msg_name    = const_cast<sockaddr*>(pAddr);
+    msg.msg_namelen = addrLen;
+    msg.msg_iov     = &iov;
+    msg.msg_iovlen  = 1;
+
+    while (true)
+    {
+        io_uring_sqe* pSqe = m_txRing.getSqe();
+        pSqe->opcode    = IORING_OP_SENDMSG;
+        pSqe->fd        = m_socketFd;
+        pSqe->addr      = reinterpret_cast<uint64_t>(&msg);
+        pSqe->len       = 1;
+        pSqe->msg_flags = MSG_NOSIGNAL;
+
+        io_uring_cqe cqe;
+        m_txRing.wait(cqe);
+        if (cqe.res >= 0) {
+            return;
+        }
+
+        switch(-cqe.res)
+        {
+            case EINTR:      [[fallthrough]];
+            case EAGAIN:
+            {
+                // Temporary Error, retry.
+                continue;
+            }
+            case EINVAL:     [[fallthrough]];
+            case EBADF:      [[fallthrough]];
+            case ECONNRESET: [[fallthrough]];
+            case ENXIO:      [[fallthrough]];
+            case EPIPE:
+            {
+                throw std::domain_error(utils::buildErrorMessage("DataSocket::", __func__, ": write: critical error: ", strerror(-cqe.res)));
+            }
+            default:
+            {
+                throw std::runtime_error(utils::buildErrorMessage("DataSocket::", __func__, ": write: returned -1: ", strerror(-cqe.res)));
+            }
+        }
+    }
+}
+
+CUdpDataLink::ERet CUdpUringEngine::reciveFrom(utils::span<uint8_t>& rSpanRx, CUdpDataLink::CallbackReciveFrom& scanForEnd)
+{
+    uint8_t* readBuffer = rSpanRx.data();
+    std::size_t dataRead = 0;
+
+    while(dataRead < rSpanRx.size_bytes())
+    {
+        sockaddr_storage peerAdr;
+        iovec iov {readBuffer + dataRead, rSpanRx.size_bytes() - dataRead};
+        msghdr msg {};
+        msg.msg_name    = &peerAdr;
+        msg.msg_namelen = sizeof(peerAdr);
+        msg.msg_iov     = &iov;
+        msg.msg_iovlen  = 1;
+
+        io_uring_sqe* pSqe = m_rxRing.getSqe();
+        pSqe->opcode    = IORING_OP_RECVMSG;
+        pSqe->fd        = m_socketFd;
+        pSqe->addr      = reinterpret_cast<uint64_t>(&msg);
+        pSqe->len       = 1;
+        pSqe->user_data = TAG_RECV;
+
+        int get = waitRecv();
+        if (get == -ECANCELED) {
+            rSpanRx = utils::span<uint8_t>(readBuffer, dataRead);
+            return CUdpDataLink::ERet::UNBLOCK;
+        }
+
+        if (get < 0)
+        {
+            switch(-get)
+            {
+                case EINTR:     [[fallthrough]];
+                case ETIMEDOUT: [[fallthrough]];
+                case EAGAIN:
+                {
+                    // Temporary error, retry
+                    continue;
+                }
+                case ECONNRESET:[[fallthrough]];
+                case ENOTCONN:
+                {
+                    get = 0;
+                    break;
+                }
+                default:
+                {
+                    throw std::runtime_error(utils::buildErrorMessage("DataSocket::", __func__, ": read: returned: ", strerror(-get)));
+                }
+            }
+        }
+        if (get == 0) {
+            break;
+        }
+        dataRead += static_cast<std::size_t>(get);
+
+        if (scanForEnd(toPeerAddr(peerAdr), utils::span<uint8_t>(readBuffer, dataRead))) {
+            break;
+        }
+    }
+    rSpanRx = utils::span<uint8_t>(readBuffer, dataRead);
+    return CUdpDataLink::ERet::OK;
+}
+
+CUdpDataLink::ERet CUdpUringEngine::waitReadable()
+{
+    while (true)
+    {
+        io_uring_sqe* pSqe = m_rxRing.getSqe();
+        pSqe->opcode        = IORING_OP_POLL_ADD;
+        pSqe->fd            = m_socketFd;
+        pSqe->poll32_events = POLLIN;
+        pSqe->user_data     = TAG_RECV;
+
+        int ret = waitRecv();
+        if (ret == -ECANCELED) {
+            return CUdpDataLink::ERet::UNBLOCK;
+        }
+        if (ret >= 0) {
+            return CUdpDataLink::ERet::OK;
+        }
+        if (ret != -EINTR) {
+            throw std::runtime_error(utils::buildErrorMessage("DataSocket::", __func__, ": poll: returned: ", strerror(-ret)));
+        }
+    }
+}
+
+int CUdpUringEngine::waitRecv()
+{
+    if (!m_pollArmed)
+    {
+        io_uring_sqe* pSqe = m_rxRing.getSqe();
+        pSqe->opcode        = IORING_OP_POLL_ADD;
+        pSqe->fd            = m_unblockFd;
+        pSqe->len           = IORING_POLL_ADD_MULTI;
+        pSqe->poll32_events = POLLIN;
+        pSqe->user_data     = TAG_UNBLOCK;
+        m_pollArmed = true;
+    }
+
+    // Wait for the prepared operation. Its buffers are referenced by the kernel
+    // until its completion, even if the recive is unblocked meanwhile.
+    bool unblocked = false;
+    bool cancelled = false;
+    int ret = 0;
+    while (true)
+    {
+        io_uring_cqe cqe;
+        m_rxRing.wait(cqe);
+        if (cqe.user_data == TAG_UNBLOCK)
+        {
+            m_pollArmed = (cqe.flags & IORING_CQE_F_MORE) != 0;
+            drainUnblock();
+            unblocked = true;
+            if (!cancelled)
+            {
+                io_uring_sqe* pSqe = m_rxRing.getSqe();
+                pSqe->opcode    = IORING_OP_ASYNC_CANCEL;
+                pSqe->addr      = TAG_RECV;
+                pSqe->user_data = TAG_CANCEL;
+                cancelled = true;
+            }
+        }
+        else if (cqe.user_data == TAG_RECV)
+        {
+            ret = cqe.res;
+            break;
+        }
+    }
+
+    if (unblocked && (ret != -ECANCELED)) {
+        // The operation completed before the cancellation took effect,
+        // the unblock is reported at the next recive call.
+        unblock();
+    }
+    return ret;
+}
+
+void CUdpUringEngine::drainUnblock() noexcept
+{
+    uint64_t cnt;
+    while (::read(m_unblockFd, &cnt, sizeof(cnt)) > 0) { }
+}
+
+bool CUdpUringEngine::unblock() noexcept
+{
+    uint64_t one = 1;
+    return ::write(m_unblockFd, &one, sizeof(one)) == sizeof(one);
+}
+
 //*****************************************************************************
 // Method definitions "CUdpDataLinkPrivate"
 CUdpDataLinkPrivate::CUdpDataLinkPrivate(int socketFd) :
@@ -101,29 +474,13 @@ void CUdpDataLinkPrivate::send(const utils::span<const uint8_t>& rSpanTx) const
 
 void CUdpDataLinkPrivate::sendTo(const SPeerAddr& rClientAddr, const utils::span<const uint8_t>& rSpanTx) const
 {
-    sockaddr_in clAddr{};
-    sockaddr_in6 clAddr6{};
-    sockaddr* claddr;
-    socklen_t claddrLen;
+    sockaddr_storage clAddr;
+    socklen_t claddrLen = toSockAddr(rClientAddr, clAddr);
+    sockaddr* claddr = reinterpret_cast<sockaddr*>(&clAddr);
 
-    if (rClientAddr.Ip.is_v4())
-    {
-        clAddr.sin_family       = AF_INET;
-        clAddr.sin_port         = htons(rClientAddr.Port);
-        std::memcpy(&clAddr.sin_addr, rClientAddr.Ip.to_v4(), sizeof(in_addr));
-        claddr = (sockaddr*)&clAddr;
-        claddrLen = sizeof(sockaddr_in);
-    }
-    else if (rClientAddr.Ip.is_v6())
-    {
-        clAddr6.sin6_family      = AF_INET6;
-        clAddr6.sin6_port        = htons(rClientAddr.Port);
-        std::memcpy(&clAddr6.sin6_addr, rClientAddr.Ip.to_v6(), sizeof(in6_addr));
-        claddr = (sockaddr*)&clAddr6;
-        claddrLen = sizeof(sockaddr_in6);
-    }
-    else {
-        throw std::logic_error(utils::buildErrorMessage("CUdpServer::", __func__, " : No valid Ip to connect"));
+    if (m_pUring) {
+        m_pUring->sendTo(claddr, claddrLen, rSpanTx);
+        return;
     }
 
     std::size_t dataWritten = 0;
@@ -173,8 +530,209 @@ void CUdpDataLinkPrivate::sendTo(const SPeerAddr& rClientAddr, const utils::span
     return;
 }
 
+template<typename PeerAt, typename DataAt>
+void CUdpDataLinkPrivate::sendBatchImpl(std::size_t count, PeerAt peerAt, DataAt dataAt) const
+{
+    std::array<mmsghdr, maxBatchDatagrams>          msgs;
+    std::array<iovec, maxBatchDatagrams>            iovs;
+    std::array<sockaddr_storage, maxBatchDatagrams> peerAdrs;
+
+    std::size_t dataWritten = 0;
+    while (dataWritten < count)
+    {
+        unsigned chunk = static_cast<unsigned>(std::min(count - dataWritten, maxBatchDatagrams));
+        for (unsigned i = 0; i < chunk; i++)
+        {
+            const utils::span<const uint8_t>& rData = dataAt(dataWritten + i);
+            iovs[i] = iovec {const_cast<uint8_t*>(rData.data()), rData.size_bytes()};
+            msgs[i] = mmsghdr {};
+            msgs[i].msg_hdr.msg_name    = &peerAdrs[i];
+            msgs[i].msg_hdr.msg_namelen = toSockAddr(peerAt(dataWritten + i), peerAdrs[i]);
+            msgs[i].msg_hdr.msg_iov     = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen  = 1;
+        }
+
+        // A partial completion reports the number of sent datagrams, the remaining ones
+        // are sent by the next call. An error is reported if the first datagram fails.
+        unsigned sent = 0;
+        while (sent < chunk)
+        {
+            int put = ::sendmmsg(m_socketFd, msgs.data() + sent, chunk - sent, MSG_NOSIGNAL);
+            if (put >= 0) {
+                sent += static_cast<unsigned>(put);
+                continue;
+            }
+
+            switch(errno)
+            {
+                case EINVAL:     [[fallthrough]];
+                case EBADF:      [[fallthrough]];
+                case ECONNRESET: [[fallthrough]];
+                case ENXIO:      [[fallthrough]];
+                case EPIPE:
+                {
+                    // Fatal error
+                    throw std::domain_error(utils::buildErrorMessage("DataSocket::", __func__, ": sendmmsg: critical error: ", strerror(errno)));
+                }
+                case EDQUOT:     [[fallthrough]];
+                case EFBIG:      [[fallthrough]];
+                case EIO:        [[fallthrough]];
+                case ENETDOWN:   [[fallthrough]];
+                case ENETUNREACH:[[fallthrough]];
+                case ENOSPC:
+                {
+                    // Resource acquisition failure or device error
+                    throw std::runtime_error(utils::buildErrorMessage("DataSocket::", __func__, ": sendmmsg: resource failure: ", strerror(errno)));
+                }
+                case EINTR:      [[fallthrough]];
+                case EAGAIN:
+                {
+                    // Temporary Error, retry the remaining datagrams
+                    continue;
+                }
+                default:
+                {
+                    throw std::runtime_error(utils::buildErrorMessage("DataSocket::", __func__, ": sendmmsg: returned -1: ", strerror(errno)));
+                }
+            }
+        }
+        dataWritten += chunk;
+    }
+}
+
+void CUdpDataLinkPrivate::sendToBatch(utils::span<const SDatagramTx> batch) const
+{
+    sendBatchImpl(batch.size(),
+                  [&batch](std::size_t i) -> const SPeerAddr& { return batch[i].Peer; },
+                  [&batch](std::size_t i) -> const utils::span<const uint8_t>& { return batch[i].Data; });
+}
+
+void CUdpDataLinkPrivate::sendToBatch(utils::span<const SPeerAddr> peers, const utils::span<const uint8_t>& rSpanTx) const
+{
+    sendBatchImpl(peers.size(),
+                  [&peers](std::size_t i) -> const SPeerAddr& { return peers[i]; },
+                  [&rSpanTx](std::size_t) -> const utils::span<const uint8_t>& { return rSpanTx; });
+}
+
+void CUdpDataLinkPrivate::sendBatch(utils::span<const utils::span<const uint8_t>> batch) const
+{
+    sendBatchImpl(batch.size(),
+                  [this](std::size_t) -> const SPeerAddr& { return m_peerAdr; },
+                  [&batch](std::size_t i) -> const utils::span<const uint8_t>& { return batch[i]; });
+}
+
+bool CUdpDataLinkPrivate::sendSegmented(const utils::span<const uint8_t>& rSpanTx, std::size_t segmentSize) const
+{
+    return sendToSegmented(m_peerAdr, rSpanTx, segmentSize);
+}
+
+bool CUdpDataLinkPrivate::sendToSegmented(const SPeerAddr& rClientAddr, const utils::span<const uint8_t>& rSpanTx, std::size_t segmentSize) const
+{
+    if ((segmentSize == 0) || (segmentSize > UINT16_MAX)) {
+        throw std::logic_error(utils::buildErrorMessage("DataSocket::", __func__, ": invalid segment size: ", segmentSize));
+    }
+
+    const std::size_t segmentsPerCall = std::min(maxGsoSegments, maxGsoPayload / segmentSize);
+    if ((segmentsPerCall < 2) || !isGsoSupported() || m_gsoFailed)
+    {
+        sendSegmentsBatch(rClientAddr, rSpanTx, segmentSize);
+        return false;
+    }
+
+    sockaddr_storage clAddr;
+    socklen_t claddrLen = toSockAddr(rClientAddr, clAddr);
+
+    uint8_t control[CMSG_SPACE(sizeof(uint16_t))] {};
+    msghdr msg {};
+    msg.msg_name       = &clAddr;
+    msg.msg_namelen    = claddrLen;
+    msg.msg_control    = control;
+    msg.msg_controllen = sizeof(control);
+    cmsghdr* pCmsg     = CMSG_FIRSTHDR(&msg);
+    pCmsg->cmsg_level  = SOL_UDP;
+    pCmsg->cmsg_type   = UDP_SEGMENT;
+    pCmsg->cmsg_len    = CMSG_LEN(sizeof(uint16_t));
+    const uint16_t gsoSize = static_cast<uint16_t>(segmentSize);
+    std::memcpy(CMSG_DATA(pCmsg), &gsoSize, sizeof(gsoSize));
+
+    // A segmented transmit is sent as a whole or fails, there is no partial write
+    std::size_t dataWritten = 0;
+    while (dataWritten < rSpanTx.size_bytes())
+    {
+        std::size_t length = std::min(rSpanTx.size_bytes() - dataWritten, segmentsPerCall * segmentSize);
+        iovec iov {const_cast<uint8_t*>(rSpanTx.data() + dataWritten), length};
+        msg.msg_iov    = &iov;
+        msg.msg_iovlen = 1;
+
+        ssize_t put = ::sendmsg(m_socketFd, &msg, MSG_NOSIGNAL);
+        if (put == -1)
+        {
+            switch(errno)
+            {
+                case EIO:        [[fallthrough]];
+                case EINVAL:
+                {
+                    // EIO: the device lacks checksum offload, GSO is given up for this link.
+                    // EINVAL: the segment exceeds the MTU of this route, only this transmit
+                    // falls back. The remainder is sent by sendmmsg, an error is reported there.
+                    if (errno == EIO) {
+                        m_gsoFailed = true;
+                    }
+                    sendSegmentsBatch(rClientAddr, utils::span<const uint8_t>(rSpanTx.data() + dataWritten, rSpanTx.size_bytes() - dataWritten), segmentSize);
+                    return false;
+                }
+                case EBADF:      [[fallthrough]];
+                case ECONNRESET: [[fallthrough]];
+                case ENXIO:      [[fallthrough]];
+                case EPIPE:
+                {
+                    // Fatal error
+                    throw std::domain_error(utils::buildErrorMessage("DataSocket::", __func__, ": sendmsg: critical error: ", strerror(errno)));
+                }
+                case EDQUOT:     [[fallthrough]];
+                case EFBIG:      [[fallthrough]];
+                case ENETDOWN:   [[fallthrough]];
+                case ENETUNREACH:[[fallthrough]];
+                case ENOSPC:
+                {
+                    // Resource acquisition failure or device error
+                    throw std::runtime_error(utils::buildErrorMessage("DataSocket::", __func__, ": sendmsg: resource failure: ", strerror(errno)));
+                }
+                case EINTR:      [[fallthrough]];
+                case EAGAIN:
+                {
+                    // Temporary Error, retry the write.
+                    continue;
+                }
+                default:
+                {
+                    throw std::runtime_error(utils::buildErrorMessage("DataSocket::", __func__, ": sendmsg: returned -1: ", strerror(errno)));
+                }
+            }
+        }
+        dataWritten += length;
+    }
+    return true;
+}
+
+void CUdpDataLinkPrivate::sendSegmentsBatch(const SPeerAddr& rClientAddr, const utils::span<const uint8_t>& rSpanTx, std::size_t segmentSize) const
+{
+    const std::size_t count = (rSpanTx.size_bytes() + segmentSize - 1) / segmentSize;
+    sendBatchImpl(count,
+                  [&rClientAddr](std::size_t) -> const SPeerAddr& { return rClientAddr; },
+                  [&rSpanTx, segmentSize](std::size_t i)
+                  {
+                      std::size_t offset = i * segmentSize;
+                      return utils::span<const uint8_t>(rSpanTx.data() + offset, std::min(segmentSize, rSpanTx.size_bytes() - offset));
+                  });
+}
+
 bool CUdpDataLinkPrivate::unblockRecive() noexcept
 {
+    if (m_pUring) {
+        return m_pUring->unblock();
+    }
+
     try {
         m_FdSet.UnBlock();
     }
@@ -187,6 +745,10 @@ bool CUdpDataLinkPrivate::unblockRecive() noexcept
 
 CUdpDataLink::ERet CUdpDataLinkPrivate::reciveFrom(utils::span<uint8_t>& rSpanRx, CUdpDataLink::CallbackReciveFrom scanForEnd) const
 {
+    if (m_pUring) {
+        return m_pUring->reciveFrom(rSpanRx, scanForEnd);
+    }
+
     utils::CFdSetRetval ret = m_FdSet.Select([this, &rSpanRx, &scanForEnd](int fd) {
         reciveFromImpl(rSpanRx, scanForEnd);
     });
@@ -201,41 +763,9 @@ CUdpDataLink::ERet CUdpDataLinkPrivate::reciveFrom(utils::span<uint8_t>& rSpanRx
 
 void CUdpDataLinkPrivate::reciveFromImpl(utils::span<uint8_t>& rSpanRx, CUdpDataLink::CallbackReciveFrom scanForEnd) const
 {
-    union e
-    {
-        sockaddr_storage  common;
-        sockaddr_in       sin;
-        sockaddr_in6      sin6;
-    } peerAdr;
-
+    sockaddr_storage peerAdr;
     socklen_t addr_size = sizeof(peerAdr);
 
-    SPeerAddr peerAddress;
-    auto toCIpAddress = [&peerAddress] (e& peerAdr)
-    {
-        switch (peerAdr.common.ss_family)
-        {
-            case AF_INET:
-            {
-                peerAddress.Ip = std::move(CIpAddress(peerAdr.sin.sin_addr));
-                peerAddress.Port = ntohs(peerAdr.sin.sin_port);
-                break;
-            }
-            case AF_INET6:
-            {
-                if (IN6_IS_ADDR_V4MAPPED(&peerAdr.sin6.sin6_addr)) {
-                    in_addr ip4;
-                    std::memcpy(&ip4, &peerAdr.sin6.sin6_addr.__in6_u.__u6_addr8[12], sizeof(in_addr));
-                    peerAddress.Ip = std::move(CIpAddress(ip4));
-                }
-                else {
-                    peerAddress.Ip = std::move(CIpAddress(peerAdr.sin6.sin6_addr));
-                }
-                peerAddress.Port = ntohs(peerAdr.sin6.sin6_port);
-                break;
-            }
-        }
-    };
     uint8_t* readBuffer = rSpanRx.data();
     std::size_t dataRead  = 0;
 
@@ -289,14 +819,306 @@ void CUdpDataLinkPrivate::reciveFromImpl(utils::span<uint8_t>& rSpanRx, CUdpData
         }
         dataRead += get;
 
-        toCIpAddress(peerAdr);
-        if (scanForEnd(peerAddress, utils::span<uint8_t>(readBuffer, dataRead))) {
+        if (scanForEnd(toPeerAddr(peerAdr), utils::span<uint8_t>(readBuffer, dataRead))) {
             break;
         }
     }
     rSpanRx = utils::span<uint8_t>(readBuffer, dataRead);
 }
 
+CUdpDataLink::ERet CUdpDataLinkPrivate::tryReciveFrom(utils::span<uint8_t>& rSpanRx, SPeerAddr& rPeerAddr) const
+{
+    sockaddr_storage peerAdr;
+
+    while (true)
+    {
+        socklen_t addr_size = sizeof(peerAdr);
+        ssize_t get = ::recvfrom(m_socketFd, rSpanRx.data(), rSpanRx.size_bytes(), MSG_DONTWAIT, (sockaddr*)&peerAdr, &addr_size);
+        if (get >= 0)
+        {
+            rSpanRx = utils::span<uint8_t>(rSpanRx.data(), static_cast<std::size_t>(get));
+            rPeerAddr = toPeerAddr(peerAdr);
+            return CUdpDataLink::ERet::OK;
+        }
+
+        switch(errno)
+        {
+            case EINTR:
+            {
+                continue;
+            }
+            case EAGAIN:
+            {
+                return CUdpDataLink::ERet::WOULDBLOCK;
+            }
+            default:
+            {
+                throw std::runtime_error(utils::buildErrorMessage("DataSocket::", __func__, ": read: returned -1: ", strerror(errno)));
+            }
+        }
+    }
+}
+
+CUdpDataLink::ERet CUdpDataLinkPrivate::reciveBatch(utils::span<SDatagram> batch, std::size_t& rCount) const
+{
+    rCount = 0;
+    if (batch.empty()) {
+        return CUdpDataLink::ERet::OK;
+    }
+
+    // Readiness is awaited once, all pending datagrams are then fetched by recvmmsg
+    while (rCount == 0)
+    {
+        if (m_pUring)
+        {
+            if (m_pUring->waitReadable() == CUdpDataLink::ERet::UNBLOCK) {
+                return CUdpDataLink::ERet::UNBLOCK;
+            }
+            rCount = reciveBatchImpl(batch);
+            continue;
+        }
+
+        utils::CFdSetRetval ret = m_FdSet.Select([this, &batch, &rCount](int) {
+            rCount = reciveBatchImpl(batch);
+        });
+        if (ret == utils::CFdSetRetval::UNBLOCK) {
+            return CUdpDataLink::ERet::UNBLOCK;
+        }
+    }
+    return CUdpDataLink::ERet::OK;
+}
+
+CUdpDataLink::ERet CUdpDataLinkPrivate::tryReciveBatch(utils::span<SDatagram> batch, std::size_t& rCount) const
+{
+    rCount = reciveBatchImpl(batch);
+    return ((rCount == 0) && !batch.empty()) ? CUdpDataLink::ERet::WOULDBLOCK : CUdpDataLink::ERet::OK;
+}
+
+std::size_t CUdpDataLinkPrivate::reciveBatchImpl(utils::span<SDatagram> batch) const
+{
+    std::array<mmsghdr, maxBatchDatagrams>          msgs;
+    std::array<iovec, maxBatchDatagrams>            iovs;
+    std::array<sockaddr_storage, maxBatchDatagrams> peerAdrs;
+
+    unsigned count = static_cast<unsigned>(std::min(batch.size(), maxBatchDatagrams));
+    for (unsigned i = 0; i < count; i++)
+    {
+        iovs[i] = iovec {batch[i].Data.data(), batch[i].Data.size_bytes()};
+        msgs[i] = mmsghdr {};
+        msgs[i].msg_hdr.msg_name    = &peerAdrs[i];
+        msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+        msgs[i].msg_hdr.msg_iov     = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen  = 1;
+    }
+
+    int get;
+    while (true)
+    {
+        get = ::recvmmsg(m_socketFd, msgs.data(), count, MSG_DONTWAIT, nullptr);
+        if (get >= 0) {
+            break;
+        }
+
+        switch(errno)
+        {
+            case EBADF:     [[fallthrough]];
+            case EFAULT:    [[fallthrough]];
+            case EINVAL:    [[fallthrough]];
+            case ENXIO:
+            { /* Fatal error. Programming bug */
+                throw std::domain_error(utils::buildErrorMessage("DataSocket::", __func__, ": recvmmsg: critical error: ", strerror(errno)));
+            }
+            case EIO:       [[fallthrough]];
+            case ENOBUFS:   [[fallthrough]];
+            case ENOMEM:
+            { /* Resource acquisition failure or device error*/
+                throw std::runtime_error(utils::buildErrorMessage("DataSocket::", __func__, ": recvmmsg: resource failure: ", strerror(errno)));
+            }
+            case EINTR:
+            {
+                continue;
+            }
+            case EAGAIN:    [[fallthrough]];
+            case ECONNREFUSED:
+            {
+                // Nothing pending, or a reported ICMP error of a previous transmit
+                return 0;
+            }
+            default:
+            {
+                throw std::runtime_error(utils::buildErrorMessage("DataSocket::", __func__, ": recvmmsg: returned -1: ", strerror(errno)));
+            }
+        }
+    }
+
+    for (int i = 0; i < get; i++)
+    {
+        batch[i].Data  = utils::span<uint8_t>(batch[i].Data.data(), std::min<std::size_t>(msgs[i].msg_len, batch[i].Data.size_bytes()));
+        batch[i].Peer  = toPeerAddr(peerAdrs[i]);
+        batch[i].Flags = msgs[i].msg_hdr.msg_flags;
+    }
+    return static_cast<std::size_t>(get);
+}
+
+bool CUdpDataLinkPrivate::setGroRecive(bool enable)
+{
+    int value = enable ? 1 : 0;
+    if (::setsockopt(m_socketFd, SOL_UDP, UDP_GRO, &value, sizeof(value)) != 0) {
+        std::cerr << utils::buildErrorMessage("CUdpDataLinkPrivate::", __func__, ": UDP_GRO: ", strerror(errno)) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+CUdpDataLink::ERet CUdpDataLinkPrivate::reciveSegments(utils::span<uint8_t> rxBuffer, CUdpDataLink::CallbackReciveSegments& rOnSegments) const
+{
+    std::size_t count = 0;
+    while (count == 0)
+    {
+        if (m_pUring)
+        {
+            if (m_pUring->waitReadable() == CUdpDataLink::ERet::UNBLOCK) {
+                return CUdpDataLink::ERet::UNBLOCK;
+            }
+            count = reciveSegmentsImpl(rxBuffer, rOnSegments);
+            continue;
+        }
+
+        utils::CFdSetRetval ret = m_FdSet.Select([this, &rxBuffer, &rOnSegments, &count](int) {
+            count = reciveSegmentsImpl(rxBuffer, rOnSegments);
+        });
+        if (ret == utils::CFdSetRetval::UNBLOCK) {
+            return CUdpDataLink::ERet::UNBLOCK;
+        }
+    }
+    return CUdpDataLink::ERet::OK;
+}
+
+CUdpDataLink::ERet CUdpDataLinkPrivate::tryReciveSegments(utils::span<uint8_t> rxBuffer, CUdpDataLink::CallbackReciveSegments& rOnSegments) const
+{
+    return (reciveSegmentsImpl(rxBuffer, rOnSegments) == 0) ? CUdpDataLink::ERet::WOULDBLOCK : CUdpDataLink::ERet::OK;
+}
+
+std::size_t CUdpDataLinkPrivate::reciveSegmentsImpl(utils::span<uint8_t> rxBuffer, CUdpDataLink::CallbackReciveSegments& rOnSegments) const
+{
+    std::array<utils::span<uint8_t>, maxGsoSegments> segments;
+    std::size_t count = 0;
+
+    while (true)
+    {
+        sockaddr_storage peerAdr;
+        iovec iov {rxBuffer.data(), rxBuffer.size_bytes()};
+        uint8_t control[CMSG_SPACE(sizeof(int))];
+        msghdr msg {};
+        msg.msg_name       = &peerAdr;
+        msg.msg_namelen    = sizeof(peerAdr);
+        msg.msg_iov        = &iov;
+        msg.msg_iovlen     = 1;
+        msg.msg_control    = control;
+        msg.msg_controllen = sizeof(control);
+
+        ssize_t get = ::recvmsg(m_socketFd, &msg, MSG_DONTWAIT);
+        if (get == -1)
+        {
+            switch(errno)
+            {
+                case EBADF:     [[fallthrough]];
+                case EFAULT:    [[fallthrough]];
+                case EINVAL:    [[fallthrough]];
+                case ENXIO:
+                { /* Fatal error. Programming bug */
+                    throw std::domain_error(utils::buildErrorMessage("DataSocket::", __func__, ": recvmsg: critical error: ", strerror(errno)));
+                }
+                case EIO:       [[fallthrough]];
+                case ENOBUFS:   [[fallthrough]];
+                case ENOMEM:
+                { /* Resource acquisition failure or device error*/
+                    throw std::runtime_error(utils::buildErrorMessage("DataSocket::", __func__, ": recvmsg: resource failure: ", strerror(errno)));
+                }
+                case EINTR:
+                {
+                    continue;
+                }
+                case EAGAIN:    [[fallthrough]];
+                case ECONNREFUSED:
+                {
+                    // Nothing pending, or a reported ICMP error of a previous transmit
+                    return count;
+                }
+                default:
+                {
+                    throw std::runtime_error(utils::buildErrorMessage("DataSocket::", __func__, ": recvmsg: returned -1: ", strerror(errno)));
+                }
+            }
+        }
+        count++;
+
+        // Without a GRO control message the datagram was not coalesced
+        std::size_t length = std::min<std::size_t>(static_cast<std::size_t>(get), rxBuffer.size_bytes());
+        std::size_t segmentSize = length;
+        for (cmsghdr* pCmsg = CMSG_FIRSTHDR(&msg); pCmsg != nullptr; pCmsg = CMSG_NXTHDR(&msg, pCmsg))
+        {
+            if ((pCmsg->cmsg_level == SOL_UDP) && (pCmsg->cmsg_type == UDP_GRO))
+            {
+                int gsoSize;
+                std::memcpy(&gsoSize, CMSG_DATA(pCmsg), sizeof(gsoSize));
+                if (gsoSize > 0) {
+                    segmentSize = static_cast<std::size_t>(gsoSize);
+                }
+            }
+        }
+
+        const SPeerAddr peer = toPeerAddr(peerAdr);
+        bool done = false;
+        std::size_t offset = 0;
+        do
+        {
+            // a datagram of more segments than views is passed by several calls
+            std::size_t segmentCount = 0;
+            while ((offset < length) && (segmentCount < segments.size()))
+            {
+                std::size_t segmentLength = std::min(segmentSize, length - offset);
+                segments[segmentCount++] = utils::span<uint8_t>(rxBuffer.data() + offset, segmentLength);
+                offset += segmentLength;
+            }
+            done = rOnSegments(peer, utils::span<const utils::span<uint8_t>>(segments.data(), segmentCount)) || done;
+        } while (offset < length);
+
+        if (done) {
+            return count;
+        }
+    }
+}
+
+int CUdpDataLinkPrivate::getFd() const noexcept
+{
+    return m_socketFd;
+}
+
+EIoEngine CUdpDataLinkPrivate::setIoEngine(EIoEngine engine)
+{
+    if ((engine == EIoEngine::URING) && isIoEngineSupported(EIoEngine::URING))
+    {
+        if (!m_pUring) {
+            try {
+                m_pUring = std::make_unique<CUdpUringEngine>(m_socketFd);
+            }
+            catch (const std::exception& e) {
+                std::cerr << e.what() << std::endl;
+            }
+        }
+    }
+    else {
+        m_pUring.reset();
+    }
+    return getIoEngine();
+}
+
+EIoEngine CUdpDataLinkPrivate::getIoEngine() const noexcept
+{
+    return m_pUring ? EIoEngine::URING : EIoEngine::POSIX;
+}
+
 //*****************************************************************************
 // Method definitions "CUdpDataLink"
 
@@ -345,4 +1167,74 @@ CUdpDataLink::ERet CUdpDataLink::reciveFrom(utils::span<uint8_t>& rSpanRx, Callb
 CUdpDataLink::ERet CUdpDataLink::reciveFrom(utils::span<uint8_t>&& rSpanRx, CallbackReciveFrom scanForEnd) const
 {
     return m_pPrivate->reciveFrom(rSpanRx, scanForEnd);
-}
\ No newline at end of file
+}
+
+CUdpDataLink::ERet CUdpDataLink::tryReciveFrom(utils::span<uint8_t>& rSpanRx, SPeerAddr& rPeerAddr) const
+{
+    return m_pPrivate->tryReciveFrom(rSpanRx, rPeerAddr);
+}
+
+void CUdpDataLink::sendToBatch(utils::span<const SDatagramTx> batch) const
+{
+    m_pPrivate->sendToBatch(batch);
+}
+
+void CUdpDataLink::sendToBatch(utils::span<const SPeerAddr> peers, const utils::span<const uint8_t>& rSpanTx) const
+{
+    m_pPrivate->sendToBatch(peers, rSpanTx);
+}
+
+void CUdpDataLink::sendBatch(utils::span<const utils::span<const uint8_t>> batch) const
+{
+    m_pPrivate->sendBatch(batch);
+}
+
+bool CUdpDataLink::sendToSegmented(const SPeerAddr& rClientAddr, const utils::span<const uint8_t>& rSpanTx, std::size_t segmentSize) const
+{
+    return m_pPrivate->sendToSegmented(rClientAddr, rSpanTx, segmentSize);
+}
+
+bool CUdpDataLink::sendSegmented(const utils::span<const uint8_t>& rSpanTx, std::size_t segmentSize) const
+{
+    return m_pPrivate->sendSegmented(rSpanTx, segmentSize);
+}
+
+CUdpDataLink::ERet CUdpDataLink::reciveBatch(utils::span<SDatagram> batch, std::size_t& rCount) const
+{
+    return m_pPrivate->reciveBatch(batch, rCount);
+}
+
+CUdpDataLink::ERet CUdpDataLink::tryReciveBatch(utils::span<SDatagram> batch, std::size_t& rCount) const
+{
+    return m_pPrivate->tryReciveBatch(batch, rCount);
+}
+
+bool CUdpDataLink::setGroRecive(bool enable)
+{
+    return m_pPrivate->setGroRecive(enable);
+}
+
+CUdpDataLink::ERet CUdpDataLink::reciveSegments(utils::span<uint8_t> rxBuffer, CallbackReciveSegments onSegments) const
+{
+    return m_pPrivate->reciveSegments(rxBuffer, onSegments);
+}
+
+CUdpDataLink::ERet CUdpDataLink::tryReciveSegments(utils::span<uint8_t> rxBuffer, CallbackReciveSegments onSegments) const
+{
+    return m_pPrivate->tryReciveSegments(rxBuffer, onSegments);
+}
+
+int CUdpDataLink::getFd() const noexcept
+{
+    return m_pPrivate ? m_pPrivate->getFd() : -1;
+}
+
+EIoEngine CUdpDataLink::setIoEngine(EIoEngine engine)
+{
+    return m_pPrivate->setIoEngine(engine);
+}
+
+EIoEngine CUdpDataLink::getIoEngine() const noexcept
+{
+    return m_pPrivate->getIoEngine();
+}
@@ -0,0 +1,227 @@
+/*
+ * This file is part of the EMBTOM project
+ * Copyright (c) 2018-2020 Thomas Willetal
+ * (https://github.com/embtom)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+//******************************************************************************
+// Headers
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <string>
+#include <map>
+#include <docopt.h>
+#include <span.h>
+#include <BaseSocket.hpp>
+#include <Tcp/TcpClient.hpp>
+#include <Tcp/TcpServer.hpp>
+#include <Tcp/TcpDataLink.hpp>
+#include <Udp/UdpClient.hpp>
+#include <Udp/UdpServer.hpp>
+#include <Udp/UdpDataLink.hpp>
+
+constexpr int PORT_NUM = 5010;
+
+using namespace EtNet;
+
+//******************************************************************************
+// Function definitions
+
+namespace
+{
+
+constexpr auto untilFull = [](utils::span<uint8_t> rx){ return false; };
+constexpr auto oneDatagram = [](SPeerAddr peer, utils::span<uint8_t> rx){ return true; };
+
+const char* toString(EIoEngine engine) noexcept
+{
+    return (engine == EIoEngine::URING) ? "uring" : "posix";
+}
+
+void printResult(const char* pProto, EIoEngine engine, unsigned messages, std::chrono::nanoseconds elapsed)
+{
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    std::cout << std::left
+              << std::setw(6)  << pProto
+              << std::setw(8)  << toString(engine)
+              << std::right << std::fixed << std::setprecision(2)
+              << std::setw(12) << (messages / seconds) << " msg/s"
+              << std::setw(10) << (seconds * 1e6 / messages) << " us/rtt"
+              << std::endl;
+}
+
+//! ping-pong of fixed size messages over a loopback stream connection
+std::chrono::nanoseconds benchTcp(EIoEngine engine, unsigned messages, std::size_t size)
+{
+    CTcpServer server(CBaseSocket::SoReuseSocket(CBaseSocket(ESocketMode::INET_STREAM)), PORT_NUM);
+    server.setIoEngine(engine);
+
+    std::thread echo([&server, engine, messages, size]()
+    {
+        CTcpDataLink link;
+        CIpAddress peer;
+        std::tie(link, peer) = server.waitForConnection();
+        link.setIoEngine(engine);
+
+        std::vector<uint8_t> rx(size);
+        for (unsigned i = 0; i < messages; i++)
+        {
+            utils::span<uint8_t> rxSpan(rx.data(), rx.size());
+            link.recive(rxSpan, untilFull);
+            link.send(utils::span<const uint8_t>(rxSpan.data(), rxSpan.size()));
+        }
+    });
+
+    CTcpClient client(CBaseSocket(ESocketMode::INET_STREAM));
+    CTcpDataLink link = client.connect(std::string("localhost"), PORT_NUM);
+    link.setIoEngine(engine);
+
+    std::vector<uint8_t> tx(size, 0x55);
+    std::vector<uint8_t> rx(size);
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < messages; i++)
+    {
+        link.send(utils::span<const uint8_t>(tx.data(), tx.size()));
+        utils::span<uint8_t> rxSpan(rx.data(), rx.size());
+        link.recive(rxSpan, untilFull);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    echo.join();
+    return elapsed;
+}
+
+//! ping-pong of fixed size datagrams over loopback
+std::chrono::nanoseconds benchUdp(EIoEngine engine, unsigned messages, std::size_t size)
+{
+    CUdpServer server(CBaseSocket::SoReuseSocket(CBaseSocket(ESocketMode::INET_DGRAM)), PORT_NUM);
+    CUdpClient client(CBaseSocket(ESocketMode::INET_DGRAM));
+    CUdpDataLink link = client.getLink(std::string("localhost"), PORT_NUM);
+    link.setIoEngine(engine);
+
+    std::vector<uint8_t> tx(size, 0x55);
+    std::vector<uint8_t> rx(size);
+
+    // The server link is returned after the first datagram has arrived
+    auto start = std::chrono::steady_clock::now();
+    link.send(utils::span<const uint8_t>(tx.data(), tx.size()));
+
+    std::thread echo([&server, engine, messages, size]()
+    {
+        CUdpDataLink link = server.waitForConnection();
+        link.setIoEngine(engine);
+
+        std::vector<uint8_t> rx(size);
+        for (unsigned i = 0; i < messages; i++)
+        {
+            link.reciveFrom(utils::span<uint8_t>(rx.data(), rx.size()), [&link](SPeerAddr peer, utils::span<uint8_t> rxSpan)
+            {
+                link.sendTo(peer, utils::span<const uint8_t>(rxSpan.data(), rxSpan.size()));
+                return true;
+            });
+        }
+    });
+
+    for (unsigned i = 0; i < messages; i++)
+    {
+        link.reciveFrom(utils::span<uint8_t>(rx.data(), rx.size()), oneDatagram);
+        if (i + 1 < messages) {
+            link.send(utils::span<const uint8_t>(tx.data(), tx.size()));
+        }
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    echo.join();
+    return elapsed;
+}
+
+} // namespace
+
+//*****************************************************************************
+//! \brief EXA_BenchIoEngine
+//!
+
+int main(int argc, char *argv[])
+{
+    constexpr std::string_view docOptCmd =
+        R"(EXA_BenchIoEngine.
+            Compares the POSIX and the io_uring engine by a loopback ping-pong.
+            Usage:
+            EXA_BenchIoEngine [--messages=<n>] [--size=<bytes>]
+            EXA_BenchIoEngine (-h | --help)
+            EXA_BenchIoEngine --version
+            Options:
+            -h --help           Show this screen.
+            --version           Show version.
+            --messages=<n>      Number of round trips [default: 100000].
+            --size=<bytes>      Size of a message [default: 64].
+        )";
+
+    constexpr auto networkAdapterVersion = "networkAdapter " NETWORKING_ADAPTER_VERSION;
+    using ArgMap_t = std::map<std::string, docopt::value>;
+    ArgMap_t args = docopt::docopt(std::string(docOptCmd),
+                                   { argv + 1, argv + argc },
+                                   true,
+                                   networkAdapterVersion);
+
+    unsigned messages = 100000;
+    std::size_t size  = 64;
+    if (args["--messages"]) {
+        messages = static_cast<unsigned>(args["--messages"].asLong());
+    }
+    if (args["--size"]) {
+        size = static_cast<std::size_t>(args["--size"].asLong());
+    }
+    if ((messages == 0) || (size == 0)) {
+        std::cout << "messages and size have to be greater than zero" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<EIoEngine> engines {EIoEngine::POSIX};
+    if (isIoEngineSupported(EIoEngine::URING)) {
+        engines.push_back(EIoEngine::URING);
+    }
+    else {
+        std::cout << "io_uring not supported by the running kernel, only POSIX is measured" << std::endl;
+    }
+
+    std::cout << messages << " round trips of " << size << " bytes" << std::endl;
+    try
+    {
+        for (auto engine : engines) {
+            printResult("tcp", engine, messages, benchTcp(engine, messages, size));
+        }
+        for (auto engine : engines) {
+            printResult("udp", engine, messages, benchUdp(engine, messages, size));
+        }
+    }
+    catch(const std::exception& e) {
+        std::cout << "Benchmark failed: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,223 @@
+/*
+ * This file is part of the EMBTOM project
+ * Copyright (c) 2018-2020 Thomas Willetal
+ * (https://github.com/embtom)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+//******************************************************************************
+// Headers
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <string>
+#include <map>
+#include <unordered_map>
+#include <docopt.h>
+#include <FlatHashMap.hpp>
+#include <Udp/UdpDataLink.hpp>
+
+using namespace EtNet;
+
+//******************************************************************************
+// Function definitions
+
+namespace
+{
+
+//! per peer state as kept by a datagram server
+struct SPeerState
+{
+    uint64_t packets {0};
+    uint64_t bytes {0};
+    std::chrono::steady_clock::time_point lastSeen;
+};
+
+struct SResult
+{
+    double insert;
+    double hit;
+    double miss;
+    double churn;
+};
+
+//! peers of IPv4 and IPv6 addresses with random ports
+std::vector<SPeerAddr> makePeers(std::size_t count, std::mt19937_64& rRandom)
+{
+    std::vector<SPeerAddr> peers;
+    peers.reserve(count);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        const uint64_t value = rRandom();
+        if (i % 4 == 0)
+        {
+            in6_addr ip {};
+            ip.s6_addr[0] = 0x20;
+            ip.s6_addr[1] = 0x01;
+            for (int byte = 8; byte < 16; byte++) {
+                ip.s6_addr[byte] = static_cast<uint8_t>(value >> (8 * (byte - 8)));
+            }
+            peers.push_back(SPeerAddr{CIpAddress(ip), static_cast<unsigned>(1024 + (value >> 48) % 60000)});
+        }
+        else
+        {
+            in_addr ip {static_cast<in_addr_t>(value)};
+            peers.push_back(SPeerAddr{CIpAddress(ip), static_cast<unsigned>(1024 + (value >> 48) % 60000)});
+        }
+    }
+    return peers;
+}
+
+template <typename Function>
+double nsPerOperation(std::size_t operations, Function function)
+{
+    auto start = std::chrono::steady_clock::now();
+    function();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(operations);
+}
+
+//! the operations of a datagram server: new peers, updates of known peers,
+//! datagrams of unknown peers and the expiry of peers replaced by new ones
+template <typename Table>
+SResult bench(const std::vector<SPeerAddr>& rPeers, const std::vector<SPeerAddr>& rUnknown,
+              const std::vector<std::size_t>& rOrder, std::size_t rounds)
+{
+    SResult result {};
+    Table table;
+    result.insert = nsPerOperation(rPeers.size(), [&]()
+    {
+        for (const auto& rPeer : rPeers) {
+            table[rPeer].lastSeen = std::chrono::steady_clock::time_point();
+        }
+    });
+
+    result.hit = nsPerOperation(rounds * rOrder.size(), [&]()
+    {
+        for (std::size_t round = 0; round < rounds; round++)
+        {
+            for (std::size_t index : rOrder)
+            {
+                auto it = table.find(rPeers[index]);
+                it->second.packets++;
+                it->second.bytes += 512;
+            }
+        }
+    });
+
+    std::size_t found = 0;
+    result.miss = nsPerOperation(rUnknown.size(), [&]()
+    {
+        for (const auto& rPeer : rUnknown) {
+            found += (table.find(rPeer) != table.end()) ? 1 : 0;
+        }
+    });
+
+    result.churn = nsPerOperation(2 * rUnknown.size(), [&]()
+    {
+        for (std::size_t i = 0; i < rUnknown.size(); i++)
+        {
+            table.erase(rPeers[rOrder[i % rOrder.size()]]);
+            table[rUnknown[i]].packets = 1;
+        }
+    });
+
+    if (found != 0) {
+        std::cout << "unexpected hit of an unknown peer" << std::endl;
+    }
+    return result;
+}
+
+void printResult(const char* pTable, const SResult& rResult)
+{
+    std::cout << std::left << std::setw(22) << pTable
+              << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << rResult.insert
+              << std::setw(10) << rResult.hit
+              << std::setw(10) << rResult.miss
+              << std::setw(10) << rResult.churn << std::endl;
+}
+
+} // namespace
+
+//*****************************************************************************
+//! \brief EXA_BenchPeerTable
+//!
+
+int main(int argc, char *argv[])
+{
+    constexpr std::string_view docOptCmd =
+        R"(EXA_BenchPeerTable.
+            Compares the per peer state table of CFlatHashMap and std::unordered_map,
+            both keyed by SPeerAddr. The times are in ns per operation.
+            Usage:
+            EXA_BenchPeerTable [--peers=<n>] [--rounds=<n>]
+            EXA_BenchPeerTable (-h | --help)
+            EXA_BenchPeerTable --version
+            Options:
+            -h --help           Show this screen.
+            --version           Show version.
+            --peers=<n>         Count of peers [default: 200000].
+            --rounds=<n>        Lookups of each peer [default: 10].
+        )";
+
+    constexpr auto networkAdapterVersion = "networkAdapter " NETWORKING_ADAPTER_VERSION;
+    using ArgMap_t = std::map<std::string, docopt::value>;
+    ArgMap_t args = docopt::docopt(std::string(docOptCmd),
+                                   { argv + 1, argv + argc },
+                                   true,
+                                   networkAdapterVersion);
+
+    std::size_t peerCount = 200000;
+    std::size_t rounds    = 10;
+    if (args["--peers"]) {
+        peerCount = static_cast<std::size_t>(args["--peers"].asLong());
+    }
+    if (args["--rounds"]) {
+        rounds = static_cast<std::size_t>(args["--rounds"].asLong());
+    }
+    if ((peerCount == 0) || (rounds == 0)) {
+        std::cout << "peers and rounds have to be greater than zero" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::mt19937_64 random(4711);
+    const std::vector<SPeerAddr> peers   = makePeers(peerCount, random);
+    const std::vector<SPeerAddr> unknown = makePeers(peerCount, random);
+    std::vector<std::size_t> order(peerCount);
+    for (std::size_t i = 0; i < order.size(); i++) {
+        order[i] = i;
+    }
+    std::shuffle(order.begin(), order.end(), random);
+
+    std::cout << peerCount << " peers, " << rounds << " lookups per peer" << std::endl;
+    std::cout << std::left << std::setw(22) << "table"
+              << std::right << std::setw(10) << "insert" << std::setw(10) << "hit"
+              << std::setw(10) << "miss" << std::setw(10) << "churn" << std::endl;
+    printResult("std::unordered_map", bench<std::unordered_map<SPeerAddr, SPeerState>>(peers, unknown, order, rounds));
+    printResult("CFlatHashMap", bench<CFlatHashMap<SPeerAddr, SPeerState>>(peers, unknown, order, rounds));
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,264 @@
+/*
+ * This file is part of the EMBTOM project
+ * Copyright (c) 2018-2020 Thomas Willetal
+ * (https://github.com/embtom)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+//******************************************************************************
+// Headers
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cstring>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <string>
+#include <map>
+#include <docopt.h>
+#include <Lookup/PrefixTable.hpp>
+
+using namespace EtNet;
+
+//******************************************************************************
+// Function definitions
+
+namespace
+{
+
+//! a prefix of the linear scan, the host bits are cleared
+struct SPrefix
+{
+    CIpAddress network;
+    unsigned length;
+
+    bool contains(const CIpAddress& rAddress) const
+    {
+        if (rAddress.addressFamily() != network.addressFamily()) {
+            return false;
+        }
+        if (const in_addr* pV4 = rAddress.to_v4())
+        {
+            const uint32_t mask = (length == 0) ? 0 : (UINT32_MAX << (32 - length));
+            return (ntohl(pV4->s_addr) & mask) == ntohl(network.to_v4()->s_addr);
+        }
+        const uint8_t* pBytes = rAddress.to_v6()->s6_addr;
+        const uint8_t* pNetwork = network.to_v6()->s6_addr;
+        const unsigned fullBytes = length / 8;
+        if (std::memcmp(pBytes, pNetwork, fullBytes) != 0) {
+            return false;
+        }
+        const uint8_t mask = static_cast<uint8_t>(0xff00 >> (length % 8));
+        return (length % 8 == 0) || ((pBytes[fullBytes] & mask) == pNetwork[fullBytes]);
+    }
+};
+
+//! random prefixes of route table like lengths, a quarter of them IPv6
+std::vector<SPrefix> makePrefixes(std::size_t count, std::mt19937_64& rRandom)
+{
+    std::vector<SPrefix> prefixes;
+    prefixes.reserve(count);
+    while (prefixes.size() < count)
+    {
+        const uint64_t value = rRandom();
+        if (prefixes.size() % 4 == 0)
+        {
+            const unsigned length = 24 + value % 41;
+            in6_addr ip {};
+            ip.s6_addr[0] = 0x20;
+            ip.s6_addr[1] = 0x01;
+            for (unsigned byte = 2; byte < 8; byte++)
+            {
+                const unsigned keep = std::min(8U, std::max(8 * byte, length) - 8 * byte);
+                ip.s6_addr[byte] = static_cast<uint8_t>((value >> (8 * byte)) & (0xff00 >> keep));
+            }
+            prefixes.push_back(SPrefix{CIpAddress(ip), length});
+        }
+        else
+        {
+            const unsigned length = 8 + (value >> 32) % 25;
+            in_addr ip {htonl(static_cast<uint32_t>(value) & (UINT32_MAX << (32 - length)))};
+            prefixes.push_back(SPrefix{CIpAddress(ip), length});
+        }
+    }
+    return prefixes;
+}
+
+//! addresses within the prefixes, with the host bits random
+std::vector<CIpAddress> makeAddresses(const std::vector<SPrefix>& rPrefixes, std::size_t count, std::mt19937_64& rRandom)
+{
+    std::vector<CIpAddress> addresses;
+    addresses.reserve(count);
+    for (std::size_t i = 0; i < count; i++)
+    {
+        const SPrefix& rPrefix = rPrefixes[rRandom() % rPrefixes.size()];
+        const uint64_t value = rRandom();
+        if (const in_addr* pV4 = rPrefix.network.to_v4())
+        {
+            const uint32_t hostMask = (rPrefix.length == 32) ? 0 : (UINT32_MAX >> rPrefix.length);
+            in_addr ip {pV4->s_addr | htonl(static_cast<uint32_t>(value) & hostMask)};
+            addresses.emplace_back(ip);
+        }
+        else
+        {
+            in6_addr ip = *rPrefix.network.to_v6();
+            for (int byte = 8; byte < 16; byte++) {
+                ip.s6_addr[byte] = static_cast<uint8_t>(value >> (8 * (byte - 8)));
+            }
+            addresses.emplace_back(ip);
+        }
+    }
+    return addresses;
+}
+
+template <typename Function>
+double nsPerOperation(std::size_t operations, Function function)
+{
+    auto start = std::chrono::steady_clock::now();
+    function();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(operations);
+}
+
+void printResult(const char* pMethod, double nsPerLookup, uint64_t checksum)
+{
+    std::cout << std::left << std::setw(22) << pMethod
+              << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << nsPerLookup
+              << std::setw(16) << 1000.0 / nsPerLookup
+              << std::setw(22) << checksum << std::endl;
+}
+
+} // namespace
+
+//*****************************************************************************
+//! \brief EXA_BenchPrefixTable
+//!
+
+int main(int argc, char *argv[])
+{
+    constexpr std::string_view docOptCmd =
+        R"(EXA_BenchPrefixTable.
+            Compares the longest prefix match of CPrefixTable, looked up directly
+            and through a CSharedPrefixTable reader, with a linear scan of the
+            prefixes. The scan is limited to the first --scan prefixes.
+            Usage:
+            EXA_BenchPrefixTable [--prefixes=<n>] [--lookups=<n>] [--scan=<n>]
+            EXA_BenchPrefixTable (-h | --help)
+            EXA_BenchPrefixTable --version
+            Options:
+            -h --help           Show this screen.
+            --version           Show version.
+            --prefixes=<n>      Count of prefixes [default: 100000].
+            --lookups=<n>       Count of lookups [default: 10000000].
+            --scan=<n>          Prefixes of the linear scan [default: 100].
+        )";
+
+    constexpr auto networkAdapterVersion = "networkAdapter " NETWORKING_ADAPTER_VERSION;
+    using ArgMap_t = std::map<std::string, docopt::value>;
+    ArgMap_t args = docopt::docopt(std::string(docOptCmd),
+                                   { argv + 1, argv + argc },
+                                   true,
+                                   networkAdapterVersion);
+
+    std::size_t prefixCount = 100000;
+    std::size_t lookups     = 10000000;
+    std::size_t scanCount   = 100;
+    if (args["--prefixes"]) {
+        prefixCount = static_cast<std::size_t>(args["--prefixes"].asLong());
+    }
+    if (args["--lookups"]) {
+        lookups = static_cast<std::size_t>(args["--lookups"].asLong());
+    }
+    if (args["--scan"]) {
+        scanCount = static_cast<std::size_t>(args["--scan"].asLong());
+    }
+    if ((prefixCount == 0) || (lookups == 0) || (scanCount == 0)) {
+        std::cout << "prefixes, lookups and scan have to be greater than zero" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::mt19937_64 random(4711);
+    const std::vector<SPrefix> prefixes = makePrefixes(prefixCount, random);
+    const std::vector<CIpAddress> addresses = makeAddresses(prefixes, 1 << 20, random);
+
+    CPrefixTable::CBuilder builder;
+    for (std::size_t i = 0; i < prefixes.size(); i++) {
+        builder.add(prefixes[i].network, prefixes[i].length, static_cast<uint32_t>(i));
+    }
+    std::shared_ptr<const CPrefixTable> pTable;
+    const double buildTime = nsPerOperation(1, [&]() { pTable = builder.build(); });
+
+    std::cout << pTable->size() << " prefixes, built in " << std::setprecision(1) << std::fixed << buildTime / 1e6
+              << " ms, " << pTable->memoryUsage() / (1024 * 1024) << " MiB" << std::endl;
+    std::cout << std::left << std::setw(22) << "method"
+              << std::right << std::setw(12) << "ns/lookup" << std::setw(16) << "Mlookups/s"
+              << std::setw(22) << "checksum" << std::endl;
+
+    const std::size_t mask = addresses.size() - 1;
+    uint64_t checksum = 0;
+    double ns = nsPerOperation(lookups, [&]()
+    {
+        for (std::size_t i = 0; i < lookups; i++) {
+            checksum += pTable->lookup(addresses[i & mask]);
+        }
+    });
+    printResult("CPrefixTable", ns, checksum);
+
+    CSharedPrefixTable shared(pTable);
+    CSharedPrefixTable::CReader reader(shared);
+    checksum = 0;
+    ns = nsPerOperation(lookups, [&]()
+    {
+        for (std::size_t i = 0; i < lookups; i++) {
+            checksum += reader.lookup(addresses[i & mask]);
+        }
+    });
+    printResult("CSharedPrefixTable", ns, checksum);
+
+    // The scan covers only a part of the prefixes, the lookups are reduced accordingly
+    const std::size_t scanPrefixes = std::min(scanCount, prefixes.size());
+    const std::size_t scanLookups  = std::max<std::size_t>(1, lookups / scanPrefixes);
+    checksum = 0;
+    ns = nsPerOperation(scanLookups, [&]()
+    {
+        for (std::size_t i = 0; i < scanLookups; i++)
+        {
+            const CIpAddress& rAddress = addresses[i & mask];
+            uint32_t value = CPrefixTable::noMatch;
+            unsigned length = 0;
+            for (std::size_t p = 0; p < scanPrefixes; p++)
+            {
+                if (prefixes[p].contains(rAddress) && ((value == CPrefixTable::noMatch) || (prefixes[p].length >= length)))
+                {
+                    value  = static_cast<uint32_t>(p);
+                    length = prefixes[p].length;
+                }
+            }
+            checksum += value;
+        }
+    });
+    printResult("linear scan", ns, checksum);
+
+    return EXIT_SUCCESS;
+}
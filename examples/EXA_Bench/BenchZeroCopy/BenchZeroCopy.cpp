@@ -0,0 +1,223 @@
+/*
+ * This file is part of the EMBTOM project
+ * Copyright (c) 2018-2020 Thomas Willetal
+ * (https://github.com/embtom)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+ * LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ * OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+ * WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+//******************************************************************************
+// Headers
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <string>
+#include <map>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <docopt.h>
+#include <span.h>
+#include <BaseSocket.hpp>
+#include <Tcp/TcpClient.hpp>
+#include <Tcp/TcpServer.hpp>
+#include <Tcp/TcpDataLink.hpp>
+
+constexpr int PORT_NUM = 5011;
+
+using namespace EtNet;
+
+//******************************************************************************
+// Function definitions
+
+namespace
+{
+
+struct SResult
+{
+    std::chrono::nanoseconds elapsed;
+    std::chrono::microseconds cpu;
+    CTcpDataLink::SZeroCopyStats stats;
+};
+
+//! user and system time consumed by the calling thread
+std::chrono::microseconds threadCpuTime()
+{
+    rusage usage {};
+    getrusage(RUSAGE_THREAD, &usage);
+    return std::chrono::seconds(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+           std::chrono::microseconds(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+void printResult(const char* pMode, uint64_t bytes, const SResult& rResult)
+{
+    double gigabytes = static_cast<double>(bytes) / (1024.0 * 1024.0 * 1024.0);
+    double seconds = std::chrono::duration<double>(rResult.elapsed).count();
+    double cpuMs = std::chrono::duration<double, std::milli>(rResult.cpu).count();
+    std::cout << std::left
+              << std::setw(10) << pMode
+              << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << (gigabytes / seconds) << " GB/s"
+              << std::setw(10) << (cpuMs / gigabytes) << " ms cpu/GB";
+    if (rResult.stats.zeroCopySends != 0) {
+        std::cout << "  (" << rResult.stats.zeroCopySends << " zero copy sends, "
+                  << rResult.stats.kernelCopied << " sendmsg calls copied by the kernel)";
+    }
+    std::cout << std::endl;
+}
+
+//! stream of the buffer, only the CPU time of the sending thread is accounted
+SResult benchSend(CTcpDataLink& rLink, bool zeroCopy, uint64_t bytes, const std::vector<uint8_t>& rTx)
+{
+    const utils::span<const uint8_t> txSpan(rTx.data(), rTx.size());
+    // the buffer is never modified, therefore the release needs no further action
+    const CTcpDataLink::CallbackRelease onRelease;
+
+    auto startCpu = threadCpuTime();
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t sent = 0; sent < bytes; sent += rTx.size())
+    {
+        if (zeroCopy) {
+            rLink.sendZeroCopy(txSpan, onRelease);
+        }
+        else {
+            rLink.send(txSpan);
+        }
+    }
+    rLink.flushZeroCopy(std::chrono::seconds(5));
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    return SResult{elapsed, threadCpuTime() - startCpu, rLink.getZeroCopyStats()};
+}
+
+//! discards the recived data until the peer closes the connection
+void sink(CTcpServer& rServer)
+{
+    CTcpDataLink link;
+    CIpAddress peer;
+    std::tie(link, peer) = rServer.waitForConnection();
+
+    std::vector<uint8_t> rx(256 * 1024);
+    while (true)
+    {
+        utils::span<uint8_t> rxSpan(rx.data(), rx.size());
+        try {
+            link.recive(rxSpan);
+        }
+        catch (const std::exception&) {
+            break;
+        }
+        if (rxSpan.size() == 0) {
+            break;
+        }
+    }
+}
+
+} // namespace
+
+//*****************************************************************************
+//! \brief EXA_BenchZeroCopy
+//!
+
+int main(int argc, char *argv[])
+{
+    constexpr std::string_view docOptCmd =
+        R"(EXA_BenchZeroCopy.
+            Compares the CPU time per GB of the copying send and the MSG_ZEROCOPY send.
+            Without a host a loopback sink is started. Be aware that loopback
+            delivery copies the data at the kernel anyway, the benefit of zero copy
+            is only visible towards a remote sink (e.g. "nc -l 5011 > /dev/null").
+            Usage:
+            EXA_BenchZeroCopy [--host=<name>] [--megabytes=<n>] [--size=<bytes>]
+            EXA_BenchZeroCopy (-h | --help)
+            EXA_BenchZeroCopy --version
+            Options:
+            -h --help           Show this screen.
+            --version           Show version.
+            --host=<name>       Remote sink listening at port 5011.
+            --megabytes=<n>     Amount of data per mode [default: 2048].
+            --size=<bytes>      Size of a single send [default: 65536].
+        )";
+
+    constexpr auto networkAdapterVersion = "networkAdapter " NETWORKING_ADAPTER_VERSION;
+    using ArgMap_t = std::map<std::string, docopt::value>;
+    ArgMap_t args = docopt::docopt(std::string(docOptCmd),
+                                   { argv + 1, argv + argc },
+                                   true,
+                                   networkAdapterVersion);
+
+    uint64_t megabytes = 2048;
+    std::size_t size   = 65536;
+    std::string host;
+    if (args["--megabytes"]) {
+        megabytes = static_cast<uint64_t>(args["--megabytes"].asLong());
+    }
+    if (args["--size"]) {
+        size = static_cast<std::size_t>(args["--size"].asLong());
+    }
+    if (args["--host"]) {
+        host = args["--host"].asString();
+    }
+    if ((megabytes == 0) || (size == 0)) {
+        std::cout << "megabytes and size have to be greater than zero" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const uint64_t bytes = megabytes * 1024 * 1024;
+    const std::vector<uint8_t> tx(size, 0x55);
+
+    std::cout << megabytes << " MB in sends of " << size << " bytes to "
+              << (host.empty() ? std::string("loopback") : host) << std::endl;
+    try
+    {
+        for (bool zeroCopy : {false, true})
+        {
+            std::unique_ptr<CTcpServer> pServer;
+            std::thread sinkThread;
+            if (host.empty()) {
+                pServer = std::make_unique<CTcpServer>(CBaseSocket::SoReuseSocket(CBaseSocket(ESocketMode::INET_STREAM)), PORT_NUM);
+                sinkThread = std::thread(sink, std::ref(*pServer));
+            }
+
+            SResult result;
+            {
+                CTcpClient client(CBaseSocket(ESocketMode::INET_STREAM));
+                CTcpDataLink link = client.connect(host.empty() ? std::string("localhost") : host, PORT_NUM);
+                if (zeroCopy && !link.setZeroCopy(0)) {
+                    std::cout << "MSG_ZEROCOPY not supported by the running kernel" << std::endl;
+                }
+                result = benchSend(link, zeroCopy, bytes, tx);
+            }
+
+            if (sinkThread.joinable()) {
+                sinkThread.join();
+            }
+            printResult(zeroCopy ? "zerocopy" : "copy", bytes, result);
+        }
+    }
+    catch(const std::exception& e) {
+        std::cout << "Benchmark failed: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
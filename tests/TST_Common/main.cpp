@@ -3,7 +3,23 @@
 #include <cstring>
 #include <tuple>
 #include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <netinet/in.h>
 #include <Tcp/TcpDataLink.hpp>
+#include <Lookup/InterfacesLookup.hpp>
+#include <Lookup/InterfaceMonitor.hpp>
+#include <Lookup/InterfaceSnapshot.hpp>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <thread>
+#include <sched.h>
 
 #define GTEST_BOX                   "[     cout ] "
 
@@ -14,6 +30,186 @@ TEST(DataLink, MoveKonstruktor)
  //   auto [a] = std::tuple(CTcpDataLink(3));
 }
 
+TEST(CNetInterface, StateMap)
+{
+    // The addresses of the netlink dump equal the ones reported by getifaddrs
+    std::map<std::string, std::set<std::string>> expected;
+    ifaddrs* pIfAddrs = nullptr;
+    ASSERT_EQ(getifaddrs(&pIfAddrs), 0);
+    for (ifaddrs* pIfa = pIfAddrs; pIfa != nullptr; pIfa = pIfa->ifa_next)
+    {
+        if (pIfa->ifa_addr == nullptr) {
+            continue;
+        }
+        if (pIfa->ifa_addr->sa_family == AF_INET) {
+            expected[pIfa->ifa_name].insert(CIpAddress(reinterpret_cast<sockaddr_in*>(pIfa->ifa_addr)->sin_addr).toString());
+        }
+        else if (pIfa->ifa_addr->sa_family == AF_INET6) {
+            expected[pIfa->ifa_name].insert(CIpAddress(reinterpret_cast<sockaddr_in6*>(pIfa->ifa_addr)->sin6_addr).toString());
+        }
+    }
+    freeifaddrs(pIfAddrs);
+
+    std::map<std::string, std::set<std::string>> actual;
+    bool loopback = false;
+    for (const auto& interface : CNetInterface::getStateMap(false))
+    {
+        EXPECT_EQ(interface.first, interface.second.getIfIndex());
+        EXPECT_EQ(interface.second.getIfIndex(), if_nametoindex(interface.second.getName().c_str()));
+        for (const auto& address : interface.second.getAddresses()) {
+            actual[interface.second.getName()].insert(address.toString());
+        }
+        if (interface.second.getName() == "lo")
+        {
+            loopback = true;
+            EXPECT_GT(interface.second.getMtu(), 0U);
+            EXPECT_EQ(interface.second.getState(), EIfState::running);
+            EXPECT_TRUE(interface.second.getSubMask().empty() || interface.second.getSubMask().front().is_v6());
+        }
+    }
+    EXPECT_EQ(actual, expected);
+    EXPECT_TRUE(loopback);
+}
+
+TEST(CNetInterfaceMonitor, Queries)
+{
+    CNetInterfaceMonitor monitor;
+    EXPECT_EQ(monitor.getAllIpv4Ip(true), CNetInterface::getAllIpv4Ip(true));
+    EXPECT_EQ(monitor.getAllIpv4Ip(false), CNetInterface::getAllIpv4Ip(false));
+    EXPECT_EQ(monitor.getAllIpv6Ip(true), CNetInterface::getAllIpv6Ip(true));
+    EXPECT_EQ(monitor.getAllIpv4Submask(), CNetInterface::getAllIpv4Submask());
+    EXPECT_EQ(monitor.getAllIpv4Broadcast(), CNetInterface::getAllIpv4Broadcast());
+
+    auto loopback = monitor.getInterface(std::string("lo"));
+    ASSERT_TRUE(loopback.has_value());
+    EXPECT_EQ(loopback->ifIndex, if_nametoindex("lo"));
+    EXPECT_EQ(loopback->state, EIfState::running);
+    EXPECT_TRUE(monitor.getInterface(loopback->ifIndex).has_value());
+    EXPECT_FALSE(monitor.getInterface(std::string("no-such-if0")).has_value());
+}
+
+TEST(CInterfaceSnapshot, Views)
+{
+    auto toVector = [](utils::span<const CIpAddress> addresses) {
+        return CIpAddress::IpAddresses(addresses.begin(), addresses.end());
+    };
+
+    auto pSnapshot = CInterfaceSnapshot::create(false);
+    auto stateMap  = CNetInterface::getStateMap(false);
+    // The snapshot contains the links without addresses as well, the state map omits them
+    for (const auto& rInterface : pSnapshot->interfaces())
+    {
+        EXPECT_EQ(pSnapshot->find(rInterface.getIfIndex()), &rInterface);
+        EXPECT_EQ(pSnapshot->find(rInterface.getName()), &rInterface);
+        auto it = stateMap.find(rInterface.getIfIndex());
+        if (it == stateMap.end())
+        {
+            EXPECT_TRUE(rInterface.getAddresses().empty());
+            continue;
+        }
+        EXPECT_EQ(rInterface.getName(), it->second.getName());
+        EXPECT_EQ(rInterface.getMtu(), it->second.getMtu());
+        EXPECT_EQ(rInterface.getState(), it->second.getState());
+        EXPECT_EQ(toVector(rInterface.getAddresses()), it->second.getAddresses());
+        EXPECT_EQ(toVector(rInterface.getSubMask()), it->second.getSubMask());
+        EXPECT_EQ(toVector(rInterface.getBroadcast()), it->second.getBroadcast());
+    }
+    for (const auto& rEntry : stateMap) {
+        EXPECT_NE(pSnapshot->find(rEntry.first), nullptr);
+    }
+    EXPECT_EQ(pSnapshot->find(std::string_view("no-such-if0")), nullptr);
+    EXPECT_EQ(pSnapshot->find(0U), nullptr);
+
+    EXPECT_EQ(toVector(pSnapshot->getAllIpv4Ip(true)), CNetInterface::getAllIpv4Ip(true));
+    EXPECT_EQ(toVector(pSnapshot->getAllIpv4Ip(false)), CNetInterface::getAllIpv4Ip(false));
+    EXPECT_EQ(toVector(pSnapshot->getAllIpv6Ip(true)), CNetInterface::getAllIpv6Ip(true));
+    EXPECT_EQ(toVector(pSnapshot->getAllIpv6Ip(false)), CNetInterface::getAllIpv6Ip(false));
+    EXPECT_EQ(toVector(pSnapshot->getAllIpv4Submask()), CNetInterface::getAllIpv4Submask());
+    EXPECT_EQ(toVector(pSnapshot->getAllIpv4Broadcast()), CNetInterface::getAllIpv4Broadcast());
+
+    // The snapshot of the monitor stays valid when the monitor is gone
+    std::shared_ptr<const CInterfaceSnapshot> pMonitored;
+    {
+        CNetInterfaceMonitor monitor;
+        pMonitored = monitor.snapshot();
+    }
+    const auto* pLoopback = pMonitored->find(std::string_view("lo"));
+    ASSERT_NE(pLoopback, nullptr);
+    EXPECT_EQ(pLoopback->getIfIndex(), if_nametoindex("lo"));
+    EXPECT_EQ(pLoopback->getState(), EIfState::running);
+}
+
+namespace
+{
+
+//! runs the function at a thread moved into a network namespace of its own, the
+//! interfaces of the host are not touched. Threads and processes started by the
+//! function inherit the namespace. False if the namespace can't be created.
+bool runInNetNamespace(const std::function<void ()>& rFunction)
+{
+    bool created = false;
+    std::thread thread([&rFunction, &created]()
+    {
+        if (::unshare(CLONE_NEWNET) == 0)
+        {
+            created = true;
+            rFunction();
+        }
+    });
+    thread.join();
+    return created;
+}
+
+}
+
+TEST(CNetInterfaceMonitor, AddressEvents)
+{
+    // Changing an address requires CAP_NET_ADMIN, the loopback of a new namespace is down
+    bool permitted = false;
+    bool created = runInNetNamespace([&permitted]()
+    {
+        if (std::system("ip link set lo up 2>/dev/null") != 0) {
+            return;
+        }
+        permitted = true;
+
+        const CIpAddress testIp(std::string("198.51.100.7"));
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::vector<CNetInterfaceMonitor::SEvent> events;
+
+        CNetInterfaceMonitor monitor;
+        monitor.subscribe([&](const CNetInterfaceMonitor::SEvent& rEvent)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            events.push_back(rEvent);
+            changed.notify_all();
+        });
+        auto waitFor = [&](CNetInterfaceMonitor::EChange change)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            return changed.wait_for(lock, std::chrono::seconds(2), [&]() {
+                return std::any_of(events.begin(), events.end(), [&](const CNetInterfaceMonitor::SEvent& rEvent) {
+                    return (rEvent.change == change) && (rEvent.address == testIp) && (rEvent.name == "lo");
+                });
+            });
+        };
+
+        ASSERT_EQ(std::system("ip address add 198.51.100.7/32 dev lo"), 0);
+        EXPECT_TRUE(waitFor(CNetInterfaceMonitor::EChange::ADDRESS_ADDED));
+        auto ipv4 = monitor.getAllIpv4Ip(true);
+        EXPECT_NE(std::find(ipv4.begin(), ipv4.end(), testIp), ipv4.end());
+
+        ASSERT_EQ(std::system("ip address del 198.51.100.7/32 dev lo"), 0);
+        EXPECT_TRUE(waitFor(CNetInterfaceMonitor::EChange::ADDRESS_REMOVED));
+        ipv4 = monitor.getAllIpv4Ip(true);
+        EXPECT_EQ(std::find(ipv4.begin(), ipv4.end(), testIp), ipv4.end());
+    });
+    if (!created || !permitted) {
+        GTEST_SKIP() << "no permission to create a network namespace or to change its interfaces";
+    }
+}
+
 int main(int argc, char **argv)
 {
     testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,219 @@
+#include <gtest/gtest.h>
+#include <iostream>
+#include <string>
+#include <array>
+#include <tuple>
+#include <thread>
+#include <chrono>
+#include <unistd.h>
+#include <BaseSocket.hpp>
+#include <CoroLoop.hpp>
+#include <Tcp/TcpServer.hpp>
+#include <Tcp/TcpClient.hpp>
+#include <Udp/UdpServer.hpp>
+#include <Udp/UdpClient.hpp>
+
+#define GTEST_BOX                   "[     cout ] "
+
+using namespace EtNet;
+
+#if defined(NETWORKING_ADAPTER_COROUTINES)
+
+namespace
+{
+
+constexpr unsigned sessionCount = 32;
+
+CTask<void> echoSession(CCoroLoop& rIo, CTcpDataLink link)
+{
+    std::array<uint8_t, 64> buffer;
+    while (true)
+    {
+        utils::span<uint8_t> rx(buffer.data(), buffer.size());
+        co_await rIo.recive(link, rx);
+        if (rx.size() == 0) {
+            break;
+        }
+        co_await rIo.send(link, utils::span<const uint8_t>(rx.data(), rx.size()));
+    }
+    rIo.release(link);
+}
+
+CTask<void> acceptor(CCoroLoop& rIo, CTcpServer& rServer, unsigned sessions)
+{
+    for (unsigned i = 0; i < sessions; i++)
+    {
+        auto accepted = co_await rIo.accept(rServer);
+        if (!accepted) {
+            break;
+        }
+        rIo.spawn(echoSession(rIo, std::get<0>(std::move(*accepted))));
+    }
+    rIo.release(rServer);
+}
+
+CTask<std::string> exchange(CCoroLoop& rIo, CTcpDataLink& rLink, const std::string& rMessage)
+{
+    co_await rIo.send(rLink, utils::span(rMessage).as_byte());
+
+    std::string echo;
+    std::array<uint8_t, 64> buffer;
+    while (echo.size() < rMessage.size())
+    {
+        utils::span<uint8_t> rx(buffer.data(), buffer.size());
+        co_await rIo.recive(rLink, rx);
+        if (rx.size() == 0) {
+            break;
+        }
+        echo.append(reinterpret_cast<char*>(rx.data()), rx.size());
+    }
+    co_return echo;
+}
+
+CTask<void> clientSession(CCoroLoop& rIo, unsigned id, unsigned& rDone)
+{
+    CTcpClient client(CBaseSocket(ESocketMode::INET_STREAM));
+    CTcpDataLink link = client.connect(std::string("localhost"), 50010);
+
+    const std::string message = "hallo session " + std::to_string(id);
+    std::string echo = co_await exchange(rIo, link, message);
+    EXPECT_EQ(echo, message);
+    rIo.release(link);
+    rDone++;
+}
+
+CTask<void> cancelledAccept(CCoroLoop& rIo, CTcpServer& rServer, std::stop_token stop, bool& rCancelled)
+{
+    auto accepted = co_await rIo.accept(rServer, stop);
+    rCancelled = !accepted.has_value();
+    rIo.release(rServer);
+}
+
+CTask<void> waitTwice(CCoroLoop& rIo, int fd, std::stop_token stop, bool& rFirst, bool& rSecond)
+{
+    rFirst  = co_await rIo.readable(fd, stop);
+    rSecond = co_await rIo.readable(fd);
+    rIo.release(fd);
+}
+
+CTask<void> datagrams(CCoroLoop& rIo, CUdpDataLink& rLink, unsigned count, unsigned& rRecived)
+{
+    std::array<uint8_t, 40> buffer;
+    for (unsigned i = 0; i < count; i++)
+    {
+        utils::span<uint8_t> rx(buffer.data(), buffer.size());
+        SPeerAddr peer;
+        EXPECT_EQ(co_await rIo.reciveFrom(rLink, rx, peer), CUdpDataLink::ERet::OK);
+        EXPECT_EQ(std::string(reinterpret_cast<char*>(rx.data()), rx.size()), "hallo dgram");
+        EXPECT_TRUE(peer.Ip.is_loopback());
+        rRecived++;
+    }
+    rIo.release(rLink);
+}
+
+}
+
+TEST(CCoroLoop, TcpEchoSessions)
+{
+    CTcpServer server(CBaseSocket::SoReuseSocket(CBaseSocket(ESocketMode::INET_STREAM)), 50010, sessionCount);
+    CEventLoop loop;
+    CCoroLoop io(loop);
+
+    // All sessions are served concurrently by the thread running the loop
+    unsigned done = 0;
+    io.spawn(acceptor(io, server, sessionCount));
+    for (unsigned i = 0; i < sessionCount; i++) {
+        io.spawn(clientSession(io, i, done));
+    }
+    EXPECT_EQ(io.running(), sessionCount + 1);
+
+    EXPECT_EQ(io.run(), CEventLoop::ERet::OK);
+    EXPECT_EQ(done, sessionCount);
+    EXPECT_EQ(loop.size(), 0u);
+}
+
+TEST(CCoroLoop, CancelAccept)
+{
+    CTcpServer server(CBaseSocket::SoReuseSocket(CBaseSocket(ESocketMode::INET_STREAM)), 50011);
+    CEventLoop loop;
+    CCoroLoop io(loop);
+
+    std::stop_source source;
+    bool cancelled = false;
+    io.spawn(cancelledAccept(io, server, source.get_token(), cancelled));
+
+    std::thread t([&source]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        source.request_stop();
+    });
+    EXPECT_EQ(io.run(), CEventLoop::ERet::OK);
+    t.join();
+    EXPECT_TRUE(cancelled);
+}
+
+TEST(CCoroLoop, StaleCancel)
+{
+    int pipeFd[2];
+    ASSERT_EQ(::pipe(pipeFd), 0);
+    CEventLoop loop;
+    CCoroLoop io(loop);
+
+    // The first wait is woken up by the event and by the posted cancel, the
+    // cancel must not hit the second wait of the same coroutine
+    std::stop_source source;
+    bool first  = true;
+    bool second = false;
+    io.spawn(waitTwice(io, pipeFd[0], source.get_token(), first, second));
+    ASSERT_EQ(::write(pipeFd[1], "a", 1), 1);
+    source.request_stop();
+
+    std::thread t([&pipeFd]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        EXPECT_EQ(::write(pipeFd[1], "b", 1), 1);
+    });
+    EXPECT_EQ(io.run(), CEventLoop::ERet::OK);
+    t.join();
+    EXPECT_FALSE(first);
+    EXPECT_TRUE(second);
+    ::close(pipeFd[0]);
+    ::close(pipeFd[1]);
+}
+
+TEST(CCoroLoop, UdpReciveFrom)
+{
+    CUdpServer server(CBaseSocket::SoReuseSocket(CBaseSocket(ESocketMode::INET_DGRAM)), 50012);
+    CUdpClient client(CBaseSocket::SoReuseSocket(CBaseSocket(ESocketMode::INET_DGRAM)));
+
+    auto link = client.getLink(std::string("127.0.0.1"), 50012);
+    std::string dataToSend("hallo dgram");
+    link.send(utils::span(dataToSend).as_byte());
+    CUdpDataLink serverLink = server.waitForConnection();
+
+    CEventLoop loop;
+    CCoroLoop io(loop);
+    unsigned recived = 0;
+    io.spawn(datagrams(io, serverLink, 3, recived));
+
+    // The first datagram was pending, the others arrive while the task is suspended
+    std::thread t([&link, &dataToSend]()
+    {
+        for (int i = 0; i < 2; i++)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            link.send(utils::span(dataToSend).as_byte());
+        }
+    });
+    EXPECT_EQ(io.run(), CEventLoop::ERet::OK);
+    t.join();
+    EXPECT_EQ(recived, 3u);
+}
+
+#endif
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
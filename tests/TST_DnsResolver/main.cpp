@@ -0,0 +1,344 @@
+#include <gtest/gtest.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <future>
+#include <chrono>
+#include <algorithm>
+#include <sys/socket.h>
+#include <BaseSocket.hpp>
+#include <Udp/UdpServer.hpp>
+#include <Lookup/DnsResolver.hpp>
+#include <Lookup/HostCache.hpp>
+
+#define GTEST_BOX                   "[     cout ] "
+
+using namespace EtNet;
+
+namespace
+{
+
+constexpr unsigned int serverPort = 50014;
+
+void put16(std::vector<uint8_t>& rOut, uint16_t value)
+{
+    rOut.push_back(static_cast<uint8_t>(value >> 8));
+    rOut.push_back(static_cast<uint8_t>(value));
+}
+
+void put32(std::vector<uint8_t>& rOut, uint32_t value)
+{
+    put16(rOut, static_cast<uint16_t>(value >> 16));
+    put16(rOut, static_cast<uint16_t>(value));
+}
+
+//! record of the name at the question, referenced by a compression pointer
+void putRecord(std::vector<uint8_t>& rOut, uint16_t type, uint32_t ttl, const std::vector<uint8_t>& rData)
+{
+    put16(rOut, 0xC00C);
+    put16(rOut, type);
+    put16(rOut, 1);
+    put32(rOut, ttl);
+    put16(rOut, static_cast<uint16_t>(rData.size()));
+    rOut.insert(rOut.end(), rData.begin(), rData.end());
+}
+
+void putSoa(std::vector<uint8_t>& rOut, uint32_t ttl, uint32_t minimum)
+{
+    std::vector<uint8_t> soa {0xC0, 0x0C, 0xC0, 0x0C};
+    for (uint32_t value : {1U, 3600U, 600U, 86400U, minimum}) {
+        put32(soa, value);
+    }
+    putRecord(rOut, 6, ttl, soa);
+}
+
+//*****************************************************************************
+//! Stand-in DNS server of the zone "test"
+class CDnsStandIn
+{
+public:
+    CDnsStandIn() :
+        m_server(serverSocket(), serverPort),
+        m_thread([this]() { serve(); })
+    { }
+
+    ~CDnsStandIn()
+    {
+        // A single byte datagram terminates the server
+        CBaseSocket socket(ESocketMode::INET_DGRAM);
+        CUdpDataLink link(socket.getFd());
+        uint8_t quit = 0;
+        link.sendTo(SPeerAddr{CIpAddress(std::string("127.0.0.1")), serverPort}, utils::span<uint8_t>(&quit, 1));
+        m_thread.join();
+    }
+
+    std::atomic<unsigned> slowQueries {0};
+    std::atomic<unsigned> counterQueries {0};
+
+private:
+    //! the queries of a batch arrive at once
+    static CBaseSocket serverSocket()
+    {
+        CBaseSocket socket(ESocketMode::INET_DGRAM);
+        int size = 1024 * 1024;
+        ::setsockopt(socket.getFd(), SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+        return std::move(CBaseSocket::SoReuseSocket(std::move(socket)));
+    }
+
+    void serve()
+    {
+        CUdpDataLink link = m_server.waitForConnection();
+        bool running = true;
+        while (running)
+        {
+            uint8_t rxBuffer[512];
+            link.reciveFrom(utils::span<uint8_t>(rxBuffer), [&](SPeerAddr peer, utils::span<uint8_t> rx)
+            {
+                if (rx.size() < 13) {
+                    running = false;
+                    return true;
+                }
+                std::vector<uint8_t> answer = respond(rx);
+                if (!answer.empty()) {
+                    link.sendTo(peer, utils::span<uint8_t>(answer.data(), answer.size()));
+                }
+                return true;
+            });
+        }
+    }
+
+    std::vector<uint8_t> respond(const utils::span<uint8_t>& rQuery)
+    {
+        std::string name;
+        std::size_t offset = 12;
+        while (rQuery[offset] != 0)
+        {
+            if (!name.empty()) {
+                name.push_back('.');
+            }
+            name.append(reinterpret_cast<char*>(&rQuery[offset + 1]), rQuery[offset]);
+            offset += rQuery[offset] + 1;
+        }
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        const uint16_t type = static_cast<uint16_t>((rQuery[offset + 1] << 8) | rQuery[offset + 2]);
+
+        if (name == "slow.test") {
+            slowQueries++;
+            return {};
+        }
+
+        // Header and question of the query
+        std::vector<uint8_t> answer(rQuery.begin(), rQuery.begin() + offset + 5);
+        answer[2] = 0x81;
+        answer[3] = 0x80;
+        answer[7] = 0;
+
+        if (name == "missing.test")
+        {
+            answer[3] |= 3;
+            answer[9] = 1;
+            putSoa(answer, 120, 45);
+        }
+        else if ((name == "a.test") && (type == 1))
+        {
+            answer[7] = 1;
+            putRecord(answer, 1, 300, {10, 0, 0, 1});
+        }
+        else if ((name == "six.test") && (type == 28))
+        {
+            answer[7] = 1;
+            putRecord(answer, 28, 90, {0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1});
+        }
+        else if ((name == "counter.test") && (type == 1))
+        {
+            // Short lived record, every query returns the next address
+            answer[7] = 1;
+            putRecord(answer, 1, 1, {10, 0, 2, static_cast<uint8_t>(++counterQueries)});
+        }
+        else if ((name.rfind("host", 0) == 0) && (type == 1))
+        {
+            answer[7] = 1;
+            putRecord(answer, 1, 600, {10, 0, 1, static_cast<uint8_t>(std::stoi(name.substr(4)))});
+        }
+        else
+        {
+            // No record of the type
+            answer[9] = 1;
+            putSoa(answer, 60, 30);
+        }
+        return answer;
+    }
+
+    CUdpServer  m_server;
+    std::thread m_thread;
+};
+
+std::vector<SPeerAddr> standInServer()
+{
+    return {SPeerAddr{CIpAddress(std::string("127.0.0.1")), serverPort}};
+}
+
+}
+
+TEST(CDnsResolver, Answers)
+{
+    CDnsStandIn standIn;
+    CDnsResolver resolver(standInServer());
+
+    auto a = resolver.resolve(std::string("a.test"));
+    auto six = resolver.resolve(std::string("Six.Test."));
+    ASSERT_EQ(a.get(), CHostLookup::IpAddresses{CIpAddress(std::string("10.0.0.1"))});
+    ASSERT_EQ(six.get(), CHostLookup::IpAddresses{CIpAddress(std::string("2001:db8::1"))});
+
+    std::promise<CDnsResolver::SAnswer> found;
+    resolver.resolve(std::string("a.test"), [&found](const std::string& rName, const CDnsResolver::SAnswer& rAnswer) {
+        EXPECT_EQ(rName, "a.test");
+        found.set_value(rAnswer);
+    });
+    CDnsResolver::SAnswer answer = found.get_future().get();
+    EXPECT_EQ(answer.status, CDnsResolver::ERet::OK);
+    EXPECT_EQ(answer.ttl, std::chrono::seconds(300));
+
+    std::promise<CDnsResolver::SAnswer> missing;
+    resolver.resolve(std::string("missing.test"), [&missing](const std::string&, const CDnsResolver::SAnswer& rAnswer) {
+        missing.set_value(rAnswer);
+    });
+    answer = missing.get_future().get();
+    EXPECT_EQ(answer.status, CDnsResolver::ERet::NOT_FOUND);
+    EXPECT_TRUE(answer.addresses.empty());
+    EXPECT_EQ(answer.ttl, std::chrono::seconds(45));
+
+    EXPECT_THROW(resolver.resolve(std::string("missing.test")).get(), std::runtime_error);
+    EXPECT_THROW(resolver.resolve(std::string("invalid..test")).get(), std::runtime_error);
+}
+
+TEST(CDnsResolver, Timeout)
+{
+    CDnsStandIn standIn;
+    CDnsResolver resolver(standInServer(), std::chrono::milliseconds(100), 3);
+
+    auto start = std::chrono::steady_clock::now();
+    std::promise<CDnsResolver::SAnswer> slow;
+    resolver.resolve(std::string("slow.test"), [&slow](const std::string&, const CDnsResolver::SAnswer& rAnswer) {
+        slow.set_value(rAnswer);
+    });
+    EXPECT_EQ(slow.get_future().get().status, CDnsResolver::ERet::TIMEOUT);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(300));
+
+    // Three transmissions of the A and the AAAA query
+    EXPECT_EQ(standIn.slowQueries, 6U);
+}
+
+TEST(CDnsResolver, Batch)
+{
+    CDnsStandIn standIn;
+    CDnsResolver resolver(standInServer());
+
+    constexpr std::size_t hosts = 250;
+    std::vector<std::string> names {"192.168.1.1", "::1"};
+    for (std::size_t i = 0; i < hosts; i++) {
+        names.push_back("host" + std::to_string(i) + ".test");
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto futures = resolver.resolve(names);
+    ASSERT_EQ(futures.size(), names.size());
+    EXPECT_EQ(futures[0].get(), CHostLookup::IpAddresses{CIpAddress(std::string("192.168.1.1"))});
+    EXPECT_EQ(futures[1].get(), CHostLookup::IpAddresses{CIpAddress(std::string("::1"))});
+    for (std::size_t i = 0; i < hosts; i++) {
+        EXPECT_EQ(futures[i + 2].get(), CHostLookup::IpAddresses{CIpAddress("10.0.1." + std::to_string(i))});
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << GTEST_BOX << hosts << " names resolved in " << elapsed.count() << " ms" << std::endl;
+}
+
+TEST(CHostCache, Expiry)
+{
+    CDnsStandIn standIn;
+    CHostCache cache(hostCacheCapacity, hostCacheMaxTtl, std::chrono::seconds(5));
+    cache.setResolver(CHostCache::dnsResolver(std::make_shared<CDnsResolver>(standInServer())));
+
+    const CHostLookup::IpAddresses first {CIpAddress(std::string("10.0.2.1"))};
+    const CHostLookup::IpAddresses second {CIpAddress(std::string("10.0.2.2"))};
+    EXPECT_EQ(cache.addresses("counter.test"), first);
+    EXPECT_EQ(cache.addresses("counter.test"), first);
+    EXPECT_THROW(cache.addresses("missing.test"), std::runtime_error);
+    EXPECT_THROW(cache.addresses("missing.test"), std::runtime_error);
+
+    CHostCache::SStats stats = cache.getStats();
+    EXPECT_EQ(stats.misses, 2U);
+    EXPECT_EQ(stats.hits, 1U);
+    EXPECT_EQ(stats.negativeHits, 1U);
+    EXPECT_EQ(standIn.counterQueries, 1U);
+
+    // After the TTL the stale address is served until the refresh completes
+    std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+    EXPECT_EQ(cache.addresses("counter.test"), first);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while ((cache.addresses("counter.test") != second) && (std::chrono::steady_clock::now() < deadline)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    EXPECT_EQ(cache.addresses("counter.test"), second);
+    stats = cache.getStats();
+    EXPECT_GE(stats.staleHits, 1U);
+    EXPECT_EQ(stats.refreshes, 1U);
+    EXPECT_EQ(stats.misses, 2U);
+}
+
+TEST(CHostCache, ConcurrentMiss)
+{
+    CDnsStandIn standIn;
+    CHostCache cache;
+    cache.setResolver(CHostCache::dnsResolver(std::make_shared<CDnsResolver>(standInServer())));
+
+    // A storm of lookups of the same name is answered by one resolution
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; i++)
+    {
+        threads.emplace_back([&cache]() {
+            EXPECT_EQ(cache.addresses("host7.test"), CHostLookup::IpAddresses{CIpAddress(std::string("10.0.1.7"))});
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    CHostCache::SStats stats = cache.getStats();
+    EXPECT_EQ(stats.misses, 1U);
+    EXPECT_EQ(stats.hits, 7U);
+    EXPECT_EQ(stats.entries, 1U);
+}
+
+TEST(CHostCache, Deadline)
+{
+    CHostCache cache;
+    std::atomic<unsigned> resolutions {0};
+    cache.setResolver([&resolutions](const std::string&)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        resolutions++;
+        return CDnsResolver::SAnswer {CDnsResolver::ERet::OK, {CIpAddress(std::string("10.0.3.1"))}, std::chrono::seconds(60)};
+    });
+
+    // A slow resolution is abandoned at the deadline, not at its end
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_THROW(cache.addresses("slow.test", start + std::chrono::milliseconds(50)), std::runtime_error);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(250));
+
+    // The next lookup waits for the running resolution instead of starting one
+    EXPECT_EQ(cache.addresses("slow.test", start + std::chrono::seconds(2)), CHostLookup::IpAddresses{CIpAddress(std::string("10.0.3.1"))});
+    EXPECT_EQ(resolutions, 1U);
+    EXPECT_EQ(cache.getStats().misses, 1U);
+}
+
+TEST(CHostCache, HostLookup)
+{
+    CDnsStandIn standIn;
+    CHostCache::instance().setResolver(CHostCache::dnsResolver(std::make_shared<CDnsResolver>(standInServer())));
+    EXPECT_EQ(CHostLookup(std::string("a.test")).addresses(), CHostLookup::IpAddresses{CIpAddress(std::string("10.0.0.1"))});
+    EXPECT_EQ(CHostCache::instance().getStats().misses, 1U);
+
+    CHostCache::instance().setResolver(nullptr);
+    CHostCache::instance().clear();
+}
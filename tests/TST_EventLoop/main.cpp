@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+#include <iostream>
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <thread>
+#include <BaseSocket.hpp>
+#include <EventLoop.hpp>
+#include <Tcp/TcpServer.hpp>
+#include <Tcp/TcpClient.hpp>
+#include <Udp/UdpServer.hpp>
+#include <Udp/UdpClient.hpp>
+
+#define GTEST_BOX                   "[     cout ] "
+
+using namespace EtNet;
+
+TEST(CEventLoop, Timeout)
+{
+    CEventLoop loop;
+    EXPECT_EQ(loop.runOnce(std::chrono::milliseconds(10)), CEventLoop::ERet::TIMEOUT);
+}
+
+TEST(CEventLoop, PostAndUnblock)
+{
+    CEventLoop loop;
+    bool called = false;
+
+    std::thread t([&loop, &called]()
+    {
+        loop.post([&loop, &called]()
+        {
+            called = true;
+            loop.unblock();
+        });
+    });
+
+    EXPECT_EQ(loop.run(), CEventLoop::ERet::UNBLOCK);
+    EXPECT_TRUE(called);
+    t.join();
+}
+
+TEST(CEventLoop, TcpEcho)
+{
+    CTcpServer server(CBaseSocket::SoReuseSocket(CBaseSocket(ESocketMode::INET_STREAM)), 50005);
+    CTcpClient client(CBaseSocket::SoReuseSocket(CBaseSocket(ESocketMode::INET_STREAM)));
+
+    std::thread t([&server]()
+    {
+        CTcpDataLink link;
+        CIpAddress peer;
+        std::tie(link, peer) = server.waitForConnection();
+        uint8_t rcvData[40] = {0};
+        link.recive(utils::span<uint8_t>(rcvData), [&link](utils::span<uint8_t> rx)
+        {
+            link.send(rx);
+            return true;
+        });
+    });
+
+    CTcpDataLink link = client.connect(std::string("localhost"), 50005);
+
+    CEventLoop loop;
+    std::string received;
+    loop.add(link, EEvent::READ, [&loop, &link, &received](EEvent events)
+    {
+        uint8_t rcvData[8];
+        while (true)
+        {
+            utils::span<uint8_t> rxSpan(rcvData);
+            if (link.tryRecive(rxSpan) == CTcpDataLink::ERet::WOULDBLOCK) {
+                break;
+            }
+            if (rxSpan.size() == 0) {
+                loop.remove(link);
+                loop.unblock();
+                break;
+            }
+            received.append(reinterpret_cast<char*>(rxSpan.data()), rxSpan.size());
+        }
+    });
+    EXPECT_EQ(loop.size(), 1u);
+
+    std::string dataToSend("hallo event loop");
+    EXPECT_EQ(link.trySend(utils::span(dataToSend).as_byte()), dataToSend.size());
+
+    t.join();
+    EXPECT_EQ(loop.run(), CEventLoop::ERet::UNBLOCK);
+    EXPECT_EQ(received, dataToSend);
+    EXPECT_EQ(loop.size(), 0u);
+}
+
+TEST(CEventLoop, UdpReceive)
+{
+    CUdpServer server(CBaseSocket::SoReuseSocket(CBaseSocket(ESocketMode::INET_DGRAM)), 50006);
+    CUdpClient client(CBaseSocket::SoReuseSocket(CBaseSocket(ESocketMode::INET_DGRAM)));
+
+    auto link = client.getLink(std::string("127.0.0.1"), 50006);
+    std::string dataToSend("hallo dgram");
+    for (int i = 0; i < 3; i++) {
+        link.send(utils::span(dataToSend).as_byte());
+    }
+
+    // already pending datagrams are reported at registration
+    CUdpDataLink serverLink = server.waitForConnection();
+
+    CEventLoop loop;
+    unsigned datagrams = 0;
+    loop.add(serverLink, EEvent::READ, [&loop, &serverLink, &datagrams](EEvent events)
+    {
+        uint8_t rcvData[40];
+        SPeerAddr peer;
+        utils::span<uint8_t> rxSpan(rcvData);
+        while (serverLink.tryReciveFrom(rxSpan, peer) == CUdpDataLink::ERet::OK)
+        {
+            EXPECT_TRUE(peer.Ip.is_loopback());
+            datagrams++;
+            rxSpan = utils::span<uint8_t>(rcvData);
+        }
+        if (datagrams == 3) {
+            loop.unblock();
+        }
+    });
+
+    EXPECT_EQ(loop.run(), CEventLoop::ERet::UNBLOCK);
+    EXPECT_EQ(datagrams, 3u);
+    loop.remove(serverLink);
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <FlatHashMap.hpp>
+#include <Udp/UdpDataLink.hpp>
+
+using namespace EtNet;
+
+#define GTEST_BOX                   "[     cout ] "
+
+namespace
+{
+
+SPeerAddr peerOf(uint32_t number)
+{
+    in_addr ip {htonl(0x0A000000 | (number >> 4))};
+    return SPeerAddr{CIpAddress(ip), 40000 + (number & 0xF)};
+}
+
+}
+
+TEST(CFlatHashMap, PeerAddrHash)
+{
+    SPeerAddr a {CIpAddress(std::string("10.0.0.1")), 5000};
+    SPeerAddr b {CIpAddress(std::string("10.0.0.1")), 5000};
+    SPeerAddr c {CIpAddress(std::string("10.0.0.1")), 5001};
+    SPeerAddr d {CIpAddress(std::string("::ffff:10.0.0.1")), 5000};
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+    EXPECT_NE(a, d);
+    EXPECT_EQ(std::hash<SPeerAddr>()(a), std::hash<SPeerAddr>()(b));
+    EXPECT_NE(std::hash<SPeerAddr>()(a), std::hash<SPeerAddr>()(c));
+    EXPECT_NE(std::hash<CIpAddress>()(a.Ip), std::hash<CIpAddress>()(d.Ip));
+
+    // Consecutive addresses spread over the buckets of a power of two table
+    std::unordered_set<std::size_t> buckets;
+    for (uint32_t i = 0; i < 1024; i++) {
+        buckets.insert(std::hash<SPeerAddr>()(peerOf(i)) & 1023);
+    }
+    EXPECT_GT(buckets.size(), 600U);
+}
+
+TEST(CFlatHashMap, AsUnorderedMap)
+{
+    CFlatHashMap<SPeerAddr, uint64_t> flat;
+    std::unordered_map<SPeerAddr, uint64_t> reference;
+    std::mt19937 random(4711);
+
+    for (int i = 0; i < 200000; i++)
+    {
+        const SPeerAddr peer = peerOf(random() % 5000);
+        switch (random() % 4)
+        {
+            case 0:
+                EXPECT_EQ(flat.erase(peer), reference.erase(peer));
+                break;
+            case 1:
+                EXPECT_EQ(flat.try_emplace(peer, i).second, reference.try_emplace(peer, i).second);
+                break;
+            default:
+            {
+                flat[peer] += i;
+                reference[peer] += i;
+                break;
+            }
+        }
+    }
+
+    ASSERT_EQ(flat.size(), reference.size());
+    for (const auto& rEntry : reference)
+    {
+        auto it = flat.find(rEntry.first);
+        ASSERT_NE(it, flat.end());
+        EXPECT_EQ(it->second, rEntry.second);
+        EXPECT_EQ(flat.at(rEntry.first), rEntry.second);
+    }
+    std::size_t visited = 0;
+    for (const auto& rEntry : flat)
+    {
+        EXPECT_EQ(reference.at(rEntry.first), rEntry.second);
+        visited++;
+    }
+    EXPECT_EQ(visited, reference.size());
+    EXPECT_THROW(flat.at(peerOf(6000)), std::out_of_range);
+
+    // Copies are independent, the moved from map is empty
+    auto copy = flat;
+    copy.clear();
+    EXPECT_EQ(flat.size(), reference.size());
+    auto moved = std::move(flat);
+    EXPECT_EQ(moved.size(), reference.size());
+    EXPECT_TRUE(flat.empty());
+    EXPECT_EQ(flat.find(peerOf(1)), flat.end());
+}
+
+TEST(CFlatHashMap, EraseIf)
+{
+    CFlatHashMap<uint32_t, std::string> flat(1000);
+    const std::size_t capacity = flat.capacity();
+    for (uint32_t i = 0; i < 1000; i++) {
+        flat[i] = std::to_string(i);
+    }
+    EXPECT_EQ(flat.capacity(), capacity);
+
+    std::size_t calls = 0;
+    EXPECT_EQ(flat.erase_if([&calls](const auto& rEntry) { calls++; return rEntry.first % 3 != 0; }), 666U);
+    EXPECT_EQ(calls, 1000U);
+    EXPECT_EQ(flat.size(), 334U);
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        auto it = flat.find(i);
+        ASSERT_EQ(it != flat.end(), i % 3 == 0) << i;
+        if (it != flat.end()) {
+            EXPECT_EQ(it->second, std::to_string(i));
+        }
+    }
+}
+
+TEST(CFlatHashSet, Insert)
+{
+    CFlatHashSet<CIpAddress> set;
+    EXPECT_TRUE(set.insert(CIpAddress(std::string("192.168.0.1"))).second);
+    EXPECT_FALSE(set.insert(CIpAddress(std::string("192.168.0.1"))).second);
+    EXPECT_TRUE(set.insert(CIpAddress(std::string("::1"))).second);
+    EXPECT_TRUE(set.contains(CIpAddress(std::string("::1"))));
+    EXPECT_FALSE(set.contains(CIpAddress(std::string("::2"))));
+    EXPECT_EQ(set.size(), 2U);
+    EXPECT_EQ(set.erase(CIpAddress(std::string("::1"))), 1U);
+    EXPECT_EQ(set.count(CIpAddress(std::string("::1"))), 0U);
+}
@@ -2,7 +2,10 @@
 #include <iostream>
 #include <Lookup/HostLookup.hpp>
 #include <IpAddress.hpp>
+#include <Subnet.hpp>
 #include <cstring>
+#include <random>
+#include <arpa/inet.h>
 
 using namespace EtNet;
 
@@ -139,6 +142,255 @@ TEST(CIpAddress, calculateBroadcast)
 }
 
 
+TEST(CIpAddress, Predicates)
+{
+    constexpr in6_addr loopbackAddr = IN6ADDR_LOOPBACK_INIT;
+    constexpr CIpAddress loopback6(loopbackAddr);
+    constexpr CIpAddress invalid;
+    static_assert(loopback6.is_v6() && loopback6.is_loopback() && !loopback6.is_submask(), "constexpr predicates");
+    static_assert(invalid.empty() && !invalid.is_loopback() && (invalid.addressFamily() == EAddressFamily::INV), "constexpr empty");
+
+    in_addr ipv4Addr;
+    ipv4Addr.s_addr = htonl(INADDR_LOOPBACK);
+    CIpAddress loopback4(ipv4Addr);
+    EXPECT_TRUE(loopback4.is_loopback());
+    EXPECT_FALSE(loopback4.is_broadcast());
+    EXPECT_EQ(loopback4.addressFamily(), EAddressFamily::INET);
+    EXPECT_TRUE(CIpAddress(std::string("255.255.255.0")).is_submask());
+    EXPECT_TRUE(CIpAddress(std::string("192.168.0.255")).is_broadcast());
+    EXPECT_FALSE(CIpAddress(std::string("::2")).is_loopback());
+    EXPECT_FALSE(CIpAddress(std::string("fd00::ff")).is_broadcast());
+    EXPECT_FALSE(invalid == CIpAddress());
+
+    // An IPv4 address does not equal the IPv6 address of the same bytes
+    in6_addr ipv6Addr {};
+    std::memcpy(&ipv6Addr, &ipv4Addr, sizeof(ipv4Addr));
+    EXPECT_NE(CIpAddress(ipv6Addr), loopback4);
+}
+
+TEST(CSubnet, Parse)
+{
+    auto subnet = CSubnet::parse("192.168.17.5/20");
+    ASSERT_TRUE(subnet);
+    EXPECT_EQ(subnet->toString(), "192.168.16.0/20");
+    EXPECT_EQ(subnet->mask(), CIpAddress(std::string("255.255.240.0")));
+    EXPECT_EQ(subnet->broadcast(), CIpAddress(std::string("192.168.31.255")));
+    EXPECT_TRUE(subnet->contains(CIpAddress(std::string("192.168.31.255"))));
+    EXPECT_FALSE(subnet->contains(CIpAddress(std::string("192.168.32.0"))));
+    EXPECT_FALSE(subnet->contains(CIpAddress(std::string("::ffff:192.168.16.1"))));
+
+    subnet = CSubnet::parse("2001:db8::1");
+    ASSERT_TRUE(subnet);
+    EXPECT_EQ(subnet->prefixLength(), 128U);
+    EXPECT_TRUE(subnet->broadcast().empty());
+    EXPECT_EQ(CSubnet::parse("2001:db8:ffff::/33")->toString(), "2001:db8:8000::/33");
+    EXPECT_EQ(CSubnet::parse("0.0.0.0/0")->toString(), "0.0.0.0/0");
+    EXPECT_TRUE(CSubnet::parse("0.0.0.0/0")->contains(CIpAddress(std::string("203.0.113.9"))));
+
+    for (const char* invalid : {"", "10.0.0.0/", "10.0.0.0/33", "::/129", "10.0.0.0/1a", "10.0.0/8", "10.0.0.0/0008"}) {
+        EXPECT_FALSE(CSubnet::parse(invalid)) << invalid;
+    }
+    EXPECT_THROW(CSubnet(CIpAddress(), 8), std::invalid_argument);
+    EXPECT_THROW(CSubnet(CIpAddress(std::string("10.0.0.0")), 33), std::invalid_argument);
+    EXPECT_FALSE(CSubnet().contains(CIpAddress()));
+}
+
+TEST(CSubnet, MaskAndOverlap)
+{
+    EXPECT_EQ(CSubnet::maskLength(CIpAddress(std::string("255.255.255.0"))), 24U);
+    EXPECT_EQ(CSubnet::maskLength(CIpAddress(std::string("255.255.255.255"))), 32U);
+    EXPECT_EQ(CSubnet::maskLength(CIpAddress(std::string("0.0.0.0"))), 0U);
+    EXPECT_EQ(CSubnet::maskLength(CIpAddress(std::string("ffff:ffff:ffff:fff8::"))), 61U);
+    EXPECT_FALSE(CSubnet::maskLength(CIpAddress(std::string("255.0.255.0"))));
+    EXPECT_FALSE(CSubnet::maskLength(CIpAddress(std::string("255.255.253.0"))));
+    EXPECT_FALSE(CSubnet::maskLength(CIpAddress()));
+
+    auto subnet = CSubnet::fromMask(CIpAddress(std::string("10.1.2.3")), CIpAddress(std::string("255.255.0.0")));
+    ASSERT_TRUE(subnet);
+    EXPECT_EQ(*subnet, *CSubnet::parse("10.1.0.0/16"));
+    EXPECT_FALSE(CSubnet::fromMask(CIpAddress(std::string("10.1.2.3")), CIpAddress(std::string("ffff::"))));
+
+    const CSubnet wide   = *CSubnet::parse("10.0.0.0/8");
+    const CSubnet narrow = *CSubnet::parse("10.1.0.0/16");
+    const CSubnet other  = *CSubnet::parse("11.0.0.0/8");
+    EXPECT_TRUE(wide.contains(narrow));
+    EXPECT_FALSE(narrow.contains(wide));
+    EXPECT_TRUE(wide.overlaps(narrow));
+    EXPECT_TRUE(narrow.overlaps(wide));
+    EXPECT_FALSE(wide.overlaps(other));
+    EXPECT_FALSE(wide.overlaps(*CSubnet::parse("::/0")));
+}
+
+TEST(CSubnet, BatchContains)
+{
+    std::mt19937 random(24);
+    std::vector<CIpAddress> addresses;
+    for (int i = 0; i < 1000; i++)
+    {
+        const uint32_t value = random();
+        if (i % 3 == 0)
+        {
+            in6_addr ip {};
+            std::memcpy(ip.s6_addr, &value, sizeof(value));
+            addresses.emplace_back(ip);
+        }
+        else {
+            addresses.emplace_back(in_addr{htonl(0xC0A80000 | (value & 0x3FF))});
+        }
+    }
+    addresses.emplace_back();
+
+    for (const char* text : {"192.168.1.0/24", "192.168.0.0/22", "0.0.0.0/0", "::/0", "192.168.3.7"})
+    {
+        const CSubnet subnet = *CSubnet::parse(text);
+        std::vector<uint64_t> matches((addresses.size() + 63) / 64, ~0ULL);
+        std::size_t expected = 0;
+        const std::size_t contained = subnet.contains(utils::span<const CIpAddress>(addresses.data(), addresses.size()),
+                                                      utils::span<uint64_t>(matches.data(), matches.size()));
+        for (std::size_t i = 0; i < addresses.size(); i++)
+        {
+            const bool isContained = subnet.contains(addresses[i]);
+            expected += isContained ? 1 : 0;
+            EXPECT_EQ((matches[i / 64] >> (i % 64)) & 1, isContained ? 1U : 0U) << text << " " << i;
+        }
+        EXPECT_EQ(contained, expected) << text;
+        EXPECT_EQ(matches.back() >> (addresses.size() % 64), 0U);
+    }
+
+    uint64_t matches[1];
+    EXPECT_THROW(CSubnet().contains(utils::span<const CIpAddress>(addresses.data(), addresses.size()), utils::span<uint64_t>(matches)),
+                 std::invalid_argument);
+}
+
+TEST(CIpAddress, Classify)
+{
+    static_assert(hasClass("127.0.0.1"_ip.classify(), EAddressClass::LOOPBACK), "constexpr classify");
+    EXPECT_EQ(CIpAddress().classify(), EAddressClass::NONE);
+    EXPECT_EQ("10.1.2.3"_ip.classify(), EAddressClass::V4 | EAddressClass::PRIVATE);
+    EXPECT_EQ("172.31.0.255"_ip.classify(), EAddressClass::V4 | EAddressClass::PRIVATE | EAddressClass::BROADCAST);
+    EXPECT_EQ("172.32.0.1"_ip.classify(), EAddressClass::V4);
+    EXPECT_EQ("169.254.7.1"_ip.classify(), EAddressClass::V4 | EAddressClass::LINK_LOCAL);
+    EXPECT_EQ("239.1.1.1"_ip.classify(), EAddressClass::V4 | EAddressClass::MULTICAST);
+    EXPECT_EQ("0.0.0.0"_ip.classify(), EAddressClass::V4 | EAddressClass::UNSPECIFIED);
+    EXPECT_EQ("::"_ip.classify(), EAddressClass::V6 | EAddressClass::UNSPECIFIED);
+    EXPECT_EQ("::1"_ip.classify(), EAddressClass::V6 | EAddressClass::LOOPBACK);
+    EXPECT_EQ("fd00::ff"_ip.classify(), EAddressClass::V6 | EAddressClass::PRIVATE);
+    EXPECT_EQ("fe80::1"_ip.classify(), EAddressClass::V6 | EAddressClass::LINK_LOCAL);
+    EXPECT_EQ("fec0::1"_ip.classify(), EAddressClass::V6);
+    EXPECT_EQ("ff02::1"_ip.classify(), EAddressClass::V6 | EAddressClass::MULTICAST);
+    EXPECT_EQ("::ffff:10.0.0.1"_ip.classify(), EAddressClass::V6 | EAddressClass::V4_MAPPED);
+
+    // The batch agrees with the classification of the single addresses, the
+    // addresses are drawn from few leading bytes to hit all classes
+    std::mt19937 random(25);
+    const uint8_t leading[] {0, 10, 127, 169, 172, 192, 224, 0xFC, 0xFE, 0xFF};
+    std::vector<CIpAddress> addresses;
+    for (int i = 0; i < 1003; i++)
+    {
+        in6_addr ip {};
+        for (auto& rByte : ip.s6_addr) {
+            rByte = (random() % 3 == 0) ? static_cast<uint8_t>(random()) : 0;
+        }
+        ip.s6_addr[0] = leading[random() % sizeof(leading)];
+        if (random() % 4 == 0)
+        {
+            std::memset(ip.s6_addr, 0, 10);
+            ip.s6_addr[10] = 0xFF;
+            ip.s6_addr[11] = 0xFF;
+        }
+        if (random() % 2 == 0)
+        {
+            in_addr ipv4;
+            std::memcpy(&ipv4, ip.s6_addr, sizeof(ipv4));
+            addresses.emplace_back(ipv4);
+        }
+        else {
+            addresses.emplace_back(ip);
+        }
+    }
+    addresses.emplace_back();
+    addresses.push_back("::1"_ip);
+
+    std::vector<EAddressClass> classes(addresses.size());
+    CIpAddress::classify(utils::span<const CIpAddress>(addresses.data(), addresses.size()),
+                         utils::span<EAddressClass>(classes.data(), classes.size()));
+    for (std::size_t i = 0; i < addresses.size(); i++)
+    {
+        const EAddressClass expected = addresses[i].classify();
+        EXPECT_EQ(classes[i], expected) << addresses[i].toString();
+        EXPECT_EQ(hasClass(expected, EAddressClass::LOOPBACK), addresses[i].is_loopback());
+        EXPECT_EQ(hasClass(expected, EAddressClass::BROADCAST), addresses[i].is_broadcast());
+    }
+    EXPECT_THROW(CIpAddress::classify(utils::span<const CIpAddress>(addresses.data(), addresses.size()),
+                                      utils::span<EAddressClass>(classes.data(), 4)), std::invalid_argument);
+}
+
+TEST(CIpAddress, ParseAsInetPton)
+{
+    const char* texts[] = {
+        "0.0.0.0", "255.255.255.255", "192.168.0.1", "1.2.3.4", "10.0.0.255",
+        "256.1.1.1", "1.2.3", "1.2.3.4.5", "01.2.3.4", "1..2.3", ".1.2.3", "1.2.3.", "1.2.3.4 ", "a.b.c.d", "1.2.3.1000", "",
+        "::", "::1", "1::", "fd00::cece:1eff:fead:2fb5", "2003:f2:93cd:e100:9131:8000:5cf5:9f0c", "::ffff:192.168.0.1",
+        "::192.168.0.1", "1:2:3:4:5:6:1.2.3.4", "1:2:3:4:5:6:7::", "::2:3:4:5:6:7:8", "ABCD:EF01::1", "0000:0:00:000::0",
+        ":::", "1:::2", "1::2::3", ":1::", "1:2:3:4:5:6:7:8:9", "1:2:3:4:5:6:7:8::", "12345::", "1:2:3:4:5:6:7:1.2.3.4",
+        "::1.2.3", "::1.2.3.04", "g::", "1:", "fe80::1%eth0"
+    };
+    for (const char* pText : texts)
+    {
+        uint8_t expected[16] = {0};
+        bool isV6 = std::strchr(pText, ':') != nullptr;
+        bool valid = inet_pton(isV6 ? AF_INET6 : AF_INET, pText, expected) == 1;
+
+        auto address = CIpAddress::parse(pText);
+        ASSERT_EQ(address.has_value(), valid) << pText;
+        if (valid)
+        {
+            EXPECT_EQ(address->is_v6(), isV6) << pText;
+            const void* pActual = isV6 ? static_cast<const void*>(address->to_v6()) : static_cast<const void*>(address->to_v4());
+            EXPECT_EQ(std::memcmp(pActual, expected, isV6 ? 16 : 4), 0) << pText;
+        }
+    }
+
+    constexpr CIpAddress local = "192.168.0.1"_ip;
+    static_assert(local.is_v4() && (local.to_v4() != nullptr), "compile time literal");
+    static_assert("::1"_ip.is_loopback(), "compile time literal");
+    EXPECT_EQ(local, CIpAddress(std::string("192.168.0.1")));
+}
+
+TEST(CIpAddress, FormatAsInetNtop)
+{
+    std::mt19937 random(4711);
+    for (int i = 0; i < 20000; i++)
+    {
+        // Sparse groups cover the zero runs and the embedded IPv4 forms
+        in6_addr v6 {};
+        for (int group = 0; group < 8; group++)
+        {
+            if (random() % 3 == 0) {
+                v6.s6_addr[2 * group]     = static_cast<uint8_t>(random() % 2 ? random() : 0);
+                v6.s6_addr[2 * group + 1] = static_cast<uint8_t>(random());
+            }
+        }
+        if (i % 4 == 0) {
+            v6.s6_addr[10] = v6.s6_addr[11] = 0xFF;
+        }
+        in_addr v4 {static_cast<in_addr_t>(random())};
+
+        char expected[INET6_ADDRSTRLEN];
+        ASSERT_NE(inet_ntop(AF_INET6, &v6, expected, sizeof(expected)), nullptr);
+        EXPECT_EQ(CIpAddress(v6).toString(), expected);
+        EXPECT_EQ(CIpAddress::parse(expected), CIpAddress(v6)) << expected;
+        ASSERT_NE(inet_ntop(AF_INET, &v4, expected, sizeof(expected)), nullptr);
+        EXPECT_EQ(CIpAddress(v4).toString(), expected);
+    }
+
+    char buffer[8];
+    EXPECT_EQ(CIpAddress(std::string("10.0.0.1")).format(utils::span<char>(buffer)), 8U);
+    EXPECT_EQ(std::string(buffer, 8), "10.0.0.1");
+    EXPECT_EQ(CIpAddress(std::string("192.168.0.1")).format(utils::span<char>(buffer)), 0U);
+    EXPECT_EQ(CIpAddress().format(utils::span<char>(buffer)), 0U);
+}
+
 TEST(HostName, NameToIP)
 {
     CHostLookup host(std::string("localhost"));
@@ -0,0 +1,203 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <Lookup/PrefixTable.hpp>
+
+using namespace EtNet;
+
+#define GTEST_BOX                   "[     cout ] "
+
+namespace
+{
+
+struct SPrefix
+{
+    CIpAddress network;
+    unsigned length;
+    uint32_t value;
+};
+
+const uint8_t* bytesOf(const CIpAddress& rAddress)
+{
+    return rAddress.is_v4() ? reinterpret_cast<const uint8_t*>(rAddress.to_v4()) : rAddress.to_v6()->s6_addr;
+}
+
+bool contains(const SPrefix& rPrefix, const CIpAddress& rAddress)
+{
+    if (rPrefix.network.addressFamily() != rAddress.addressFamily()) {
+        return false;
+    }
+    for (unsigned bit = 0; bit < rPrefix.length; bit++)
+    {
+        const uint8_t mask = static_cast<uint8_t>(0x80 >> (bit % 8));
+        if ((bytesOf(rPrefix.network)[bit / 8] & mask) != (bytesOf(rAddress)[bit / 8] & mask)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//! reference of the longest prefix match by a linear scan, the value added last wins
+uint32_t linearLookup(const std::vector<SPrefix>& rPrefixes, const CIpAddress& rAddress)
+{
+    uint32_t value = CPrefixTable::noMatch;
+    int bestLength = -1;
+    for (const auto& rPrefix : rPrefixes)
+    {
+        if (contains(rPrefix, rAddress) && (static_cast<int>(rPrefix.length) >= bestLength))
+        {
+            bestLength = static_cast<int>(rPrefix.length);
+            value = rPrefix.value;
+        }
+    }
+    return value;
+}
+
+CIpAddress randomAddress(std::mt19937& rRandom, bool v6, const in6_addr& rBase)
+{
+    // The addresses are drawn close to a base to hit the prefixes
+    in6_addr bytes = rBase;
+    const unsigned size = v6 ? 16 : 4;
+    const unsigned keep = std::uniform_int_distribution<unsigned>(0, size)(rRandom);
+    for (unsigned i = keep; i < size; i++) {
+        bytes.s6_addr[i] = static_cast<uint8_t>(rRandom());
+    }
+    if (v6) {
+        return CIpAddress(bytes);
+    }
+    in_addr v4;
+    std::memcpy(&v4, bytes.s6_addr, sizeof(v4));
+    return CIpAddress(v4);
+}
+
+}
+
+TEST(CPrefixTable, PrefixList)
+{
+    CPrefixTable::CBuilder builder;
+    EXPECT_EQ(builder.add("192.168.17.5/20 2001:db8:ffff::/33", 1), 2U);
+    EXPECT_EQ(builder.add(" # only a comment\n", 2), 0U);
+    for (const char* invalid : {"10.0.0.0/", "10.0.0.0/33", "::/129", "10.0.0.0/1a", "10.0.0/8", "10.0.0.0/0008"}) {
+        EXPECT_THROW(builder.add(invalid, 3), std::invalid_argument) << invalid;
+    }
+    EXPECT_THROW(builder.add(CIpAddress(), 0, 3), std::invalid_argument);
+    EXPECT_THROW(builder.add(CIpAddress(std::string("10.0.0.0")), 33, 3), std::invalid_argument);
+    EXPECT_THROW(builder.add(CIpAddress(std::string("10.0.0.0")), 8, CPrefixTable::noMatch), std::invalid_argument);
+
+    // The host bits of the prefixes are ignored
+    auto pTable = builder.build();
+    EXPECT_EQ(pTable->size(), 2U);
+    EXPECT_EQ(pTable->lookup(CIpAddress(std::string("192.168.31.255"))), 1U);
+    EXPECT_EQ(pTable->lookup(CIpAddress(std::string("192.168.32.0"))), CPrefixTable::noMatch);
+    EXPECT_EQ(pTable->lookup(CIpAddress(std::string("2001:db8:8000::1"))), 1U);
+    EXPECT_EQ(pTable->lookup(CIpAddress(std::string("2001:db8:7fff::1"))), CPrefixTable::noMatch);
+    EXPECT_EQ(pTable->lookup(CIpAddress(std::string("::ffff:192.168.16.1"))), CPrefixTable::noMatch);
+}
+
+TEST(CPrefixTable, LongestMatch)
+{
+    CPrefixTable::CBuilder builder;
+    EXPECT_EQ(builder.add("10.0.0.0/8, 10.1.0.0/16\n"
+                          "10.1.2.0/23 # a comment, 1.2.3.0/24\n"
+                          "2001:db8::/32", 1), 4U);
+    builder.add(CIpAddress(std::string("10.1.0.0")), 16, 2);
+    builder.add(CIpAddress(std::string("10.1.2.128")), 25, 3);
+    builder.add(CIpAddress(std::string("::")), 0, 4);
+    EXPECT_THROW(builder.add("10.0.0.0/8 bad", 5), std::invalid_argument);
+
+    // The last bits of the addresses are in the last slots of the deepest nodes
+    EXPECT_EQ(builder.add("255.255.255.254/31 ffff:ffff:ffff:ffff:ffff:ffff:ffff:fffe/127", 6), 2U);
+    EXPECT_EQ(builder.add("255.255.255.255 ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff", 7), 2U);
+
+    auto pTable = builder.build();
+    EXPECT_EQ(pTable->size(), 10U);
+    EXPECT_EQ(pTable->lookup(CIpAddress(std::string("10.200.0.1"))), 1U);
+    EXPECT_EQ(pTable->lookup(CIpAddress(std::string("10.1.0.1"))), 2U);
+    EXPECT_EQ(pTable->lookup(CIpAddress(std::string("10.1.3.1"))), 1U);
+    EXPECT_EQ(pTable->lookup(CIpAddress(std::string("10.1.2.200"))), 3U);
+    EXPECT_EQ(pTable->lookup(CIpAddress(std::string("1.2.3.4"))), CPrefixTable::noMatch);
+    EXPECT_EQ(pTable->lookup(CIpAddress(std::string("2001:db8:1::1"))), 1U);
+    EXPECT_EQ(pTable->lookup(CIpAddress(std::string("fe80::1"))), 4U);
+    EXPECT_EQ(pTable->lookup(CIpAddress(std::string("255.255.255.254"))), 6U);
+    EXPECT_EQ(pTable->lookup(CIpAddress(std::string("255.255.255.255"))), 7U);
+    EXPECT_EQ(pTable->lookup(CIpAddress(std::string("255.255.255.253"))), CPrefixTable::noMatch);
+    EXPECT_EQ(pTable->lookup(CIpAddress(std::string("ffff:ffff:ffff:ffff:ffff:ffff:ffff:fffe"))), 6U);
+    EXPECT_EQ(pTable->lookup(CIpAddress(std::string("ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff"))), 7U);
+    EXPECT_EQ(pTable->lookup(CIpAddress(std::string("ffff:ffff:ffff:ffff:ffff:ffff:ffff:fffd"))), 4U);
+    EXPECT_EQ(pTable->lookup(CIpAddress()), CPrefixTable::noMatch);
+    EXPECT_EQ(CPrefixTable().lookup(CIpAddress(std::string("10.0.0.1"))), CPrefixTable::noMatch);
+}
+
+TEST(CPrefixTable, AgainstLinearScan)
+{
+    std::mt19937 random(23);
+    const in6_addr base {{{0x20, 0x01, 0x0d, 0xb8, 0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf0, 0x11, 0x22, 0x33, 0x44}}};
+
+    for (bool v6 : {false, true})
+    {
+        const unsigned maxLength = v6 ? 128 : 32;
+        std::vector<SPrefix> prefixes;
+        CPrefixTable::CBuilder builder;
+        for (uint32_t value = 0; value < 500; value++)
+        {
+            // The host bits are left set, the table has to ignore them
+            const unsigned length = std::uniform_int_distribution<unsigned>(0, maxLength)(random);
+            const CIpAddress network = randomAddress(random, v6, base);
+            prefixes.push_back(SPrefix{network, length, value});
+            builder.add(network, length, value);
+        }
+
+        auto pTable = builder.build();
+        for (int i = 0; i < 20000; i++)
+        {
+            CIpAddress address = randomAddress(random, v6, base);
+            ASSERT_EQ(pTable->lookup(address), linearLookup(prefixes, address)) << address.toString();
+        }
+        std::cout << GTEST_BOX << (v6 ? "IPv6" : "IPv4") << " prefixes: " << pTable->size()
+                  << " memory: " << pTable->memoryUsage() << std::endl;
+    }
+}
+
+TEST(CPrefixTable, SharedReplace)
+{
+    const CIpAddress address(std::string("192.0.2.1"));
+    CSharedPrefixTable shared;
+    CSharedPrefixTable::CReader reader(shared);
+    EXPECT_EQ(reader.lookup(address), CPrefixTable::noMatch);
+
+    std::thread writer([&shared]()
+    {
+        for (uint32_t value = 0; value < 100; value++)
+        {
+            CPrefixTable::CBuilder builder;
+            builder.add("192.0.2.0/24", value);
+            shared.store(builder.build());
+        }
+    });
+
+    // Each reader observes the values in the order of the stores
+    uint32_t last = 0;
+    while (last != 99)
+    {
+        uint32_t value = reader.lookup(address);
+        if (value != CPrefixTable::noMatch)
+        {
+            ASSERT_GE(value, last);
+            last = value;
+        }
+    }
+    writer.join();
+
+    EXPECT_EQ(shared.load()->lookup(address), 99U);
+    EXPECT_THROW(shared.store(nullptr), std::invalid_argument);
+}
+
+int main(int argc, char **argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
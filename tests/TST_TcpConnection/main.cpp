@@ -3,10 +3,20 @@
 #include <cstring>
 #include <tuple>
 #include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <future>
+#include <cstdio>
+#include <unistd.h>
 #include <templateHelpers.h>
 #include <BaseSocket.hpp>
 #include <Tcp/TcpClient.hpp>
 #include <Tcp/TcpServer.hpp>
+#include <Tcp/TcpConnectionPool.hpp>
+#include <Lookup/HostCache.hpp>
 
 
 #define ANSI_TXT_GRN                "\033[0;32m"
@@ -171,6 +181,445 @@ TEST_F(CTcpComTest, ComplexDataEndian)
     t.join();
 }
 
+TEST_F(CTcpComTest, UringEngine)
+{
+    if (!isIoEngineSupported(EIoEngine::URING)) {
+        GTEST_SKIP() << "io_uring not supported by the running kernel";
+    }
+    EXPECT_EQ(m_Server.setIoEngine(EIoEngine::URING), EIoEngine::URING);
+
+    std::thread t([this]()
+    {
+        uint8_t rcvData[40] = {0};
+        utils::span<uint8_t> rcvSpan (rcvData);
+
+        CTcpDataLink a;
+        CIpAddress b;
+        std::tie(a, b) = m_Server.waitForConnection();
+        EXPECT_TRUE(b.is_loopback());
+        EXPECT_EQ(a.setIoEngine(EIoEngine::URING), EIoEngine::URING);
+        a.recive(rcvSpan, [&a](utils::span<uint8_t> rx)
+        {
+            a.send(rx);
+            return true;
+        });
+    });
+
+    auto a = m_Client.connect(std::string("localhost"),50003);
+    EXPECT_EQ(a.setIoEngine(EIoEngine::URING), EIoEngine::URING);
+
+    STestData dataTransmit ("hallo", 0xFFBBCCDD, 0xAAEE, 0x88);
+    a.send(EtEndian::CNetOrder(dataTransmit));
+
+    EtEndian::CHostOrder<STestData> rx;
+    a.recive(rx);
+    EXPECT_EQ(dataTransmit, rx.HostOrder());
+    t.join();
+
+    a.unblockRecive();
+    uint8_t rcvData[4];
+    EXPECT_EQ(a.recive(utils::span<uint8_t>(rcvData)), CTcpDataLink::ERet::UNBLOCK);
+}
+
+TEST_F(CTcpComTest, ScatterGather)
+{
+    // The payload exceeds the socket buffers, the transmit completes by partial writes
+    constexpr std::size_t partCount = 24;
+    constexpr std::size_t partSize  = 64 * 1024;
+    std::vector<std::vector<uint8_t>> payload(partCount);
+    for (std::size_t i = 0; i < partCount; i++) {
+        payload[i].assign(partSize, static_cast<uint8_t>(i));
+    }
+    const std::string trailer("header and payload in one call");
+
+    std::vector<EIoEngine> engines {EIoEngine::POSIX};
+    if (isIoEngineSupported(EIoEngine::URING)) {
+        engines.push_back(EIoEngine::URING);
+    }
+
+    for (auto engine : engines)
+    {
+        std::thread t([this, &payload, &trailer]()
+        {
+            CTcpDataLink a;
+            CIpAddress b;
+            std::tie(a, b) = m_Server.waitForConnection();
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+            EtEndian::CHostOrder<STestData> header;
+            a.recive(header, [](utils::span<uint8_t> rx) { return false; });
+            EXPECT_EQ(STestData("scattered", 0x01020304, 0x0506, 0x07), header.HostOrder());
+
+            std::vector<uint8_t> rcvData(partCount * partSize);
+            utils::span<uint8_t> rcvSpan (rcvData.data(), rcvData.size());
+            a.recive(rcvSpan, [](utils::span<uint8_t> rx) { return false; });
+            ASSERT_EQ(rcvSpan.size(), rcvData.size());
+            for (std::size_t i = 0; i < partCount; i++) {
+                EXPECT_TRUE(std::equal(payload[i].begin(), payload[i].end(), rcvData.begin() + i * partSize));
+            }
+
+            EtEndian::CHostOrder<STestData> trailerHeader;
+            a.recive(trailerHeader, [](utils::span<uint8_t> rx) { return false; });
+            EXPECT_EQ(STestData("collected", 0x11121314, 0x1516, 0x17), trailerHeader.HostOrder());
+            std::vector<uint8_t> rcvTrailer(trailer.size());
+            utils::span<uint8_t> rcvTrailerSpan (rcvTrailer.data(), rcvTrailer.size());
+            a.recive(rcvTrailerSpan, [](utils::span<uint8_t> rx) { return false; });
+            ASSERT_EQ(rcvTrailerSpan.size(), trailer.size());
+            EXPECT_TRUE(std::equal(trailer.begin(), trailer.end(), rcvTrailer.begin()));
+        });
+
+        CTcpClient client(CBaseSocket(EtNet::ESocketMode::INET_STREAM));
+        auto a = client.connect(std::string("localhost"), 50003);
+        EXPECT_EQ(a.setIoEngine(engine), engine);
+
+        std::vector<utils::span<const uint8_t>> parts;
+        for (const auto& part : payload) {
+            parts.emplace_back(part.data(), part.size());
+        }
+        a.send(EtEndian::CNetOrder(STestData("scattered", 0x01020304, 0x0506, 0x07)), utils::span<const uint8_t>());
+        a.send(utils::span<const utils::span<const uint8_t>>(parts.data(), parts.size()));
+        a.send(EtEndian::CNetOrder(STestData("collected", 0x11121314, 0x1516, 0x17)), utils::span(trailer));
+        t.join();
+    }
+}
+
+TEST_F(CTcpComTest, ZeroCopy)
+{
+    constexpr std::size_t blockCount = 8;
+    constexpr std::size_t blockSize  = 512 * 1024;
+    std::vector<std::vector<uint8_t>> payload(blockCount);
+    for (std::size_t i = 0; i < blockCount; i++) {
+        payload[i].assign(blockSize, static_cast<uint8_t>(i + 1));
+    }
+    std::vector<uint8_t> small(64, 0xAA);
+
+    std::thread t([this, &payload, &small]()
+    {
+        CTcpDataLink a;
+        CIpAddress b;
+        std::tie(a, b) = m_Server.waitForConnection();
+
+        std::vector<uint8_t> rcvData(blockCount * blockSize + small.size());
+        utils::span<uint8_t> rcvSpan (rcvData.data(), rcvData.size());
+        a.recive(rcvSpan, [](utils::span<uint8_t> rx) { return false; });
+        ASSERT_EQ(rcvSpan.size(), rcvData.size());
+        for (std::size_t i = 0; i < blockCount; i++) {
+            EXPECT_TRUE(std::equal(payload[i].begin(), payload[i].end(), rcvData.begin() + i * blockSize));
+        }
+        EXPECT_TRUE(std::equal(small.begin(), small.end(), rcvData.begin() + blockCount * blockSize));
+    });
+
+    CTcpClient client(CBaseSocket(EtNet::ESocketMode::INET_STREAM));
+    auto a = client.connect(std::string("localhost"), 50003);
+    // without kernel support the buffers are copied and released at once
+    const bool zeroCopy = a.setZeroCopy();
+
+    std::atomic<std::size_t> released {0};
+    for (const auto& block : payload) {
+        a.sendZeroCopy(utils::span<const uint8_t>(block.data(), block.size()), [&released]() { released++; });
+    }
+    // below the threshold the buffer is copied and released at once
+    bool smallReleased = false;
+    a.sendZeroCopy(utils::span<const uint8_t>(small.data(), small.size()), [&smallReleased]() { smallReleased = true; });
+    EXPECT_TRUE(smallReleased);
+
+    t.join();
+    EXPECT_EQ(a.flushZeroCopy(std::chrono::milliseconds(2000)), 0u);
+    EXPECT_EQ(released, blockCount);
+
+    auto stats = a.getZeroCopyStats();
+    std::cout << GTEST_BOX << "zero copy: " << stats.zeroCopySends << " copied: " << stats.copiedSends
+              << " kernel copied: " << stats.kernelCopied << std::endl;
+    if (zeroCopy) {
+        EXPECT_EQ(stats.zeroCopySends, blockCount);
+        EXPECT_EQ(stats.copiedSends, 1u);
+    }
+}
+
+TEST_F(CTcpComTest, ZeroCopyFailure)
+{
+    std::vector<uint8_t> payload(32 * 1024 * 1024, 0x55);
+
+    std::thread t([this]()
+    {
+        CTcpDataLink a;
+        CIpAddress b;
+        std::tie(a, b) = m_Server.waitForConnection();
+
+        // Closing with unread data resets the connection during the transmit
+        std::vector<uint8_t> rcvData(64 * 1024);
+        utils::span<uint8_t> rcvSpan (rcvData.data(), rcvData.size());
+        a.recive(rcvSpan, [](utils::span<uint8_t> rx) { return false; });
+    });
+
+    CTcpClient client(CBaseSocket(EtNet::ESocketMode::INET_STREAM));
+    auto a = client.connect(std::string("localhost"), 50003);
+    a.setZeroCopy();
+
+    // The parts queued before the failure are released by their completions
+    std::atomic<std::size_t> released {0};
+    EXPECT_THROW(a.sendZeroCopy(utils::span<const uint8_t>(payload.data(), payload.size()), [&released]() { released++; }),
+                 std::domain_error);
+    t.join();
+    EXPECT_EQ(a.flushZeroCopy(std::chrono::milliseconds(2000)), 0u);
+    EXPECT_EQ(released, 1u);
+}
+
+TEST_F(CTcpComTest, SendFile)
+{
+    constexpr std::size_t fileSize = 3 * 1024 * 1024 + 123;
+    constexpr off_t offset = 1000;
+    std::vector<uint8_t> content(fileSize);
+    for (std::size_t i = 0; i < fileSize; i++) {
+        content[i] = static_cast<uint8_t>(i * 7);
+    }
+
+    FILE* pFile = std::tmpfile();
+    ASSERT_NE(pFile, nullptr);
+    ASSERT_EQ(std::fwrite(content.data(), 1, content.size(), pFile), content.size());
+    std::fflush(pFile);
+    const int fileFd = ::fileno(pFile);
+
+    std::promise<std::size_t> cancelled;
+    std::thread t([this, &content, &cancelled]()
+    {
+        CTcpDataLink a;
+        CIpAddress b;
+        std::tie(a, b) = m_Server.waitForConnection();
+
+        // the remaining file beyond the offset
+        std::vector<uint8_t> rcvData(fileSize - offset);
+        utils::span<uint8_t> rcvSpan (rcvData.data(), rcvData.size());
+        a.recive(rcvSpan, [](utils::span<uint8_t> rx) { return false; });
+        ASSERT_EQ(rcvSpan.size(), rcvData.size());
+        EXPECT_TRUE(std::equal(rcvData.begin(), rcvData.end(), content.begin() + offset));
+
+        // the head of the file up to the cancellation
+        std::vector<uint8_t> headData(cancelled.get_future().get());
+        utils::span<uint8_t> headSpan (headData.data(), headData.size());
+        a.recive(headSpan, [](utils::span<uint8_t> rx) { return false; });
+        ASSERT_EQ(headSpan.size(), headData.size());
+        EXPECT_TRUE(std::equal(headData.begin(), headData.end(), content.begin()));
+    });
+
+    CTcpClient client(CBaseSocket(EtNet::ESocketMode::INET_STREAM));
+    auto a = client.connect(std::string("localhost"), 50003);
+
+    std::size_t lastProgress = 0;
+    std::size_t sent = a.sendFile(fileFd, offset, 0, [&lastProgress](std::size_t sent, std::size_t length)
+    {
+        EXPECT_GT(sent, lastProgress);
+        EXPECT_EQ(length, fileSize - offset);
+        lastProgress = sent;
+        return true;
+    });
+    EXPECT_EQ(sent, fileSize - offset);
+    EXPECT_EQ(lastProgress, sent);
+
+    // cancel after the first chunk
+    sent = a.sendFile(fileFd, 0, fileSize, [](std::size_t sent, std::size_t length) { return false; });
+    EXPECT_GT(sent, 0u);
+    EXPECT_LT(sent, fileSize);
+    cancelled.set_value(sent);
+
+    t.join();
+    std::fclose(pFile);
+}
+
+TEST_F(CTcpComTest, ConnectTimeout)
+{
+    std::thread t([this]()
+    {
+        CTcpDataLink a;
+        CIpAddress b;
+        std::tie(a, b) = m_Server.waitForConnection();
+        a.send(utils::span<const uint8_t>(reinterpret_cast<const uint8_t*>("ok"), 2));
+    });
+
+    auto a = m_Client.connect(std::string("localhost"), 50003, std::chrono::seconds(1));
+    uint8_t rcvData[2] = {0};
+    utils::span<uint8_t> rcvSpan (rcvData);
+    EXPECT_EQ(a.recive(rcvSpan, [](utils::span<uint8_t> rx) { return false; }), CTcpDataLink::ERet::OK);
+    EXPECT_EQ(rcvSpan.size(), 2U);
+    t.join();
+}
+
+TEST_F(CTcpComTest, ConnectAddress)
+{
+    std::thread t([this]()
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            CTcpDataLink a;
+            CIpAddress b;
+            std::tie(a, b) = m_Server.waitForConnection();
+            a.send(utils::span<const uint8_t>(reinterpret_cast<const uint8_t*>("ok"), 2));
+        }
+    });
+
+    // Literal and already resolved addresses are connected without a lookup
+    const CHostCache::SStats before = CHostCache::instance().getStats();
+    const CIpAddress loopback(std::string("127.0.0.1"));
+    std::vector<CTcpDataLink> links;
+    links.push_back(m_Client.connect(std::string("127.0.0.1"), 50003));
+    links.push_back(CTcpClient(CBaseSocket(EtNet::ESocketMode::INET_STREAM)).connect(loopback, 50003));
+    links.push_back(CTcpClient(CBaseSocket(EtNet::ESocketMode::INET_STREAM)).connect(CIpAddress::IpAddresses{loopback}, 50003, std::chrono::seconds(1)));
+    const CHostCache::SStats after = CHostCache::instance().getStats();
+    EXPECT_EQ(after.misses + after.hits + after.staleHits, before.misses + before.hits + before.staleHits);
+
+    for (auto& link : links)
+    {
+        uint8_t rcvData[2] = {0};
+        utils::span<uint8_t> rcvSpan (rcvData);
+        EXPECT_EQ(link.recive(rcvSpan, [](utils::span<uint8_t> rx) { return false; }), CTcpDataLink::ERet::OK);
+        EXPECT_EQ(rcvSpan.size(), 2U);
+    }
+    t.join();
+}
+
+TEST(CTcpClient, ConnectRefused)
+{
+    CTcpClient client(CBaseSocket(EtNet::ESocketMode::INET_STREAM));
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_THROW(client.connect(std::string("127.0.0.1"), 50008, std::chrono::seconds(5)), std::runtime_error);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+
+    // The lookup is bounded by the deadline as well
+    EXPECT_THROW(client.connect(std::string("localhost"), 50008, std::chrono::milliseconds(0)), std::runtime_error);
+}
+
+TEST(CTcpClient, ConnectDeadline)
+{
+    // The listener never accepts, once its queue is full the SYNs are dropped
+    CTcpServer server(CBaseSocket::SoReuseSocket(CBaseSocket(EtNet::ESocketMode::INET_STREAM)), 50009, 0);
+    std::vector<CTcpDataLink> links;
+    bool timedOut = false;
+    for (int i = 0; (i < 8) && !timedOut; i++)
+    {
+        CTcpClient client(CBaseSocket(EtNet::ESocketMode::INET_STREAM));
+        auto start = std::chrono::steady_clock::now();
+        try {
+            links.push_back(client.connect(std::string("127.0.0.1"), 50009, std::chrono::milliseconds(100)));
+        }
+        catch (const std::runtime_error&) {
+            timedOut = true;
+            EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+        }
+    }
+    EXPECT_TRUE(timedOut);
+}
+
+TEST(CTcpAcceptorPool, ShardedAccept)
+{
+    constexpr unsigned connections = 16;
+    CTcpAcceptorPool pool(EtNet::ESocketMode::INET_STREAM, 50007, 4, 64);
+    EXPECT_EQ(pool.size(), 4U);
+
+    std::atomic<unsigned> accepted {0};
+    pool.start([&accepted](CTcpDataLink link, CIpAddress peer)
+    {
+        EXPECT_TRUE(peer.is_loopback());
+        accepted++;
+    });
+
+    std::vector<CTcpDataLink> links;
+    for (unsigned i = 0; i < connections; i++)
+    {
+        CTcpClient client(CBaseSocket(EtNet::ESocketMode::INET_STREAM));
+        links.push_back(client.connect(std::string("localhost"), 50007));
+    }
+
+    for (int i = 0; (i < 200) && (accepted < connections); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(accepted, connections);
+
+    auto stats = pool.getStats();
+    EXPECT_EQ(stats.accepted, connections);
+    ASSERT_EQ(stats.listeners.size(), 4U);
+    for (const auto& listener : stats.listeners)
+    {
+        EXPECT_EQ(listener.queued, 0U);
+        EXPECT_EQ(listener.backlog, 64U);
+    }
+    pool.stop();
+
+    // The listeners are shut down by stop, the pool can't be restarted
+    EXPECT_THROW(pool.start([](CTcpDataLink link, CIpAddress peer) { }), std::logic_error);
+}
+
+TEST(CTcpConnectionPool, Reuse)
+{
+    CTcpAcceptorPool server(EtNet::ESocketMode::INET_STREAM, 50013, 1, 16);
+    std::mutex mutex;
+    std::vector<CTcpDataLink> accepted;
+    server.start([&mutex, &accepted](CTcpDataLink link, CIpAddress peer)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        accepted.push_back(std::move(link));
+    });
+
+    CTcpConnectionPool pool(1);
+    int fd;
+    {
+        auto lease = pool.acquire(std::string("localhost"), 50013);
+        ASSERT_TRUE(lease);
+        fd = lease->getFd();
+        std::string dataToSend("pooled");
+        lease->send(utils::span(dataToSend).as_byte());
+
+        // the backend is capped to one connection
+        EXPECT_THROW(pool.acquire(std::string("localhost"), 50013, std::chrono::milliseconds(20)), std::runtime_error);
+    }
+    {
+        auto lease = pool.acquire(std::string("localhost"), 50013);
+        EXPECT_EQ(lease->getFd(), fd);
+    }
+    auto stats = pool.getStats();
+    EXPECT_EQ(stats.connects, 1U);
+    EXPECT_EQ(stats.reuses, 1U);
+    EXPECT_EQ(stats.idle, 1U);
+    EXPECT_EQ(stats.leased, 0U);
+
+    // The server closes the idle connection, the health check drops it
+    for (int i = 0; i < 100; i++)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!accepted.empty()) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ASSERT_EQ(accepted.size(), 1U);
+        accepted.clear();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    {
+        auto lease = pool.acquire(std::string("localhost"), 50013);
+        EXPECT_TRUE(lease);
+        lease.discard();
+        EXPECT_FALSE(lease);
+    }
+    stats = pool.getStats();
+    EXPECT_EQ(stats.connects, 2U);
+    EXPECT_EQ(stats.dropped, 1U);
+    EXPECT_EQ(stats.idle, 0U);
+
+    // A lease left by an exception closes its connection
+    try
+    {
+        auto lease = pool.acquire(std::string("localhost"), 50013);
+        throw std::runtime_error("request failed");
+    }
+    catch (const std::runtime_error&) { }
+    stats = pool.getStats();
+    EXPECT_EQ(stats.connects, 3U);
+    EXPECT_EQ(stats.idle, 0U);
+    EXPECT_EQ(stats.leased, 0U);
+    server.stop();
+}
 
 int main(int argc, char **argv)
 {
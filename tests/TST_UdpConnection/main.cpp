@@ -3,6 +3,8 @@
 #include <cstring>
 #include <tuple>
 #include <thread>
+#include <array>
+#include <vector>
 #include <Udp/UdpClient.hpp>
 #include <BaseSocket.hpp>
 #include <Udp/UdpServer.hpp>
@@ -157,6 +159,48 @@ TEST_F(CDgramComTest, ComplexDataEndian)
     t.join();
 }
 
+TEST_F(CDgramComTest, BatchEndian)
+{
+    const std::vector<STestData> dataTransmit {
+        STestData("first",  0x11223344, 0xAA01, 0x01),
+        STestData("second", 0x55667788, 0xAA02, 0x02),
+        STestData("third",  0x99AABBCC, 0xAA03, 0x03)
+    };
+
+    auto a = m_Client.getLink(std::string("localhost"),50002);
+    std::vector<EtEndian::CNetOrder<STestData>> txBatch;
+    for (const auto& data : dataTransmit) {
+        txBatch.emplace_back(data);
+    }
+    a.sendBatch(txBatch);
+
+    // The server returns the first datagram to the client twice by a fan-out
+    std::thread t([this]()
+    {
+        uint8_t rcvData[3][sizeof(STestData)] = {0};
+        std::array<SDatagram, 3> batch;
+        for (std::size_t i = 0; i < batch.size(); i++) {
+            batch[i].Data = utils::span<uint8_t>(rcvData[i]);
+        }
+
+        CUdpDataLink b = m_Server.waitForConnection();
+        std::size_t count = 0;
+        ASSERT_EQ(b.reciveBatch(utils::span<SDatagram>(batch.data(), batch.size()), count), CUdpDataLink::ERet::OK);
+        ASSERT_GT(count, 0U);
+
+        const std::array<SPeerAddr, 2> peers {batch[0].Peer, batch[0].Peer};
+        b.sendToBatch(utils::span<const SPeerAddr>(peers.data(), peers.size()), utils::span<const uint8_t>(batch[0].Data.data(), batch[0].Data.size()));
+    });
+
+    for (int i = 0; i < 2; i++)
+    {
+        EtEndian::CHostOrder<STestData> rx;
+        a.reciveFrom(rx, [](EtNet::SPeerAddr ClientAddr, utils::span<uint8_t> rx) { return true; });
+        EXPECT_EQ(dataTransmit[0], rx.HostOrder());
+    }
+    t.join();
+}
+
 int main(int argc, char **argv)
 {
     testing::InitGoogleTest(&argc, argv);
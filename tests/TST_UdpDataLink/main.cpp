@@ -3,6 +3,10 @@
 #include <cstring>
 #include <tuple>
 #include <thread>
+#include <array>
+#include <vector>
+#include <algorithm>
+#include <sys/socket.h>
 #include <Udp/UdpClient.hpp>
 #include <BaseSocket.hpp>
 #include <Udp/UdpServer.hpp>
@@ -64,6 +68,167 @@ TEST_F(CDgramComTest, simple)
     t.join();
 }
 
+TEST_F(CDgramComTest, UringEngine)
+{
+    if (!isIoEngineSupported(EIoEngine::URING)) {
+        GTEST_SKIP() << "io_uring not supported by the running kernel";
+    }
+
+    auto a = m_Client.getLink(std::string("localhost"),50002);
+    EXPECT_EQ(a.setIoEngine(EIoEngine::URING), EIoEngine::URING);
+
+    std::thread t([this]()
+    {
+        uint8_t rcvData[40] = {0};
+        CUdpDataLink a = m_Server.waitForConnection();
+        EXPECT_EQ(a.setIoEngine(EIoEngine::URING), EIoEngine::URING);
+
+        a.reciveFrom(utils::span<uint8_t>(rcvData), [&a](EtNet::SPeerAddr ClientAddr, utils::span<uint8_t> rx)
+        {
+            a.sendTo(ClientAddr, rx);
+            return true;
+        });
+    });
+
+    std::string dataToSend ("hallo uring dgram test");
+    uint8_t rcvData[40] = {0};
+    a.send(utils::span(dataToSend).as_byte());
+    a.reciveFrom(utils::span<uint8_t>(rcvData), [] (EtNet::SPeerAddr ClientAddr, utils::span<uint8_t> rx)
+    {
+        return true;
+    });
+    EXPECT_EQ(std::string((char*)rcvData), dataToSend);
+    t.join();
+
+    a.unblockRecive();
+    EXPECT_EQ(a.reciveFrom(utils::span<uint8_t>(rcvData)), CUdpDataLink::ERet::UNBLOCK);
+}
+
+TEST_F(CDgramComTest, BatchRecive)
+{
+    auto a = m_Client.getLink(std::string("localhost"),50002);
+    const std::vector<std::string> dataToSend {"first", "second datagram", "3", "fourth", "fifth and truncated datagram"};
+    for (const auto& data : dataToSend) {
+        a.send(utils::span(data).as_byte());
+    }
+
+    CUdpDataLink b = m_Server.waitForConnection();
+    std::array<std::array<uint8_t, 16>, 8> buffers;
+    std::array<SDatagram, 8> batch;
+
+    std::size_t recived = 0;
+    while (recived < dataToSend.size())
+    {
+        for (std::size_t i = 0; i < batch.size(); i++) {
+            batch[i].Data = utils::span<uint8_t>(buffers[i].data(), buffers[i].size());
+        }
+
+        std::size_t count = 0;
+        ASSERT_EQ(b.reciveBatch(utils::span<SDatagram>(batch.data(), batch.size()), count), CUdpDataLink::ERet::OK);
+        ASSERT_GT(count, 0U);
+        for (std::size_t i = 0; i < count; i++, recived++)
+        {
+            const std::string& expected = dataToSend[recived];
+            std::size_t length = std::min<std::size_t>(expected.size(), buffers[i].size());
+            EXPECT_EQ(std::string(reinterpret_cast<char*>(batch[i].Data.data()), batch[i].Data.size()), expected.substr(0, length));
+            EXPECT_EQ((batch[i].Flags & MSG_TRUNC) != 0, expected.size() > buffers[i].size());
+            EXPECT_TRUE(batch[i].Peer.Ip.is_loopback());
+            EXPECT_NE(batch[i].Peer.Port, 0U);
+        }
+    }
+
+    std::size_t count = 1;
+    EXPECT_EQ(b.tryReciveBatch(utils::span<SDatagram>(batch.data(), batch.size()), count), CUdpDataLink::ERet::WOULDBLOCK);
+    EXPECT_EQ(count, 0U);
+
+    b.unblockRecive();
+    EXPECT_EQ(b.reciveBatch(utils::span<SDatagram>(batch.data(), batch.size()), count), CUdpDataLink::ERet::UNBLOCK);
+}
+
+TEST_F(CDgramComTest, SegmentedSend)
+{
+    // The buffer exceeds the segments of one sendmsg, the last segment is shorter
+    constexpr std::size_t segmentSize  = 200;
+    constexpr std::size_t segmentCount = 101;
+    std::vector<uint8_t> dataToSend(segmentSize * (segmentCount - 1) + 50);
+    for (std::size_t i = 0; i < dataToSend.size(); i++) {
+        dataToSend[i] = static_cast<uint8_t>(i / segmentSize);
+    }
+
+    auto a = m_Client.getLink(std::string("localhost"),50002);
+    bool segmented = a.sendSegmented(utils::span<const uint8_t>(dataToSend.data(), dataToSend.size()), segmentSize);
+    std::cout << GTEST_BOX << "segmented by the kernel: " << segmented << std::endl;
+
+    CUdpDataLink b = m_Server.waitForConnection();
+    std::array<std::array<uint8_t, 2 * segmentSize>, maxBatchDatagrams> buffers;
+    std::array<SDatagram, maxBatchDatagrams> batch;
+
+    std::size_t recived = 0;
+    while (recived < segmentCount)
+    {
+        for (std::size_t i = 0; i < batch.size(); i++) {
+            batch[i].Data = utils::span<uint8_t>(buffers[i].data(), buffers[i].size());
+        }
+
+        std::size_t count = 0;
+        ASSERT_EQ(b.reciveBatch(utils::span<SDatagram>(batch.data(), batch.size()), count), CUdpDataLink::ERet::OK);
+        for (std::size_t i = 0; i < count; i++, recived++)
+        {
+            std::size_t offset = recived * segmentSize;
+            std::size_t length = std::min(segmentSize, dataToSend.size() - offset);
+            ASSERT_EQ(batch[i].Data.size(), length);
+            EXPECT_TRUE(std::equal(batch[i].Data.begin(), batch[i].Data.end(), dataToSend.begin() + offset));
+        }
+    }
+}
+
+TEST_F(CDgramComTest, GroRecive)
+{
+    constexpr std::size_t segmentSize  = 300;
+    constexpr std::size_t segmentCount = 20;
+    std::vector<uint8_t> dataToSend(segmentSize * segmentCount);
+    for (std::size_t i = 0; i < dataToSend.size(); i++) {
+        dataToSend[i] = static_cast<uint8_t>(i / segmentSize + 1);
+    }
+
+    // GRO has to be enabled at the server link before the segments arrive
+    auto a = m_Client.getLink(std::string("localhost"),50002);
+    std::string hello ("hello");
+    a.send(utils::span(hello).as_byte());
+    CUdpDataLink b = m_Server.waitForConnection();
+    bool gro = b.setGroRecive(true);
+
+    std::vector<uint8_t> rxBuffer(maxGroDatagram);
+    std::size_t recived = 0;
+    std::size_t datagrams = 0;
+    auto onSegments = [&](SPeerAddr ClientAddr, utils::span<const utils::span<uint8_t>> segments)
+    {
+        datagrams++;
+        for (const auto& segment : segments)
+        {
+            if (recived == 0) {
+                EXPECT_EQ(std::string(reinterpret_cast<char*>(segment.data()), segment.size()), hello);
+            }
+            else {
+                std::size_t offset = (recived - 1) * segmentSize;
+                EXPECT_EQ(segment.size(), segmentSize);
+                EXPECT_TRUE(std::equal(segment.begin(), segment.end(), dataToSend.begin() + offset));
+            }
+            recived++;
+        }
+        return false;
+    };
+
+    ASSERT_EQ(b.reciveSegments(utils::span<uint8_t>(rxBuffer.data(), rxBuffer.size()), onSegments), CUdpDataLink::ERet::OK);
+    EXPECT_EQ(recived, 1U);
+
+    a.sendSegmented(utils::span<const uint8_t>(dataToSend.data(), dataToSend.size()), segmentSize);
+    while (recived < segmentCount + 1) {
+        ASSERT_EQ(b.reciveSegments(utils::span<uint8_t>(rxBuffer.data(), rxBuffer.size()), onSegments), CUdpDataLink::ERet::OK);
+    }
+    std::cout << GTEST_BOX << "GRO: " << gro << " segments: " << segmentCount << " in datagrams: " << datagrams - 1 << std::endl;
+    EXPECT_EQ(b.tryReciveSegments(utils::span<uint8_t>(rxBuffer.data(), rxBuffer.size()), onSegments), CUdpDataLink::ERet::WOULDBLOCK);
+}
 
 int main(int argc, char **argv)
 {